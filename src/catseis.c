@@ -1,32 +1,90 @@
 /*-------------------------------------------------------------
   * Cat seismograms (collect seismogram portions from each PE for collective output)
   *
+  * The traces of the PEs are gathered on PE 0 with MPI_Gatherv, so that
+  * only PE 0 holds the whole section (fulldata may be NULL on the other
+  * PEs).  The traces arrive ordered by PE and are moved to their global
+  * positions in place.  If the seismograms are streamed (SEIS_STREAM>0),
+  * PE 0 reads the section of the quantity type (see saveseis_glob) from
+  * the scratch file instead (see seisstream.c).
+  *
   *------------------------------------------------------------- */
 
 #include "fd.h"
 #include "globvar.h"
 
 
-void	catseis(float **data, float **fulldata, int *recswitch, int ntr_glob, int ns) {
-	int		i, j, k;
-	float		**fulldata2;
+void	catseis(float **data, float **fulldata, int *recswitch, int ntr_glob, int ns, int type) {
 
-	/* temporary global data array for MPI-exchange */
-	fulldata2 = fmatrix(1,ntr_glob,1,ns);
+	extern int MYID, NP, SEIS_STREAM;
 
-	k = 0;	/* trace counter for local data array */
+	int		i, j, k, r, ntr = 0;
+	int		*gidx = NULL, *gidx_loc = NULL, *counts = NULL, *displs = NULL, *inv = NULL;
+	float		*tmp;
+	MPI_Datatype	trace;
 
-	/* loop over global traces: copy traces of local array	*/
-	/* to appropriate locations in the global array		*/
-	for(i=1;i<=ntr_glob;i++)
-	{
-		if (recswitch[i]) {
-			k++;
-			for(j=1;j<=ns;j++)	fulldata2[i][j] = data[k][j];
-		}
+	if (SEIS_STREAM > 0) {
+		if (MYID == 0) seisstream_read(fulldata, type);
+		return;
+	}
+
+	/* global indices of the local traces */
+	for (i=1;i<=ntr_glob;i++) if (recswitch[i]) ntr++;
+	gidx_loc = ivector(1, max(ntr,1));
+	k = 0;
+	for (i=1;i<=ntr_glob;i++) if (recswitch[i]) gidx_loc[++k] = i;
+
+	if (MYID == 0) {
+		counts = ivector(0, NP-1);
+		displs = ivector(0, NP-1);
+		gidx = ivector(1, ntr_glob);
+	}
+
+	MPI_Gather(&ntr, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	if (MYID == 0) {
+		displs[0] = 0;
+		for (r=1;r<NP;r++) displs[r] = displs[r-1] + counts[r-1];
+		if (displs[NP-1] + counts[NP-1] != ntr_glob)
+			err(" catseis: %d traces gathered, %d expected ", displs[NP-1] + counts[NP-1], ntr_glob);
 	}
 
-	MPI_Allreduce(&fulldata2[1][1], &fulldata[1][1], ntr_glob*ns, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+	MPI_Gatherv(&gidx_loc[1], ntr, MPI_INT, (MYID == 0) ? &gidx[1] : NULL,
+			counts, displs, MPI_INT, 0, MPI_COMM_WORLD);
+
+	/* one trace of ns samples per element, so that the counts do not overflow */
+	MPI_Type_contiguous(ns, MPI_FLOAT, &trace);
+	MPI_Type_commit(&trace);
+	MPI_Gatherv((ntr > 0) ? &data[1][1] : NULL, ntr, trace, (MYID == 0) ? &fulldata[1][1] : NULL,
+			counts, displs, trace, 0, MPI_COMM_WORLD);
+	MPI_Type_free(&trace);
+
+	if (MYID == 0) {
+		/* the received trace k belongs to the global trace gidx[k]: follow the
+		   cycles of this permutation with one spare trace */
+		inv = ivector(1, ntr_glob);
+		for (k=1;k<=ntr_glob;k++) inv[gidx[k]] = k;
+		tmp = vector(1, ns);
+
+		for (i=1;i<=ntr_glob;i++) {
+			if (inv[i] == i) continue;
+			for (j=1;j<=ns;j++) tmp[j] = fulldata[i][j];
+			k = i;
+			while (inv[k] != i) {
+				r = inv[k];
+				for (j=1;j<=ns;j++) fulldata[k][j] = fulldata[r][j];
+				inv[k] = k;
+				k = r;
+			}
+			for (j=1;j<=ns;j++) fulldata[k][j] = tmp[j];
+			inv[k] = k;
+		}
+
+		free_vector(tmp, 1, ns);
+		free_ivector(inv, 1, ntr_glob);
+		free_ivector(gidx, 1, ntr_glob);
+		free_ivector(counts, 0, NP-1);
+		free_ivector(displs, 0, NP-1);
+	}
 
-	free_matrix(fulldata2, 1,ntr_glob,1,ns);
+	free_ivector(gidx_loc, 1, max(ntr,1));
 }
@@ -9,6 +9,7 @@
 #include <libgen.h>
 #include <unistd.h>
 #include "fd.h"
+#include "enum.h"
 #include "globvar.h"
 
 
@@ -16,16 +17,21 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 		float *** ptaus, float *** ptaup, float *peta, float **srcpos, int nsrc, int **recpos, int ntr){
 
 	/* external variables */
-	extern float DX, DY, DZ, DT, TS, TIME, TSNAP2;
+	extern float DX, DY, DZ, DT, TS, TIME, TSNAP2, COMPRESS_TOL;
 	extern int NX, NY, NZ, L, MYID, IDX, IDY, IDZ, FW, POS[4], NT, NDT, NDTSHIFT;
 	extern int FDCOEFF, ABS_TYPE;
-	extern int NPROCX, NPROCY,NPROCZ, FW, SRCREC, FREE_SURF;
-	extern int SNAP, SEISMO, CHECKPTREAD, CHECKPTWRITE, SEIS_FORMAT[6], SNAP_FORMAT;
+	extern int FW, SRCREC, FREE_SURF;
+	extern int NXG, NYG, NZG, DECOMP, REBALANCE, RUN_MULTIPLE_SHOTS;
+	extern int SNAP, SEISMO, CHECKPTREAD, CHECKPTWRITE, SEIS_FORMAT[6], SNAP_FORMAT, SNAP_MPIIO;
+	extern int CHECKPT_COMPRESS, MODEL_COMPRESS, SEIS_STREAM, SEIS_MPIIO;
+	extern int CHECKPT_INTERVAL;
 	extern int FDORDER, FDORDER_TIME;
 	extern char SEIS_FILE[STRING_SIZE], CHECKPTFILE[STRING_SIZE], SNAP_FILE[STRING_SIZE];
 	extern char SOURCE_FILE[STRING_SIZE], REC_FILE[STRING_SIZE];
 
 	extern int BOUNDARY;
+	extern int HALO_SHM, OVERLAP_COMM, PERSISTENT_COMM, HALO_DATATYPE;
+	extern int HALO_DEEP, FUSED_SWEEP, SOURCE_TYPE;
 
 	/* local variables */
 	float  c=0.0, cmax_p=0.0, cmin_p=1e9, cmax_s=0.0, cmin_s=1.0e9, fmax, cwater=1.0e-1;
@@ -33,7 +39,7 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 	float snapoutx=0.0, snapouty=0.0, snapoutz=0.0, dhmax, dhmin;
     float  cmax=0.0, cmin=1e9, sum, ts, cmax_r, cmin_r, qmax_r, g=0.0;
     // float gamma=0.0; // isnt needed anymore
-	float srec_minx=DX*NX*NPROCX+1, srec_miny=DY*NY*NPROCY+1, srec_minz=DZ*NZ*NPROCZ+1;
+	float srec_minx=DX*NXG+1, srec_miny=DY*NYG+1, srec_minz=DZ*NZG+1;
 	float srec_maxx=-1.0, srec_maxy=-1.0, srec_maxz=-1.0;
 	const float w=2.0*PI/TS; /*center frequency of source*/
 
@@ -100,6 +106,10 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 			sprintf(file_ext,".bin");
 			strcpy(xmod,"ab");
 			break;
+		case 6:
+			sprintf(file_ext,".cmp");
+			strcpy(xmod,"ab");
+			break;
 		default: err(" Sorry. Snapshot format (SNAP_FORMAT) unknown. \n");
 		break;
 		}
@@ -269,14 +279,15 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 	/*-------------------------- */
 	if (CHECKPTREAD>0) {
 		strcpy(xmod,"rb");
-		sprintf(xfile,"%s.%d",CHECKPTFILE,MYID);
+		if (CHECKPTREAD==2) sprintf(xfile,"%s.restart.%d",CHECKPTFILE,checkpoint_pe()); /* see checkpoint.c */
+		else sprintf(xfile,"%s.%d",CHECKPTFILE,checkpoint_pe());
 		fprintf(fp," Check readability for checkpoint files %s... \n",xfile);
 		if (((fpcheck=fopen(xfile,xmod))==NULL) && (MYID==0)) err(" PE 0 cannot read checkpoints!");
 		else fclose(fpcheck);
 	}
 	if ((CHECKPTWRITE>0)){
 		strcpy(xmod,"ab");
-		sprintf(xfile,"%s.%d",CHECKPTFILE,MYID);
+		sprintf(xfile,"%s.%d",CHECKPTFILE,checkpoint_pe());
 		fprintf(fp," Check writability for checkpoint files %s... \n",xfile);
 		if (((fpcheck=fopen(xfile,xmod))==NULL) && (MYID==0)) err(" PE 0 cannot write checkpoints!");
 		else fclose(fpcheck); /* Is there any reason to remove it? */
@@ -383,7 +394,6 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 
 	fprintf(fp," MYID\t Vp_min(f=fc) \t Vp_max(f=inf) \t Vs_min(f=fc) \t Vs_max(f=inf) \n");
 	fprintf(fp," %d \t %8.2f \t %8.2f \t %8.2f \t %8.2f \n\n\n", MYID, cmin_p, cmax_p, cmin_s, cmax_s);
-	fprintf(fp,"    DENSITY file %f, %f ... \n\n\n\n\n\n\n\n\n\n\n\n",prho[25][25][25], prho[5][5][5]);
 
 	fprintf(fp," Note : if any P- or S-wave velocity is set below 1.0 m/s to simulate water or air,\n");
 	fprintf(fp," this minimum velocity will be ignored for determining stable DH and DT.\n\n");
@@ -542,12 +552,64 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 		fprintf(fp,"    Output of snapshot gridpoints per node (NY/NPROCY/IDY) %8.2f .\n", snapouty);
 		fprintf(fp,"    Output of snapshot gridpoints per node (NZ/NPROCZ/IDZ) %8.2f .\n", snapoutz);
 
-		if (snapoutx-(int)snapoutx>0)
+		/* the slabs of DECOMP=1 start at multiples of IDX, IDY, IDZ (see decomp.c) */
+		if ((snapoutx-(int)snapoutx>0) && !DECOMP)
 			err("\n\n Ratio NX-NPROCX-IDX must be whole-numbered \n\n");
-		if (snapouty-(int)snapouty>0)
+		if ((snapouty-(int)snapouty>0) && !DECOMP)
 			err("\n\n Ratio NY-NPROCY-IDY must be whole-numbered \n\n");
-		if (snapoutz-(int)snapoutz>0)
+		if ((snapoutz-(int)snapoutz>0) && !DECOMP)
 			err("\n\n Ratio NZ-NPROCZ-IDZ must be whole-numbered \n\n");
+
+		if (SNAP_MPIIO && (SNAP_FORMAT!=3))
+			err("\n\n Snapshots are written with MPI-IO (SNAP_MPIIO=1) in binary format only (SNAP_FORMAT=3) \n\n");
+	}
+
+	if ((SNAP_FORMAT==6 || CHECKPT_COMPRESS || MODEL_COMPRESS) && (COMPRESS_TOL<0.0))
+		err("\n\n The error bound of the compression (COMPRESS_TOL) must not be negative \n\n");
+
+	if (SEISMO && (SEIS_STREAM<0))
+		err("\n\n The block length of the seismogram streaming (SEIS_STREAM) must not be negative \n\n");
+
+	if (SEISMO && SEIS_MPIIO && (SEIS_FORMAT[0]==2))
+		err("\n\n Seismograms are written with MPI-IO (SEIS_MPIIO=1) in SEG-Y, SU or binary format only \n\n");
+
+	if (CHECKPT_INTERVAL<0)
+		err("\n\n The interval of the checkpoints (CHECKPT_INTERVAL) must not be negative \n\n");
+
+	/* the derivatives of the previous time steps are not stored in the checkpoints */
+	if (((CHECKPT_INTERVAL>0) || (CHECKPTREAD==2)) && (FDORDER_TIME>2))
+		err("\n\n Checkpoints in the time loop (CHECKPT_INTERVAL, CHECKPTREAD=2) require FDORDER_TIME=2 \n\n");
+
+	/* the slabs change between the shots (see decomp_rebalance) */
+	if (REBALANCE && !DECOMP)
+		err("\n\n The load rebalancing (REBALANCE=1) requires the cost-weighted domain decomposition (DECOMP=1) \n\n");
+	if (REBALANCE && ((CHECKPT_INTERVAL>0) || CHECKPTREAD || CHECKPTWRITE))
+		err("\n\n The load rebalancing (REBALANCE=1) cannot be combined with checkpoints \n\n");
+	if (REBALANCE && SNAP && !SNAP_MPIIO)
+		err("\n\n With the load rebalancing (REBALANCE=1) snapshots are written with MPI-IO only (SNAP_MPIIO=1) \n\n");
+	if (REBALANCE && !RUN_MULTIPLE_SHOTS && (MYID==0))
+		warning(" The load rebalancing (REBALANCE=1) takes effect between the shots of RUN_MULTIPLE_SHOTS=1 only.\n");
+
+	/* the shared buffers replace those of the blocking exchange (see halo_shm.c) */
+	if (HALO_SHM && (OVERLAP_COMM || PERSISTENT_COMM || HALO_DATATYPE))
+		err("\n\n The exchange through shared memory (HALO_SHM=1) cannot be combined with OVERLAP_COMM, PERSISTENT_COMM or HALO_DATATYPE \n\n");
+
+	/* the ghost zones are updated redundantly by the plain elastic update
+	   with the damping frame only (see halo_deep.c) */
+	if (HALO_DEEP<0)
+		err("\n\n The depth of the deep halo (HALO_DEEP) must not be negative \n\n");
+	if (HALO_DEEP>1){
+		if ((ABS_TYPE!=2) || L || (FDORDER_TIME!=2))
+			err("\n\n The deep halo (HALO_DEEP>1) requires ABS_TYPE=2, L=0 and FDORDER_TIME=2 \n\n");
+		if (OVERLAP_COMM || PERSISTENT_COMM || HALO_DATATYPE || HALO_SHM || FUSED_SWEEP)
+			err("\n\n The deep halo (HALO_DEEP>1) cannot be combined with OVERLAP_COMM, PERSISTENT_COMM, HALO_DATATYPE, HALO_SHM or FUSED_SWEEP \n\n");
+		if (BOUNDARY || REBALANCE || (CHECKPT_INTERVAL>0) || CHECKPTREAD || CHECKPTWRITE)
+			err("\n\n The deep halo (HALO_DEEP>1) cannot be combined with BOUNDARY=1, REBALANCE=1 or checkpoints \n\n");
+		if (SOURCE_TYPE==SOURCE_TYPE_RANDOM)
+			err("\n\n The deep halo (HALO_DEEP>1) cannot be combined with the random source (SOURCE_TYPE=0) \n\n");
+		if ((NX<HALO_DEEP*FDORDER) || (NY<HALO_DEEP*FDORDER) || (NZ<HALO_DEEP*FDORDER))
+			err("\n\n With the deep halo the subdomains must be at least HALO_DEEP*FDORDER = %d grid points wide, \n"
+				" but PE %d has NX=%d, NY=%d, NZ=%d \n\n", HALO_DEEP*FDORDER, MYID, NX, NY, NZ);
 	}
 
 	if ((SEISMO)&& (MYID==0)){
@@ -558,12 +620,12 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 	}
 
 	if ((SEISMO>0) && (MYID==0)) {
-		srec_minx=DX*NX*NPROCX+1, srec_miny=DY*NY*NPROCY+1, srec_minz=DZ*NZ*NPROCZ+1;
+		srec_minx=DX*NXG+1, srec_miny=DY*NYG+1, srec_minz=DZ*NZG+1;
 		srec_maxx=-1.0, srec_maxy=-1.0, srec_maxz=-1.0;
 		fprintf(fp,"\n Checking for receiver position(s) specified in input file.\n");
-		fprintf(fp,"    Global grid size in m : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",DX,NX*DX*NPROCX,DY,NY*DY*NPROCY,DZ,NZ*DZ*NPROCZ);
-		if (FREE_SURF==0) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NX*DX*NPROCX-FW*DX,FW*DY,NY*DY*NPROCY-FW*DY,FW*DZ,NZ*DZ*NPROCZ-FW*DZ);
-		if (FREE_SURF==1) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NX*DX*NPROCX-FW*DX,DY,NY*DY*NPROCY-FW*DY,FW*DZ,NZ*DZ*NPROCZ-FW*DZ);
+		fprintf(fp,"    Global grid size in m : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",DX,NXG*DX,DY,NYG*DY,DZ,NZG*DZ);
+		if (FREE_SURF==0) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NXG*DX-FW*DX,FW*DY,NYG*DY-FW*DY,FW*DZ,NZG*DZ-FW*DZ);
+		if (FREE_SURF==1) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NXG*DX-FW*DX,DY,NYG*DY-FW*DY,FW*DZ,NZG*DZ-FW*DZ);
 
 		/* find maximum and minimum source positions coordinate ---- from input file*/
 		/*note that "y" is used for the vertical coordinate */
@@ -620,7 +682,7 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 		if ((((srec_maxx<0.0) || (srec_maxy<0.0)) || ((srec_maxz<0.0))) || (((srec_minx<0.0) || (srec_miny<0.0)) || ((srec_minz<0.0)))) {
 			err("\n\n Coordinate of at least one receiver location is outside the global grid. \n\n");
 		}
-		if (((srec_maxx>NX*DX*NPROCX) || (srec_maxz>NZ*DZ*NPROCZ)) || ((srec_maxy>NY*DY*NPROCY))) {
+		if (((srec_maxx>NXG*DX) || (srec_maxz>NZG*DZ)) || ((srec_maxy>NYG*DY))) {
 			err("\n\n Coordinate of at least one receiver location is outside the global grid. \n\n");
 		}
 		/* checking if receiver coordinate of first receiver in line specified in input-file is inside the Absorbing Boundary  */
@@ -628,7 +690,7 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 			/* this warning appears, when at least a single receiver is located in AB between 0 - FW+DX/DX/DZ ("inner boundary")*/
 			warning("\n\n Coordinate of at least one receiver location is inside the Absorbing Boundary (warning 1). \n\n");
 		}
-		if (((srec_maxx>(NX*DX*NPROCX-FW*DX)) || (srec_maxy>(NY*DY*NPROCY-FW*DY)) || ((srec_maxz>(NZ*DZ*NPROCZ-FW*DZ))))) {
+		if (((srec_maxx>(NXG*DX-FW*DX)) || (srec_maxy>(NYG*DY-FW*DY)) || ((srec_maxz>(NZG*DZ-FW*DZ))))) {
 			/* this warning appears, when at least a single receiver is located in AB between NX/NY/NZ-FW+DX/DX/DZ and NX/NY/NZ ("outer boundary")*/
 			warning("\n\n Coordinate of at least one receiver location is inside the Absorbing Boundary (warning 2). \n\n");
 		}
@@ -638,12 +700,12 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 	}
 
 	if ((SRCREC==1)&& (MYID==0)){
-		srec_minx=DX*NX*NPROCX+1, srec_miny=DY*NY*NPROCY+1, srec_minz=DZ*NZ*NPROCZ+1;
+		srec_minx=DX*NXG+1, srec_miny=DY*NYG+1, srec_minz=DZ*NZG+1;
 		srec_maxx=-1.0, srec_maxy=-1.0, srec_maxz=-1.0;
 		fprintf(fp,"\n Checking for source position(s) specified in source file. \n");
-		fprintf(fp,"    Global grid size in m: %5.2f (x) : %5.2f (y) : %5.2f (z) :.\n",NX*DX*NPROCX,NY*DY*NPROCY,NZ*DZ*NPROCZ);
-		if (FREE_SURF==0) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in	m).\n",FW*DX,NX*DX*NPROCX-FW*DX,FW*DZ,NY*DY*NPROCY-FW*DY,FW*DZ,NZ*DZ*NPROCZ-FW*DZ);
-		if (FREE_SURF==1) fprintf(fp,"    Global grid size in m(-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NX*DX*NPROCX-FW*DX,FW*DY,NZ*DY*NPROCY-FW*DY,DZ,NZ*DZ*NPROCZ-FW*DZ);
+		fprintf(fp,"    Global grid size in m: %5.2f (x) : %5.2f (y) : %5.2f (z) :.\n",NXG*DX,NYG*DY,NZG*DZ);
+		if (FREE_SURF==0) fprintf(fp,"    Global grid size in m (-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in	m).\n",FW*DX,NXG*DX-FW*DX,FW*DZ,NYG*DY-FW*DY,FW*DZ,NZG*DZ-FW*DZ);
+		if (FREE_SURF==1) fprintf(fp,"    Global grid size in m(-width of abs.boundary) : \n        %5.2f-%5.2f (x in m) : %5.2f-%5.2f (y in m) : %5.2f-%5.2f (z in m).\n",FW*DX,NXG*DX-FW*DX,FW*DY,NYG*DY-FW*DY,DZ,NZG*DZ-FW*DZ);
 
 		/*only for testing
 		fprintf(fp," initial min : %5.2f (x) %5.2f (y) %5.2f (z). \n",srec_minx,srec_miny,srec_minz);
@@ -672,7 +734,7 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 		if ((((srec_maxx<0.0) || (srec_maxy<0.0)) || ((srec_maxz<0.0))) || (((srec_minx<0.0) || (srec_miny<0.0)) || ((srec_minz<0.0)))) {
 			err("\n\n Coordinate of at least one source location is outside the global grid. \n\n");
 		}
-		if (((srec_maxx>NX*DX*NPROCX) || (srec_maxy>NY*DY*NPROCY)) || ((srec_maxz>NZ*DZ*NPROCZ))) {
+		if (((srec_maxx>NXG*DX) || (srec_maxy>NYG*DY)) || ((srec_maxz>NZG*DZ))) {
 			err("\n\n Coordinate of at least one source location is outside the global grid. \n\n");
 		}
 		/* checking if receiver coordinate of first receiver in line specified in input-file is outside the Absorbing Boundary  */
@@ -680,7 +742,7 @@ void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
 			/* this warning appears, when at least a single receiver is located in AB between 0 - FW+DX/DX/DZ ("inner boundary")*/
 			warning("\n\n Coordinate of at least one source location is inside the Absorbing Boundary (warning 1). \n\n");
 		}
-		if (((srec_maxx>(NX*DX*NPROCX-FW*DX)) || (srec_maxy>(NY*DY*NPROCY-FW*DY)) || ((srec_maxz>(NZ*DZ*NPROCZ-FW*DZ))))) {
+		if (((srec_maxx>(NXG*DX-FW*DX)) || (srec_maxy>(NYG*DY-FW*DY)) || ((srec_maxz>(NZG*DZ-FW*DZ))))) {
 			/* this warning appears, when at least a single receiver is located in AB between NX/NY/NZ-FW+DX/DX/DZ and NX/NY/NZ ("outer boundary")*/
 			warning("\n\n Coordinate of at least one source location is inside the Absorbing Boundary (warning 2). \n\n");
 		}
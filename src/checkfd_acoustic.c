@@ -16,11 +16,13 @@
 void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, int nsrc, int **recpos, int ntr){
 
 	/* external variables */
-	extern float DX, DY, DZ, DT, TS, TIME, TSNAP2;
+	extern float DX, DY, DZ, DT, TS, TIME, TSNAP2, COMPRESS_TOL;
 	extern int NX, NY, NZ, MYID, IDX, IDY, IDZ, FW, POS[4], NT, NDT, NDTSHIFT;
 	extern int FDCOEFF, ABS_TYPE;
 	extern int NPROCX, NPROCY,NPROCZ, FW, SRCREC, FREE_SURF;
-	extern int SNAP, SEISMO, CHECKPTREAD, CHECKPTWRITE, SEIS_FORMAT[6], SNAP_FORMAT;
+	extern int SNAP, SEISMO, CHECKPTREAD, CHECKPTWRITE, SEIS_FORMAT[6], SNAP_FORMAT, SNAP_MPIIO;
+	extern int CHECKPT_INTERVAL, PERSISTENT_COMM, OVERLAP_COMM, HALO_DATATYPE, HALO_SHM, HALO_DEEP;
+	extern int CHECKPT_COMPRESS, MODEL_COMPRESS, SEIS_STREAM, SEIS_MPIIO;
 	extern int FDORDER;
 	extern char SEIS_FILE[STRING_SIZE], CHECKPTFILE[STRING_SIZE], SNAP_FILE[STRING_SIZE];
 	extern char SOURCE_FILE[STRING_SIZE], REC_FILE[STRING_SIZE];
@@ -68,6 +70,10 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 			sprintf(file_ext,".bin");
 			strcpy(xmod,"ab");
 			break;
+		case 6:
+			sprintf(file_ext,".cmp");
+			strcpy(xmod,"ab");
+			break;
 		default: err(" Sorry. Snapshot format (SNAP_FORMAT) unknown. \n");
 		}		
 
@@ -236,6 +242,18 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 
 	/*Checking CHECKPOINT Output */
 	/*-------------------------- */
+	if ((CHECKPT_INTERVAL>0) || (CHECKPTREAD==2))
+		err("\n\n Checkpoints in the time loop (CHECKPT_INTERVAL, CHECKPTREAD=2) are not available in the acoustic code \n\n");
+	if (PERSISTENT_COMM)
+		err("\n\n Persistent requests for the halo exchange (PERSISTENT_COMM) are not available in the acoustic code \n\n");
+	if (OVERLAP_COMM)
+		err("\n\n The overlap of the halo exchange with the update (OVERLAP_COMM) is not available in the acoustic code \n\n");
+	if (HALO_DATATYPE)
+		err("\n\n The halo exchange with MPI derived datatypes (HALO_DATATYPE) is not available in the acoustic code \n\n");
+	if (HALO_SHM)
+		err("\n\n The halo exchange through shared memory (HALO_SHM) is not available in the acoustic code \n\n");
+	if (HALO_DEEP>1)
+		err("\n\n The deep halo (HALO_DEEP>1) is not available in the acoustic code \n\n");
 	if (CHECKPTREAD>0) {
 		strcpy(xmod,"rb");
 		sprintf(xfile,"%s.%d",CHECKPTFILE,MYID);
@@ -432,8 +450,20 @@ void checkfd_acoustic(FILE *fp, float *** prho, float *** ppi, float **srcpos, i
 			err("\n\n Ratio NY-NPROCY-IDY must be whole-numbered \n\n");
 		if (snapoutz-(int)snapoutz>0)
 			err("\n\n Ratio NZ-NPROCZ-IDZ must be whole-numbered \n\n");
+
+		if (SNAP_MPIIO && (SNAP_FORMAT!=3))
+			err("\n\n Snapshots are written with MPI-IO (SNAP_MPIIO=1) in binary format only (SNAP_FORMAT=3) \n\n");
 	}
 
+	if ((SNAP_FORMAT==6 || CHECKPT_COMPRESS || MODEL_COMPRESS) && (COMPRESS_TOL<0.0))
+		err("\n\n The error bound of the compression (COMPRESS_TOL) must not be negative \n\n");
+
+	if (SEISMO && (SEIS_STREAM<0))
+		err("\n\n The block length of the seismogram streaming (SEIS_STREAM) must not be negative \n\n");
+
+	if (SEISMO && SEIS_MPIIO && (SEIS_FORMAT[0]==2))
+		err("\n\n Seismograms are written with MPI-IO (SEIS_MPIIO=1) in SEG-Y, SU or binary format only \n\n");
+
 	if ((SEISMO)&& (MYID==0)){
 		fprintf(fp,"\n Checking the number of seismogram samples. \n");
 		fprintf(fp,"    Number of timesteps %d.\n", NT);
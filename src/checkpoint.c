@@ -0,0 +1,505 @@
+/*------------------------------------------------------------------------
+ *   Periodic checkpoints in the time loop (CHECKPT_INTERVAL > 0) and the
+ *   restart of an interrupted run at the time step of the last checkpoint
+ *   (CHECKPTREAD=2).
+ *
+ *   The wavefields, memory variables, CPML variables and the seismogram
+ *   sections of the PE are registered once (`checkpoint_field`,
+ *   `checkpoint_section`).  Every CHECKPT_INTERVAL time steps each PE writes
+ *   them with one fwrite per array after a header with the position in the
+ *   time loop to
+ *
+ *       CHECKPT_FILE.restart.PE.tmp
+ *
+ *   and after all PEs have written their files, each PE renames it to
+ *   CHECKPT_FILE.restart.PE.  A checkpoint is thus published atomically:
+ *   if the run is killed while writing, the previous checkpoint remains.
+ *   With CHECKPT_ASYNC=1 the arrays are copied to a staging buffer and an
+ *   I/O thread writes the file while the time stepping continues; the
+ *   checkpoint is published with the next one or at the end of the run.
+ *
+ *   The checkpoint also records the sizes of the snapshot files of the PE,
+ *   which are cut back to these sizes on restart, so that the snapshots
+ *   after the checkpoint are not appended twice.  Streamed seismograms
+ *   (SEIS_STREAM) are synchronized to disk before the checkpoint.
+ *
+ *   PE is the index of the subdomain in the processor grid (`checkpoint_pe`),
+ *   not MYID, since MPI_Cart_create may reorder the ranks between the runs.
+ *   The header also holds the index and the first global grid point of the
+ *   subdomain, which must be the same on restart.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fd.h"
+#include "globvar.h"
+
+
+#define CHECKPOINT_MAGIC 0x41534331L /* "ASC1" */
+#define CHECKPOINT_NHEAD 16          /* magic, size, position, snapshot files, subdomain */
+
+/* a registered array: box of a 3-D array or section of ntr x ns samples */
+typedef struct {
+    float ***a, **section;
+    int box[6];
+    long n;
+} CheckptItem;
+
+static CheckptItem *item = NULL;
+static int nitem = 0;
+static long nvalue = 0, nmax = 0;
+
+static char file[STRING_SIZE], tmpname[STRING_SIZE];
+static long head[CHECKPOINT_NHEAD];
+static float *buf = NULL;  /* staging buffer (CHECKPT_ASYNC) or scratch of one array */
+static FILE *fpread = NULL;
+static int pending = 0, ok = 1, active = 0;
+
+/* I/O thread: writes the staging buffer if `todo` is set */
+static pthread_t writer;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int todo = 0, done = 0;
+
+/* snapshot quantities, see `snap` */
+static const char *snapquant[6] = {"vx", "vy", "vz", "div", "curl", "p"};
+
+
+/* pack the item it into b or unpack b into the item */
+static void checkpoint_copy(const CheckptItem *it, float *b, int pack)
+{
+    const int *x = it->box;
+    long m = 0;
+    int i, j, k;
+
+    if (it->section) {
+        for (i = x[0]; i <= x[1]; i++)
+            for (k = x[2]; k <= x[3]; k++) {
+                if (pack) b[m++] = it->section[i][k];
+                else it->section[i][k] = b[m++];
+            }
+        return;
+    }
+    for (j = x[2]; j <= x[3]; j++)
+        for (i = x[0]; i <= x[1]; i++)
+            for (k = x[4]; k <= x[5]; k++) {
+                if (pack) b[m++] = it->a[j][i][k];
+                else it->a[j][i][k] = b[m++];
+            }
+}
+
+/* write the header and the arrays to the temporary file, from the staging
+   buffer (staged) or array by array; returns 0 on failure */
+static int checkpoint_file_write(int staged)
+{
+    FILE *fp;
+    int n, success;
+
+    fp = fopen(tmpname, "wb");
+    if (fp == NULL)
+        return 0;
+
+    success = (fwrite(head, sizeof(long), CHECKPOINT_NHEAD, fp) == CHECKPOINT_NHEAD);
+    if (staged)
+        success = success && (fwrite(buf, sizeof(float), nvalue, fp) == (size_t) nvalue);
+    else
+        for (n = 0; success && (n < nitem); n++) {
+            checkpoint_copy(&item[n], buf, 1);
+            success = (fwrite(buf, sizeof(float), item[n].n, fp) == (size_t) item[n].n);
+        }
+
+    /* the data must be on disk before the checkpoint is published */
+    success = success && (fflush(fp) == 0) && (fsync(fileno(fp)) == 0);
+    return (fclose(fp) == 0) && success;
+}
+
+static void *checkpoint_writer(void *arg)
+{
+    int success;
+
+    (void) arg;
+
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        while (!todo && !done)
+            pthread_cond_wait(&cond, &lock);
+        if (!todo) {
+            pthread_mutex_unlock(&lock);
+            break;
+        }
+        pthread_mutex_unlock(&lock);
+
+        success = checkpoint_file_write(1);
+
+        pthread_mutex_lock(&lock);
+        ok = success;
+        todo = 0;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+
+    return NULL;
+}
+
+/* publish the checkpoint written last, collective over MPI_COMM_WORLD */
+static void checkpoint_publish(void)
+{
+    extern int CHECKPT_ASYNC, MYID;
+    extern FILE *FP;
+
+    int success, all;
+
+    if (!pending)
+        return;
+
+    if (CHECKPT_ASYNC) {
+        pthread_mutex_lock(&lock);
+        while (todo)
+            pthread_cond_wait(&cond, &lock);
+        pthread_mutex_unlock(&lock);
+    }
+    success = ok;
+
+    /* the previous checkpoint is replaced only if all PEs have written theirs */
+    MPI_Allreduce(&success, &all, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!all)
+        err(" Could not write the checkpoint of time step %ld (file %s) ! ", head[3], tmpname);
+    if (rename(tmpname, file))
+        err(" Could not rename checkpoint file %s to %s ! ", tmpname, file);
+    pending = 0;
+
+    if (MYID == 0)
+        fprintf(FP, " Checkpoint of shot %ld, time step %ld written to %s.restart.*\n",
+                head[2], head[3], CHECKPTFILE);
+}
+
+/* the snapshot file of the quantity q of the PE */
+static int checkpoint_snapfile(char *name, int q)
+{
+    extern int SNAP, SNAP_FORMAT, SNAP_MPIIO;
+
+    if (!SNAP || SNAP_MPIIO)
+        return 0;
+    snap_file(name, SNAP_FORMAT, snapquant[q]);
+    return 1;
+}
+
+
+/**
+ * Register the box nx1..nx2, ny1..ny2, nz1..nz2 of the array a [j][i][k]
+ * for the checkpoints.
+ */
+void checkpoint_field(float ***a, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2)
+{
+    CheckptItem *it;
+
+    item = realloc(item, (nitem + 1) * sizeof(CheckptItem));
+    if (item == NULL)
+        err(" Allocation of the checkpoint list failed ! ");
+    it = &item[nitem++];
+    it->a = a;
+    it->section = NULL;
+    it->box[0] = nx1; it->box[1] = nx2;
+    it->box[2] = ny1; it->box[3] = ny2;
+    it->box[4] = nz1; it->box[5] = nz2;
+    it->n = (long) (nx2 - nx1 + 1) * (ny2 - ny1 + 1) * (nz2 - nz1 + 1);
+    nvalue += it->n;
+    nmax = max(nmax, it->n);
+}
+
+/**
+ * Register the seismogram section [1..ntr][1..ns] for the checkpoints
+ * (nothing is done if section is NULL).
+ */
+void checkpoint_section(float **section, int ntr, int ns)
+{
+    CheckptItem *it;
+
+    if ((section == NULL) || (ntr <= 0))
+        return;
+
+    item = realloc(item, (nitem + 1) * sizeof(CheckptItem));
+    if (item == NULL)
+        err(" Allocation of the checkpoint list failed ! ");
+    it = &item[nitem++];
+    it->a = NULL;
+    it->section = section;
+    it->box[0] = 1; it->box[1] = ntr;
+    it->box[2] = 1; it->box[3] = ns;
+    it->box[4] = it->box[5] = 0;
+    it->n = (long) ntr * ns;
+    nvalue += it->n;
+    nmax = max(nmax, it->n);
+}
+
+/**
+ * Register the wavefields of the time stepping like `save_checkpoint`, but
+ * including all halos: velocity and stress (allocated with the bounds
+ * nrl..ndh, the normal stresses and sxz from y = sl), the memory variables
+ * (L>0) and the CPML variables psi (ABS_TYPE=1), of which psi[0..5] are
+ * damped along x, psi[6..11] along y and psi[12..17] along z.
+ */
+void checkpoint_wavefield(Velocity *v, Tensor3d *s, Tensor3d *r, float ***psi[18],
+        int nrl, int nrh, int ncl, int nch, int ndl, int ndh, int sl)
+{
+    extern int NX, NY, NZ, FW, L, ABS_TYPE;
+
+    /* the boxes of the CPML variables along x, y and z, see sofi3D.c */
+    const int psibox[3][6] = {
+        {1, 2 * FW, 1, NY, 1, NZ},
+        {1, NX, 1, 2 * FW, 1, NZ},
+        {1, NX, 1, NY, 1, 2 * FW}};
+    int n, d;
+
+    checkpoint_field(v->x, ncl, nch, nrl, nrh, ndl, ndh);
+    checkpoint_field(v->y, ncl, nch, nrl, nrh, ndl, ndh);
+    checkpoint_field(v->z, ncl, nch, nrl, nrh, ndl, ndh);
+    checkpoint_field(s->xy, ncl, nch, nrl, nrh, ndl, ndh);
+    checkpoint_field(s->yz, ncl, nch, nrl, nrh, ndl, ndh);
+    checkpoint_field(s->xz, ncl, nch, sl, nrh, ndl, ndh);
+    checkpoint_field(s->xx, ncl, nch, sl, nrh, ndl, ndh);
+    checkpoint_field(s->yy, ncl, nch, sl, nrh, ndl, ndh);
+    checkpoint_field(s->zz, ncl, nch, sl, nrh, ndl, ndh);
+
+    if (L) {
+        checkpoint_field(r->xx, 1, NX, 1, NY, 1, NZ);
+        checkpoint_field(r->yy, 1, NX, 1, NY, 1, NZ);
+        checkpoint_field(r->zz, 1, NX, 1, NY, 1, NZ);
+        checkpoint_field(r->xy, 1, NX, 1, NY, 1, NZ);
+        checkpoint_field(r->yz, 1, NX, 1, NY, 1, NZ);
+        checkpoint_field(r->xz, 1, NX, 1, NY, 1, NZ);
+    }
+
+    if (ABS_TYPE == 1)
+        for (n = 0; n < 18; n++) {
+            d = n / 6;
+            checkpoint_field(psi[n], psibox[d][0], psibox[d][1], psibox[d][2], psibox[d][3],
+                    psibox[d][4], psibox[d][5]);
+        }
+}
+
+/**
+ * Index of the subdomain of the PE in the processor grid, x varying fastest.
+ * Without reordering of the ranks by MPI_Cart_create it equals MYID.
+ */
+int checkpoint_pe(void)
+{
+    extern int NPROCX, NPROCY, POS[4];
+
+    return POS[1] + NPROCX * (POS[2] + NPROCY * POS[3]);
+}
+
+/* linear global index of the first grid point of the subdomain */
+static long checkpoint_origin(void)
+{
+    extern int NXG, NYG, POS[4];
+
+    return SLABX[POS[1]] + (long) NXG * (SLABY[POS[2]] + (long) NYG * SLABZ[POS[3]]);
+}
+
+/**
+ * Allocate the buffer of the checkpoints and start the I/O thread
+ * (CHECKPT_ASYNC=1).  Called after the registration of the arrays.
+ */
+void checkpoint_ini(void)
+{
+    extern int CHECKPT_INTERVAL, CHECKPT_ASYNC, CHECKPTREAD, MYID;
+    extern FILE *FP;
+
+    if ((CHECKPT_INTERVAL <= 0) && (CHECKPTREAD != 2))
+        return;
+    active = 1;
+
+    sprintf(file, "%s.restart.%d", CHECKPTFILE, checkpoint_pe());
+    sprintf(tmpname, "%s.tmp", file);
+
+    /* the whole checkpoint is staged for the I/O thread */
+    if ((CHECKPT_INTERVAL > 0) && CHECKPT_ASYNC) {
+        buf = malloc(max(nvalue, 1) * sizeof(float));
+        todo = done = 0;
+        if ((buf != NULL) && pthread_create(&writer, NULL, checkpoint_writer, NULL))
+            err(" Could not start the checkpoint I/O thread ! ");
+    }
+    else
+        buf = malloc(max(nmax, 1) * sizeof(float));
+    if (buf == NULL)
+        err(" Allocation of the checkpoint buffer failed ! ");
+
+    if ((MYID == 0) && (CHECKPT_INTERVAL > 0))
+        fprintf(FP, " Checkpoints every %d time steps (%.2f MB per PE%s).\n", CHECKPT_INTERVAL,
+                nvalue * sizeof(float) / (1024.0 * 1024.0),
+                CHECKPT_ASYNC ? ", written by an I/O thread" : "");
+}
+
+/**
+ * Is a checkpoint due after time step nt ?
+ */
+int checkpoint_due(int nt)
+{
+    extern int CHECKPT_INTERVAL, NT;
+
+    return (CHECKPT_INTERVAL > 0) && (nt < NT) && (nt % CHECKPT_INTERVAL == 0);
+}
+
+/**
+ * Write a checkpoint after the time step pos->nt, see the header of the
+ * file.  Collective over MPI_COMM_WORLD.  The halo exchange of the time step
+ * must be complete.
+ */
+void checkpoint_write(const CheckptPos *pos)
+{
+    extern int CHECKPT_ASYNC, MYID;
+    extern FILE *FP;
+
+    struct stat st;
+    char snapname[STRING_SIZE];
+    double t = MPI_Wtime();
+    long m = 0;
+    int n, q;
+
+    /* the previous checkpoint is published before its buffer is reused */
+    checkpoint_publish();
+
+    /* the output up to this time step must be complete */
+    snap_async_wait();
+    seisstream_sync();
+
+    head[0] = CHECKPOINT_MAGIC;
+    head[1] = nvalue;
+    head[2] = pos->ishot;
+    head[3] = pos->nt;
+    head[4] = pos->nsnap;
+    head[5] = pos->lsnap;
+    head[6] = pos->nlsamp;
+    head[7] = pos->lsamp;
+    for (q = 0; q < 6; q++) {
+        head[8 + q] = -1;
+        if (checkpoint_snapfile(snapname, q) && (stat(snapname, &st) == 0))
+            head[8 + q] = (long) st.st_size;
+    }
+    head[14] = checkpoint_pe();
+    head[15] = checkpoint_origin();
+
+    if (CHECKPT_ASYNC) {
+        for (n = 0; n < nitem; n++) {
+            checkpoint_copy(&item[n], buf + m, 1);
+            m += item[n].n;
+        }
+        pthread_mutex_lock(&lock);
+        todo = 1;
+        pending = 1;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+    else {
+        ok = checkpoint_file_write(0);
+        pending = 1;
+        checkpoint_publish();
+    }
+
+    if (MYID == 0)
+        fprintf(FP, " Checkpoint after time step %d took %4.2f s on PE 0.\n", pos->nt, MPI_Wtime() - t);
+}
+
+/**
+ * Read the position in the time loop from the checkpoint of an interrupted
+ * run (CHECKPTREAD=2); the arrays are restored by `checkpoint_restore`.
+ * Collective over MPI_COMM_WORLD.
+ */
+void checkpoint_read(CheckptPos *pos)
+{
+    extern int MYID;
+    extern FILE *FP;
+
+    int p[2], pmin[2], pmax[2];
+
+    fpread = fopen(file, "rb");
+    if (fpread == NULL)
+        err(" Could not open checkpoint file %s ! ", file);
+    if (fread(head, sizeof(long), CHECKPOINT_NHEAD, fpread) != CHECKPOINT_NHEAD)
+        err(" Could not read the header of checkpoint file %s ! ", file);
+    if (head[0] != CHECKPOINT_MAGIC)
+        err(" %s is not a checkpoint written with CHECKPT_INTERVAL ! ", file);
+    if (head[1] != nvalue)
+        err(" Checkpoint file %s holds %ld values, %ld expected (different model or parameters?) ! ",
+                file, head[1], nvalue);
+    if ((head[14] != checkpoint_pe()) || (head[15] != checkpoint_origin()))
+        err(" Checkpoint file %s belongs to another subdomain (different PEs or slabs?) ! ", file);
+
+    pos->ishot = (int) head[2];
+    pos->nt = (int) head[3];
+    pos->nsnap = (int) head[4];
+    pos->lsnap = (int) head[5];
+    pos->nlsamp = (int) head[6];
+    pos->lsamp = (int) head[7];
+
+    /* a run killed while the checkpoints were renamed leaves files of two checkpoints */
+    p[0] = pos->ishot;
+    p[1] = pos->nt;
+    MPI_Allreduce(p, pmin, 2, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(p, pmax, 2, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if ((pmin[0] != pmax[0]) || (pmin[1] != pmax[1]))
+        err(" The checkpoint files of the PEs belong to different time steps ! ");
+
+    if (MYID == 0)
+        fprintf(FP, " Restarting shot %d after time step %d from checkpoint files %s.restart.*\n",
+                pos->ishot, pos->nt, CHECKPTFILE);
+}
+
+/**
+ * Restore the registered arrays and the snapshot files of the PE from the
+ * checkpoint opened by `checkpoint_read`.
+ */
+void checkpoint_restore(void)
+{
+    char snapname[STRING_SIZE];
+    int n, q;
+
+    if (fpread == NULL)
+        return;
+
+    for (n = 0; n < nitem; n++) {
+        if (fread(buf, sizeof(float), item[n].n, fpread) != (size_t) item[n].n)
+            err(" Could not read array %d from checkpoint file %s ! ", n + 1, file);
+        checkpoint_copy(&item[n], buf, 0);
+    }
+    fclose(fpread);
+    fpread = NULL;
+
+    for (q = 0; q < 6; q++)
+        if ((head[8 + q] >= 0) && checkpoint_snapfile(snapname, q))
+            if (truncate(snapname, (off_t) head[8 + q]))
+                err(" Could not cut snapshot file %s back to the checkpoint ! ", snapname);
+}
+
+/**
+ * Publish the last checkpoint, stop the I/O thread and free the buffers.
+ * Collective over MPI_COMM_WORLD.
+ */
+void checkpoint_free(void)
+{
+    extern int CHECKPT_INTERVAL, CHECKPT_ASYNC;
+
+    if (!active)
+        return;
+
+    checkpoint_publish();
+    if ((CHECKPT_INTERVAL > 0) && CHECKPT_ASYNC) {
+        pthread_mutex_lock(&lock);
+        done = 1;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+        pthread_join(writer, NULL);
+    }
+
+    free(buf);
+    free(item);
+    buf = NULL;
+    item = NULL;
+    nitem = 0;
+    nvalue = nmax = 0;
+    active = 0;
+}
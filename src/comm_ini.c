@@ -8,46 +8,57 @@
 #include "globvar.h"
 
 
-void comm_ini(float *** bufferlef_to_rig, float *** bufferrig_to_lef, 
-float *** buffertop_to_bot, float *** bufferbot_to_top, 
-float *** bufferfro_to_bac, float *** bufferbac_to_fro, 
+/*
+ * Create the persistent requests for the exchange of particle velocities
+ * (PERSISTENT_COMM=1); they are started by `exchange_v_start` and completed
+ * by `exchange_v_finish` in every time step.
+ *
+ * Standard-mode sends are used, i.e. no buffer has to be attached for
+ * MPI_Bsend.  The received values go to separate buffers of the same size as
+ * the send buffers.  If `type_send` is not NULL, the datatypes of
+ * `exchange_v_types` are used instead of the buffers (HALO_DATATYPE=1).
+ * The requests are stored in the order top_to_bot, bot_to_top, lef_to_rig,
+ * rig_to_lef, fro_to_bac, bac_to_fro and are released by
+ * `halo_requests_free`.
+ */
+void comm_ini(float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+float *** buffertop_to_bot, float *** bufferbot_to_top,
+float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+MPI_Datatype *type_send, MPI_Datatype *type_rec,
 MPI_Request *req_send, MPI_Request *req_rec){
 
 
-	extern int NX, NY, NZ, INDEX[7], FDORDER;
+	extern int NX, NY, NZ, FDORDER;
 	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
 
-	int nf1, nf2;
+	int nf1, nf2, nb[7];
 
-	/* comunication initialisation for persistent communication */
+	if (type_send){
+		halo_persistent(type_send, type_rec, req_send, req_rec);
+		return;
+	}
 
-	/* buffer arrays are copied into local buffers using buffered send (bsend),
-	  Actually send is activated by MPI_START(request) within time loop.
-	  MPI_BSEND and MPI_RECV (see below) are then non-blocking.
-	*/
-	
-	
 	/* number of wavefield parameters that need to be exchanged - see exchange_v.c */
 	nf1=3*FDORDER/2 -1;
 	nf2=nf1-1;
-	
-	
-	MPI_Bsend_init(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[1],TAG1,MPI_COMM_WORLD,&req_send[0]);
-	MPI_Bsend_init(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[2],TAG2,MPI_COMM_WORLD,&req_send[1]);
-	MPI_Bsend_init(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[5],TAG3,MPI_COMM_WORLD,&req_send[2]);
-	MPI_Bsend_init(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[6],TAG4,MPI_COMM_WORLD,&req_send[3]);
-	MPI_Bsend_init(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,MPI_COMM_WORLD,&req_send[4]);
-	MPI_Bsend_init(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,MPI_COMM_WORLD,&req_send[5]);
-
-	/* initialising of receive of buffer arrays. Same arrays for send and receive
-	   are used. Thus, before starting receive, it is necessary to check if
-	   Bsend has copied data into local buffers, i.e. has completed.
-	*/
-	MPI_Recv_init(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[2],TAG1,MPI_COMM_WORLD,&req_rec[0]);
-	MPI_Recv_init(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[1],TAG2,MPI_COMM_WORLD,&req_rec[1]);
-	MPI_Recv_init(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[6],TAG3,MPI_COMM_WORLD,&req_rec[2]);
-	MPI_Recv_init(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[5],TAG4,MPI_COMM_WORLD,&req_rec[3]);
-	MPI_Recv_init(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[4],TAG5,MPI_COMM_WORLD,&req_rec[4]);
-	MPI_Recv_init(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[3],TAG6,MPI_COMM_WORLD,&req_rec[5]);
+
+	halo_neighbours(nb);
+
+	MPI_Send_init(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[3],TAG5,MPI_COMM_WORLD,&req_send[0]);
+	MPI_Send_init(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[4],TAG6,MPI_COMM_WORLD,&req_send[1]);
+	MPI_Send_init(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[1],TAG1,MPI_COMM_WORLD,&req_send[2]);
+	MPI_Send_init(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[2],TAG2,MPI_COMM_WORLD,&req_send[3]);
+	MPI_Send_init(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[5],TAG3,MPI_COMM_WORLD,&req_send[4]);
+	MPI_Send_init(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[6],TAG4,MPI_COMM_WORLD,&req_send[5]);
+
+	MPI_Recv_init(&rbuffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[4],TAG5,MPI_COMM_WORLD,&req_rec[0]);
+	MPI_Recv_init(&rbufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[3],TAG6,MPI_COMM_WORLD,&req_rec[1]);
+	MPI_Recv_init(&rbufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[2],TAG1,MPI_COMM_WORLD,&req_rec[2]);
+	MPI_Recv_init(&rbufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[1],TAG2,MPI_COMM_WORLD,&req_rec[3]);
+	MPI_Recv_init(&rbufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[6],TAG3,MPI_COMM_WORLD,&req_rec[4]);
+	MPI_Recv_init(&rbufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[5],TAG4,MPI_COMM_WORLD,&req_rec[5]);
 
 }
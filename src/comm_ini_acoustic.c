@@ -1,46 +0,0 @@
-/*------------------------------------------------------------------------
- *   initialisation of repeated comunications. This may reduce the
- *   network overhead. Communication is started later
- *   with MPI_START(request)
-  *  ----------------------------------------------------------------------*/
-
-#include "fd.h"
-#include "globvar.h"
-
-
-void comm_ini_acoustic(float *** bufferlef_to_rig, float *** bufferrig_to_lef, 
-float *** buffertop_to_bot, float *** bufferbot_to_top, 
-float *** bufferfro_to_bac, float *** bufferbac_to_fro, 
-MPI_Request *req_send, MPI_Request *req_rec){
-
-
-	extern int NX, NY, NZ, INDEX[7], FDORDER;
-	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
-
-
-
-	/* comunication initialisation for persistent communication */
-
-	/* buffer arrays are copied into local buffers using buffered send (bsend),
-	  Actually send is activated by MPI_START(request) within time loop.
-	  MPI_BSEND and MPI_RECV (see below) are then non-blocking.
-	*/
-	MPI_Bsend_init(&bufferlef_to_rig[1][1][1],NY*NZ*FDORDER/2,MPI_FLOAT,INDEX[1],TAG1,MPI_COMM_WORLD,&req_send[0]);
-	MPI_Bsend_init(&bufferrig_to_lef[1][1][1],NY*NZ*(FDORDER/2-1),MPI_FLOAT,INDEX[2],TAG2,MPI_COMM_WORLD,&req_send[1]);
-	MPI_Bsend_init(&bufferfro_to_bac[1][1][1],NX*NY*FDORDER/2,MPI_FLOAT,INDEX[5],TAG3,MPI_COMM_WORLD,&req_send[2]);
-	MPI_Bsend_init(&bufferbac_to_fro[1][1][1],NX*NY*(FDORDER/2-1),MPI_FLOAT,INDEX[6],TAG4,MPI_COMM_WORLD,&req_send[3]);
-	MPI_Bsend_init(&buffertop_to_bot[1][1][1],NX*NZ*FDORDER/2,MPI_FLOAT,INDEX[3],TAG5,MPI_COMM_WORLD,&req_send[4]);
-	MPI_Bsend_init(&bufferbot_to_top[1][1][1],NX*NZ*(FDORDER/2-1),MPI_FLOAT,INDEX[4],TAG6,MPI_COMM_WORLD,&req_send[5]);
-
-	/* initialising of receive of buffer arrays. Same arrays for send and receive
-	   are used. Thus, before starting receive, it is necessary to check if
-	   Bsend has copied data into local buffers, i.e. has completed.
-	*/
-	MPI_Recv_init(&bufferlef_to_rig[1][1][1],NY*NZ*FDORDER/2,MPI_FLOAT,INDEX[2],TAG1,MPI_COMM_WORLD,&req_rec[0]);
-	MPI_Recv_init(&bufferrig_to_lef[1][1][1],NY*NZ*(FDORDER/2-1),MPI_FLOAT,INDEX[1],TAG2,MPI_COMM_WORLD,&req_rec[1]);
-	MPI_Recv_init(&bufferfro_to_bac[1][1][1],NX*NY*FDORDER/2,MPI_FLOAT,INDEX[6],TAG3,MPI_COMM_WORLD,&req_rec[2]);
-	MPI_Recv_init(&bufferbac_to_fro[1][1][1],NX*NY*(FDORDER/2-1),MPI_FLOAT,INDEX[5],TAG4,MPI_COMM_WORLD,&req_rec[3]);
-	MPI_Recv_init(&buffertop_to_bot[1][1][1],NX*NZ*FDORDER/2,MPI_FLOAT,INDEX[4],TAG5,MPI_COMM_WORLD,&req_rec[4]);
-	MPI_Recv_init(&bufferbot_to_top[1][1][1],NX*NZ*(FDORDER/2-1),MPI_FLOAT,INDEX[3],TAG6,MPI_COMM_WORLD,&req_rec[5]);
-
-}
@@ -0,0 +1,219 @@
+/*------------------------------------------------------------------------
+ *   Error-bounded lossy compression of float arrays.
+ *
+ *   Used for snapshots (SNAP_FORMAT=6), checkpoints (CHECKPT_COMPRESS=1)
+ *   and the model files of the PEs (MODEL_COMPRESS=1).  The values are
+ *   quantized with the step 2*tol, so that the error of each value does not
+ *   exceed tol, where tol is COMPRESS_TOL (COMPRESS_REL=0) or COMPRESS_TOL
+ *   times the largest amplitude of the record (COMPRESS_REL=1).  The
+ *   differences of successive quantized values are stored in blocks of
+ *   COMPRESS_BLOCK values with the number of bits of the largest difference
+ *   of the block (block floating point), so that the quiet parts of a
+ *   wavefield take one byte per block.
+ *
+ *   A file is a sequence of records:
+ *
+ *       int magic, n; float step; int nbytes; nbytes bytes of blocks
+ *
+ *   Each block consists of one byte nbits followed by its (at most
+ *   COMPRESS_BLOCK) zigzag coded differences of nbits bits each, least
+ *   significant bit first.  Integers and floats are stored in the native
+ *   byte order like the binary output.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+
+
+#define COMPRESS_MAGIC 0x504d4341 /* "ACMP" */
+#define COMPRESS_BLOCK 64
+
+/* largest quantized amplitude, so that the differences fit into 32 bits */
+#define COMPRESS_QMAX (1L << 30)
+
+typedef struct {
+    int magic, n;
+    float step;
+    int nbytes;
+} CompressHeader;
+
+
+/* upper bound of the size of the blocks of n values */
+static size_t compress_bound(int n)
+{
+    return (size_t) n * 4 + (size_t) (n / COMPRESS_BLOCK + 1);
+}
+
+/* quantization step of the n values a for the error bound tol */
+static float compress_step(const float *a, int n, float tol, int rel)
+{
+    float amax = 0.0, step;
+    int i;
+
+    for (i = 0; i < n; i++)
+        amax = max(amax, fabsf(a[i]));
+    if (amax == 0.0)
+        return 0.0;
+
+    step = 2.0 * tol * (rel ? amax : 1.0);
+    if ((step <= 0.0) || (amax / step > COMPRESS_QMAX))
+        step = amax / COMPRESS_QMAX;
+    return step;
+}
+
+/* encode the n values a quantized with step to out, returns the number of bytes */
+static size_t compress_encode(const float *a, int n, float step, unsigned char *out)
+{
+    unsigned long long z[COMPRESS_BLOCK], zor, acc;
+    long long q, prev = 0;
+    size_t len = 0;
+    int b, i, m, nbits, nacc;
+
+    if (step == 0.0)
+        return 0;
+
+    for (b = 0; b < n; b += COMPRESS_BLOCK) {
+        m = min(COMPRESS_BLOCK, n - b);
+        zor = 0;
+        for (i = 0; i < m; i++) {
+            q = llrint((double) a[b + i] / step);
+            z[i] = (q >= prev) ? 2ULL * (unsigned long long) (q - prev)
+                               : 2ULL * (unsigned long long) (prev - q) - 1;
+            zor |= z[i];
+            prev = q;
+        }
+
+        for (nbits = 0; (nbits < 64) && (zor >> nbits); nbits++)
+            ;
+        out[len++] = (unsigned char) nbits;
+
+        acc = 0;
+        nacc = 0;
+        for (i = 0; (i < m) && nbits; i++) {
+            acc |= z[i] << nacc;
+            nacc += nbits;
+            while (nacc >= 8) {
+                out[len++] = (unsigned char) (acc & 0xff);
+                acc >>= 8;
+                nacc -= 8;
+            }
+        }
+        if (nacc > 0)
+            out[len++] = (unsigned char) acc;
+    }
+
+    return len;
+}
+
+/* decode n values from the nbytes bytes in, returns 0 on corrupt data */
+static int compress_decode(const unsigned char *in, size_t nbytes, float step, float *a, int n)
+{
+    unsigned long long z, acc, mask;
+    long long q = 0;
+    size_t len = 0;
+    int b, i, m, nbits, nacc;
+
+    if (step == 0.0) {
+        for (i = 0; i < n; i++)
+            a[i] = 0.0;
+        return nbytes == 0;
+    }
+
+    for (b = 0; b < n; b += COMPRESS_BLOCK) {
+        m = min(COMPRESS_BLOCK, n - b);
+        if (len >= nbytes)
+            return 0;
+        nbits = in[len++];
+        if (nbits > 33)
+            return 0;
+        mask = (1ULL << nbits) - 1;
+
+        acc = 0;
+        nacc = 0;
+        for (i = 0; i < m; i++) {
+            while (nacc < nbits) {
+                if (len >= nbytes)
+                    return 0;
+                acc |= (unsigned long long) in[len++] << nacc;
+                nacc += 8;
+            }
+            z = acc & mask;
+            acc >>= nbits;
+            nacc -= nbits;
+
+            q += (z & 1) ? -(long long) ((z + 1) / 2) : (long long) (z / 2);
+            a[b + i] = (float) (q * (double) step);
+        }
+    }
+
+    return len == nbytes;
+}
+
+/**
+ * Write the n values a as one compressed record to fp.  The error of each
+ * value is at most tol, or tol times the largest amplitude of a if rel is
+ * set.
+ */
+void compress_write(FILE *fp, const float *a, int n, float tol, int rel)
+{
+    CompressHeader h;
+    unsigned char *buf;
+
+    buf = malloc(compress_bound(n));
+    if (buf == NULL)
+        err(" Allocation of the compression buffer failed ! ");
+
+    h.magic = COMPRESS_MAGIC;
+    h.n = n;
+    h.step = compress_step(a, n, tol, rel);
+    h.nbytes = (int) compress_encode(a, n, h.step, buf);
+
+    if ((fwrite(&h, sizeof(h), 1, fp) != 1)
+            || (fwrite(buf, 1, h.nbytes, fp) != (size_t) h.nbytes))
+        err(" Could not write %d compressed amplitudes to disk. ", n);
+
+    free(buf);
+}
+
+/**
+ * Number of values of the next record of fp without reading it, or 0 at
+ * the end of the file.
+ */
+int compress_next(FILE *fp)
+{
+    CompressHeader h;
+
+    if (fread(&h, sizeof(h), 1, fp) != 1)
+        return 0;
+    fseek(fp, -(long) sizeof(h), SEEK_CUR);
+
+    if (h.magic != COMPRESS_MAGIC)
+        err(" Not a compressed file (or corrupt record) ! ");
+    return h.n;
+}
+
+/**
+ * Read the next record of fp, which must hold n values, to a.
+ */
+void compress_read(FILE *fp, float *a, int n)
+{
+    CompressHeader h;
+    unsigned char *buf;
+
+    if (fread(&h, sizeof(h), 1, fp) != 1)
+        err(" Could not read a compressed record (end of file) ! ");
+    if (h.magic != COMPRESS_MAGIC)
+        err(" Not a compressed file (or corrupt record) ! ");
+    if (h.n != n)
+        err(" Compressed record of %d values where %d values are expected ! ", h.n, n);
+
+    buf = malloc(max(h.nbytes, 1));
+    if (buf == NULL)
+        err(" Allocation of the compression buffer failed ! ");
+    if (fread(buf, 1, h.nbytes, fp) != (size_t) h.nbytes)
+        err(" Could not read %d compressed amplitudes ! ", n);
+    if (!compress_decode(buf, h.nbytes, h.step, a, n))
+        err(" Corrupt compressed record of %d values ! ", n);
+
+    free(buf);
+}
@@ -0,0 +1,10 @@
+# Automatic configuration file for ASOFI3D
+# Do not modify! This file was created automatically.
+# Detected C compiler: gcc
+# CC: MPI wrapper over C compiler
+# CFLAGS: flags for C compiler
+# LDLIBS: libraries that must be linked into the executables
+CC = mpicc
+CFLAGS = -Wall -Wextra -Wpedantic -std=c11 -pthread  -O3 -flto -ftree-vectorize -funroll-loops
+CPPFLAGS =  -D_XOPEN_SOURCE=500
+LDLIBS = -lm
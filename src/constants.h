@@ -6,6 +6,9 @@
 //#define STRING_SIZE 74 //previous value, sometimes not enough to handle longer file names
 #define STRING_SIZE 256
 #define REQUEST_COUNT 6
+/* wavefields exchanged through shared memory (HALO_SHM), see halo_shm.c */
+#define HALO_SHM_V 0
+#define HALO_SHM_S 1
 
 enum NPROC_ENUM { NPROCX_MAX = 100, NPROCY_MAX = 100, NPROCZ_MAX = 100 };
 #endif
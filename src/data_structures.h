@@ -93,8 +93,45 @@ typedef struct {
     float ***C55ipkp;
 } OrthoPar;
 
+/*
+ * Update coefficients of the viscoelastic medium (L=1) at each grid point,
+ * computed once from the material and relaxation parameters by
+ * `visco_coeff` instead of at every point and time step.
+ */
+typedef struct {
+    // uipjp*DT*(1+L*tausipjp) and alike on the half-integer grid.
+    float ***fipjp;
+    float ***fjpkp;
+    float ***fipkp;
+    // pi*(1+L*taup) and 2*u*(1+L*taus).
+    float ***g;
+    float ***f;
+    // uipjp*eta*tausipjp and alike, coefficients of the memory variables.
+    float ***dipjp;
+    float ***djpkp;
+    float ***dipkp;
+    // 2*u*eta*taus and pi*eta*taup.
+    float ***d;
+    float ***e;
+} ViscoPar;
+
+/*
+ * Position in the loops over shots and time steps after time step nt, with
+ * the counters of the snapshots and seismogram samples, as stored in the
+ * checkpoints written with CHECKPT_INTERVAL (see checkpoint.c).
+ */
+typedef struct {
+    int ishot, nt;
+    // number of the last snapshot and time step of the next one.
+    int nsnap, lsnap;
+    // number and time step of the next seismogram sample.
+    int nlsamp, lsamp;
+} CheckptPos;
+
 /* ****************************************************************************
    Allocation and deallocation operations.
+   The components are allocated with `f3tensor_aligned`: each one is a single
+   aligned block with padded rows, and the usual [j][i][k] pointer tables.
 */
 void init_velocity(
         Velocity *v,
@@ -112,6 +149,14 @@ void free_tensor3d(
         Tensor3d *t,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh);
 
+void init_visco_par(
+        ViscoPar *vp,
+        int nrl, int nrh, int ncl, int nch, int ndl, int ndh);
+
+void free_visco_par(
+        ViscoPar *vp,
+        int nrl, int nrh, int ncl, int nch, int ndl, int ndh);
+
 void init_velocity_derivatives_tensor(
         VelocityDerivativesTensor *dv,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh);
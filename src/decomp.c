@@ -0,0 +1,677 @@
+/*------------------------------------------------------------------------
+ *   Domain decomposition of the global grid into NPROCX*NPROCY*NPROCZ
+ *   subdomains.
+ *
+ *   The subdomains are the products of slabs along the axes: the PEs at
+ *   POS[1]=ip hold the global grid points SLABX[ip]+1 ... SLABX[ip+1] in x
+ *   (likewise SLABY in y and SLABZ in z).  With DECOMP=0 all slabs have the
+ *   same width, which requires NX, NY and NZ to be multiples of NPROCX,
+ *   NPROCY and NPROCZ.  With DECOMP=1 the grid may have any size and the
+ *   slab widths are chosen from a cost model of the time step, so that the
+ *   PEs owning the absorbing frame, which have more work per grid point,
+ *   get fewer grid points:
+ *
+ *       interior grid point        1 + 0.14*L
+ *       CPML frame (ABS_TYPE=1)    additional 0.33 + 0.28*L
+ *       damping frame (ABS_TYPE=2) additional 0.05
+ *       free surface (j=1)         additional 1
+ *       receiver                   4 per seismogram sample (every NDT steps)
+ *
+ *   in units of the update of an interior grid point of the elastic model
+ *   (measured with FDORDER=4 on a 96^3 grid).  Along each axis the costs
+ *   of the grid planes are summed over the other axes and the axis is cut
+ *   into slabs of the smallest possible maximum cost.  With snapshots
+ *   (SNAP>0) the cuts are multiples of IDX (IDY, IDZ), so that the decimated
+ *   snapshots of the PEs fit together, and the slabs at the edges of the
+ *   grid are at least FW wide to hold the absorbing frame.
+ *
+ *   The predicted costs of the subdomains of the weighted and of the uniform
+ *   decomposition (the remainder of the division in the last slab) are
+ *   printed before the time stepping; if the uniform slabs are possible and
+ *   predicted to be as fast, they are taken.  snapmerge needs
+ *   the slabs to merge the snapshots; they are written to SNAP_FILE.decomp.
+ *
+ *   If NPROCX, NPROCY or NPROCZ is 0, the process grid is chosen for the
+ *   number of PEs of the run (`decomp_procgrid`), so that the PEs exchange
+ *   the fewest halo points.  The chosen grid is written to SNAP_FILE.decomp
+ *   as well.
+ *
+ *   With REBALANCE=1 the cost model is corrected by measurement between the
+ *   shots of RUN_MULTIPLE_SHOTS=1 (`decomp_rebalance`): the time of each PE
+ *   in the time loop without the halo exchange, divided by the predicted
+ *   cost of its subdomain, weights the grid points and receivers of the
+ *   subdomain, and the axes are cut anew with these weights.  The model
+ *   arrays are then moved to the new subdomains (`decomp_redistribute`).
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/* cost model, see above */
+#define DECOMP_COST_VISCO 0.14       /* per relaxation mechanism */
+#define DECOMP_COST_CPML 0.33
+#define DECOMP_COST_CPML_VISCO 0.28  /* per relaxation mechanism */
+#define DECOMP_COST_ABS 0.05
+#define DECOMP_COST_SURF 1.0
+#define DECOMP_COST_REC 4.0
+
+/* least predicted gain of the rebalanced slabs (REBALANCE=1) */
+#define DECOMP_REBALANCE_GAIN 0.05
+
+static double cost_base, cost_frame;
+
+/* grid points 1 ... n[d] of the axes x, y, z (d = 0, 1, 2) outside the
+   absorbing frame: first[d] ... last[d] */
+static int n[3], first[3], last[3];
+
+static void decomp_model(void)
+{
+    extern int NXG, NYG, NZG, L, ABS_TYPE, FW, FREE_SURF, BOUNDARY;
+
+    const int lo[3] = {ABS_TYPE && !((ABS_TYPE == 2) && BOUNDARY), ABS_TYPE && !FREE_SURF,
+                       ABS_TYPE && !((ABS_TYPE == 2) && BOUNDARY)};
+    const int hi[3] = {lo[0], ABS_TYPE != 0, lo[2]};
+    int d;
+
+    cost_base = 1.0 + DECOMP_COST_VISCO * L;
+    cost_frame = 0.0;
+    if (ABS_TYPE == 1)
+        cost_frame = DECOMP_COST_CPML + DECOMP_COST_CPML_VISCO * L;
+    if (ABS_TYPE == 2)
+        cost_frame = DECOMP_COST_ABS;
+
+    n[0] = NXG; n[1] = NYG; n[2] = NZG;
+    for (d = 0; d < 3; d++) {
+        first[d] = lo[d] ? FW + 1 : 1;
+        last[d] = hi[d] ? n[d] - FW : n[d];
+    }
+}
+
+/* number of grid points of [i1, i2] outside the frame of axis d */
+static int decomp_inner(int d, int i1, int i2)
+{
+    return max(0, min(i2, last[d]) - max(i1, first[d]) + 1);
+}
+
+/* cost of the box b = {x1, x2, y1, y2, z1, z2} of global grid points
+   without the receivers */
+static double decomp_cost(const int *b)
+{
+    extern int FREE_SURF;
+
+    const double nx = b[1] - b[0] + 1, ny = b[3] - b[2] + 1, nz = b[5] - b[4] + 1;
+    const double inner = (double) decomp_inner(0, b[0], b[1]) * decomp_inner(1, b[2], b[3])
+                       * decomp_inner(2, b[4], b[5]);
+    double c;
+
+    c = cost_base * nx * ny * nz + cost_frame * (nx * ny * nz - inner);
+    if (FREE_SURF && (b[2] == 1))
+        c += DECOMP_COST_SURF * nx * nz;
+    return c;
+}
+
+/* measured time per predicted cost of the subdomains of the slabs ox, oy, oz
+   (index ip + NPROCX*(jp + NPROCY*kp)), only while decomp_rebalance cuts
+   the axes anew */
+static double *weight = NULL;
+
+/* the slabs before the last rebalancing, POS[1...3] of the ranks */
+static int ox[NPROCX_MAX + 1], oy[NPROCY_MAX + 1], oz[NPROCZ_MAX + 1];
+static int *rankpos = NULL;
+
+/* cost of the box b, weighted with the measured factors of the subdomains
+   it overlaps */
+static double decomp_wcost(const int *b)
+{
+    extern int NPROCX, NPROCY, NPROCZ;
+
+    int c[6], ip, jp, kp;
+    double cost = 0.0;
+
+    if (!weight)
+        return decomp_cost(b);
+    for (kp = 0; kp < NPROCZ; kp++)
+        for (jp = 0; jp < NPROCY; jp++)
+            for (ip = 0; ip < NPROCX; ip++) {
+                c[0] = max(b[0], ox[ip] + 1); c[1] = min(b[1], ox[ip + 1]);
+                c[2] = max(b[2], oy[jp] + 1); c[3] = min(b[3], oy[jp + 1]);
+                c[4] = max(b[4], oz[kp] + 1); c[5] = min(b[5], oz[kp + 1]);
+                if ((c[0] <= c[1]) && (c[2] <= c[3]) && (c[4] <= c[5]))
+                    cost += weight[ip + NPROCX * (jp + NPROCY * kp)] * decomp_cost(c);
+            }
+    return cost;
+}
+
+/* cost of the receiver i, weighted like decomp_wcost */
+static double decomp_rec(int **recpos, int i)
+{
+    extern int NPROCX, NPROCY, NPROCZ, NDT;
+
+    int ip, jp, kp;
+
+    if (!weight)
+        return DECOMP_COST_REC / NDT;
+    ip = decomp_owner(ox, NPROCX, recpos[1][i]);
+    jp = decomp_owner(oy, NPROCY, recpos[2][i]);
+    kp = decomp_owner(oz, NPROCZ, recpos[3][i]);
+    if ((ip < 0) || (jp < 0) || (kp < 0))
+        return DECOMP_COST_REC / NDT;
+    return weight[ip + NPROCX * (jp + NPROCY * kp)] * DECOMP_COST_REC / NDT;
+}
+
+/* greedy cut of the grid planes 1 ... nn with the summed costs cum[0...nn]
+   into np slabs of a cost of at most t each (cuts multiples of g, slabs at least wmin, at the edges wfw wide);
+   returns 0 if this is not possible */
+static int decomp_cut(const double *cum, int nn, int np, int g, int wmin, int wfw,
+        double t, int *slab)
+{
+    int p, c, c1, c2, rest;
+
+    slab[0] = 0;
+    for (p = 0; p < np - 1; p++) {
+        /* the following slabs need at least rest grid points */
+        rest = (np - p - 2) * wmin + max(wmin, wfw);
+        c1 = slab[p] + ((p == 0) ? max(wmin, wfw) : wmin);
+        c1 = (c1 + g - 1) / g * g;
+        c2 = (nn - rest) / g * g;
+        if ((c1 > c2) || (cum[c1] - cum[slab[p]] > t))
+            return 0;
+        for (c = c1; (c + g <= c2) && (cum[c + g] - cum[slab[p]] <= t); c += g)
+            ;
+        slab[p + 1] = c;
+    }
+    slab[np] = nn;
+    return (nn - slab[np - 1] >= max(wmin, wfw)) && (cum[nn] - cum[slab[np - 1]] <= t);
+}
+
+/* granularity g[0...2] of the cuts along x, y, z: multiples of IDX, IDY,
+   IDZ only for the snapshots */
+static void decomp_grain(int *g)
+{
+    extern int IDX, IDY, IDZ, SNAP;
+
+    g[0] = SNAP ? IDX : 1;
+    g[1] = SNAP ? IDY : 1;
+    g[2] = SNAP ? IDZ : 1;
+}
+
+/* weighted slabs of axis d among np PEs, cuts multiples of g;
+   returns 0 if the axis cannot be divided (slab is undefined then) */
+static int decomp_axis(int d, int np, int g, int **recpos, int ntr, int *slab)
+{
+    extern int FW, FDORDER;
+
+    /* the other axes */
+    const int e = (d == 0) ? 1 : 0, f = (d == 2) ? 1 : 2;
+    double *cum, lo, hi, t;
+    int b[6], i, it;
+
+    cum = dvector(0, n[d]);
+    b[2 * e] = 1; b[2 * e + 1] = n[e];
+    b[2 * f] = 1; b[2 * f + 1] = n[f];
+
+    cum[0] = 0.0;
+    for (i = 1; i <= n[d]; i++) {
+        b[2 * d] = b[2 * d + 1] = i;
+        cum[i] = decomp_wcost(b);
+    }
+    for (i = 1; i <= ntr; i++)
+        if ((recpos[d + 1][i] >= 1) && (recpos[d + 1][i] <= n[d]))
+            cum[recpos[d + 1][i]] += decomp_rec(recpos, i);
+    for (i = 1; i <= n[d]; i++)
+        cum[i] += cum[i - 1];
+
+    /* bisection of the largest cost of a slab */
+    lo = 0.0;
+    hi = cum[n[d]];
+    if (!decomp_cut(cum, n[d], np, g, FDORDER, FW, hi, slab)) {
+        free_dvector(cum, 0, n[d]);
+        return 0;
+    }
+    for (it = 0; it < 60; it++) {
+        t = 0.5 * (lo + hi);
+        if (decomp_cut(cum, n[d], np, g, FDORDER, FW, t, slab))
+            hi = t;
+        else
+            lo = t;
+    }
+    decomp_cut(cum, n[d], np, g, FDORDER, FW, hi, slab);
+
+    free_dvector(cum, 0, n[d]);
+    return 1;
+}
+
+/* largest and mean predicted cost of the subdomains of the slabs sx, sy, sz */
+static void decomp_predict(const int *sx, const int *sy, const int *sz, int **recpos, int ntr,
+        double *cmax, double *cmean)
+{
+    extern int NPROCX, NPROCY, NPROCZ;
+
+    int b[6], ip, jp, kp, i;
+    double c;
+
+    *cmax = *cmean = 0.0;
+    for (kp = 0; kp < NPROCZ; kp++)
+        for (jp = 0; jp < NPROCY; jp++)
+            for (ip = 0; ip < NPROCX; ip++) {
+                b[0] = sx[ip] + 1; b[1] = sx[ip + 1];
+                b[2] = sy[jp] + 1; b[3] = sy[jp + 1];
+                b[4] = sz[kp] + 1; b[5] = sz[kp + 1];
+                c = decomp_wcost(b);
+                for (i = 1; i <= ntr; i++)
+                    if ((recpos[1][i] >= b[0]) && (recpos[1][i] <= b[1])
+                            && (recpos[2][i] >= b[2]) && (recpos[2][i] <= b[3])
+                            && (recpos[3][i] >= b[4]) && (recpos[3][i] <= b[5]))
+                        c += decomp_rec(recpos, i);
+                *cmax = max(*cmax, c);
+                *cmean += c;
+            }
+    *cmean /= NPROCX * NPROCY * NPROCZ;
+}
+
+/* widths of the slabs SLABX, SLABY, SLABZ to FP */
+static void decomp_print_slabs(void)
+{
+    extern int NPROCX, NPROCY, NPROCZ;
+    extern FILE *FP;
+
+    int p;
+
+    fprintf(FP, " x:");
+    for (p = 0; p < NPROCX; p++) fprintf(FP, " %d", SLABX[p + 1] - SLABX[p]);
+    fprintf(FP, "\n y (vertical):");
+    for (p = 0; p < NPROCY; p++) fprintf(FP, " %d", SLABY[p + 1] - SLABY[p]);
+    fprintf(FP, "\n z:");
+    for (p = 0; p < NPROCZ; p++) fprintf(FP, " %d", SLABZ[p + 1] - SLABZ[p]);
+    fprintf(FP, "\n");
+}
+
+/**
+ * Process grid NPROCX x NPROCY x NPROCZ for the NP PEs if one or more of
+ * NPROCX, NPROCY, NPROCZ are 0 (the others are kept).  Of the factorizations
+ * of NP which give valid subdomains, the one with the fewest grid points in
+ * the halos of an inner subdomain (FDORDER/2 planes at each face with a
+ * neighbour) is chosen, ties are broken by the halo points of all PEs.
+ * All PEs choose the same grid.  PE 0 prints it to FP.
+ */
+void decomp_procgrid(void)
+{
+    extern int NXG, NYG, NZG, NP, NPROC, NPROCX, NPROCY, NPROCZ, IDX, IDY, IDZ;
+    extern int FW, FDORDER, BOUNDARY, DECOMP, SNAP, MYID;
+    extern FILE *FP;
+
+    const int ng[3] = {NXG, NYG, NZG}, id[3] = {IDX, IDY, IDZ};
+    const int fixed[3] = {NPROCX, NPROCY, NPROCZ};
+    const int npmax[3] = {NPROCX_MAX, NPROCY_MAX, NPROCZ_MAX};
+    const int wmin = max(FW, FDORDER);
+    double halo, total, face, best = -1.0, besttotal = 0.0;
+    int p[3], pbest[3] = {0, 0, 0}, d, ok, w;
+
+    for (p[0] = 1; p[0] <= NP; p[0]++)
+        for (p[1] = 1; p[1] <= NP / p[0]; p[1]++) {
+            if (NP % (p[0] * p[1]))
+                continue;
+            p[2] = NP / (p[0] * p[1]);
+
+            for (d = 0, ok = 1; ok && (d < 3); d++) {
+                ok = (p[d] <= npmax[d]) && (!fixed[d] || (p[d] == fixed[d]));
+                if (ok && DECOMP) {
+                    /* the slabs of decomp_weighted are multiples of IDX with snapshots */
+                    w = SNAP ? ((wmin + id[d] - 1) / id[d]) * id[d] : wmin;
+                    ok = (p[d] * w <= ng[d]);
+                } else if (ok) {
+                    ok = (ng[d] % p[d] == 0) && (ng[d] / p[d] >= wmin)
+                      && (!SNAP || ((ng[d] / p[d]) % id[d] == 0));
+                }
+            }
+            if (!ok)
+                continue;
+
+            halo = total = 0.0;
+            for (d = 0; d < 3; d++) {
+                face = (double) ng[(d + 1) % 3] * ng[(d + 2) % 3];
+                if ((p[d] > 1) || ((d == 0) && BOUNDARY))
+                    halo += 2.0 * face / (p[(d + 1) % 3] * p[(d + 2) % 3]);
+                total += (p[d] - 1 + ((d == 0) && BOUNDARY)) * face;
+            }
+            if ((best < 0.0) || (halo < best) || ((halo == best) && (total < besttotal))) {
+                best = halo;
+                besttotal = total;
+                for (d = 0; d < 3; d++) pbest[d] = p[d];
+            }
+        }
+
+    if (best < 0.0)
+        err(" No process grid of %d PEs fits the grid of %d x %d x %d points (see NPROCX, NPROCY, NPROCZ) ! ",
+            NP, NXG, NYG, NZG);
+
+    NPROCX = pbest[0];
+    NPROCY = pbest[1];
+    NPROCZ = pbest[2];
+    NPROC = NPROCX * NPROCY * NPROCZ;
+
+    if (MYID == 0) {
+        fprintf(FP, "\n **Message from decomp (printed by PE %d):\n", MYID);
+        fprintf(FP, " Automatic process grid for %d PEs: NPROCX = %d, NPROCY = %d, NPROCZ = %d\n",
+                NP, NPROCX, NPROCY, NPROCZ);
+        fprintf(FP, " (an inner PE exchanges %.0f halo points per wavefield component).\n",
+                best * (FDORDER / 2));
+    }
+}
+
+/**
+ * Slabs of the same width NXG/NPROCX (NYG/NPROCY, NZG/NPROCZ).
+ */
+void decomp_uniform(void)
+{
+    extern int NXG, NYG, NZG, NPROCX, NPROCY, NPROCZ;
+
+    int p;
+
+    for (p = 0; p <= NPROCX; p++) SLABX[p] = p * (NXG / NPROCX);
+    for (p = 0; p <= NPROCY; p++) SLABY[p] = p * (NYG / NPROCY);
+    for (p = 0; p <= NPROCZ; p++) SLABZ[p] = p * (NZG / NPROCZ);
+}
+
+/**
+ * Slabs of the cost-weighted decomposition (DECOMP=1) of the global grid
+ * with the ntr receivers at the global grid points recpos[1...3][1...ntr]
+ * (recpos may be NULL if ntr=0).  All PEs compute the same slabs.  PE 0
+ * prints the slabs and the predicted load imbalance to FP.
+ */
+void decomp_weighted(int **recpos, int ntr)
+{
+    extern int NXG, NYG, NZG, NPROCX, NPROCY, NPROCZ, FW, FDORDER, MYID;
+    extern FILE *FP;
+
+    const char name[3] = {'x', 'y', 'z'};
+    const int np[3] = {NPROCX, NPROCY, NPROCZ};
+    int *slab[3] = {SLABX, SLABY, SLABZ};
+    int sx[NPROCX_MAX + 1], sy[NPROCY_MAX + 1], sz[NPROCZ_MAX + 1];
+    const int wmin = max(FW, FDORDER);
+    int g[3], gx, gy, gz;
+    double wmax, wmean, umax, umean;
+    int d, p, uniform;
+
+    decomp_grain(g);
+    gx = g[0]; gy = g[1]; gz = g[2];
+    decomp_model();
+    for (d = 0; d < 3; d++)
+        if (!decomp_axis(d, np[d], g[d], recpos, ntr, slab[d]))
+            err(" The grid cannot be divided into %d slabs along %c: %d grid points, slabs of at "
+                "least %d (%d at the edges) grid points at multiples of %d ! ",
+                np[d], name[d], n[d], FDORDER, wmin, g[d]);
+
+    /* the uniform decomposition for comparison (remainder to the last slab),
+       which is taken if it is possible and not predicted to be slower */
+    for (p = 0; p <= NPROCX; p++) sx[p] = (p < NPROCX) ? p * (NXG / NPROCX) : NXG;
+    for (p = 0; p <= NPROCY; p++) sy[p] = (p < NPROCY) ? p * (NYG / NPROCY) : NYG;
+    for (p = 0; p <= NPROCZ; p++) sz[p] = (p < NPROCZ) ? p * (NZG / NPROCZ) : NZG;
+    decomp_predict(SLABX, SLABY, SLABZ, recpos, ntr, &wmax, &wmean);
+    decomp_predict(sx, sy, sz, recpos, ntr, &umax, &umean);
+    uniform = ((NXG / NPROCX) % gx == 0) && ((NYG / NPROCY) % gy == 0) && ((NZG / NPROCZ) % gz == 0)
+           && (NXG % gx == 0) && (NYG % gy == 0) && (NZG % gz == 0)
+           && (NXG / NPROCX >= wmin) && (NYG / NPROCY >= wmin) && (NZG / NPROCZ >= wmin)
+           && (umax <= wmax);
+    if (uniform) {
+        for (p = 0; p <= NPROCX; p++) SLABX[p] = sx[p];
+        for (p = 0; p <= NPROCY; p++) SLABY[p] = sy[p];
+        for (p = 0; p <= NPROCZ; p++) SLABZ[p] = sz[p];
+    }
+
+    if (MYID != 0)
+        return;
+
+    fprintf(FP, "\n **Message from decomp (printed by PE %d):\n", MYID);
+    fprintf(FP, " Cost-weighted domain decomposition (DECOMP=1), widths of the slabs:\n");
+    decomp_print_slabs();
+    fprintf(FP, " Predicted load imbalance (largest / mean cost of a subdomain):\n");
+    fprintf(FP, " weighted slabs: %.3f, uniform slabs: %.3f (time step %.2f times faster).\n",
+            wmax / wmean, umax / umean, umax / wmax);
+    if (uniform)
+        fprintf(FP, " The weighted slabs are not faster, the uniform slabs are used.\n");
+    else if (umax < wmax)
+        fprintf(FP, " The uniform slabs are not possible (see FW, IDX, IDY, IDZ), the weighted slabs are used.\n");
+}
+
+/**
+ * The PE coordinate (0 ... np-1) of the slab of `slab` holding the global
+ * grid point iglob, or -1 if iglob lies outside the grid.
+ */
+int decomp_owner(const int *slab, int np, int iglob)
+{
+    int p;
+
+    for (p = 0; p < np; p++)
+        if ((iglob > slab[p]) && (iglob <= slab[p + 1]))
+            return p;
+    return -1;
+}
+
+/**
+ * Rebalance the slabs after the shot ishot with the busy time tbusy of this
+ * PE (time loop without the halo exchange and the snapshots) and the ntr
+ * receivers at the global grid points recpos[1...3][1...ntr].  The time of
+ * each PE divided by the predicted cost of its subdomain weights the grid
+ * points and receivers of the subdomain, and the axes are cut anew with
+ * these weights.  The new slabs are taken if their predicted largest time is
+ * at least DECOMP_REBALANCE_GAIN below the measured one: then SLABX, SLABY,
+ * SLABZ and IENDX, IENDY, IENDZ are updated and 1 is returned, and the
+ * model arrays have to be moved with `decomp_redistribute`.  Called by all
+ * PEs, which take the same decision.  PE 0 prints the times and slabs to FP.
+ */
+int decomp_rebalance(int ishot, double tbusy, int **recpos, int ntr)
+{
+    extern int NPROCX, NPROCY, NPROCZ, POS[4], IENDX, IENDY, IENDZ, MYID;
+    extern FILE *FP;
+
+    const int np = NPROCX * NPROCY * NPROCZ;
+    int sx[NPROCX_MAX + 1], sy[NPROCY_MAX + 1], sz[NPROCZ_MAX + 1];
+    int b[6], g[3], i, p, ok;
+    double *f, c, tmax, tmean, pmax = 0.0, pmean = 0.0;
+
+    if (!rankpos) {
+        rankpos = ivector(0, 3 * np - 1);
+        MPI_Allgather(&POS[1], 3, MPI_INT, rankpos, 3, MPI_INT, MPI_COMM_WORLD);
+    }
+
+    /* measured time per predicted cost of the subdomain of each PE */
+    decomp_model();
+    b[0] = SLABX[POS[1]] + 1; b[1] = SLABX[POS[1] + 1];
+    b[2] = SLABY[POS[2]] + 1; b[3] = SLABY[POS[2] + 1];
+    b[4] = SLABZ[POS[3]] + 1; b[5] = SLABZ[POS[3] + 1];
+    c = decomp_cost(b);
+    for (i = 1; i <= ntr; i++)
+        if ((recpos[1][i] >= b[0]) && (recpos[1][i] <= b[1])
+                && (recpos[2][i] >= b[2]) && (recpos[2][i] <= b[3])
+                && (recpos[3][i] >= b[4]) && (recpos[3][i] <= b[5]))
+            c += decomp_rec(recpos, i);
+
+    f = dvector(0, np - 1);
+    for (p = 0; p < np; p++) f[p] = 0.0;
+    f[POS[1] + NPROCX * (POS[2] + NPROCY * POS[3])] = tbusy / c;
+    MPI_Allreduce(MPI_IN_PLACE, &f[0], np, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&tbusy, &tmax, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(&tbusy, &tmean, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    tmean /= np;
+
+    /* new slabs with the measured weights of the present subdomains */
+    for (p = 0; p <= NPROCX; p++) ox[p] = SLABX[p];
+    for (p = 0; p <= NPROCY; p++) oy[p] = SLABY[p];
+    for (p = 0; p <= NPROCZ; p++) oz[p] = SLABZ[p];
+    for (p = 0, ok = 1; p < np; p++)
+        ok = ok && (f[p] > 0.0);
+    if (ok) {
+        /* the present slabs are kept if the axes cannot be cut anew */
+        decomp_grain(g);
+        weight = f;
+        ok = decomp_axis(0, NPROCX, g[0], recpos, ntr, sx)
+          && decomp_axis(1, NPROCY, g[1], recpos, ntr, sy)
+          && decomp_axis(2, NPROCZ, g[2], recpos, ntr, sz);
+        if (ok)
+            decomp_predict(sx, sy, sz, recpos, ntr, &pmax, &pmean);
+        weight = NULL;
+        ok = ok && (pmax < (1.0 - DECOMP_REBALANCE_GAIN) * tmax);
+    }
+    free_dvector(f, 0, np - 1);
+
+    if (ok) {
+        for (p = 0; p <= NPROCX; p++) SLABX[p] = sx[p];
+        for (p = 0; p <= NPROCY; p++) SLABY[p] = sy[p];
+        for (p = 0; p <= NPROCZ; p++) SLABZ[p] = sz[p];
+        IENDX = SLABX[POS[1] + 1] - SLABX[POS[1]];
+        IENDY = SLABY[POS[2] + 1] - SLABY[POS[2]];
+        IENDZ = SLABZ[POS[3] + 1] - SLABZ[POS[3]];
+    }
+
+    if (MYID == 0) {
+        fprintf(FP, "\n **Message from decomp (printed by PE %d):\n", MYID);
+        fprintf(FP, " Time of the PEs in shot %d without the halo exchange:\n", ishot);
+        fprintf(FP, " largest %.2f s, mean %.2f s (load imbalance %.3f).\n", tmax, tmean, tmax / tmean);
+        if (ok) {
+            fprintf(FP, " Rebalanced slabs for the next shots, widths:\n");
+            decomp_print_slabs();
+            fprintf(FP, " Predicted load imbalance %.3f (time step %.2f times faster).\n",
+                    pmax / pmean, tmax / pmax);
+        } else {
+            fprintf(FP, " The slabs are kept (predicted gain below %.0f%%).\n",
+                    100.0 * DECOMP_REBALANCE_GAIN);
+        }
+    }
+    return ok;
+}
+
+/* global grid points lo[d] ... hi[d] (d = 0, 1, 2 for x, y, z) of the
+   subdomain at pa[0...2] of the slabs xa, ya, za within the subdomain at
+   pb[0...2] of the slabs xb, yb, zb; returns their number */
+static int decomp_overlap(const int *pa, const int *xa, const int *ya, const int *za,
+        const int *pb, const int *xb, const int *yb, const int *zb, int *lo, int *hi)
+{
+    lo[0] = max(xa[pa[0]], xb[pb[0]]) + 1; hi[0] = min(xa[pa[0] + 1], xb[pb[0] + 1]);
+    lo[1] = max(ya[pa[1]], yb[pb[1]]) + 1; hi[1] = min(ya[pa[1] + 1], yb[pb[1] + 1]);
+    lo[2] = max(za[pa[2]], zb[pb[2]]) + 1; hi[2] = min(za[pa[2] + 1], zb[pb[2] + 1]);
+    if ((lo[0] > hi[0]) || (lo[1] > hi[1]) || (lo[2] > hi[2]))
+        return 0;
+    return (hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1);
+}
+
+/**
+ * Move the model array a[0...NY+1][0...NX+1][0...NZ+1] of the subdomain of
+ * this PE before `decomp_rebalance` to the rebalanced subdomains.  Returns
+ * the array of the new subdomain (f3tensor_aligned if aligned, else
+ * f3tensor, of the present NX, NY, NZ) with the grid points 1...NX, 1...NY,
+ * 1...NZ; the points at 0 and NX+1 etc. are left to matcopy.  a is freed.
+ * Called by all PEs.
+ */
+float ***decomp_redistribute(float ***a, int aligned)
+{
+    extern int NX, NY, NZ, NP, POS[4];
+
+    const int onx = ox[POS[1] + 1] - ox[POS[1]], ony = oy[POS[2] + 1] - oy[POS[2]],
+              onz = oz[POS[3] + 1] - oz[POS[3]];
+    int *scount, *sdispl, *rcount, *rdispl, lo[3], hi[3], r, i, j, k, n, ns, nr;
+    float *sbuf, *rbuf, ***b;
+
+    scount = ivector(0, NP - 1);
+    sdispl = ivector(0, NP - 1);
+    rcount = ivector(0, NP - 1);
+    rdispl = ivector(0, NP - 1);
+    for (r = 0, ns = 0; r < NP; r++) {
+        sdispl[r] = ns;
+        ns += scount[r] = decomp_overlap(&POS[1], ox, oy, oz, &rankpos[3 * r], SLABX, SLABY, SLABZ, lo, hi);
+    }
+    for (r = 0, nr = 0; r < NP; r++) {
+        rdispl[r] = nr;
+        nr += rcount[r] = decomp_overlap(&rankpos[3 * r], ox, oy, oz, &POS[1], SLABX, SLABY, SLABZ, lo, hi);
+    }
+    sbuf = vector(0, ns);
+    rbuf = vector(0, nr);
+
+    /* grid points of the old subdomain in the new subdomains of the PEs */
+    for (r = 0, n = 0; r < NP; r++)
+        if (decomp_overlap(&POS[1], ox, oy, oz, &rankpos[3 * r], SLABX, SLABY, SLABZ, lo, hi))
+            for (j = lo[1]; j <= hi[1]; j++)
+                for (i = lo[0]; i <= hi[0]; i++)
+                    for (k = lo[2]; k <= hi[2]; k++)
+                        sbuf[n++] = a[j - oy[POS[2]]][i - ox[POS[1]]][k - oz[POS[3]]];
+
+    MPI_Alltoallv(&sbuf[0], scount, sdispl, MPI_FLOAT, &rbuf[0], rcount, rdispl, MPI_FLOAT, MPI_COMM_WORLD);
+
+    b = aligned ? f3tensor_aligned(0, NY + 1, 0, NX + 1, 0, NZ + 1) : f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+    for (r = 0, n = 0; r < NP; r++)
+        if (decomp_overlap(&rankpos[3 * r], ox, oy, oz, &POS[1], SLABX, SLABY, SLABZ, lo, hi))
+            for (j = lo[1]; j <= hi[1]; j++)
+                for (i = lo[0]; i <= hi[0]; i++)
+                    for (k = lo[2]; k <= hi[2]; k++)
+                        b[j - SLABY[POS[2]]][i - SLABX[POS[1]]][k - SLABZ[POS[3]]] = rbuf[n++];
+
+    if (aligned)
+        free_f3tensor_aligned(a, 0, ony + 1, 0, onx + 1, 0, onz + 1);
+    else
+        free_f3tensor(a, 0, ony + 1, 0, onx + 1, 0, onz + 1);
+    free_vector(sbuf, 0, ns);
+    free_vector(rbuf, 0, nr);
+    free_ivector(scount, 0, NP - 1);
+    free_ivector(sdispl, 0, NP - 1);
+    free_ivector(rcount, 0, NP - 1);
+    free_ivector(rdispl, 0, NP - 1);
+    return b;
+}
+
+/**
+ * Write the process grid and the slabs to the text file SNAP_FILE.decomp
+ * for snapmerge.
+ */
+void decomp_write(void)
+{
+    extern int NPROCX, NPROCY, NPROCZ;
+    extern char SNAP_FILE[STRING_SIZE];
+
+    char file[STRING_SIZE + 8];
+    FILE *fp;
+    int p;
+
+    sprintf(file, "%s.decomp", SNAP_FILE);
+    if ((fp = fopen(file, "w")) == NULL)
+        err(" Could not open %s for writing the domain decomposition ! ", file);
+    fprintf(fp, "%d %d %d\n", NPROCX, NPROCY, NPROCZ);
+    for (p = 0; p <= NPROCX; p++) fprintf(fp, "%d%c", SLABX[p], (p < NPROCX) ? ' ' : '\n');
+    for (p = 0; p <= NPROCY; p++) fprintf(fp, "%d%c", SLABY[p], (p < NPROCY) ? ' ' : '\n');
+    for (p = 0; p <= NPROCZ; p++) fprintf(fp, "%d%c", SLABZ[p], (p < NPROCZ) ? ' ' : '\n');
+    fclose(fp);
+}
+
+/**
+ * Read the process grid and the slabs written by `decomp_write`.
+ */
+void decomp_read(void)
+{
+    extern int NXG, NYG, NZG, NPROCX, NPROCY, NPROCZ;
+    extern char SNAP_FILE[STRING_SIZE];
+
+    char file[STRING_SIZE + 8];
+    FILE *fp;
+    int npx, npy, npz, p, ok;
+
+    sprintf(file, "%s.decomp", SNAP_FILE);
+    if ((fp = fopen(file, "r")) == NULL)
+        err(" Could not open %s to read the domain decomposition ! ", file);
+    ok = (fscanf(fp, "%d %d %d", &npx, &npy, &npz) == 3)
+        && (!NPROCX || (npx == NPROCX)) && (!NPROCY || (npy == NPROCY)) && (!NPROCZ || (npz == NPROCZ))
+        && (npx <= NPROCX_MAX) && (npy <= NPROCY_MAX) && (npz <= NPROCZ_MAX);
+    if (ok) {
+        /* process grid chosen by the solver (NPROC?=0) */
+        NPROCX = npx;
+        NPROCY = npy;
+        NPROCZ = npz;
+    }
+    for (p = 0; ok && (p <= NPROCX); p++) ok = (fscanf(fp, "%d", &SLABX[p]) == 1);
+    for (p = 0; ok && (p <= NPROCY); p++) ok = (fscanf(fp, "%d", &SLABY[p]) == 1);
+    for (p = 0; ok && (p <= NPROCZ); p++) ok = (fscanf(fp, "%d", &SLABZ[p]) == 1);
+    fclose(fp);
+
+    if (!ok || (SLABX[NPROCX] != NXG) || (SLABY[NPROCY] != NYG) || (SLABZ[NPROCZ] != NZG))
+        err(" The domain decomposition in %s does not fit the grid and NPROCX, NPROCY, NPROCZ ! ", file);
+}
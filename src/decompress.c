@@ -0,0 +1,79 @@
+/*------------------------------------------------------------------------
+ *   Decompress a file written with the lossy compression of compress.c
+ *   (snapshot files of the PEs with SNAP_FORMAT=6, checkpoints with
+ *   CHECKPT_COMPRESS=1, model files of the PEs with MODEL_COMPRESS=1)
+ *   to a binary file of 4-byte floats.  The records are decompressed one
+ *   after the other and written in the same order.
+ *
+ *  ----------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fd.h"
+#include "globvar.h" /* definition of global variables  */
+
+
+void _usage()
+{
+    printf("***********************************************************\n");
+    printf("This is program DECOMPRESS. \n");
+    printf("Decompression of files written with SNAP_FORMAT=6,\n");
+    printf("CHECKPT_COMPRESS=1 or MODEL_COMPRESS=1 to binary files\n");
+    printf("***********************************************************\n");
+    printf("\n");
+    printf("Syntax example if executed from ./par directory: "
+           "../bin/decompress snap/test.cmp.vx.0.0.0 snap/test.bin.vx.0.0.0\n");
+    printf("\n");
+}
+
+
+static int decompress(int argc, char **argv)
+{
+    FILE *fp_in, *fp_out;
+    float *a;
+    int n, nmax = 0, nrec = 0;
+    long nvalue = 0;
+
+    _usage();
+    if (argc != 3) {
+        printf("USAGE:\n");
+        printf("    decompress <compressed-file> <binary-file>\n");
+        exit(1);
+    }
+
+    fp_in = fopen(argv[1], "rb");
+    if (fp_in == NULL)
+        err("Could not open %s for reading.", argv[1]);
+    fp_out = fopen(argv[2], "wb");
+    if (fp_out == NULL)
+        err("Could not open %s for writing.", argv[2]);
+
+    a = NULL;
+    while ((n = compress_next(fp_in)) > 0) {
+        if (n > nmax) {
+            if (a != NULL)
+                free_vector(a, 0, nmax - 1);
+            nmax = n;
+            a = vector(0, nmax - 1);
+        }
+        compress_read(fp_in, a, n);
+        writedsk_block(fp_out, a, n, 3);
+        nrec++;
+        nvalue += n;
+    }
+
+    if (a != NULL)
+        free_vector(a, 0, nmax - 1);
+    fclose(fp_in);
+    fclose(fp_out);
+
+    printf("Decompressed %d records of %ld values in total from %s to %s\n",
+           nrec, nvalue, argv[1], argv[2]);
+    return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+    decompress(argc, argv);
+}
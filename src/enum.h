@@ -48,5 +48,7 @@ enum FILE_FORMAT_ENUM {
     FILE_FORMAT_SEGY_IEEE754_LITTLEEND = 4,
     // SEG-Y format with 4-byte floats in IBM/BE format.
     FILE_FORMAT_SEGY_IBM_BIGEND = 5,
+    // Records of lossy compressed 4-byte floats, see compress.c.
+    FILE_FORMAT_COMPRESSED = 6,
 };
 #endif
@@ -31,6 +31,14 @@ void exchange_par(void) {
 	extern int RSF; // RSF
 	extern char SNAP_FILE[STRING_SIZE], SOURCE_FILE[STRING_SIZE], REC_FILE[STRING_SIZE], SEIS_FILE[STRING_SIZE];
 	extern char  FILEINP[STRING_SIZE];
+	extern int OVERLAP_COMM, HALO_DATATYPE, PERSISTENT_COMM, SIMD_KERNEL;
+	extern int TILING, TILE_X, TILE_Y, TILE_Z, FUSED_SWEEP, FOLD_COEFF;
+	extern int SNAP_MPIIO, SNAP_ASYNC, SNAP_ASYNC_MB;
+	extern float COMPRESS_TOL;
+	extern int COMPRESS_REL, CHECKPT_COMPRESS, MODEL_COMPRESS;
+	extern int SEIS_STREAM, SEIS_MPIIO;
+	extern int CHECKPT_INTERVAL, CHECKPT_ASYNC;
+	extern int DECOMP, REBALANCE, HALO_SHM, HALO_DEEP;
 
     // Model parameters for model generation.
     extern float VPV1, VSV1, EPSX1, EPSY1, DELX1, DELY1, DELXY1;
@@ -120,6 +128,8 @@ void exchange_par(void) {
         fdum[65] = M23;
         fdum[66] = M33;
 
+        fdum[67] = COMPRESS_TOL;
+
 
 
 		idum[0]  = FDORDER;
@@ -181,6 +191,33 @@ void exchange_par(void) {
 		idum[47] = OUTSOURCEWAVELET;
 		idum[48] = OUTNTIMESTEPINFO;
 
+		// halo exchange
+		idum[49] = OVERLAP_COMM;
+		idum[50] = HALO_DATATYPE;
+		idum[51] = PERSISTENT_COMM;
+
+		idum[52] = SIMD_KERNEL;
+		idum[53] = TILING;
+		idum[54] = TILE_X;
+		idum[55] = TILE_Y;
+		idum[56] = TILE_Z;
+		idum[57] = FUSED_SWEEP;
+		idum[58] = FOLD_COEFF;
+		idum[59] = SNAP_MPIIO;
+		idum[60] = SNAP_ASYNC;
+		idum[61] = SNAP_ASYNC_MB;
+		idum[62] = COMPRESS_REL;
+		idum[63] = CHECKPT_COMPRESS;
+		idum[64] = MODEL_COMPRESS;
+		idum[65] = SEIS_STREAM;
+		idum[66] = SEIS_MPIIO;
+		idum[67] = CHECKPT_INTERVAL;
+		idum[68] = CHECKPT_ASYNC;
+		idum[69] = DECOMP;
+		idum[70] = REBALANCE;
+		idum[71] = HALO_SHM;
+		idum[72] = HALO_DEEP;
+
 	}
 
 	if (MYID != 0) FL=vector(1,L);
@@ -279,6 +316,8 @@ void exchange_par(void) {
     M23 = fdum[65];
     M33 = fdum[66];
 
+    COMPRESS_TOL = fdum[67];
+
     // -------------------
     // Integer parameters.
 	FDORDER = idum[0];
@@ -340,6 +379,30 @@ void exchange_par(void) {
 	RSF = idum[46];
 	OUTSOURCEWAVELET = idum[47];
 	OUTNTIMESTEPINFO = idum[48];
+	OVERLAP_COMM = idum[49];
+	HALO_DATATYPE = idum[50];
+	PERSISTENT_COMM = idum[51];
+	SIMD_KERNEL = idum[52];
+	TILING = idum[53];
+	TILE_X = idum[54];
+	TILE_Y = idum[55];
+	TILE_Z = idum[56];
+	FUSED_SWEEP = idum[57];
+	FOLD_COEFF = idum[58];
+	SNAP_MPIIO = idum[59];
+	SNAP_ASYNC = idum[60];
+	SNAP_ASYNC_MB = idum[61];
+	COMPRESS_REL = idum[62];
+	CHECKPT_COMPRESS = idum[63];
+	MODEL_COMPRESS = idum[64];
+	SEIS_STREAM = idum[65];
+	SEIS_MPIIO = idum[66];
+	CHECKPT_INTERVAL = idum[67];
+	CHECKPT_ASYNC = idum[68];
+	DECOMP = idum[69];
+	REBALANCE = idum[70];
+	HALO_SHM = idum[71];
+	HALO_DEEP = idum[72];
 
 
 
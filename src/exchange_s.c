@@ -8,36 +8,27 @@
 #include "fd.h"
 #include "globvar.h"
 
+#ifdef __GNUC__
+	#define ATTR_UNUSED __attribute__((unused))
+#else
+	#define ATTR_UNUSED
+#endif
 
-double exchange_s(int nt, Tensor3d *s,
-		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
-		float *** buffertop_to_bot, float *** bufferbot_to_top,
-		float *** bufferfro_to_bac, float *** bufferbac_to_fro) {
-
-	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, MYID, FDORDER, LOG, INDEX[7];
-	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
-	extern FILE *FP;
-	extern int OUTNTIMESTEPINFO;
-
-	MPI_Status status;	
-	int i, j, k, l, n, nf1, nf2;
-	double time=0.0, time1=0.0, time2=0.0;
-
-        float ***sxx = s->xx;
-        float ***syy = s->yy;
-        float ***szz = s->zz;
-        float ***sxy = s->xy;
-        float ***syz = s->yz;
-        float ***sxz = s->xz;
-
-	nf1=(3*FDORDER/2)-1;
-	nf2=nf1-1;
 
+/*
+ * Copy the stress components at the top and bottom of the local volume
+ * into the buffers which are sent to the upper and lower neighbours.
+ */
+static void pack_s_top_bot(Tensor3d *s,
+	float *** buffertop_to_bot, float *** bufferbot_to_top)
+{
+	extern int NX, NY, NZ, POS[4], NPROCY, BOUNDARY, FDORDER;
 
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
+	float ***syy = s->yy;
+	float ***sxy = s->xy;
+	float ***syz = s->yz;
 
-	/* top-bottom -----------------------------------------------------------*/	
+	int i, k, l, n;
 
 	if (BOUNDARY || (POS[2]!=0))	/* no boundary exchange at top of global grid */
 		for (i=1;i<=NX;i++){
@@ -76,9 +67,23 @@ double exchange_s(int nt, Tensor3d *s,
 
 			}
 		}
+}
 
-	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);	
-	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+
+/*
+ * Copy the stress components received from the upper and lower neighbours
+ * into the halo of the local volume.
+ */
+static void unpack_s_top_bot(Tensor3d *s,
+	float *** buffertop_to_bot, float *** bufferbot_to_top)
+{
+	extern int NX, NY, NZ, POS[4], NPROCY, BOUNDARY, FDORDER;
+
+	float ***syy = s->yy;
+	float ***sxy = s->xy;
+	float ***syz = s->yz;
+
+	int i, k, l, n;
 
 	if (BOUNDARY || (POS[2]!=NPROCY-1))	/* no boundary exchange at bottom of global grid */
 		for (i=1;i<=NX;i++){
@@ -114,15 +119,23 @@ double exchange_s(int nt, Tensor3d *s,
 
 			}
 		}
+}
 
 
+/*
+ * Copy the stress components at the left and right edge of the local
+ * volume into the buffers which are sent to the neighbours.
+ */
+static void pack_s_lef_rig(Tensor3d *s,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef)
+{
+	extern int NX, NY, NZ, POS[4], NPROCX, BOUNDARY, FDORDER;
 
+	float ***sxx = s->xx;
+	float ***sxy = s->xy;
+	float ***sxz = s->xz;
 
-
-
-	/* left-right -----------------------------------------------------------*/	
-
-
+	int j, k, l, n;
 
 	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
 		for (j=1;j<=NY;j++){
@@ -159,9 +172,23 @@ double exchange_s(int nt, Tensor3d *s,
 				}
 			}
 		}
+}
 
-	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
+
+/*
+ * Copy the stress components received from the left and right neighbours
+ * into the halo of the local volume.
+ */
+static void unpack_s_lef_rig(Tensor3d *s,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef)
+{
+	extern int NX, NY, NZ, POS[4], NPROCX, BOUNDARY, FDORDER;
+
+	float ***sxx = s->xx;
+	float ***sxy = s->xy;
+	float ***sxz = s->xz;
+
+	int j, k, l, n;
 
 	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
 		for (j=1;j<=NY;j++){
@@ -194,13 +221,24 @@ double exchange_s(int nt, Tensor3d *s,
 				}
 			}
 		}
+}
 
 
+/*
+ * Copy the stress components at the front and back side of the local
+ * volume into the buffers which are sent to the neighbours.
+ */
+static void pack_s_fro_bac(Tensor3d *s,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
+{
+	extern int NX, NY, NZ, POS[4], NPROCZ, BOUNDARY, FDORDER;
 
+	float ***szz = s->zz;
+	float ***syz = s->yz;
+	float ***sxz = s->xz;
 
+	int i, j, l, n;
 
-
-	/* front-back -----------------------------------------------------------*/
 	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
 		for (i=1;i<=NX;i++){
 			for (j=1;j<=NY;j++){
@@ -236,9 +274,23 @@ double exchange_s(int nt, Tensor3d *s,
 				}
 			}
 		}
+}
 
-	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
+
+/*
+ * Copy the stress components received from the front and back neighbours
+ * into the halo of the local volume.
+ */
+static void unpack_s_fro_bac(Tensor3d *s,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
+{
+	extern int NX, NY, NZ, POS[4], NPROCZ, BOUNDARY, FDORDER;
+
+	float ***szz = s->zz;
+	float ***syz = s->yz;
+	float ***sxz = s->xz;
+
+	int i, j, l, n;
 
 	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
 		for (i=1;i<=NX;i++){
@@ -273,33 +325,255 @@ double exchange_s(int nt, Tensor3d *s,
 
 			}
 		}
+}
+
+
+double exchange_s(int nt, Tensor3d *s,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro) {
+
+	extern int NX, NY, NZ, MYID, FDORDER, LOG, INDEX[7];
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	MPI_Status status;
+	int nf1, nf2;
+	double time=0.0, time1=0.0, time2=0.0;
 
+	nf1=(3*FDORDER/2)-1;
+	nf2=nf1-1;
+
+
+	time1=MPI_Wtime();
+
+	/* top-bottom -----------------------------------------------------------*/
+
+	pack_s_top_bot(s, buffertop_to_bot, bufferbot_to_top);
+
+	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+
+	unpack_s_top_bot(s, buffertop_to_bot, bufferbot_to_top);
+
+	/* left-right -----------------------------------------------------------*/
+
+	pack_s_lef_rig(s, bufferlef_to_rig, bufferrig_to_lef);
+
+	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
+
+	unpack_s_lef_rig(s, bufferlef_to_rig, bufferrig_to_lef);
+
+	/* front-back -----------------------------------------------------------*/
+
+	pack_s_fro_bac(s, bufferfro_to_bac, bufferbac_to_fro);
+
+	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
+
+	unpack_s_fro_bac(s, bufferfro_to_bac, bufferbac_to_fro);
+
+	time2=MPI_Wtime();
+	time=time2-time1;
 	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0){
-			time2=MPI_Wtime();
-			time=time2-time1;
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
 			fprintf(FP," Real time for stress tensor exchange: \t\t %4.2f s.\n",time);
+	return time;
+
+}
+
+
+/*
+ * Start the non-blocking exchange of the stress components (OVERLAP_COMM=1).
+ * See `exchange_v_start` for the meaning of the parameters.  The halo of `s`
+ * is only valid after the matching call of `exchange_s_finish`.
+ */
+double exchange_s_start(int nt ATTR_UNUSED, Tensor3d *s,
+		float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+		float *** buffertop_to_bot, float *** bufferbot_to_top,
+		float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+		float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+		float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+		float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+		MPI_Request *req_send, MPI_Request *req_rec,
+		MPI_Datatype *type_send, MPI_Datatype *type_rec) {
+
+	extern int NX, NY, NZ, FDORDER;
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern int PERSISTENT_COMM;
+
+	int nf1, nf2, nb[7];
+	double time=0.0, time1=0.0;
+
+	nf1=(3*FDORDER/2)-1;
+	nf2=nf1-1;
+
+	time1=MPI_Wtime();
+
+	/* persistent requests of comm_ini_s */
+	if (PERSISTENT_COMM){
+		MPI_Startall(REQUEST_COUNT, req_rec);
+		if (!type_send){
+			pack_s_top_bot(s, buffertop_to_bot, bufferbot_to_top);
+			pack_s_lef_rig(s, bufferlef_to_rig, bufferrig_to_lef);
+			pack_s_fro_bac(s, bufferfro_to_bac, bufferbac_to_fro);
 		}
+		MPI_Startall(REQUEST_COUNT, req_send);
+		time=MPI_Wtime()-time1;
+		return time;
+	}
+
+	/* zero-copy exchange directly from and into the wavefield */
+	if (type_send){
+		halo_isendrecv(type_send, type_rec, req_send, req_rec);
+		time=MPI_Wtime()-time1;
+		return time;
+	}
+
+	halo_neighbours(nb);
+
+	MPI_Irecv(&rbuffertop_to_bot[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[4],TAG5,MPI_COMM_WORLD,&req_rec[0]);
+	MPI_Irecv(&rbufferbot_to_top[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[3],TAG6,MPI_COMM_WORLD,&req_rec[1]);
+	MPI_Irecv(&rbufferlef_to_rig[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[2],TAG1,MPI_COMM_WORLD,&req_rec[2]);
+	MPI_Irecv(&rbufferrig_to_lef[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[1],TAG2,MPI_COMM_WORLD,&req_rec[3]);
+	MPI_Irecv(&rbufferfro_to_bac[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[6],TAG3,MPI_COMM_WORLD,&req_rec[4]);
+	MPI_Irecv(&rbufferbac_to_fro[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[5],TAG4,MPI_COMM_WORLD,&req_rec[5]);
+
+	pack_s_top_bot(s, buffertop_to_bot, bufferbot_to_top);
+	MPI_Isend(&buffertop_to_bot[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[3],TAG5,MPI_COMM_WORLD,&req_send[0]);
+	MPI_Isend(&bufferbot_to_top[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[4],TAG6,MPI_COMM_WORLD,&req_send[1]);
+
+	pack_s_lef_rig(s, bufferlef_to_rig, bufferrig_to_lef);
+	MPI_Isend(&bufferlef_to_rig[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[1],TAG1,MPI_COMM_WORLD,&req_send[2]);
+	MPI_Isend(&bufferrig_to_lef[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[2],TAG2,MPI_COMM_WORLD,&req_send[3]);
+
+	pack_s_fro_bac(s, bufferfro_to_bac, bufferbac_to_fro);
+	MPI_Isend(&bufferfro_to_bac[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[5],TAG3,MPI_COMM_WORLD,&req_send[4]);
+	MPI_Isend(&bufferbac_to_fro[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[6],TAG4,MPI_COMM_WORLD,&req_send[5]);
+
+	time=MPI_Wtime()-time1;
 	return time;
+}
 
+
+/*
+ * Complete the exchange of the stress components started by
+ * `exchange_s_start` and copy the received values into the halo of `s`
+ * (not needed if the datatypes `type_rec` were used).
+ */
+double exchange_s_finish(int nt, Tensor3d *s,
+		float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+		float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+		float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+		MPI_Request *req_send, MPI_Request *req_rec,
+		MPI_Datatype *type_rec) {
+
+	extern int MYID, LOG;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	double time=0.0, time1=0.0, time2=0.0;
+
+	time1=MPI_Wtime();
+
+	MPI_Waitall(REQUEST_COUNT, req_rec, MPI_STATUSES_IGNORE);
+
+	if (!type_rec){
+		unpack_s_top_bot(s, rbuffertop_to_bot, rbufferbot_to_top);
+		unpack_s_lef_rig(s, rbufferlef_to_rig, rbufferrig_to_lef);
+		unpack_s_fro_bac(s, rbufferfro_to_bac, rbufferbac_to_fro);
+	}
+
+	MPI_Waitall(REQUEST_COUNT, req_send, MPI_STATUSES_IGNORE);
+
+	time2=MPI_Wtime();
+	time=time2-time1;
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			fprintf(FP," Real time for waiting on stress tensor exchange: \t %4.2f s.\n",time);
+	return time;
 }
 
 
+/*
+ * Create the datatypes for the zero-copy exchange of the stress components
+ * (HALO_DATATYPE=1), see `exchange_v_types`.
+ */
+void exchange_s_types(Tensor3d *s, MPI_Datatype *type_send, MPI_Datatype *type_rec) {
+
+	float ***ev_y[1] = {s->yy}, ***od_y[2] = {s->xy, s->yz};
+	float ***ev_x[1] = {s->xx}, ***od_x[2] = {s->xy, s->xz};
+	float ***ev_z[1] = {s->zz}, ***od_z[2] = {s->yz, s->xz};
+
+	halo_axis_types(0, ev_y, 1, od_y, 2, &type_send[0], &type_rec[0]);
+	halo_axis_types(1, ev_x, 1, od_x, 2, &type_send[2], &type_rec[2]);
+	halo_axis_types(2, ev_z, 1, od_z, 2, &type_send[4], &type_rec[4]);
+}
 
 
+/*
+ * Exchange the stress components at the grid boundaries between MPI
+ * processes without staging buffers, using the datatypes of
+ * `exchange_s_types`.
+ */
+double exchange_s_dt(int nt, MPI_Datatype *type_send, MPI_Datatype *type_rec) {
 
+	extern int MYID, LOG;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
 
+	double time=0.0, time1=0.0, time2=0.0;
 
+	time1=MPI_Wtime();
 
+	halo_sendrecv(type_send, type_rec);
 
+	time2=MPI_Wtime();
+	time=time2-time1;
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			fprintf(FP," Real time for stress tensor exchange: \t\t %4.2f s.\n",time);
+	return time;
+}
 
 
+/*
+ * Exchange the stress components at the grid boundaries between MPI
+ * processes through the shared buffers of `halo_shm_ini` (HALO_SHM=1),
+ * see `exchange_v_shm`.
+ */
+double exchange_s_shm(int nt, Tensor3d *s) {
 
+	extern int MYID, LOG;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
 
+	float ***send[REQUEST_COUNT], ***rec[REQUEST_COUNT];
+	double time=0.0, time1=0.0, time2=0.0;
 
+	time1=MPI_Wtime();
 
+	halo_shm_begin(HALO_SHM_S, send, rec);
 
+	pack_s_top_bot(s, send[0], send[1]);
+	pack_s_lef_rig(s, send[2], send[3]);
+	pack_s_fro_bac(s, send[4], send[5]);
 
+	halo_shm_post(HALO_SHM_S);
+	halo_shm_wait(HALO_SHM_S);
 
+	unpack_s_top_bot(s, rec[0], rec[1]);
+	unpack_s_lef_rig(s, rec[2], rec[3]);
+	unpack_s_fro_bac(s, rec[4], rec[5]);
 
+	halo_shm_end(HALO_SHM_S);
 
+	time2=MPI_Wtime();
+	time=time2-time1;
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			fprintf(FP," Real time for stress tensor exchange: \t\t %4.2f s.\n",time);
+	return time;
+}
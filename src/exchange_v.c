@@ -2,45 +2,27 @@
 #include "fd.h"
 #include "globvar.h"
 
+#ifdef __GNUC__
+	#define ATTR_UNUSED __attribute__((unused))
+#else
+	#define ATTR_UNUSED
+#endif
+
 
 /*
- * Exchange particle velocities at the grid boundaries between MPI processes.
- *
- * Parameters
- * ----------
- * nt :
- *     Time step.
- * v :
- *     Velocity field.
- * bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
- * bufferfro_to_bac, bufferbac_to_fro :
- *     Buffers used to exchange data between MPI processes in 3D grid.
+ * Copy the particle velocities at the top and bottom of the local volume
+ * into the buffers which are sent to the upper and lower neighbours.
  */
-double exchange_v(int nt, Velocity *v,
-	float *** bufferlef_to_rig, float *** bufferrig_to_lef,
-	float *** buffertop_to_bot, float *** bufferbot_to_top,
-	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
+static void pack_v_top_bot(Velocity *v,
+	float *** buffertop_to_bot, float *** bufferbot_to_top)
 {
-	extern int NX, NY, NZ, POS[4], NPROCX, NPROCY, NPROCZ, BOUNDARY, MYID, FDORDER, LOG, INDEX[7];
-	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
-	extern FILE *FP;
-	extern int OUTNTIMESTEPINFO;
+	extern int NX, NY, NZ, POS[4], NPROCY, BOUNDARY, FDORDER;
 
 	float ***vx = v->x;
 	float ***vy = v->y;
 	float ***vz = v->z;
 
-	MPI_Status status;	
-	int i, j, k, l, n, nf1, nf2;
-	double time=0.0, time1=0.0, time2=0.0;
-
-	nf1=3*FDORDER/2-1;
-	nf2=nf1-1; 
-
-	if (LOG){
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();}
-
-	/* top-bottom -----------------------------------------------------------*/	
+	int i, k, l, n;
 
 	if (BOUNDARY || (POS[2]!=0))	/* no boundary exchange at top of global grid */
 		for (i=1;i<=NX;i++){
@@ -74,9 +56,23 @@ double exchange_v(int nt, Velocity *v,
 				}
 			}
 		}
+}
 
-	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
+
+/*
+ * Copy the particle velocities received from the upper and lower neighbours
+ * into the halo of the local volume.
+ */
+static void unpack_v_top_bot(Velocity *v,
+	float *** buffertop_to_bot, float *** bufferbot_to_top)
+{
+	extern int NX, NY, NZ, POS[4], NPROCY, BOUNDARY, FDORDER;
+
+	float ***vx = v->x;
+	float ***vy = v->y;
+	float ***vz = v->z;
+
+	int i, k, l, n;
 
 	if (BOUNDARY || (POS[2]!=NPROCY-1))	/* no boundary exchange at bottom of global grid */
 		for (i=1;i<=NX;i++){
@@ -109,9 +105,23 @@ double exchange_v(int nt, Velocity *v,
 				}
 			}
 		}
+}
 
-	/* left-right -----------------------------------------------------------*/	
 
+/*
+ * Copy the particle velocities at the left and right edge of the local
+ * volume into the buffers which are sent to the neighbours.
+ */
+static void pack_v_lef_rig(Velocity *v,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef)
+{
+	extern int NX, NY, NZ, POS[4], NPROCX, BOUNDARY, FDORDER;
+
+	float ***vx = v->x;
+	float ***vy = v->y;
+	float ***vz = v->z;
+
+	int j, k, l, n;
 
 	if ((BOUNDARY) || (POS[1]!=0))	/* no boundary exchange at left edge of global grid */
 		for (j=1;j<=NY;j++){
@@ -145,9 +155,23 @@ double exchange_v(int nt, Velocity *v,
 				}
 			}
 		}
+}
 
-	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
+
+/*
+ * Copy the particle velocities received from the left and right neighbours
+ * into the halo of the local volume.
+ */
+static void unpack_v_lef_rig(Velocity *v,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef)
+{
+	extern int NX, NY, NZ, POS[4], NPROCX, BOUNDARY, FDORDER;
+
+	float ***vx = v->x;
+	float ***vy = v->y;
+	float ***vz = v->z;
+
+	int j, k, l, n;
 
 	if ((BOUNDARY) || (POS[1]!=NPROCX-1))	/* no boundary exchange at right edge of global grid */
 		for (j=1;j<=NY;j++){
@@ -181,10 +205,23 @@ double exchange_v(int nt, Velocity *v,
 
 			}
 		}
+}
 
 
-	/* front-back -----------------------------------------------------------*/
+/*
+ * Copy the particle velocities at the front and back side of the local
+ * volume into the buffers which are sent to the neighbours.
+ */
+static void pack_v_fro_bac(Velocity *v,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
+{
+	extern int NX, NY, NZ, POS[4], NPROCZ, BOUNDARY, FDORDER;
 
+	float ***vx = v->x;
+	float ***vy = v->y;
+	float ***vz = v->z;
+
+	int i, j, l, n;
 
 	if ((BOUNDARY) || (POS[3]!=0))	/* no boundary exchange at front side of global grid */
 		for (i=1;i<=NX;i++){
@@ -220,9 +257,23 @@ double exchange_v(int nt, Velocity *v,
 
 			}
 		}
+}
 
-	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
-	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
+
+/*
+ * Copy the particle velocities received from the front and back neighbours
+ * into the halo of the local volume.
+ */
+static void unpack_v_fro_bac(Velocity *v,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
+{
+	extern int NX, NY, NZ, POS[4], NPROCZ, BOUNDARY, FDORDER;
+
+	float ***vx = v->x;
+	float ***vy = v->y;
+	float ***vz = v->z;
+
+	int i, j, l, n;
 
 	/* no exchange if periodic boundary condition is applied */
 	if ((BOUNDARY) || (POS[3]!=NPROCZ-1))	/* no boundary exchange at back side of global grid */
@@ -257,14 +308,302 @@ double exchange_v(int nt, Velocity *v,
 				}
 			}
 		}
+}
+
+
+/*
+ * Exchange particle velocities at the grid boundaries between MPI processes.
+ *
+ * Parameters
+ * ----------
+ * nt :
+ *     Time step.
+ * v :
+ *     Velocity field.
+ * bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot, bufferbot_to_top,
+ * bufferfro_to_bac, bufferbac_to_fro :
+ *     Buffers used to exchange data between MPI processes in 3D grid.
+ *
+ * Returns the real time of the exchange on every PE (used for the load
+ * rebalancing, REBALANCE=1); PE 0 prints it if LOG is set.
+ */
+double exchange_v(int nt, Velocity *v,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+	float *** buffertop_to_bot, float *** bufferbot_to_top,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro)
+{
+	extern int NX, NY, NZ, MYID, FDORDER, LOG, INDEX[7];
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	MPI_Status status;
+	int nf1, nf2;
+	double time=0.0, time1=0.0, time2=0.0;
+
+	nf1=3*FDORDER/2-1;
+	nf2=nf1-1;
+
+	time1=MPI_Wtime();
+
+	/* top-bottom -----------------------------------------------------------*/
+
+	pack_v_top_bot(v, buffertop_to_bot, bufferbot_to_top);
+
+	MPI_Sendrecv_replace(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,INDEX[3],TAG5,INDEX[4],TAG5,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,INDEX[4],TAG6,INDEX[3],TAG6,MPI_COMM_WORLD,&status);
 
+	unpack_v_top_bot(v, buffertop_to_bot, bufferbot_to_top);
 
+	/* left-right -----------------------------------------------------------*/
+
+	pack_v_lef_rig(v, bufferlef_to_rig, bufferrig_to_lef);
+
+	MPI_Sendrecv_replace(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,INDEX[1],TAG1,INDEX[2],TAG1,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,INDEX[2],TAG2,INDEX[1],TAG2,MPI_COMM_WORLD,&status);
+
+	unpack_v_lef_rig(v, bufferlef_to_rig, bufferrig_to_lef);
+
+	/* front-back -----------------------------------------------------------*/
+
+	pack_v_fro_bac(v, bufferfro_to_bac, bufferbac_to_fro);
+
+	MPI_Sendrecv_replace(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,INDEX[5],TAG3,INDEX[6],TAG3,MPI_COMM_WORLD,&status);
+	MPI_Sendrecv_replace(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,INDEX[6],TAG4,INDEX[5],TAG4,MPI_COMM_WORLD,&status);
+
+	unpack_v_fro_bac(v, bufferfro_to_bac, bufferbac_to_fro);
+
+	time2=MPI_Wtime();
+	time=time2-time1;
 	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) {
-			time2=MPI_Wtime();
-			time=time2-time1;
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
 			fprintf(FP," Real time for particle velocity exchange: \t %4.2f s.\n",time);
+	return time;
+
+}
+
+
+/*
+ * Start the non-blocking exchange of particle velocities (OVERLAP_COMM=1).
+ *
+ * All six faces of the local volume are copied into the send buffers and the
+ * messages are posted at once.  The halo is only valid after the matching
+ * call of `exchange_v_finish`; in between, the send buffers must not be
+ * modified and the halo of `v` must not be read.  Processes at the edges of
+ * the global grid do not communicate with their periodic neighbours unless
+ * BOUNDARY=1.  With PERSISTENT_COMM=1 the requests of `comm_ini` are
+ * restarted instead of posting new messages.
+ *
+ * Parameters
+ * ----------
+ * nt :
+ *     Time step.
+ * v :
+ *     Velocity field.
+ * bufferlef_to_rig, ..., bufferbac_to_fro :
+ *     Send buffers (see `exchange_v`).
+ * rbufferlef_to_rig, ..., rbufferbac_to_fro :
+ *     Receive buffers of the same size as the send buffers.
+ * req_send, req_rec :
+ *     Arrays of REQUEST_COUNT requests which are filled by this function,
+ *     or the persistent requests of `comm_ini`.
+ * type_send, type_rec :
+ *     Datatypes of `exchange_v_types` for the zero-copy exchange
+ *     (HALO_DATATYPE=1), or NULL to exchange through the buffers.
+ */
+double exchange_v_start(int nt ATTR_UNUSED, Velocity *v,
+	float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+	float *** buffertop_to_bot, float *** bufferbot_to_top,
+	float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+	float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+	float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+	float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+	MPI_Request *req_send, MPI_Request *req_rec,
+	MPI_Datatype *type_send, MPI_Datatype *type_rec)
+{
+	extern int NX, NY, NZ, FDORDER;
+	extern const int TAG1,TAG2,TAG3,TAG4,TAG5,TAG6;
+	extern int PERSISTENT_COMM;
+
+	int nf1, nf2, nb[7];
+	double time=0.0, time1=0.0;
+
+	nf1=3*FDORDER/2-1;
+	nf2=nf1-1;
+
+	time1=MPI_Wtime();
+
+	/* persistent requests of comm_ini */
+	if (PERSISTENT_COMM){
+		MPI_Startall(REQUEST_COUNT, req_rec);
+		if (!type_send){
+			pack_v_top_bot(v, buffertop_to_bot, bufferbot_to_top);
+			pack_v_lef_rig(v, bufferlef_to_rig, bufferrig_to_lef);
+			pack_v_fro_bac(v, bufferfro_to_bac, bufferbac_to_fro);
 		}
+		MPI_Startall(REQUEST_COUNT, req_send);
+		time=MPI_Wtime()-time1;
+		return time;
+	}
+
+	/* zero-copy exchange directly from and into the wavefield */
+	if (type_send){
+		halo_isendrecv(type_send, type_rec, req_send, req_rec);
+		time=MPI_Wtime()-time1;
+		return time;
+	}
+
+	halo_neighbours(nb);
+
+	MPI_Irecv(&rbuffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[4],TAG5,MPI_COMM_WORLD,&req_rec[0]);
+	MPI_Irecv(&rbufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[3],TAG6,MPI_COMM_WORLD,&req_rec[1]);
+	MPI_Irecv(&rbufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[2],TAG1,MPI_COMM_WORLD,&req_rec[2]);
+	MPI_Irecv(&rbufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[1],TAG2,MPI_COMM_WORLD,&req_rec[3]);
+	MPI_Irecv(&rbufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[6],TAG3,MPI_COMM_WORLD,&req_rec[4]);
+	MPI_Irecv(&rbufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[5],TAG4,MPI_COMM_WORLD,&req_rec[5]);
+
+	pack_v_top_bot(v, buffertop_to_bot, bufferbot_to_top);
+	MPI_Isend(&buffertop_to_bot[1][1][1],NX*NZ*nf1,MPI_FLOAT,nb[3],TAG5,MPI_COMM_WORLD,&req_send[0]);
+	MPI_Isend(&bufferbot_to_top[1][1][1],NX*NZ*nf2,MPI_FLOAT,nb[4],TAG6,MPI_COMM_WORLD,&req_send[1]);
+
+	pack_v_lef_rig(v, bufferlef_to_rig, bufferrig_to_lef);
+	MPI_Isend(&bufferlef_to_rig[1][1][1],NY*NZ*nf1,MPI_FLOAT,nb[1],TAG1,MPI_COMM_WORLD,&req_send[2]);
+	MPI_Isend(&bufferrig_to_lef[1][1][1],NY*NZ*nf2,MPI_FLOAT,nb[2],TAG2,MPI_COMM_WORLD,&req_send[3]);
+
+	pack_v_fro_bac(v, bufferfro_to_bac, bufferbac_to_fro);
+	MPI_Isend(&bufferfro_to_bac[1][1][1],NX*NY*nf1,MPI_FLOAT,nb[5],TAG3,MPI_COMM_WORLD,&req_send[4]);
+	MPI_Isend(&bufferbac_to_fro[1][1][1],NX*NY*nf2,MPI_FLOAT,nb[6],TAG4,MPI_COMM_WORLD,&req_send[5]);
+
+	time=MPI_Wtime()-time1;
+	return time;
+}
+
+
+/*
+ * Complete the exchange of particle velocities started by
+ * `exchange_v_start` and copy the received values into the halo of `v`
+ * (not needed if the datatypes `type_rec` were used).
+ */
+double exchange_v_finish(int nt, Velocity *v,
+	float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+	float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+	float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+	MPI_Request *req_send, MPI_Request *req_rec,
+	MPI_Datatype *type_rec)
+{
+	extern int MYID, LOG;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	double time=0.0, time1=0.0, time2=0.0;
+
+	time1=MPI_Wtime();
+
+	MPI_Waitall(REQUEST_COUNT, req_rec, MPI_STATUSES_IGNORE);
+
+	if (!type_rec){
+		unpack_v_top_bot(v, rbuffertop_to_bot, rbufferbot_to_top);
+		unpack_v_lef_rig(v, rbufferlef_to_rig, rbufferrig_to_lef);
+		unpack_v_fro_bac(v, rbufferfro_to_bac, rbufferbac_to_fro);
+	}
+
+	MPI_Waitall(REQUEST_COUNT, req_send, MPI_STATUSES_IGNORE);
+
+	time2=MPI_Wtime();
+	time=time2-time1;
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			fprintf(FP," Real time for waiting on particle velocity exchange: %4.2f s.\n",time);
+	return time;
+}
+
+
+/*
+ * Create the datatypes for the zero-copy exchange of particle velocities
+ * (HALO_DATATYPE=1).  They hold the absolute addresses of the ghost planes
+ * of `v` and remain valid as long as `v` is not reallocated.
+ *
+ * Parameters
+ * ----------
+ * v :
+ *     Velocity field.
+ * type_send, type_rec :
+ *     Arrays of REQUEST_COUNT datatypes in the order top_to_bot, bot_to_top,
+ *     lef_to_rig, rig_to_lef, fro_to_bac, bac_to_fro.
+ */
+void exchange_v_types(Velocity *v, MPI_Datatype *type_send, MPI_Datatype *type_rec)
+{
+	float ***ev_y[2] = {v->x, v->z}, ***od_y[1] = {v->y};
+	float ***ev_x[2] = {v->y, v->z}, ***od_x[1] = {v->x};
+	float ***ev_z[2] = {v->x, v->y}, ***od_z[1] = {v->z};
+
+	halo_axis_types(0, ev_y, 2, od_y, 1, &type_send[0], &type_rec[0]);
+	halo_axis_types(1, ev_x, 2, od_x, 1, &type_send[2], &type_rec[2]);
+	halo_axis_types(2, ev_z, 2, od_z, 1, &type_send[4], &type_rec[4]);
+}
+
+
+/*
+ * Exchange particle velocities at the grid boundaries between MPI processes
+ * without staging buffers, using the datatypes of `exchange_v_types`.
+ */
+double exchange_v_dt(int nt, MPI_Datatype *type_send, MPI_Datatype *type_rec)
+{
+	extern int MYID, LOG;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	double time=0.0, time1=0.0, time2=0.0;
+
+	time1=MPI_Wtime();
+
+	halo_sendrecv(type_send, type_rec);
+
+	time2=MPI_Wtime();
+	time=time2-time1;
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			fprintf(FP," Real time for particle velocity exchange: \t %4.2f s.\n",time);
 	return time;
+}
 
+
+/*
+ * Exchange particle velocities at the grid boundaries between MPI processes
+ * through the shared buffers of `halo_shm_ini` (HALO_SHM=1): the ghost
+ * planes are unpacked directly from the buffers of the neighbours on the
+ * same node, only neighbours on other nodes get MPI messages.
+ */
+double exchange_v_shm(int nt, Velocity *v)
+{
+	extern int MYID, LOG;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	float ***send[REQUEST_COUNT], ***rec[REQUEST_COUNT];
+	double time=0.0, time1=0.0, time2=0.0;
+
+	time1=MPI_Wtime();
+
+	halo_shm_begin(HALO_SHM_V, send, rec);
+
+	pack_v_top_bot(v, send[0], send[1]);
+	pack_v_lef_rig(v, send[2], send[3]);
+	pack_v_fro_bac(v, send[4], send[5]);
+
+	halo_shm_post(HALO_SHM_V);
+	halo_shm_wait(HALO_SHM_V);
+
+	unpack_v_top_bot(v, rec[0], rec[1]);
+	unpack_v_lef_rig(v, rec[2], rec[3]);
+	unpack_v_fro_bac(v, rec[4], rec[5]);
+
+	halo_shm_end(HALO_SHM_V);
+
+	time2=MPI_Wtime();
+	time=time2-time1;
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			fprintf(FP," Real time for particle velocity exchange: \t %4.2f s.\n",time);
+	return time;
 }
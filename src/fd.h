@@ -24,6 +24,19 @@
 #define max(x,y) ((x<y)?y:x)
 #define fsign(x) ((x<0.0)?(-1):1)
 
+// Promise the compiler that the iterations of the next loop are independent,
+// e.g., in the stencil loops along k, where the rows of different wavefields
+// never overlap, so that it vectorizes without run-time alias checks.
+#if defined(__INTEL_COMPILER)
+    #define IVDEP _Pragma("ivdep")
+#elif defined(__clang__)
+    #define IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+    #define IVDEP _Pragma("GCC ivdep")
+#else
+    #define IVDEP
+#endif
+
 // Check that C compiler conforms at least to the C11 standard
 // and define macro `ASOFI_STDC11_AT_LEAST` that signals about that.
 #if defined(__STDC_VERSION__)
@@ -52,6 +65,11 @@ void CPML_coeff(float * K_x, float * alpha_prime_x, float * a_x, float * b_x,
 
 void CPML_ini_elastic(int * xb, int * yb, int * zb);
 
+void visco_coeff(ViscoPar *vp, float ***pi, float ***u,
+        float ***uipjp, float ***ujpkp, float ***uipkp,
+        float ***taus, float ***tausipjp, float ***tausjpkp, float ***tausipkp,
+        float ***taup, float *eta);
+
 void av_mat(float *** rho,
         float *** C44, float *** C55, float *** C66,
         float *** taus,
@@ -60,7 +78,28 @@ void av_mat(float *** rho,
 
 void av_mat_acoustic(float *** rho, float  *** rjp, float  *** rkp, float  *** rip );
 
-void catseis(float **data, float **fulldata, int *recswitch, int ntr_glob, int ns);
+void catseis(float **data, float **fulldata, int *recswitch, int ntr_glob, int ns, int type);
+
+void checkpoint_field(float ***a, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2);
+
+void checkpoint_section(float **section, int ntr, int ns);
+
+void checkpoint_wavefield(Velocity *v, Tensor3d *s, Tensor3d *r, float ***psi[18],
+        int nrl, int nrh, int ncl, int nch, int ndl, int ndh, int sl);
+
+int checkpoint_pe(void);
+
+void checkpoint_ini(void);
+
+int checkpoint_due(int nt);
+
+void checkpoint_write(const CheckptPos *pos);
+
+void checkpoint_read(CheckptPos *pos);
+
+void checkpoint_restore(void);
+
+void checkpoint_free(void);
 
 void checkfd(FILE *fp, float *** prho, float *** ppi, float *** pu,
         float *** ptaus, float *** ptaup, float *peta, float **srcpos, int nsrc, int **recpos, int ntr);
@@ -73,18 +112,39 @@ void checkfd_rsg(FILE *fp, float *** prho, float *** ppi, float *** pu,
 void comm_ini(float *** bufferlef_to_rig,
         float *** bufferrig_to_lef, float *** buffertop_to_bot,
         float *** bufferbot_to_top, float *** bufferfro_to_bac,
-        float *** bufferbac_to_fro, MPI_Request *req_send, MPI_Request *req_rec);
+        float *** bufferbac_to_fro,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Datatype *type_send, MPI_Datatype *type_rec,
+        MPI_Request *req_send, MPI_Request *req_rec);
 
 void comm_ini_s(float *** bufferlef_to_rig,
         float *** bufferrig_to_lef, float *** buffertop_to_bot,
         float *** bufferbot_to_top, float *** bufferfro_to_bac,
-        float *** bufferbac_to_fro, MPI_Request *req_send, MPI_Request *req_rec);
+        float *** bufferbac_to_fro,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Datatype *type_send, MPI_Datatype *type_rec,
+        MPI_Request *req_send, MPI_Request *req_rec);
 
-void comm_ini_acoustic(float *** bufferlef_to_rig,
-        float *** bufferrig_to_lef, float *** buffertop_to_bot,
-        float *** bufferbot_to_top, float *** bufferfro_to_bac,
-        float *** bufferbac_to_fro, MPI_Request *req_send, MPI_Request *req_rec);
 
+void decomp_procgrid(void);
+
+void decomp_uniform(void);
+
+void decomp_weighted(int **recpos, int ntr);
+
+int decomp_owner(const int *slab, int np, int iglob);
+
+int decomp_rebalance(int ishot, double tbusy, int **recpos, int ntr);
+
+float ***decomp_redistribute(float ***a, int aligned);
+
+void decomp_write(void);
+
+void decomp_read(void);
 
 void eqsource(int nt, Tensor3d *s,
         float **  srcpos_loc, float ** signals, int nsrc, int * stype,
@@ -103,6 +163,29 @@ double exchange_s(int nt, Tensor3d *s,
         float *** buffertop_to_bot, float *** bufferbot_to_top,
         float *** bufferfro_to_bac, float *** bufferbac_to_fro);
 
+double exchange_s_start(int nt, Tensor3d *s,
+        float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+        float *** buffertop_to_bot, float *** bufferbot_to_top,
+        float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req_send, MPI_Request *req_rec,
+        MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+double exchange_s_finish(int nt, Tensor3d *s,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req_send, MPI_Request *req_rec,
+        MPI_Datatype *type_rec);
+
+void exchange_s_types(Tensor3d *s, MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+double exchange_s_dt(int nt, MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+double exchange_s_shm(int nt, Tensor3d *s);
+
 double exchange_s_acoustic(int nt, float *** sxx,
         float *** bufferlef_to_rig, float *** bufferrig_to_lef,
         float *** buffertop_to_bot, float *** bufferbot_to_top,
@@ -118,6 +201,74 @@ double exchange_v(int nt, Velocity *v,
         float *** buffertop_to_bot, float *** bufferbot_to_top,
         float *** bufferfro_to_bac, float *** bufferbac_to_fro);
 
+double exchange_v_start(int nt, Velocity *v,
+        float *** bufferlef_to_rig, float *** bufferrig_to_lef,
+        float *** buffertop_to_bot, float *** bufferbot_to_top,
+        float *** bufferfro_to_bac, float *** bufferbac_to_fro,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req_send, MPI_Request *req_rec,
+        MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+double exchange_v_finish(int nt, Velocity *v,
+        float *** rbufferlef_to_rig, float *** rbufferrig_to_lef,
+        float *** rbuffertop_to_bot, float *** rbufferbot_to_top,
+        float *** rbufferfro_to_bac, float *** rbufferbac_to_fro,
+        MPI_Request *req_send, MPI_Request *req_rec,
+        MPI_Datatype *type_rec);
+
+void exchange_v_types(Velocity *v, MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+double exchange_v_dt(int nt, MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+double exchange_v_shm(int nt, Velocity *v);
+
+void halo_neighbours(int *nb);
+
+void halo_split(int *xb, int *yb, int *zb, int hw, int box[7][6]);
+
+void halo_shell(int *xb, int *yb, int *zb, int box[7][6]);
+
+void halo_axis_types(int axis, float ****ev, int nev, float ****od, int nod,
+        MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+void halo_types_free(MPI_Datatype *types);
+
+void halo_sendrecv(MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+void halo_isendrecv(MPI_Datatype *type_send, MPI_Datatype *type_rec,
+        MPI_Request *req_send, MPI_Request *req_rec);
+
+void halo_persistent(MPI_Datatype *type_send, MPI_Datatype *type_rec,
+        MPI_Request *req_send, MPI_Request *req_rec);
+
+void halo_requests_free(MPI_Request *req);
+
+void halo_deep_types(float ****a, int n, int g, MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+int halo_deep_depth(void);
+
+void halo_deep_box(int nt, int vel, int *xb, int *yb, int *zb, int *b);
+
+void halo_deep_ini(Velocity *v, Tensor3d *s, MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+void halo_deep_model(float ****a, int n);
+
+double exchange_deep(int nt, MPI_Datatype *type_send, MPI_Datatype *type_rec);
+
+void halo_shm_ini(int f, int nf1, int nf2);
+
+void halo_shm_begin(int f, float ****send, float ****rec);
+
+void halo_shm_post(int f);
+
+void halo_shm_wait(int f);
+
+void halo_shm_end(int f);
+
+void halo_shm_free(int f);
+
 void read_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         Velocity *v,
         Tensor3d *s,
@@ -129,7 +280,7 @@ void read_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 
 void info(FILE *fp);
 
-void initproc(void);
+void initproc(int **recpos, int ntr);
 
 int initsour(int nxs,int nys, int  nzs, int *nxsl,int *nysl, int  *nzsl );
 
@@ -142,6 +293,9 @@ void matcopy_acoustic(float *** rho, float *** pi);
 
 void merge(int nsnap, int type);
 
+void merge_planes(FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], FILE *fpout,
+        int nsnap, int format_in, int format_out);
+
 void mergemod(char modfile[STRING_SIZE], int format);
 
 void merge_source_field(char modfile[STRING_SIZE], int format);
@@ -169,6 +323,10 @@ void outseis_glob(FILE *fp, FILE *fpdata, float **section,
         int **recpos, int **recpos_loc, int ntr, float ** srcpos,
         int nsrc, int ns, int seis_form[6], int ishot, int comp);
 
+void outseis_mpiio(FILE *fp, const char *file, float **section, int *recswitch,
+        int **recpos, int ntr_glob, float **srcpos, int nsrc, int ns,
+        int seis_form[6], int comp);
+
 void output_source_signal(FILE *fp, float **signals, int ns, int seis_form);
 
 int plane_wave(float *** force_points);
@@ -199,6 +357,25 @@ void readbufv(float *** vx, float *** vy, float *** vz,
 
 float readdsk(FILE *fp_in, int format);
 
+void readdsk_block(FILE *fp_in, float *a, int n, int format);
+
+void compress_write(FILE *fp, const float *a, int n, float tol, int rel);
+
+int compress_next(FILE *fp);
+
+void compress_read(FILE *fp, float *a, int n);
+
+MPI_Datatype mpiio_block_type(void);
+
+float *mpiio_read_block(const char *filename);
+
+void mpiio_free_block(float *buf);
+
+void mpiio_iwrite_snap(const char *filename, const float *buf, int n, int nsnap,
+        MPI_File *fh, MPI_Request *req);
+
+void mpiio_write_snap(const char *filename, const float *buf, int n, int nsnap);
+
 
 void read_par_json(FILE *fp, char *fileinp);
 
@@ -220,6 +397,9 @@ void saveseis(FILE *fp, float **sectionvx, float **sectionvy,float **sectionvz,
 void saveseis_glob(FILE *fp, float **sectiondata,
         int  **recpos, int ntr, float ** srcpos, int nsrc,int ns, int sectiondatatype);
 
+void saveseis_all(FILE *fp, float **section, float **fulldata, int *recswitch, int **recpos,
+        int ntr_glob, float ** srcpos, int ishot, int ns, int sectiondatatype);
+
 void save_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         Velocity *v,
         Tensor3d *s,
@@ -238,6 +418,25 @@ void seismo(int lsamp, int ntr, int **recpos, float **sectionvx, float **section
         Velocity *v,
         Tensor3d *s, float ***pi, float ***u);
 
+int seisstream_ini(int ntr, int ntr_glob, int *recswitch, int ns);
+
+int seisstream_col(int nlsamp);
+
+void seisstream_open(int ishot, int nlsamp);
+
+void seisstream_write(int nlsamp, float **sectionvx, float **sectionvy, float **sectionvz,
+        float **sectionp, float **sectiondiv, float **sectioncurl);
+
+void seisstream_sync(void);
+
+void seisstream_close(void);
+
+int seisstream_read(float **fulldata, int type);
+
+void seisstream_read_local(float **data, int type);
+
+void seisstream_free(void);
+
 void seismo_rsg(int lsamp, int ntr, int **recpos, float **sectionvx, float **sectionvy,
         float **sectionvz, float **sectiondiv, float **sectioncurl, float **sectionp,
         float ***vx, float ***vy, float ***vz,
@@ -253,6 +452,16 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
         int idx, int idy, int idz, int nx1, int ny1, int nz1, int nx2,
         int ny2, int nz2);
 
+void snap_file(char *file, int format, const char *quant);
+
+void snap_async_ini(void);
+
+void snap_async_write(const char *file, const float *buf, int n, int nsnap, int format);
+
+void snap_async_wait(void);
+
+void snap_async_free(void);
+
 
 void snap_rsg(FILE *fp, int nt, int nsnap, int format, int type,
         float ***vx, float ***vy, float ***vz, float ***sxx, float ***syy, float ***szz,
@@ -269,7 +478,7 @@ float **sources(FILE * fpsrc, int *nsrc, int * stype);
 
 int **splitrec(int **recpos,int *ntr_loc, int ntr,int *recswitch);
 
-float **splitsrc(float **srcpos,int *nsrc_loc, int nsrc, int * stype_loc, int *stype);
+float **splitsrc(float **srcpos,int *nsrc_loc, int nsrc, int * stype_loc, int *stype, int g);
 
 void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** taup,
         float * eta, Tensor3d *s,
@@ -277,7 +486,8 @@ void surface(int ndepth, float *** u, float *** pi, float ***taus, float *** tau
         float * K_x, float * a_x, float * b_x, float * K_z, float * a_z, float * b_z,
         float *** psi_vxx, float *** psi_vzz );
 
-void surface_elastic(int ndepth, float *** u, float *** pi,
+void surface_elastic(int ndepth, int nx1, int nx2, int nz1, int nz2,
+        float *** u, float *** pi,
         Tensor3d *s,
         Velocity *v,
         float * K_x, float * a_x, float * b_x, float * K_z, float * a_z, float * b_z,
@@ -292,10 +502,20 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                 Velocity *v,
                 Tensor3d *s,
                 Tensor3d *r,
-                float ***  pi, float ***  u,
-                float ***  uipjp, float ***  ujpkp, float ***  uipkp,
-                float  ***  taus, float  ***  tausipjp, float  ***  tausjpkp, float  ***  tausipkp,
-                float  ***  taup, float *  eta,
+                ViscoPar *vp, float *  eta,
+                VelocityDerivativesTensor *dv,
+                VelocityDerivativesTensor *dv_2,
+                VelocityDerivativesTensor *dv_3,
+                VelocityDerivativesTensor *dv_4,
+                Tensor3d *r_2,
+                Tensor3d *r_3,
+                Tensor3d *r_4);
+
+void update_s_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+                Velocity *v,
+                Tensor3d *s,
+                Tensor3d *r,
+                ViscoPar *vp, float *  eta,
                 VelocityDerivativesTensor *dv,
                 VelocityDerivativesTensor *dv_2,
                 VelocityDerivativesTensor *dv_3,
@@ -304,6 +524,8 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                 Tensor3d *r_3,
                 Tensor3d *r_4);
 
+void update_s_kernel_ini(void);
+
 
 double update_s_elastic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         Velocity *v,
@@ -315,8 +537,27 @@ double update_s_elastic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, in
                         VelocityDerivativesTensor *dv_3,
                         VelocityDerivativesTensor *dv_4);
 
+void update_s_elastic_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+                        Velocity *v,
+                        Tensor3d *s,
+                        float ***pi, float ***u,
+                        OrthoPar *op,
+                        VelocityDerivativesTensor *dv,
+                        VelocityDerivativesTensor *dv_2,
+                        VelocityDerivativesTensor *dv_3,
+                        VelocityDerivativesTensor *dv_4);
+
 void compute_vel_deriv_2nd_order(Velocity *v, int i, int j, int k, Strain_ijk *e);
 
+void update_s_elastic_kernel_ini(void);
+
+void update_s_elastic_simd_ini(int request, int fdorder, int fold);
+
+const char *update_s_elastic_simd_name(void);
+
+int update_s_elastic_simd(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+                        Velocity *v, Tensor3d *s, OrthoPar *op, const float *b);
+
 void update_s_ijk_2nd_order(OrthoPar *op, Strain_ijk *e, int i, int j, int k, Tensor3d *s);
 
 /*double update_s_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
@@ -331,8 +572,7 @@ void update_s_ijk_2nd_order(OrthoPar *op, Strain_ijk *e, int i, int j, int k, Te
 double update_s_CPML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt, Velocity *v,
              Tensor3d *s,
                      Tensor3d *r,
-                     float ***  pi, float ***  u, float ***  uipjp, float ***  ujpkp, float ***  uipkp,
-        float  ***  taus, float  ***  tausipjp, float  ***  tausjpkp, float  ***  tausipkp,  float  ***  taup, float *  eta,
+                     ViscoPar *vp, float *  eta,
         float * K_x, float * a_x, float * b_x, float * K_x_half, float * a_x_half, float * b_x_half,
         float * K_y, float * a_y, float * b_y, float * K_y_half, float * a_y_half, float * b_y_half,
         float * K_z, float * a_z, float * b_z, float * K_z_half, float * a_z_half, float * b_z_half,
@@ -348,6 +588,9 @@ double update_s_CPML_elastic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                  Velocity *v, float *** sxx, float ***  pi);
 
+void update_s_acoustic_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+                 Velocity *v, float *** sxx, float ***  pi);
+
 double update_s_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
         Velocity *v,
         float *** sxx, float *** sxx1, float *** sxx2, float *** sxx3,
@@ -371,6 +614,40 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         StressDerivativesWrtVelocity *ds_dv_3,
         StressDerivativesWrtVelocity *ds_dv_4);
 
+void update_v_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v,
+        Tensor3d *s,
+        float  *** rjp, float  *** rkp, float  *** rip,
+        StressDerivativesWrtVelocity *ds_dv,
+        StressDerivativesWrtVelocity *ds_dv_2,
+        StressDerivativesWrtVelocity *ds_dv_3,
+        StressDerivativesWrtVelocity *ds_dv_4);
+
+void update_v_kernel_ini(void);
+
+int tile_first(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int *t);
+
+int tile_next(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int *t);
+
+void tile_ini(void);
+
+void wavefront_ini(int *xb, int *yb, int *zb, int sbox[7][6], int fbox[7][6]);
+
+int wavefront_first(int *vbox, int *sbox, int *w);
+
+int wavefront_next(int *vbox, int *sbox, int *w);
+
+void update_v_point_forces(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        int nt, Velocity *v,
+        float  *** rjp, float  *** rkp, float  *** rip,
+        float **  srcpos_loc, float ** signals, int nsrc, int * stype);
+
+void update_v_body_forces(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        int nt, Velocity *v,
+        Tensor3d *s,
+        float  *** rjp, float  *** rkp, float  *** rip,
+        float **  srcpos_loc, float ** signals, int nsrc, float ***absorb_coeff, int * stype);
+
 /*double update_v_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt, float *** vx, float *** vy, float *** vz,
 float *** sxx, float *** syy, float *** szz, float *** sxy,float *** syz, float *** sxz, float *** vx1, float *** vy1,
 float *** vz1, float *** sxx1, float *** syy1, float *** szz1, float *** sxy1, float *** syz1, float *** sxz1, float *** vx2,
@@ -395,6 +672,9 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         int nt, Velocity *v,
         float *** sxx, float  ***  rho, float **  srcpos_loc, float ** signals, int nsrc, float ***absorb_coeff, int * stype);
 
+void update_v_acoustic_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, float *** sxx, float  ***  rho);
+
 double update_v_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         int nt, Velocity *v, float *** sxx,  float *** vx1,
         float *** vy2, float *** vz3, float  ***  rho, float **  srcpos_loc,
@@ -421,6 +701,8 @@ void writebufv(float *** vx, float *** vy, float *** vz,
 
 void writedsk(FILE *fp_out, float amp, int format);
 
+void writedsk_block(FILE *fp_out, const float *a, int n, int format);
+
 void writemod(char modfile[STRING_SIZE], float *** rho, int format);
 
 void writepar(FILE *fp, int ns);
@@ -509,6 +791,7 @@ int *ivector(int nl, int nh);
 int **imatrix(int nrl, int nrh, int ncl, int nch);
 
 float ***f3tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh);
+float ***f3tensor_aligned(int nrl, int nrh, int ncl, int nch, int ndl, int ndh);
 
 void free_vector(float *v, int nl, int nh);
 void free_ivector(int *v, int nl, int nh);
@@ -516,6 +799,8 @@ void free_matrix(float **m, int nrl, int nrh, int ncl, int nch);
 void free_imatrix(int **m, int nrl, int nrh, int ncl, int nch);
 void free_f3tensor(float ***t, int nrl, int nrh, int ncl, int nch, int ndl,
         int ndh);
+void free_f3tensor_aligned(float ***t, int nrl, int nrh, int ncl, int nch,
+        int ndl, int ndh);
 
 double *dvector(int nl, int nh);
 void free_dvector(double *v, int nl, int nh);
@@ -0,0 +1,64 @@
+/*------------------------------------------------------------------------
+ *   Coefficients of the staggered grid FD operators.
+ *
+ *   Writes the FDORDER/2 coefficients b[0..FDORDER/2-1] of the spatial
+ *   FD operator of order `fdorder` to `b`: Taylor coefficients for
+ *   fdcoeff=1, Holberg coefficients (E=0.1 %) for fdcoeff=2.
+ *   Returns the number of coefficients.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "stencil.h"
+
+int fd_coeff(int fdorder, int fdcoeff, float *b)
+{
+    /* Taylor coefficients */
+    static const double taylor[FD_MAX_NB][FD_MAX_NB] = {
+        {1.0},
+        {9.0/8.0, -1.0/24.0},
+        {75.0/64.0, -25.0/384.0, 3.0/640.0},
+        {1225.0/1024.0, -245.0/3072.0, 49.0/5120.0, -5.0/7168.0},
+        {19845.0/16384.0, -735.0/8192.0, 567.0/40960.0, -405.0/229376.0, 35.0/294912.0},
+        {160083.0/131072.0, -12705.0/131072.0, 22869.0/1310720.0,
+            -5445.0/1835008.0, 847.0/2359296.0, -63.0/2883584}
+    };
+    /* Holberg coefficients E=0.1 % */
+    static const double holberg[FD_MAX_NB][FD_MAX_NB] = {
+        {1.00100},
+        {1.1382, -0.046414},
+        {1.1965, -0.078804, 0.0081781},
+        {1.2257, -0.099537, 0.018063, -0.0026274},
+        {1.2415, -0.11231, 0.026191, -0.0064682, 0.001191},
+        {1.2508, -0.12034, 0.032131, -0.010142, 0.0029857, -0.00066667}
+    };
+    int n, nb = fdorder / 2;
+
+    if ((fdorder % 2 != 0) || (nb < 1) || (nb > FD_MAX_NB))
+        err(" fd_coeff: no FD coefficients for this FDORDER ! ");
+
+    for (n = 0; n < nb; n++)
+        b[n] = (fdcoeff == 2) ? holberg[nb-1][n] : taylor[nb-1][n];
+
+    return nb;
+}
+
+/*
+ * Coefficients of the kernels for FDORDER_TIME=2: three rows of FD_MAX_NB
+ * coefficients for the derivatives along x, y and z (see FD_BX, FD_BY,
+ * FD_BZ in stencil.h), so `b` must hold 3*FD_MAX_NB values.  If `fold` is
+ * set, the rows are multiplied by DT/DX, DT/DY and DT/DZ.
+ * Returns the number of coefficients per row.
+ */
+int fd_coeff_fold(int fdorder, int fdcoeff, int fold, float *b)
+{
+    extern float DT, DX, DY, DZ;
+    const double h[3] = {DX, DY, DZ};
+    int d, n, nb = fd_coeff(fdorder, fdcoeff, b);
+
+    for (d = 2; d >= 0; d--)
+        for (n = 0; n < nb; n++)
+            b[d * FD_MAX_NB + n] = fold ? (float) (b[n] * (double) DT / h[d]) : b[n];
+
+    return nb;
+}
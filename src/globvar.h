@@ -54,6 +54,27 @@ extern int SOFI3DVERS; /* version of SOFI3D 33: current 3D isotropic elastic (SS
 extern int NP, NPSP, NPROC, NPROCX, NPROCY, NPROCZ, MYID, IENDX, IENDY, IENDZ;
 extern int POS[4], INDEX[7];
 extern const int TAG1, TAG2, TAG3, TAG4, TAG5, TAG6;
+extern int OVERLAP_COMM; /* overlap the halo exchange with the update of the interior */
+extern int HALO_DATATYPE; /* exchange the halo with MPI derived datatypes instead of buffers */
+extern int PERSISTENT_COMM; /* exchange the halo with persistent requests */
+extern int HALO_SHM; /* exchange the halo through the shared memory of a node */
+extern int HALO_DEEP; /* ghost zones for HALO_DEEP time steps, exchanged every HALO_DEEP steps */
+
+extern int SIMD_KERNEL; /* stress kernel: 0 auto, 1 scalar, 2 AVX2, 3 AVX-512 */
+extern int TILING, TILE_X, TILE_Y, TILE_Z; /* cache blocking: 0 off, 1 tile sizes given, 2 automatic */
+extern int FUSED_SWEEP; /* update velocity and stress of the inner grid in one sweep */
+extern int FOLD_COEFF; /* fold DT and the grid spacing into the FD coefficients */
+extern int SNAP_MPIIO; /* write snapshots to global files with collective MPI-IO */
+extern int SNAP_ASYNC, SNAP_ASYNC_MB; /* write snapshots in the background, memory budget in MB */
+extern float COMPRESS_TOL; /* error bound of the lossy compression (see compress.c) */
+extern int COMPRESS_REL; /* COMPRESS_TOL relative to the largest amplitude of a record */
+extern int CHECKPT_COMPRESS, MODEL_COMPRESS; /* compress the checkpoints, the model files of the PEs */
+extern int SEIS_STREAM; /* stream the seismograms to disk in blocks of SEIS_STREAM samples */
+extern int SEIS_MPIIO; /* write the seismograms of all PEs with collective MPI-IO */
+extern int CHECKPT_INTERVAL, CHECKPT_ASYNC; /* checkpoints every CHECKPT_INTERVAL time steps, by an I/O thread */
+extern int DECOMP; /* domain decomposition: 0 uniform, 1 cost-weighted slabs */
+extern int REBALANCE; /* rebalance the slabs between the shots with the measured times */
+extern int SLABX[NPROCX_MAX+1], SLABY[NPROCY_MAX+1], SLABZ[NPROCZ_MAX+1]; /* the PEs at POS[1]=ip hold x = SLABX[ip]+1 ... SLABX[ip+1] */
 
 extern float FC, AMP, REFSRC[3], SRC_DT, SRCTSHIFT;
 extern int SRC_MF, SIGNAL_FORMAT[6];
@@ -0,0 +1,333 @@
+/*------------------------------------------------------------------------
+ *   Helper functions for the exchange of the halo (ghost) points between
+ *   neighbouring processes.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/*
+ * Return the ranks of the six neighbours of this process in the order of
+ * INDEX (left, right, upper, lower, front, back).  At the edges of the global
+ * grid the periodic neighbour is replaced by MPI_PROC_NULL unless BOUNDARY=1,
+ * so that no message is exchanged there at all.
+ */
+void halo_neighbours(int *nb)
+{
+	extern int POS[4], INDEX[7], NPROCX, NPROCY, NPROCZ, BOUNDARY;
+
+	nb[0] = MPI_PROC_NULL;
+	nb[1] = (BOUNDARY || (POS[1] != 0)) ? INDEX[1] : MPI_PROC_NULL;
+	nb[2] = (BOUNDARY || (POS[1] != NPROCX - 1)) ? INDEX[2] : MPI_PROC_NULL;
+	nb[3] = (BOUNDARY || (POS[2] != 0)) ? INDEX[3] : MPI_PROC_NULL;
+	nb[4] = (BOUNDARY || (POS[2] != NPROCY - 1)) ? INDEX[4] : MPI_PROC_NULL;
+	nb[5] = (BOUNDARY || (POS[3] != 0)) ? INDEX[5] : MPI_PROC_NULL;
+	nb[6] = (BOUNDARY || (POS[3] != NPROCZ - 1)) ? INDEX[6] : MPI_PROC_NULL;
+}
+
+
+/*
+ * Split the box [xb[0]...xb[1]][yb[0]...yb[1]][zb[0]...zb[1]] of the local
+ * grid into an inner box, whose update does not read any halo point, and six
+ * disjoint boxes covering the remaining shell of width hw (FDORDER/2).
+ *
+ * On return box[0] holds the inner box and box[1]...box[6] the shell,
+ * each as {x1, x2, y1, y2, z1, z2}.  Boxes may be empty (x2 < x1 etc.),
+ * e.g. the inner box vanishes on very small subdomains.
+ */
+void halo_split(int *xb, int *yb, int *zb, int hw, int box[7][6])
+{
+	extern int NX, NY, NZ;
+
+	int x1, x2, y1, y2, z1, z2;
+
+	/* inner box, clamped so that xb[0] <= x1 <= x2+1 <= xb[1]+1 */
+	x1 = min(max(xb[0], 1 + hw), xb[1] + 1);
+	x2 = max(min(xb[1], NX - hw), x1 - 1);
+	y1 = min(max(yb[0], 1 + hw), yb[1] + 1);
+	y2 = max(min(yb[1], NY - hw), y1 - 1);
+	z1 = min(max(zb[0], 1 + hw), zb[1] + 1);
+	z2 = max(min(zb[1], NZ - hw), z1 - 1);
+
+	box[0][0] = x1;    box[0][1] = x2;    box[0][2] = y1;    box[0][3] = y2;    box[0][4] = z1;    box[0][5] = z2;
+
+	halo_shell(xb, yb, zb, box);
+}
+
+
+/*
+ * Split the part of the box [xb[0]...xb[1]][yb[0]...yb[1]][zb[0]...zb[1]]
+ * outside of the inner box box[0] into six disjoint boxes box[1]...box[6].
+ * box[0] must satisfy xb[0] <= x1 <= x2+1 <= xb[1]+1 (and alike in y and z).
+ */
+void halo_shell(int *xb, int *yb, int *zb, int box[7][6])
+{
+	int x1 = box[0][0], x2 = box[0][1], y1 = box[0][2], y2 = box[0][3], z1 = box[0][4], z2 = box[0][5];
+
+	/* upper and lower slabs over the full box */
+	box[1][0] = xb[0]; box[1][1] = xb[1]; box[1][2] = yb[0]; box[1][3] = y1 - 1; box[1][4] = zb[0]; box[1][5] = zb[1];
+	box[2][0] = xb[0]; box[2][1] = xb[1]; box[2][2] = y2 + 1; box[2][3] = yb[1]; box[2][4] = zb[0]; box[2][5] = zb[1];
+
+	/* left and right slabs between them */
+	box[3][0] = xb[0]; box[3][1] = x1 - 1; box[3][2] = y1;    box[3][3] = y2;    box[3][4] = zb[0]; box[3][5] = zb[1];
+	box[4][0] = x2 + 1; box[4][1] = xb[1]; box[4][2] = y1;    box[4][3] = y2;    box[4][4] = zb[0]; box[4][5] = zb[1];
+
+	/* front and back slabs of the remaining column */
+	box[5][0] = x1;    box[5][1] = x2;    box[5][2] = y1;    box[5][3] = y2;    box[5][4] = zb[0]; box[5][5] = z1 - 1;
+	box[6][0] = x1;    box[6][1] = x2;    box[6][2] = y1;    box[6][3] = y2;    box[6][4] = z2 + 1; box[6][5] = zb[1];
+}
+
+
+/*
+ * Describe the block a[j1...j2][i1...i2][k1...k2] of a wavefield allocated by
+ * f3tensor as a datatype relative to the address `disp` of its first element.
+ * Returns 0 (and creates no datatype) if the block is empty.
+ */
+static int halo_block(float ***a, int j1, int j2, int i1, int i2, int k1, int k2,
+	MPI_Datatype *type, MPI_Aint *disp)
+{
+	MPI_Datatype row;
+	MPI_Aint plane_stride = 0;
+	int row_stride = 0;
+
+	if ((j2 < j1) || (i2 < i1) || (k2 < k1)) return 0;
+
+	/* strides are taken from the row pointers of the tensor */
+	if (i2 > i1) row_stride = (int)(a[j1][i1 + 1] - a[j1][i1]);
+	if (j2 > j1) plane_stride = (MPI_Aint)((a[j1 + 1][i1] - a[j1][i1]) * sizeof(float));
+
+	MPI_Type_vector(i2 - i1 + 1, k2 - k1 + 1, row_stride, MPI_FLOAT, &row);
+	MPI_Type_create_hvector(j2 - j1 + 1, 1, plane_stride, row, type);
+	MPI_Type_free(&row);
+
+	MPI_Get_address(&a[j1][i1][k1], disp);
+	return 1;
+}
+
+
+/*
+ * Append the planes p1...p2 normal to `axis` (0: y, 1: x, 2: z) of the
+ * wavefields a[0...n-1] to the block list of a datatype.  The planes span
+ * g ghost planes on both sides of the axes exchanged before (y before x
+ * before z), none for g=0.
+ */
+static void halo_planes(int axis, int g, float ****a, int n, int p1, int p2,
+	int *nblock, MPI_Datatype *types, MPI_Aint *disps)
+{
+	extern int NX, NY, NZ;
+
+	int m, found = 0;
+
+	for (m = 0; m < n; m++) {
+		switch (axis) {
+		case 0:
+			found = halo_block(a[m], p1, p2, 1, NX, 1, NZ, &types[*nblock], &disps[*nblock]);
+			break;
+		case 1:
+			found = halo_block(a[m], 1 - g, NY + g, p1, p2, 1, NZ, &types[*nblock], &disps[*nblock]);
+			break;
+		default:
+			found = halo_block(a[m], 1 - g, NY + g, 1 - g, NX + g, p1, p2, &types[*nblock], &disps[*nblock]);
+		}
+		*nblock += found;
+	}
+}
+
+
+/*
+ * Combine the block list into one committed datatype with absolute
+ * addresses, to be used together with MPI_BOTTOM.
+ */
+static void halo_commit(int nblock, MPI_Datatype *types, MPI_Aint *disps, MPI_Datatype *type)
+{
+	int m, *len = ivector(0, nblock - 1);
+
+	for (m = 0; m < nblock; m++) len[m] = 1;
+	MPI_Type_create_struct(nblock, len, disps, types, type);
+	MPI_Type_commit(type);
+	for (m = 0; m < nblock; m++) MPI_Type_free(&types[m]);
+	free_ivector(len, 0, nblock - 1);
+}
+
+
+/*
+ * Build the datatypes for the exchange across the two faces normal to `axis`
+ * (0: y, 1: x, 2: z) so that MPI reads and writes the ghost planes of the
+ * wavefields directly (HALO_DATATYPE=1).
+ *
+ * The wavefields in `ev` are sent with FDORDER/2 planes towards the lower
+ * neighbour and with FDORDER/2-1 planes towards the upper neighbour, those in
+ * `od` vice versa; this is the layout of the buffers in exchange_v.c and
+ * exchange_s.c.  type_send[0] and type_rec[0] belong to the message towards
+ * the lower neighbour (top_to_bot, lef_to_rig, fro_to_bac), type_send[1] and
+ * type_rec[1] to the opposite one.
+ */
+void halo_axis_types(int axis, float ****ev, int nev, float ****od, int nod,
+	MPI_Datatype *type_send, MPI_Datatype *type_rec)
+{
+	extern int NX, NY, NZ, FDORDER;
+
+	MPI_Datatype types[6];
+	MPI_Aint disps[6];
+	int nblock, hw = FDORDER / 2, n;
+
+	n = (axis == 0) ? NY : ((axis == 1) ? NX : NZ);
+
+	nblock = 0;
+	halo_planes(axis, 0, ev, nev, 1, hw, &nblock, types, disps);
+	halo_planes(axis, 0, od, nod, 1, hw - 1, &nblock, types, disps);
+	halo_commit(nblock, types, disps, &type_send[0]);
+
+	nblock = 0;
+	halo_planes(axis, 0, ev, nev, n + 1, n + hw, &nblock, types, disps);
+	halo_planes(axis, 0, od, nod, n + 1, n + hw - 1, &nblock, types, disps);
+	halo_commit(nblock, types, disps, &type_rec[0]);
+
+	nblock = 0;
+	halo_planes(axis, 0, od, nod, n - hw + 1, n, &nblock, types, disps);
+	halo_planes(axis, 0, ev, nev, n - hw + 2, n, &nblock, types, disps);
+	halo_commit(nblock, types, disps, &type_send[1]);
+
+	nblock = 0;
+	halo_planes(axis, 0, od, nod, 1 - hw, 0, &nblock, types, disps);
+	halo_planes(axis, 0, ev, nev, 2 - hw, 0, &nblock, types, disps);
+	halo_commit(nblock, types, disps, &type_rec[1]);
+}
+
+
+/*
+ * Build the datatypes for the exchange of g ghost planes of the arrays
+ * a[0...n-1] across all six faces (HALO_DEEP), in the order of the
+ * datatypes of exchange_v_types.  The arrays must hold the grid points
+ * 1-g...NX+g, 1-g...NY+g and 1-g...NZ+g and the local grid at least g
+ * points in each direction.  Since halo_sendrecv exchanges y before x
+ * before z, the planes normal to x and z include the ghost planes of the
+ * preceding axes and the edges and corners of the ghost zone are filled,
+ * too.
+ */
+void halo_deep_types(float ****a, int n, int g, MPI_Datatype *type_send, MPI_Datatype *type_rec)
+{
+	extern int NX, NY, NZ;
+
+	MPI_Datatype *types = malloc(n * sizeof(MPI_Datatype));
+	MPI_Aint *disps = malloc(n * sizeof(MPI_Aint));
+	int axis, nblock, nn;
+
+	if ((!types) || (!disps)) err("allocation failure in function halo_deep_types() ");
+
+	for (axis = 0; axis < 3; axis++) {
+		nn = (axis == 0) ? NY : ((axis == 1) ? NX : NZ);
+
+		nblock = 0;
+		halo_planes(axis, g, a, n, 1, g, &nblock, types, disps);
+		halo_commit(nblock, types, disps, &type_send[2 * axis]);
+
+		nblock = 0;
+		halo_planes(axis, g, a, n, nn + 1, nn + g, &nblock, types, disps);
+		halo_commit(nblock, types, disps, &type_rec[2 * axis]);
+
+		nblock = 0;
+		halo_planes(axis, g, a, n, nn - g + 1, nn, &nblock, types, disps);
+		halo_commit(nblock, types, disps, &type_send[2 * axis + 1]);
+
+		nblock = 0;
+		halo_planes(axis, g, a, n, 1 - g, 0, &nblock, types, disps);
+		halo_commit(nblock, types, disps, &type_rec[2 * axis + 1]);
+	}
+
+	free(types);
+	free(disps);
+}
+
+
+/*
+ * Release the REQUEST_COUNT datatypes created by halo_axis_types.
+ */
+void halo_types_free(MPI_Datatype *types)
+{
+	int m;
+
+	for (m = 0; m < REQUEST_COUNT; m++) MPI_Type_free(&types[m]);
+}
+
+
+/*
+ * Exchange the halo described by the datatypes of exchange_v_types or
+ * exchange_s_types, face by face with blocking MPI_Sendrecv.
+ */
+void halo_sendrecv(MPI_Datatype *type_send, MPI_Datatype *type_rec)
+{
+	extern const int TAG1, TAG2, TAG3, TAG4, TAG5, TAG6;
+
+	int m, nb[7];
+	const int dest[REQUEST_COUNT] = {3, 4, 1, 2, 5, 6};
+	const int src[REQUEST_COUNT] = {4, 3, 2, 1, 6, 5};
+	const int tag[REQUEST_COUNT] = {TAG5, TAG6, TAG1, TAG2, TAG3, TAG4};
+
+	halo_neighbours(nb);
+
+	for (m = 0; m < REQUEST_COUNT; m++)
+		MPI_Sendrecv(MPI_BOTTOM, 1, type_send[m], nb[dest[m]], tag[m],
+			MPI_BOTTOM, 1, type_rec[m], nb[src[m]], tag[m],
+			MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
+
+
+/*
+ * Post the non-blocking exchange of the halo described by the datatypes;
+ * the requests are completed by the caller.
+ */
+void halo_isendrecv(MPI_Datatype *type_send, MPI_Datatype *type_rec,
+	MPI_Request *req_send, MPI_Request *req_rec)
+{
+	extern const int TAG1, TAG2, TAG3, TAG4, TAG5, TAG6;
+
+	int m, nb[7];
+	const int dest[REQUEST_COUNT] = {3, 4, 1, 2, 5, 6};
+	const int src[REQUEST_COUNT] = {4, 3, 2, 1, 6, 5};
+	const int tag[REQUEST_COUNT] = {TAG5, TAG6, TAG1, TAG2, TAG3, TAG4};
+
+	halo_neighbours(nb);
+
+	for (m = 0; m < REQUEST_COUNT; m++)
+		MPI_Irecv(MPI_BOTTOM, 1, type_rec[m], nb[src[m]], tag[m], MPI_COMM_WORLD, &req_rec[m]);
+	for (m = 0; m < REQUEST_COUNT; m++)
+		MPI_Isend(MPI_BOTTOM, 1, type_send[m], nb[dest[m]], tag[m], MPI_COMM_WORLD, &req_send[m]);
+}
+
+
+/*
+ * Create persistent requests for the exchange of the halo described by the
+ * datatypes (PERSISTENT_COMM=1 together with HALO_DATATYPE=1).
+ */
+void halo_persistent(MPI_Datatype *type_send, MPI_Datatype *type_rec,
+	MPI_Request *req_send, MPI_Request *req_rec)
+{
+	extern const int TAG1, TAG2, TAG3, TAG4, TAG5, TAG6;
+
+	int m, nb[7];
+	const int dest[REQUEST_COUNT] = {3, 4, 1, 2, 5, 6};
+	const int src[REQUEST_COUNT] = {4, 3, 2, 1, 6, 5};
+	const int tag[REQUEST_COUNT] = {TAG5, TAG6, TAG1, TAG2, TAG3, TAG4};
+
+	halo_neighbours(nb);
+
+	for (m = 0; m < REQUEST_COUNT; m++) {
+		MPI_Recv_init(MPI_BOTTOM, 1, type_rec[m], nb[src[m]], tag[m], MPI_COMM_WORLD, &req_rec[m]);
+		MPI_Send_init(MPI_BOTTOM, 1, type_send[m], nb[dest[m]], tag[m], MPI_COMM_WORLD, &req_send[m]);
+	}
+}
+
+
+/*
+ * Release the REQUEST_COUNT persistent requests created by comm_ini,
+ * comm_ini_s or halo_persistent.
+ */
+void halo_requests_free(MPI_Request *req)
+{
+	int m;
+
+	for (m = 0; m < REQUEST_COUNT; m++) MPI_Request_free(&req[m]);
+}
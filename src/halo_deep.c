@@ -0,0 +1,121 @@
+/*------------------------------------------------------------------------
+ *   Communication-avoiding deep halo (HALO_DEEP = K > 1).
+ *
+ *   The ghost zones of the particle velocities and the stress are
+ *   G = K*FDORDER planes deep instead of FDORDER/2, and both fields are
+ *   exchanged together once every K time steps only.  In between, each
+ *   process updates its ghost zones redundantly, with the same operations as
+ *   the neighbour owning these points.  The update of one field reads
+ *   FDORDER/2 planes of the other one, so that the valid part of the ghost
+ *   zone shrinks by FDORDER/2 planes with every update: at the time step c
+ *   (1...K) of a cycle, the velocity box is extended by G-(2c-1)*FDORDER/2
+ *   and the stress box by G-2c*FDORDER/2 planes on each side with a
+ *   neighbour.  After the stress update of step K only the local grid is
+ *   valid and the ghost zones are exchanged again.
+ *
+ *   The redundant update needs the staggered material parameters, the
+ *   damping coefficients and the sources in the ghost zone; the model is
+ *   exchanged once with halo_deep_model and splitsrc assigns the sources
+ *   within G points of a face to the neighbour, too.  Since every grid point
+ *   is computed as on its own process, the results are identical to the
+ *   exchange in every time step.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "data_structures.h"
+#include "fd.h"
+#include "globvar.h"
+
+
+/*
+ * Depth of the ghost zones of the wavefields and the model with
+ * HALO_DEEP > 1, 0 otherwise.
+ */
+int halo_deep_depth(void)
+{
+	extern int HALO_DEEP, FDORDER;
+
+	return (HALO_DEEP > 1) ? HALO_DEEP * FDORDER : 0;
+}
+
+
+/*
+ * Extend the box [xb[0]...xb[1]][yb[0]...yb[1]][zb[0]...zb[1]] into the ghost
+ * zones on the sides with a neighbour, by the planes that can be updated at
+ * the time step nt: b = {x1, x2, y1, y2, z1, z2} is the box of the particle
+ * velocities for vel=1 and that of the stress for vel=0.  Without HALO_DEEP
+ * the box is returned unchanged.
+ */
+void halo_deep_box(int nt, int vel, int *xb, int *yb, int *zb, int *b)
+{
+	extern int HALO_DEEP, FDORDER;
+
+	int nb[7], e = 0;
+
+	/* time step 1...HALO_DEEP of the cycle between two exchanges */
+	if (HALO_DEEP > 1)
+		e = halo_deep_depth() - (2 * ((nt - 1) % HALO_DEEP + 1) - vel) * (FDORDER / 2);
+
+	halo_neighbours(nb);
+	b[0] = xb[0] - ((nb[1] != MPI_PROC_NULL) ? e : 0);
+	b[1] = xb[1] + ((nb[2] != MPI_PROC_NULL) ? e : 0);
+	b[2] = yb[0] - ((nb[3] != MPI_PROC_NULL) ? e : 0);
+	b[3] = yb[1] + ((nb[4] != MPI_PROC_NULL) ? e : 0);
+	b[4] = zb[0] - ((nb[5] != MPI_PROC_NULL) ? e : 0);
+	b[5] = zb[1] + ((nb[6] != MPI_PROC_NULL) ? e : 0);
+}
+
+
+/*
+ * Build the datatypes for the exchange of the deep ghost zones of all
+ * components of the particle velocities and the stress.
+ */
+void halo_deep_ini(Velocity *v, Tensor3d *s, MPI_Datatype *type_send, MPI_Datatype *type_rec)
+{
+	float ***f[9] = {v->x, v->y, v->z, s->xx, s->yy, s->zz, s->xy, s->yz, s->xz};
+
+	halo_deep_types(f, 9, halo_deep_depth(), type_send, type_rec);
+}
+
+
+/*
+ * Fill the deep ghost zones of the model arrays a[0...n-1] with the values
+ * of the neighbours, once before the time loop.
+ */
+void halo_deep_model(float ****a, int n)
+{
+	MPI_Datatype type_send[REQUEST_COUNT], type_rec[REQUEST_COUNT];
+
+	halo_deep_types(a, n, halo_deep_depth(), type_send, type_rec);
+	halo_sendrecv(type_send, type_rec);
+	halo_types_free(type_send);
+	halo_types_free(type_rec);
+}
+
+
+/*
+ * Exchange the deep ghost zones of the particle velocities and the stress
+ * with the datatypes of `halo_deep_ini` after every HALO_DEEP-th time step.
+ */
+double exchange_deep(int nt, MPI_Datatype *type_send, MPI_Datatype *type_rec)
+{
+	extern int MYID, LOG, HALO_DEEP;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	double time=0.0, time1=0.0, time2=0.0;
+
+	if (nt % HALO_DEEP)
+		return 0.0;
+
+	time1=MPI_Wtime();
+
+	halo_sendrecv(type_send, type_rec);
+
+	time2=MPI_Wtime();
+	time=time2-time1;
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0)
+			fprintf(FP," Real time for exchange of the deep halo: \t %4.2f s.\n",time);
+	return time;
+}
@@ -0,0 +1,302 @@
+/*------------------------------------------------------------------------
+ *   Exchange of the halo through the shared memory of a node (HALO_SHM=1).
+ *
+ *   The PEs of a node (MPI_Comm_split_type with MPI_COMM_TYPE_SHARED)
+ *   allocate the six send buffers of the particle velocities and of the
+ *   stress in a shared window (MPI_Win_allocate_shared).  A PE packs its
+ *   boundary planes into its own buffers and then sets a counter in the
+ *   header of its window.  A neighbour on the same node waits for this
+ *   counter and unpacks the ghost planes directly from the buffers of the
+ *   PE, without any MPI message, and afterwards sets its own counter, so
+ *   that the PE may overwrite the buffers in the next exchange.  Neighbours
+ *   on other nodes are sent the same buffers with MPI_Isend and receive
+ *   into local buffers with MPI_Irecv.
+ *
+ *   The counters are read and written within a passive target epoch
+ *   (MPI_Win_lock_all) with MPI_Win_sync as memory barrier, as required for
+ *   the unified memory model of MPI-3 shared memory windows.
+ *
+ *   The buffers have the layout of exchange_v.c and exchange_s.c; the
+ *   buffer of a neighbour has the size of the own one, since neighbouring
+ *   sub grids have the same extent in the two other directions.
+ *  ----------------------------------------------------------------------*/
+
+#include <sched.h>
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/* header of the window of a PE in ints: counters and offsets of the buffers */
+#define HALO_SHM_HEAD 16
+#define HALO_SHM_READY 0  /* last exchange packed into the buffers */
+#define HALO_SHM_DONE 1   /* last exchange unpacked from the buffers of the neighbours */
+#define HALO_SHM_OFF 2    /* offsets of the REQUEST_COUNT buffers in floats */
+
+typedef struct {
+	MPI_Comm comm;
+	MPI_Win win;
+	volatile int *head;
+	/* headers of the PEs on the node which send the buffer m to this PE
+	   (src) or read the buffer m of this PE (dest), NULL for other nodes */
+	volatile int *src[REQUEST_COUNT], *dest[REQUEST_COUNT];
+	/* neighbours on other nodes, MPI_PROC_NULL otherwise */
+	int nbsrc[REQUEST_COUNT], nbdest[REQUEST_COUNT];
+	float ***send[REQUEST_COUNT], ***rec[REQUEST_COUNT];
+	int n1[REQUEST_COUNT], n2[REQUEST_COUNT], nf[REQUEST_COUNT];
+	MPI_Request req_send[REQUEST_COUNT], req_rec[REQUEST_COUNT];
+	int seq;
+} HaloShm;
+
+/* particle velocities (HALO_SHM_V) and stress (HALO_SHM_S) */
+static HaloShm shm[2];
+
+static const int dest_nb[REQUEST_COUNT] = {3, 4, 1, 2, 5, 6};
+static const int src_nb[REQUEST_COUNT] = {4, 3, 2, 1, 6, 5};
+
+
+/*
+ * Pointer tables t[1...n1][1...n2][1...nf] like those of f3tensor for the
+ * buffer at `data`, which is not copied.
+ */
+static float ***halo_shm_tensor(float *data, int n1, int n2, int nf)
+{
+	float ***t, **rows;
+	int i, j;
+
+	/* element 0 of the tables is not used */
+	t = (float ***) malloc((size_t) (n1 + 1) * sizeof(float **));
+	if (!t) err("allocation failure 1 in function halo_shm_tensor() ");
+	rows = (float **) malloc((size_t) (n1 * n2 + 1) * sizeof(float *));
+	if (!rows) err("allocation failure 2 in function halo_shm_tensor() ");
+
+	for (i = 1; i <= n1; i++) {
+		t[i] = rows + (size_t) (i - 1) * n2;
+		for (j = 1; j <= n2; j++)
+			t[i][j] = data + ((size_t) (i - 1) * n2 + j - 1) * nf - 1;
+	}
+	return t;
+}
+
+
+static void halo_shm_tensor_free(float ***t)
+{
+	free(t[1]);
+	free(t);
+}
+
+
+/*
+ * Wait until the counter of another PE has reached `seq`.  MPI is kept
+ * progressing for the messages to other nodes, and the processor is yielded
+ * now and then if there are more PEs than cores.
+ */
+static void halo_shm_poll(HaloShm *h, volatile int *counter, int seq)
+{
+	int n = 0, flag;
+
+	MPI_Win_sync(h->win);
+	while (counter[0] < seq) {
+		MPI_Testall(REQUEST_COUNT, h->req_rec, &flag, MPI_STATUSES_IGNORE);
+		MPI_Testall(REQUEST_COUNT, h->req_send, &flag, MPI_STATUSES_IGNORE);
+		if ((++n % 64) == 0) sched_yield();
+		MPI_Win_sync(h->win);
+	}
+}
+
+
+/*
+ * Allocate the shared buffers of the wavefield f (HALO_SHM_V or HALO_SHM_S)
+ * and find the neighbours on the same node.  The buffers towards the lower
+ * neighbours (top_to_bot, lef_to_rig, fro_to_bac) hold nf1, the others nf2
+ * values per grid point.  Collective over all PEs.
+ */
+void halo_shm_ini(int f, int nf1, int nf2)
+{
+	extern int NX, NY, NZ, MYID;
+
+	HaloShm *h = &shm[f];
+	MPI_Group world, node;
+	MPI_Info info;
+	MPI_Aint size;
+	float *base, *ptr;
+	long n;
+	int m, nb[7], rank[2], noderank[2], disp_unit;
+
+	MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, MYID, MPI_INFO_NULL, &h->comm);
+
+	n = 0;
+	for (m = 0; m < REQUEST_COUNT; m++) {
+		h->n1[m] = (m < 2) ? NX : NY;
+		h->n2[m] = (m < 4) ? NZ : NX;
+		h->nf[m] = (m % 2) ? nf2 : nf1;
+		n += (long) h->n1[m] * h->n2[m] * h->nf[m];
+	}
+
+	/* each PE's part of the window in its own memory (first touch) */
+	MPI_Info_create(&info);
+	MPI_Info_set(info, "alloc_shared_noncontig", "true");
+	size = (MPI_Aint) (HALO_SHM_HEAD * sizeof(int) + n * sizeof(float));
+	MPI_Win_allocate_shared(size, sizeof(float), info, h->comm, &base, &h->win);
+	MPI_Info_free(&info);
+
+	h->head = (volatile int *) base;
+	n = HALO_SHM_HEAD * sizeof(int) / sizeof(float);
+	for (m = 0; m < REQUEST_COUNT; m++) {
+		h->head[HALO_SHM_OFF + m] = (int) n;
+		h->send[m] = halo_shm_tensor(base + n, h->n1[m], h->n2[m], h->nf[m]);
+		n += (long) h->n1[m] * h->n2[m] * h->nf[m];
+	}
+	h->head[HALO_SHM_READY] = h->head[HALO_SHM_DONE] = h->seq = 0;
+
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, h->win);
+	MPI_Win_sync(h->win);
+	MPI_Barrier(h->comm);
+	MPI_Win_sync(h->win);
+
+	halo_neighbours(nb);
+	MPI_Comm_group(MPI_COMM_WORLD, &world);
+	MPI_Comm_group(h->comm, &node);
+
+	for (m = 0; m < REQUEST_COUNT; m++) {
+		rank[0] = nb[src_nb[m]];
+		rank[1] = nb[dest_nb[m]];
+		noderank[0] = noderank[1] = MPI_UNDEFINED;
+		if (rank[0] != MPI_PROC_NULL) MPI_Group_translate_ranks(world, 1, &rank[0], node, &noderank[0]);
+		if (rank[1] != MPI_PROC_NULL) MPI_Group_translate_ranks(world, 1, &rank[1], node, &noderank[1]);
+
+		h->src[m] = NULL;
+		h->nbsrc[m] = MPI_PROC_NULL;
+		h->rec[m] = NULL;
+		if (noderank[0] != MPI_UNDEFINED) {
+			/* read the ghost planes from the buffer of the neighbour */
+			MPI_Win_shared_query(h->win, noderank[0], &size, &disp_unit, &ptr);
+			h->src[m] = (volatile int *) ptr;
+			h->rec[m] = halo_shm_tensor(ptr + h->src[m][HALO_SHM_OFF + m], h->n1[m], h->n2[m], h->nf[m]);
+		} else if (rank[0] != MPI_PROC_NULL) {
+			h->nbsrc[m] = rank[0];
+			h->rec[m] = f3tensor(1, h->n1[m], 1, h->n2[m], 1, h->nf[m]);
+		}
+
+		h->dest[m] = NULL;
+		h->nbdest[m] = MPI_PROC_NULL;
+		if (noderank[1] != MPI_UNDEFINED) {
+			MPI_Win_shared_query(h->win, noderank[1], &size, &disp_unit, &ptr);
+			h->dest[m] = (volatile int *) ptr;
+		} else
+			h->nbdest[m] = rank[1];
+
+		h->req_send[m] = h->req_rec[m] = MPI_REQUEST_NULL;
+	}
+
+	MPI_Group_free(&world);
+	MPI_Group_free(&node);
+}
+
+
+/*
+ * Start an exchange of the wavefield f: wait until the neighbours on the
+ * node have read the previous one and post the receives from other nodes.
+ * On return send[m] are the buffers to be packed and rec[m] those to be
+ * unpacked after `halo_shm_wait` (NULL at the edges of the global grid).
+ */
+void halo_shm_begin(int f, float ****send, float ****rec)
+{
+	extern const int TAG1, TAG2, TAG3, TAG4, TAG5, TAG6;
+
+	HaloShm *h = &shm[f];
+	const int tag[REQUEST_COUNT] = {TAG5, TAG6, TAG1, TAG2, TAG3, TAG4};
+	int m;
+
+	h->seq++;
+	for (m = 0; m < REQUEST_COUNT; m++)
+		if (h->dest[m]) halo_shm_poll(h, h->dest[m] + HALO_SHM_DONE, h->seq - 1);
+
+	for (m = 0; m < REQUEST_COUNT; m++) {
+		if (h->nbsrc[m] != MPI_PROC_NULL)
+			MPI_Irecv(&h->rec[m][1][1][1], h->n1[m] * h->n2[m] * h->nf[m], MPI_FLOAT,
+				h->nbsrc[m], tag[m], MPI_COMM_WORLD, &h->req_rec[m]);
+		send[m] = h->send[m];
+		rec[m] = h->rec[m];
+	}
+}
+
+
+/*
+ * Publish the packed buffers of the wavefield f to the neighbours on the
+ * node and send them to the neighbours on other nodes.
+ */
+void halo_shm_post(int f)
+{
+	extern const int TAG1, TAG2, TAG3, TAG4, TAG5, TAG6;
+
+	HaloShm *h = &shm[f];
+	const int tag[REQUEST_COUNT] = {TAG5, TAG6, TAG1, TAG2, TAG3, TAG4};
+	int m;
+
+	/* the buffers are written before the counter */
+	MPI_Win_sync(h->win);
+	h->head[HALO_SHM_READY] = h->seq;
+	MPI_Win_sync(h->win);
+
+	for (m = 0; m < REQUEST_COUNT; m++)
+		if (h->nbdest[m] != MPI_PROC_NULL)
+			MPI_Isend(&h->send[m][1][1][1], h->n1[m] * h->n2[m] * h->nf[m], MPI_FLOAT,
+				h->nbdest[m], tag[m], MPI_COMM_WORLD, &h->req_send[m]);
+}
+
+
+/*
+ * Wait until the buffers rec[m] of `halo_shm_begin` hold the ghost planes.
+ */
+void halo_shm_wait(int f)
+{
+	HaloShm *h = &shm[f];
+	int m;
+
+	for (m = 0; m < REQUEST_COUNT; m++)
+		if (h->src[m]) halo_shm_poll(h, h->src[m] + HALO_SHM_READY, h->seq);
+	MPI_Waitall(REQUEST_COUNT, h->req_rec, MPI_STATUSES_IGNORE);
+}
+
+
+/*
+ * Complete an exchange of the wavefield f after unpacking: release the
+ * buffers of the neighbours on the node and wait for the sends.
+ */
+void halo_shm_end(int f)
+{
+	HaloShm *h = &shm[f];
+
+	/* the buffers are read before the counter */
+	MPI_Win_sync(h->win);
+	h->head[HALO_SHM_DONE] = h->seq;
+	MPI_Win_sync(h->win);
+
+	MPI_Waitall(REQUEST_COUNT, h->req_send, MPI_STATUSES_IGNORE);
+}
+
+
+/*
+ * Release the shared buffers of the wavefield f.  Collective over all PEs.
+ */
+void halo_shm_free(int f)
+{
+	HaloShm *h = &shm[f];
+	int m;
+
+	/* the neighbours may still read the buffers of the last exchange */
+	MPI_Barrier(h->comm);
+
+	for (m = 0; m < REQUEST_COUNT; m++) {
+		halo_shm_tensor_free(h->send[m]);
+		if (h->src[m])
+			halo_shm_tensor_free(h->rec[m]);
+		else if (h->rec[m])
+			free_f3tensor(h->rec[m], 1, h->n1[m], 1, h->n2[m], 1, h->nf[m]);
+	}
+
+	MPI_Win_unlock_all(h->win);
+	MPI_Win_free(&h->win);
+	MPI_Comm_free(&h->comm);
+}
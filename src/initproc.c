@@ -1,7 +1,13 @@
 /* ----------------------------------------------------------------------
  * This is function initproc.
    Dividing the 3-D FD grid into domains and assigning the
-   PEs to these domains,
+   PEs to these domains (see decomp.c), 
+   recpos holds the global positions of the ntr receivers,
+   which are weighted by the cost-weighted decomposition (DECOMP=1).
+   The processor locations and the neighbours are taken from a
+   Cartesian communicator, which MPI may reorder to place neighbouring
+   domains on the same node; all communication uses the ranks of these
+   PEs in MPI_COMM_WORLD.
    
 ----------------------------------------------------------------------*/
 
@@ -9,31 +15,59 @@
 #include "globvar.h"
 
 
-void initproc(void)	{
+void initproc(int **recpos, int ntr)	{
 
 	extern int NX, NY, NZ, IENDX, IENDY, IENDZ, POS[4], INDEX[7];
-	extern int NP, NPROC, NPROCX, NPROCY, NPROCZ, MYID;
+	extern int NP, NPROC, NPROCX, NPROCY, NPROCZ, MYID, DECOMP, SNAP, SNAP_MPIIO;
 	extern FILE *FP;
 
+	int dims[3], periods[3] = {1, 1, 1}, coords[3], rank, cart[6];
+	MPI_Comm comm_cart;
+	MPI_Group group_cart, group_world;
+
+	/* automatic process grid if NPROCX, NPROCY or NPROCZ is 0 */
+	const int procgrid = (NPROCX == 0) || (NPROCY == 0) || (NPROCZ == 0);
+	if (procgrid)
+		decomp_procgrid();
+
 	if ((NPROC != NP)  && (MYID==0)) {
 		fprintf(FP,"You specified NPROC =  %d (in parameter file) and NP = %d (command line) \n",NPROC,NP);
 		err("NP and NPROC differ!");
 	}
+	if ((NPROCX>NPROCX_MAX)||(NPROCY>NPROCY_MAX)||(NPROCZ>NPROCZ_MAX))
+		err(" initproc.c: constant expression NPROC?_MAX < NPROC? ");
+
+	/*---------------   POS indicates the processor location in the 3D logical processor array	---------*/
+	/* x varies fastest, then y and z as in the rank order without reordering */
+	dims[0] = NPROCZ;
+	dims[1] = NPROCY;
+	dims[2] = NPROCX;
+	MPI_Cart_create(MPI_COMM_WORLD, 3, dims, periods, 1, &comm_cart);
+	MPI_Comm_rank(comm_cart, &rank);
+	MPI_Cart_coords(comm_cart, rank, 3, coords);
+	POS[1] = coords[2];	/*  x coordinate */
+	POS[2] = coords[1];	/*  y coordinate */
+	POS[3] = coords[0];	/*  z coordinate */
 
+	if (DECOMP) decomp_weighted(recpos,ntr);
+	else {
+		if ((NX % NPROCX) > 0)
+			err("NX % NPROCX must be zero!");
+		if ((NY % NPROCY) > 0)
+			err("NY % NPROCY must be zero!");
+		if ((NZ % NPROCZ) > 0)
+			err("NZ % NPROCZ must be zero!");
+		decomp_uniform();
+	}
 
 	// Determine the length of the subarray on this processor.
-	IENDX = NX / NPROCX;
-	IENDY = NY / NPROCY;
-	IENDZ = NZ / NPROCZ;
-
-	/* POS(1) indicates x POSition of the processor in the 
-		     logical 3D processor array*/
-	if ((NX % NPROCX) > 0)
-		err("NX % NPROCX must be zero!");
-	if ((NY % NPROCY) > 0)
-		err("NY % NPROCY must be zero!");
-	if ((NZ % NPROCZ) > 0)
-		err("NZ % NPROCZ must be zero!");
+	IENDX = SLABX[POS[1]+1]-SLABX[POS[1]];
+	IENDY = SLABY[POS[2]+1]-SLABY[POS[2]];
+	IENDZ = SLABZ[POS[3]+1]-SLABZ[POS[3]];
+
+	/* snapmerge needs the process grid and the slabs */
+	if ((DECOMP || procgrid) && SNAP && !SNAP_MPIIO && (MYID==0))
+		decomp_write();
 
 	MPI_Barrier(MPI_COMM_WORLD);
 	if (MYID==0){
@@ -49,23 +83,16 @@ void initproc(void)	{
 	MPI_Barrier(MPI_COMM_WORLD);
 
 	/*---------------   index is indicating neighbouring processes	--------------------*/
-	INDEX[1]=MYID-1;  		 /* left	*/
-	INDEX[2]=MYID+1;  		 /* right	*/
-	INDEX[3]=MYID-NPROCX;  		 /* upper	*/
-	INDEX[4]=MYID+NPROCX;  		 /* lower	*/
-	INDEX[5]=MYID-NPROCX*NPROCY;  	 /* fronT	*/
-	INDEX[6]=MYID+NPROCX*NPROCY;  	 /* back	*/
-	/*---------------   POS indicates the processor location in the 3D logical processor array	---------*/
-	POS[1] = MYID % NPROCX;			/*  x coordinate */
-	POS[3] = (MYID/(NPROCX*NPROCY)); 	/*  y coordinate */
-	POS[2] = ( (MYID-(NPROCX*NPROCY)*POS[3]) / NPROCX ); 	/* z coordinate */
-
-	if (POS[1] == 0)        INDEX[1]=INDEX[1] + NPROCX;        	  
-	if (POS[1] == NPROCX-1) INDEX[2]=INDEX[2] - NPROCX;          	 
-	if (POS[3] == 0)        INDEX[5]=NPROC-(NPROCX*NPROCY)+MYID;	 
-	if (POS[3] == NPROCZ-1) INDEX[6]=MYID-NPROC+(NPROCX*NPROCY); 	 
-	if (POS[2] == 0)        INDEX[3]=(NPROCX*NPROCY)+MYID-NPROCX; 	 
-	if (POS[2] == NPROCY-1) INDEX[4]=MYID+NPROCX-(NPROCX*NPROCY);	 
+	/* periodic in all directions, the exchange routines skip the edges of the global grid */
+	MPI_Cart_shift(comm_cart, 2, 1, &cart[0], &cart[1]);	/* left, right	*/
+	MPI_Cart_shift(comm_cart, 1, 1, &cart[2], &cart[3]);	/* upper, lower	*/
+	MPI_Cart_shift(comm_cart, 0, 1, &cart[4], &cart[5]);	/* front, back	*/
+	MPI_Comm_group(comm_cart, &group_cart);
+	MPI_Comm_group(MPI_COMM_WORLD, &group_world);
+	MPI_Group_translate_ranks(group_cart, 6, cart, group_world, &INDEX[1]);
+	MPI_Group_free(&group_cart);
+	MPI_Group_free(&group_world);
+	MPI_Comm_free(&comm_cart);
 
 	fprintf(FP,"\n");
 	fprintf(FP," **Message from initprocs (written by PE %d):\n",MYID);
@@ -73,5 +100,7 @@ void initproc(void)	{
 	fprintf(FP," MYID \t POS(1):left,right \t POS(3): front, back \t POS(2): top, bottom\n");
 	fprintf(FP," %d \t\t %d: %d,%d \t\t %d: %d,%d \t\t %d: %d,%d \n",
 	    MYID,POS[1],INDEX[1],INDEX[2],POS[3],INDEX[5],INDEX[6],POS[2], INDEX[3],INDEX[4]);
+	if (DECOMP) fprintf(FP," Size of the subarray in gridpoints: IENDX = %d, IENDY (vertical) = %d, IENDZ = %d\n",
+	    IENDX,IENDY,IENDZ);
 	MPI_Barrier(MPI_COMM_WORLD);
 }
@@ -12,7 +12,7 @@
 int initsour(int nxs,int nys, int  nzs, int *nxsl,int *nysl, int  *nzsl )
 {
 
-	extern  int	IENDX, IENDY, IENDZ;
+	extern  int	NPROCX, NPROCY, NPROCZ;
 	extern  int   MYID, POS[4];
 	extern float PLANE_WAVE_DEPTH;
 	extern FILE *FP;
@@ -22,13 +22,14 @@ int initsour(int nxs,int nys, int  nzs, int *nxsl,int *nysl, int  *nzsl )
 	/* init of the source coordinates and using nsps as root processor*/
 	npsp = -1;
 
-	if ((POS[1]==((nxs-1)/IENDX)) && (POS[2]==((nys-1)/IENDY)) && (POS[3]==((nzs-1)/IENDZ)))
+	if ((POS[1]==decomp_owner(SLABX,NPROCX,nxs)) && (POS[2]==decomp_owner(SLABY,NPROCY,nys))
+			&& (POS[3]==decomp_owner(SLABZ,NPROCZ,nzs)))
 		npsp = MYID;
 		
 	if (npsp == MYID){
-		*nxsl=(nxs)-POS[1]*IENDX;
-		*nysl=(nys)-POS[2]*IENDY;
-		*nzsl=(nzs)-POS[3]*IENDZ;
+		*nxsl=(nxs)-SLABX[POS[1]];
+		*nysl=(nys)-SLABY[POS[2]];
+		*nzsl=(nzs)-SLABZ[POS[3]];
 		if (PLANE_WAVE_DEPTH <= 0.0) {
 			fprintf(FP,"\n **Message from initsource (printed by PE %d):\n",MYID);
 			fprintf(FP," PE which includes source (npsp) is me.\n");
@@ -133,14 +133,14 @@ void madinput(char header[], float *** DEN ){
 
 		tempRho=readdsk(ioh_file, format);
 
-		if ((POS[1]==((i-1)/NX)) 
-			&& (POS[2]==((j-1)/NY)) 
-			&& (POS[3]==((k-1)/NZ)))
+		if ((i>SLABX[POS[1]]) && (i<=SLABX[POS[1]+1]) 
+			&& (j>SLABY[POS[2]]) && (j<=SLABY[POS[2]+1]) 
+			&& (k>SLABZ[POS[3]]) && (k<=SLABZ[POS[3]+1]))
 		{
 		    if (tempRho!=5000) fprintf(FP,"\n New in %g Nx %d Ny %d Nz %d Nxg %d Nyg %d Nzg %d",tempRho,NX,NY,NZ,POS[1], POS[2], POS[3]);
-		    ii=i-POS[1]*NX;
-		    jj=j-POS[2]*NY;
-		    kk=k-POS[3]*NZ;
+		    ii=i-SLABX[POS[1]];
+		    jj=j-SLABY[POS[2]];
+		    kk=k-SLABZ[POS[3]];
 		    DEN[jj][ii][kk]=tempRho;
 		}
 	    }
@@ -5,68 +5,100 @@ void init_velocity(
         Velocity *v,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
 
-    v->x = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    v->y = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    v->z = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
+    v->x = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    v->y = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    v->z = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
 }
 
 void free_velocity(
         Velocity *v,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
 
-    free_f3tensor(v->x, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(v->y, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(v->z, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(v->x, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(v->y, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(v->z, nrl, nrh, ncl, nch, ndl, ndh);
 }
 
 void init_tensor3d(
         Tensor3d *t,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
 
-    t->xy = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    t->yz = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    t->xz = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    t->xx = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    t->yy = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    t->zz = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
+    t->xy = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    t->yz = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    t->xz = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    t->xx = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    t->yy = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    t->zz = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
 }
 
 void free_tensor3d(
         Tensor3d *t,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
 
-    free_f3tensor(t->xy, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(t->yz, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(t->xz, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(t->xx, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(t->yy, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(t->zz, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(t->xy, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(t->yz, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(t->xz, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(t->xx, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(t->yy, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(t->zz, nrl, nrh, ncl, nch, ndl, ndh);
+}
+
+void init_visco_par(
+        ViscoPar *vp,
+        int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
+
+    vp->fipjp = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->fjpkp = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->fipkp = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->g = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->f = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->dipjp = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->djpkp = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->dipkp = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->d = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    vp->e = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+}
+
+void free_visco_par(
+        ViscoPar *vp,
+        int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
+
+    free_f3tensor_aligned(vp->fipjp, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->fjpkp, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->fipkp, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->g, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->f, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->dipjp, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->djpkp, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->dipkp, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->d, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(vp->e, nrl, nrh, ncl, nch, ndl, ndh);
 }
 
 void init_velocity_derivatives_tensor(
         VelocityDerivativesTensor *dv,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
 
-    dv->xyyx = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    dv->yzzy = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    dv->xzzx = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    dv->yyzz = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    dv->xxzz = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    dv->xxyy = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    dv->xxyyzz = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
+    dv->xyyx = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    dv->yzzy = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    dv->xzzx = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    dv->yyzz = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    dv->xxzz = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    dv->xxyy = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    dv->xxyyzz = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
 }
 
 void free_velocity_derivatives_tensor(
         VelocityDerivativesTensor *dv,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
 
-    free_f3tensor(dv->xyyx, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(dv->yzzy, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(dv->xzzx, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(dv->yyzz, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(dv->xxzz, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(dv->xxyy, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(dv->xxyyzz, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(dv->xyyx, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(dv->yzzy, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(dv->xzzx, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(dv->yyzz, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(dv->xxzz, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(dv->xxyy, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(dv->xxyyzz, nrl, nrh, ncl, nch, ndl, ndh);
 }
 
 void init_stress_derivatives_wrt_velocity(
@@ -74,16 +106,16 @@ void init_stress_derivatives_wrt_velocity(
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
 
 
-    ds_dv->x = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    ds_dv->y = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
-    ds_dv->z = f3tensor(nrl, nrh, ncl, nch, ndl, ndh);
+    ds_dv->x = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    ds_dv->y = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
+    ds_dv->z = f3tensor_aligned(nrl, nrh, ncl, nch, ndl, ndh);
 }
 
 void free_stress_derivatives_wrt_velocity(
         StressDerivativesWrtVelocity *ds_dv,
         int nrl, int nrh, int ncl, int nch, int ndl, int ndh) {
 
-    free_f3tensor(ds_dv->x, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(ds_dv->y, nrl, nrh, ncl, nch, ndl, ndh);
-    free_f3tensor(ds_dv->z, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(ds_dv->x, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(ds_dv->y, nrl, nrh, ncl, nch, ndl, ndh);
+    free_f3tensor_aligned(ds_dv->z, nrl, nrh, ncl, nch, ndl, ndh);
 }
@@ -13,13 +13,11 @@ void merge(int nsnap, int type)
 {
     extern char SNAP_FILE[STRING_SIZE];
     extern int NXG, NYG, SNAP_FORMAT, NPROCX, NPROCY, NPROCZ;
-    extern int NX, NY, NZ, IDX, IDY, IDZ;
     extern FILE *FP;
 
-    char file[STRING_SIZE], mfile[STRING_SIZE], outfile[STRING_SIZE], ext[10];
+    char file[STRING_SIZE], mfile[STRING_SIZE], outfile[STRING_SIZE], ext[10], qext[10];
     FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], *fpout;
-    int i, j, k, ip, jp, kp, n;
-    float a;
+    int ip, jp, kp, format_out;
 
     if ((NPROCX > NPROCX_MAX) || (NPROCY > NPROCY_MAX) || (NPROCZ > NPROCZ_MAX))
         err(" merge.c: constant expression NPROC?_MAX < NPROC? ");
@@ -34,32 +32,35 @@ void merge(int nsnap, int type)
         case 3:
             sprintf(ext, ".bin");
             break;
+        case 6:
+            sprintf(ext, ".cmp");
+            break;
     }
 
     switch (type) {
         case 1:
             fprintf(FP, "x-component of particle velocity");
-            strcat(ext, ".vx");
+            sprintf(qext, ".vx");
             break;
         case 2:
             fprintf(FP, "y-component of particle velocity");
-            strcat(ext, ".vy");
+            sprintf(qext, ".vy");
             break;
         case 3:
             fprintf(FP, "z-component of particle velocity");
-            strcat(ext, ".vz");
+            sprintf(qext, ".vz");
             break;
         case 4:
             fprintf(FP, "P-wave energyfield");
-            strcat(ext, ".div");
+            sprintf(qext, ".div");
             break;
         case 5:
             fprintf(FP, "S-wave energyfield");
-            strcat(ext, ".curl");
+            sprintf(qext, ".curl");
             break;
         case 6:
             fprintf(FP, "pressure");
-            strcat(ext, ".p");
+            sprintf(qext, ".p");
             break;
         default:
             err("[%s] Incorrect type of the snapshot quantity"
@@ -67,10 +68,14 @@ void merge(int nsnap, int type)
             break;
     }
 
-    sprintf(mfile, "%s%s", SNAP_FILE, ext);
+    sprintf(mfile, "%s%s%s", SNAP_FILE, ext, qext);
     fprintf(FP, " (files: %s.x.y.z).\n", mfile);
 
-    sprintf(outfile, "%s%s", SNAP_FILE, ext);
+    /* compressed snapshots are merged to a binary file */
+    format_out = (SNAP_FORMAT == FILE_FORMAT_COMPRESSED) ? FILE_FORMAT_BINARY : SNAP_FORMAT;
+    if (format_out != SNAP_FORMAT)
+        sprintf(ext, ".bin");
+    sprintf(outfile, "%s%s%s", SNAP_FILE, ext, qext);
     fprintf(FP, "Writing merged snapshot file to %s\n", outfile);
     fpout = fopen(outfile, "w");
 
@@ -90,17 +95,7 @@ void merge(int nsnap, int type)
     fprintf(FP, " ... finished. \n");
 
     fprintf(FP, " Copying...");
-    for (n = 0; n < nsnap; n++)
-        for (kp = 0; kp <= NPROCZ - 1; kp++)
-            for (k = 1; k <= NZ; k += IDZ)
-                for (ip = 0; ip <= NPROCX - 1; ip++)
-                    for (i = 1; i <= NX; i += IDX)
-                        for (jp = 0; jp <= NPROCY - 1; jp++)
-                            for (j = 1; j <= NY; j += IDY)
-                            {
-                                a = readdsk(fp[jp][ip][kp], SNAP_FORMAT);
-                                writedsk(fpout, a, SNAP_FORMAT);
-                            }
+    merge_planes(fp, fpout, nsnap, SNAP_FORMAT, format_out);
     fprintf(FP, " ... finished. \n");
 
     for (kp = 0; kp <= NPROCZ - 1; kp++)
@@ -111,7 +106,7 @@ void merge(int nsnap, int type)
 
     fclose(fpout);
 
-    if (SNAP_FORMAT == FILE_FORMAT_BINARY) {
+    if (format_out == FILE_FORMAT_BINARY) {
         fprintf(FP, "Use command:\n");
         fprintf(FP, "xmovie n1=%d n2=%d < %s loop=1 label1=Y label2=X\n",
                 ((NYG - 1) / IDY) + 1, ((NXG - 1) / IDY) + 1, outfile);
@@ -119,3 +114,56 @@ void merge(int nsnap, int type)
         fprintf(FP, "=====================================================\n");
     }
 }
+
+/*
+ * Copy `nsnap` snapshots (or one model) from the files fp[jp][ip][kp]
+ * written by the PEs (see `snap` and `writemod`) to `fpout` in the order of
+ * the global grid.  For each grid plane k of a row of PEs in x, the PEs'
+ * parts of the plane are read and interleaved in memory, and the merged
+ * part of the global plane is written with one call.  The files of the PEs
+ * are read in format_in and the merged file is written in format_out, so
+ * that compressed files (format 6) are decompressed on the fly.  The sizes
+ * of the parts follow from the slabs of the PEs (SLABX, SLABY, SLABZ, see
+ * decomp.c).
+ */
+void merge_planes(FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], FILE *fpout,
+        int nsnap, int format_in, int format_out)
+{
+    extern int IDX, IDY, IDZ, NPROCX, NPROCY, NPROCZ;
+
+    /* number of values of the PEs in each direction, first value in y */
+    int nx[NPROCX_MAX], ny[NPROCY_MAX], nz[NPROCZ_MAX], y0[NPROCY_MAX];
+    float *in, *out;
+    int i, k, ip, jp, kp, n, nxmax = 0, nymax = 0, nyg = 0;
+
+    for (ip = 0; ip <= NPROCX - 1; ip++) {
+        nx[ip] = (SLABX[ip + 1] - SLABX[ip] - 1) / IDX + 1;
+        nxmax = max(nxmax, nx[ip]);
+    }
+    for (jp = 0; jp <= NPROCY - 1; jp++) {
+        ny[jp] = (SLABY[jp + 1] - SLABY[jp] - 1) / IDY + 1;
+        y0[jp] = nyg;
+        nyg += ny[jp];
+        nymax = max(nymax, ny[jp]);
+    }
+    for (kp = 0; kp <= NPROCZ - 1; kp++)
+        nz[kp] = (SLABZ[kp + 1] - SLABZ[kp] - 1) / IDZ + 1;
+
+    in = vector(0, nxmax * nymax - 1);
+    out = vector(0, nxmax * nyg - 1);
+
+    for (n = 0; n < nsnap; n++)
+        for (kp = 0; kp <= NPROCZ - 1; kp++)
+            for (k = 0; k < nz[kp]; k++)
+                for (ip = 0; ip <= NPROCX - 1; ip++) {
+                    for (jp = 0; jp <= NPROCY - 1; jp++) {
+                        readdsk_block(fp[jp][ip][kp], in, nx[ip] * ny[jp], format_in);
+                        for (i = 0; i < nx[ip]; i++)
+                            memcpy(out + i * nyg + y0[jp], in + i * ny[jp], ny[jp] * sizeof(float));
+                    }
+                    writedsk_block(fpout, out, nx[ip] * nyg, format_out);
+                }
+
+    free_vector(in, 0, nxmax * nymax - 1);
+    free_vector(out, 0, nxmax * nyg - 1);
+}
@@ -13,14 +13,13 @@ void mergemod(char modfile[STRING_SIZE], int format){
 
 
 	extern int NXG, NYG, MYID, NPROCX, NPROCY, NPROCZ;
-	extern int NX, NY, NZ, NPROC, IDX, IDY, IDZ;
+	extern int NPROC, IDX, IDY, MODEL_COMPRESS;
 	extern FILE *FP;
 
 
 	char file[STRING_SIZE];
 	FILE *fp[NPROCY_MAX][NPROCX_MAX][NPROCZ_MAX], *fpout;
-	int i, j, k, ip, jp, kp;
-	float a;
+	int ip, jp, kp;
 
 
 	if ((NPROCX>NPROCX_MAX)||(NPROCY>NPROCY_MAX)||(NPROCZ>NPROCZ_MAX))
@@ -48,15 +47,8 @@ void mergemod(char modfile[STRING_SIZE], int format){
 
 	fprintf(FP," Copying...");
 
-	for (kp=0;kp<=NPROCZ-1; kp++)
-		for (k=1;k<=NZ;k+=IDZ)
-			for (ip=0;ip<=NPROCX-1; ip++)
-				for (i=1;i<=NX;i+=IDX)
-					for (jp=0;jp<=NPROCY-1; jp++)
-						for (j=1;j<=NY;j+=IDY){
-							a=readdsk(fp[jp][ip][kp],format);
-							writedsk(fpout,a,format);
-						}
+	/* the files of the PEs are compressed by writemod */
+	merge_planes(fp, fpout, 1, (MODEL_COMPRESS && (format == 3)) ? 6 : format, format);
 
 	fprintf(FP," ... finished. \n");
 
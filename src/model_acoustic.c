@@ -11,7 +11,7 @@ void model_acoustic(float  ***  rho, float ***  pi){
 	/*--------------------------------------------------------------------------*/
 	/* extern variables */
 
-	extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], MYID;
+	extern int NXG, NYG, NZG, POS[4], MYID;
 	extern char  MFILE[STRING_SIZE];
 	extern int WRITE_MODELFILES;
 
@@ -47,12 +47,12 @@ void model_acoustic(float  ***  rho, float ***  pi){
 
 				/* only the PE which belongs to the current global gridpoint 
 				  is saving model parameters in his local arrays */
-				if ((POS[1]==((i-1)/NX)) && 
-						(POS[2]==((j-1)/NY)) &&
-						(POS[3]==((k-1)/NZ))){
-					ii=i-POS[1]*NX;
-					jj=j-POS[2]*NY;
-					kk=k-POS[3]*NZ;
+				if ((i>SLABX[POS[1]]) && (i<=SLABX[POS[1]+1]) && 
+						(j>SLABY[POS[2]]) && (j<=SLABY[POS[2]+1]) &&
+						(k>SLABZ[POS[3]]) && (k<=SLABZ[POS[3]+1])){
+					ii=i-SLABX[POS[1]];
+					jj=j-SLABY[POS[2]];
+					kk=k-SLABZ[POS[3]];
 
 					rho[jj][ii][kk]=Rhov;
 					pi[jj][ii][kk]=piv;
@@ -182,13 +182,13 @@ void model_elastic(float ***rho, float ***pi, float ***u,
                     /* only the PE which belongs to the current global gridpoint
                      * is saving model parameters in his local arrays */
 
-                    if ((POS[1] == ((i - 1) / NX)) &&
-                        (POS[2] == ((j - 1) / NY)) &&
-                        (POS[3] == ((k - 1) / NZ)))
+                    if ((i > SLABX[POS[1]]) && (i <= SLABX[POS[1] + 1]) &&
+                        (j > SLABY[POS[2]]) && (j <= SLABY[POS[2] + 1]) &&
+                        (k > SLABZ[POS[3]]) && (k <= SLABZ[POS[3] + 1]))
                     {
-                        ii = i - POS[1] * NX;
-                        jj = j - POS[2] * NY;
-                        kk = k - POS[3] * NZ;
+                        ii = i - SLABX[POS[1]];
+                        jj = j - SLABY[POS[2]];
+                        kk = k - SLABZ[POS[3]];
 
                         // leftovers from isotropic case -- necessary for PML
                         u[jj][ii][kk] = muv;
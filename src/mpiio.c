@@ -0,0 +1,155 @@
+/*------------------------------------------------------------------------
+ *   Collective MPI-IO of the local subdomains in global binary files.
+ *
+ *   The global model files hold NXG*NYG*NZG floats with y running fastest
+ *   and z slowest, i.e. the value at the global grid point (i, j, k) is at
+ *   position ((k-1)*NXG + (i-1))*NYG + (j-1).  Instead of seeking every
+ *   column of its subdomain, each PE sets a subarray view of its block on
+ *   the file and all PEs read their blocks in one collective call, so that
+ *   the MPI library can merge the requests into few large reads.
+ *
+ *   Snapshots (SNAP_MPIIO=1) are written the same way to global files with
+ *   the layout of the files merged by snapmerge: the grid decimated by IDX,
+ *   IDY and IDZ, one snapshot after the other.  The writes may be
+ *   nonblocking (SNAP_ASYNC=1, see snap_async.c).
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+
+
+/* subdomain of each PE in a global file of the grid decimated by idx, idy
+   and idz (the slabs of the PEs start at multiples of idx, idy, idz) */
+static MPI_Datatype mpiio_subarray(int idx, int idy, int idz)
+{
+    extern int NX, NY, NZ, NXG, NYG, NZG, POS[4];
+    extern int SLABX[], SLABY[], SLABZ[];
+
+    int gsizes[3] = {(NZG - 1) / idz + 1, (NXG - 1) / idx + 1, (NYG - 1) / idy + 1};
+    int lsizes[3] = {(NZ - 1) / idz + 1, (NX - 1) / idx + 1, (NY - 1) / idy + 1};
+    int starts[3] = {SLABZ[POS[3]] / idz, SLABX[POS[1]] / idx, SLABY[POS[2]] / idy};
+    MPI_Datatype block;
+
+    MPI_Type_create_subarray(3, gsizes, lsizes, starts, MPI_ORDER_C, MPI_FLOAT, &block);
+    MPI_Type_commit(&block);
+    return block;
+}
+
+/**
+ * File view of the local subdomain of NX*NY*NZ grid points in a global file
+ * of NXG*NYG*NZG floats (see above).  The type must be freed with
+ * MPI_Type_free.
+ */
+MPI_Datatype mpiio_block_type(void)
+{
+    return mpiio_subarray(1, 1, 1);
+}
+
+/**
+ * Read the local subdomain from the global file `filename`.  Collective
+ * over MPI_COMM_WORLD.
+ *
+ * Returns a vector of NX*NY*NZ floats in the order of the file (index
+ * ((k-1)*NX + (i-1))*NY + (j-1) for the local grid point (i, j, k)), to be
+ * freed with `mpiio_free_block`, or NULL if the file cannot be opened.
+ */
+float *mpiio_read_block(const char *filename)
+{
+    extern int NX, NY, NZ;
+
+    const int n = NX * NY * NZ;
+    MPI_File fh;
+    MPI_Datatype block;
+    MPI_Status status;
+    float *buf;
+    int count;
+
+    if (MPI_File_open(MPI_COMM_WORLD, (char *) filename, MPI_MODE_RDONLY,
+                MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        return NULL;
+
+    block = mpiio_block_type();
+    MPI_File_set_view(fh, 0, MPI_FLOAT, block, "native", MPI_INFO_NULL);
+
+    buf = vector(0, n - 1);
+    MPI_File_read_all(fh, buf, n, MPI_FLOAT, &status);
+    MPI_Get_count(&status, MPI_FLOAT, &count);
+
+    MPI_File_close(&fh);
+    MPI_Type_free(&block);
+
+    if (count != n)
+        err("Could not read the subdomain from model file %s "
+            "(%d of %d values)!", filename, count, n);
+
+    return buf;
+}
+
+void mpiio_free_block(float *buf)
+{
+    extern int NX, NY, NZ;
+
+    if (buf != NULL)
+        free_vector(buf, 0, NX * NY * NZ - 1);
+}
+
+/**
+ * Start writing the snapshot number `nsnap` (starting with 1) of the local
+ * subdomain to the global file `filename`.  buf holds the n values of the
+ * grid points 1, 1+IDX, ... (likewise in y and z) in the order of `snap`.
+ * The file is truncated with the first snapshot.  Collective over
+ * MPI_COMM_WORLD.
+ *
+ * The file fh stays open until the request req is completed; then buf may
+ * be reused and fh must be closed with MPI_File_close.
+ */
+void mpiio_iwrite_snap(const char *filename, const float *buf, int n, int nsnap,
+        MPI_File *fh, MPI_Request *req)
+{
+    extern int NX, NY, NZ, NXG, NYG, NZG, IDX, IDY, IDZ;
+
+    const int nx = (NX - 1) / IDX + 1, ny = (NY - 1) / IDY + 1, nz = (NZ - 1) / IDZ + 1;
+    const MPI_Offset nglob = (MPI_Offset) ((NXG - 1) / IDX + 1) * ((NYG - 1) / IDY + 1)
+                           * ((NZG - 1) / IDZ + 1);
+    MPI_Datatype block;
+    MPI_Offset disp;
+
+    if (n != nx * ny * nz)
+        err("Snapshot of %d values does not fit the subdomain of %d x %d x %d values!",
+            n, nx, ny, nz);
+
+    if (MPI_File_open(MPI_COMM_WORLD, (char *) filename, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                MPI_INFO_NULL, fh) != MPI_SUCCESS)
+        err("Could not open snapshot file %s for writing!", filename);
+
+    if (nsnap == 1)
+        MPI_File_set_size(*fh, 0);
+
+    disp = (nsnap - 1) * nglob * (MPI_Offset) sizeof(float);
+    block = mpiio_subarray(IDX, IDY, IDZ);
+    MPI_File_set_view(*fh, disp, MPI_FLOAT, block, "native", MPI_INFO_NULL);
+    MPI_Type_free(&block);
+
+    MPI_File_iwrite_all(*fh, (void *) buf, n, MPI_FLOAT, req);
+}
+
+/**
+ * Write the snapshot like `mpiio_iwrite_snap`, but return after the data
+ * are written.
+ */
+void mpiio_write_snap(const char *filename, const float *buf, int n, int nsnap)
+{
+    MPI_File fh;
+    MPI_Request req;
+    MPI_Status status;
+    int count;
+
+    mpiio_iwrite_snap(filename, buf, n, nsnap, &fh, &req);
+    MPI_Wait(&req, &status);
+    MPI_Get_count(&status, MPI_FLOAT, &count);
+    MPI_File_close(&fh);
+
+    if (count != n)
+        err("Could not write the subdomain to snapshot file %s "
+            "(%d of %d values)!", filename, count, n);
+}
@@ -0,0 +1,134 @@
+/*------------------------------------------------------------------------
+ *   Write the seismograms of all PEs collectively to one file with MPI-IO
+ *   (SEIS_MPIIO=1)
+ *
+ *   Each PE encodes the trace headers and samples of its own receivers
+ *   like outseis_glob and writes them in one collective call.  The traces
+ *   have a fixed length, so that trace g (in the order of the receivers)
+ *   starts at byte
+ *
+ *       header + (g-1)*(240 + 4*ns)
+ *
+ *   with header=3600 for SEG-Y and 0 for SU (without the 240-byte trace
+ *   header for binary output).  PE 0 writes the SEG-Y file headers.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "globvar.h"
+
+
+void outseis_mpiio(FILE *fp, const char *file, float **section, int *recswitch,
+		int **recpos, int ntr_glob, float **srcpos, int nsrc, int ns,
+		int seis_form[6], int comp){
+
+	/* declaration of extern variables */
+	extern int NDT, NDTSHIFT, SOFI3DVERS, MYID;
+	extern int LITTLEBIG, IEEEIBM;
+	extern float DT;
+	extern char FILEINP[STRING_SIZE];
+
+	/* declaration of extern functions from rwsegy.c */
+	extern int DDN_wsegytxth(FILE * outstream, int asciiebcdic, char * kindofdata, char * infilename, int ns, float dt, int ndt);
+	extern int DDN_wsegybinh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int ns,
+			float dt, int ndt, int ntrpr, int nart);
+	extern int DDN_etraceh(char * hbuf, int lbendian, int ieeeibm, int meterfeet, int susegy,
+			int ns, float dt, float dtshift, float srctime, int traceno, int globrecno, int shotno,
+			int recno, int comp, int trid, int ntraces, int **recpos, int **recpos_loc, float ** srcpos,
+			int nsrc, float xcoo, float ycoo);
+	extern float * native2float(float * outdata, int len, int lbendian, int ieeeibm, int meterfeet);
+	extern int * swap4(int * ip);
+
+	/* declaration of local variables */
+	int i, j, g, ntr = 0, header, theader, tracebytes, count;
+	char kindofdata[STRING_SIZE], *buf;
+	float *data;
+	MPI_Aint *displ;
+	MPI_Datatype trace, traces;
+	MPI_File fh;
+	MPI_Status status;
+	FILE *fpdata;
+
+	switch (seis_form[0]){
+	case 0 : header=3600; theader=240; break; /* SEG-Y */
+	case 1 : header=0; theader=240; break;    /* SU */
+	case 3 : header=0; theader=0; break;      /* BINARY */
+	default :
+		err(" Seismograms are written with MPI-IO (SEIS_MPIIO=1) in SEG-Y, SU or binary format only ! ");
+		return;
+	}
+	tracebytes = theader + 4*ns;
+
+	/* PE 0 creates the file and writes the SEG-Y file headers */
+	if (MYID==0){
+		if ((fpdata=fopen(file,"w"))==NULL)
+			err(" Could not open seismogram file %s for writing ! ", file);
+		if (header){
+			strncpy(kindofdata,"synthetic seismograms modeled by SOFI3D",STRING_SIZE);
+			if (SOFI3DVERS==33)
+				strncat(kindofdata," (3D isotropic elastic)",STRING_SIZE-sizeof("synthetic seismograms modeled by SOFI3D"));
+			else if (SOFI3DVERS==32)
+				strncat(kindofdata," (3D isotropic acoustic)",STRING_SIZE-sizeof("synthetic seismograms modeled by SOFI3D"));
+			kindofdata[STRING_SIZE-1]='\0';
+
+			DDN_wsegytxth(fpdata, seis_form[1], kindofdata, FILEINP, ns, DT, NDT);
+			DDN_wsegybinh(fpdata, seis_form[2], seis_form[3], seis_form[4], ns, DT, NDT, ntr_glob, 0);
+		}
+		fclose(fpdata);
+	}
+	MPI_Barrier(MPI_COMM_WORLD);
+
+	/* encode the traces of the PE */
+	for (g=1;g<=ntr_glob;g++) if (recswitch[g]) ntr++;
+	buf = malloc((size_t) max(ntr,1) * tracebytes);
+	displ = malloc(max(ntr,1) * sizeof(MPI_Aint));
+	if ((buf==NULL) || (displ==NULL))
+		err(" Allocation of the seismogram output buffer failed ! ");
+
+	i = 0;
+	for (g=1;g<=ntr_glob;g++){
+		if (!recswitch[g]) continue;
+		displ[i] = (MPI_Aint) header + (MPI_Aint) (g-1) * tracebytes;
+		if (theader)
+			DDN_etraceh(buf + (size_t) i*tracebytes, seis_form[2], seis_form[3], seis_form[4], (seis_form[0]==0),
+					ns, DT*NDT, DT*NDTSHIFT, 0.0, g, recpos[4][g], nsrc,
+					g, comp, 1, ntr_glob, recpos, recpos, srcpos, nsrc, 0, 0);
+		data = (float *) (buf + (size_t) i*tracebytes + theader);
+		for (j=0;j<ns;j++) data[j] = section[i+1][j+1];
+
+		/* the sample conversions of outseis_glob */
+		if (theader)
+			native2float(data, ns, seis_form[2], seis_form[3], seis_form[4]);
+		else if (seis_form[3]==IEEEIBM){
+			if (seis_form[4]==1) for (j=0;j<ns;j++) data[j] = data[j]/0.3048; /* FEET */
+			if (seis_form[2]!=LITTLEBIG) for (j=0;j<ns;j++) swap4((int *) &data[j]);
+		}
+		else native2float(data, ns, seis_form[2], seis_form[3], seis_form[4]);
+		i++;
+	}
+
+	/* the traces of the PE at their positions in the file */
+	MPI_Type_contiguous(tracebytes, MPI_BYTE, &trace);
+	MPI_Type_commit(&trace);
+	MPI_Type_create_hindexed_block(ntr, 1, displ, trace, &traces);
+	MPI_Type_commit(&traces);
+
+	if (MPI_File_open(MPI_COMM_WORLD, (char *) file, MPI_MODE_WRONLY,
+				MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+		err(" Could not open seismogram file %s for writing ! ", file);
+	MPI_File_set_view(fh, 0, MPI_BYTE, traces, "native", MPI_INFO_NULL);
+	MPI_File_write_all(fh, buf, ntr, trace, &status);
+	MPI_Get_count(&status, trace, &count);
+	MPI_File_close(&fh);
+
+	if (count != ntr)
+		err(" Could not write %d seismogram traces to %s (%d written) ! ", ntr, file, count);
+
+	MPI_Type_free(&traces);
+	MPI_Type_free(&trace);
+	free(displ);
+	free(buf);
+
+	if (MYID==0)
+		fprintf(fp," (%d traces of %d bytes each).\n", ntr_glob, tracebytes);
+}
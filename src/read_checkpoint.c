@@ -6,7 +6,8 @@
 #include "globvar.h"
 
 
-static void read_value(float *dst, FILE *fp);
+static void read_points(FILE *fp, float ***a[], int nf, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2);
+static void read_field(FILE *fp, float ***a, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2);
 
 void read_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, Velocity *v,
                      Tensor3d *s,
@@ -16,13 +17,12 @@ void read_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, Veloc
                      float *** psi_vxx, float *** psi_vyx, float *** psi_vzx, float *** psi_vxy, float *** psi_vyy, float *** psi_vzy,
                      float *** psi_vxz, float *** psi_vyz, float *** psi_vzz) {
 
-	int i,j,k;
-	char myid[5];
+	int n;
+	char myid[12];
 	FILE *fp;
 	char checkptfile[STRING_SIZE];
-	extern int MYID;
 	extern int ABS_TYPE, NX,NY,NZ,FW,POS[4],NPROCX,NPROCY,NPROCZ,FREE_SURF;
-	extern int L;
+	extern int L, CHECKPT_COMPRESS;
 	extern char  CHECKPTFILE[STRING_SIZE];
         float ***vx = v->x;
         float ***vy = v->y;
@@ -42,8 +42,15 @@ void read_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, Veloc
         float ***ryz = r->yz;
         float ***rxz = r->xz;
 	
+	float ***fields[9] = {vx, vy, vz, sxx, syy, szz, sxy, syz, sxz};
+	float ***rfields[6] = {rxx, ryy, rzz, rxy, ryz, rxz};
+	float ***psix[6] = {psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_vxx, psi_vyx, psi_vzx};
+	float ***psiy[6] = {psi_sxy_y, psi_syy_y, psi_syz_y, psi_vxy, psi_vyy, psi_vzy};
+	float ***psiz[6] = {psi_sxz_z, psi_syz_z, psi_szz_z, psi_vxz, psi_vyz, psi_vzz};
+
 	sprintf(checkptfile,"%s",CHECKPTFILE);
-	sprintf(myid,".%d",MYID);
+	/* named by the subdomain, the ranks may be reordered */
+	sprintf(myid,".%d",checkpoint_pe());
 	strcat(checkptfile,myid);
 
 
@@ -53,155 +60,85 @@ void read_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, Veloc
 		err("CHECKPTFILE can't be opened !");
 	}
 
-	for (j=ny1; j<=ny2; j++) {
-		for (i=nx1; i<=nx2; i++) {
-			for (k=nz1; k<=nz2; k++) {
-				read_value(&vx[j][i][k], fp);
-				read_value(&vy[j][i][k], fp);
-				read_value(&vz[j][i][k], fp);
-
-				read_value(&sxx[j][i][k], fp);
-				read_value(&syy[j][i][k], fp);
-				read_value(&szz[j][i][k], fp);
-				read_value(&sxy[j][i][k], fp);
-				read_value(&syz[j][i][k], fp);
-				read_value(&sxz[j][i][k], fp);
-			}
-		}
-	}
-
-	
-    // Viscoelastic data.
-	if (L) {
-		for (j=1; j<=NY; j++) {
-			for (i=1; i<=NX; i++) {
-				for (k=1; k<=NZ; k++) {
-					read_value(&rxx[j][i][k], fp);
-					read_value(&ryy[j][i][k], fp);
-					read_value(&rzz[j][i][k], fp);
-					read_value(&rxy[j][i][k], fp);
-					read_value(&ryz[j][i][k], fp);
-					read_value(&rxz[j][i][k], fp);
-				}
+	/* compressed checkpoint written by save_checkpoint with CHECKPT_COMPRESS=1 */
+	if (CHECKPT_COMPRESS) {
+		for (n=0; n<9; n++) read_field(fp,fields[n],nx1,nx2,ny1,ny2,nz1,nz2);
+		if (L) for (n=0; n<6; n++) read_field(fp,rfields[n],1,NX,1,NY,1,NZ);
+		if (ABS_TYPE == 1) {
+			for (n=0; n<6; n++) {
+				if (POS[1]==0) read_field(fp,psix[n],1,FW,1,NY,1,NZ);
+				if (POS[1]==NPROCX-1) read_field(fp,psix[n],FW+1,2*FW,1,NY,1,NZ);
+				if (POS[2]==0 && FREE_SURF==0) read_field(fp,psiy[n],1,NX,1,FW,1,NZ);
+				if (POS[2]==NPROCY-1) read_field(fp,psiy[n],1,NX,FW+1,2*FW,1,NZ);
+				if (POS[3]==0) read_field(fp,psiz[n],1,NX,1,NY,1,FW);
+				if (POS[3]==NPROCZ-1) read_field(fp,psiz[n],1,NX,1,NY,FW+1,2*FW);
 			}
 		}
+		fclose(fp);
+		return;
 	}
-	
-	
-	
-	if (ABS_TYPE == 1) {
-		if (POS[1]==0) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=FW; i++) {
-					for (k=1; k<=NZ; k++) {
-						read_value(&psi_sxx_x[j][i][k], fp);
-						read_value(&psi_sxy_x[j][i][k], fp);
-						read_value(&psi_sxz_x[j][i][k], fp);
-
-						read_value(&psi_vxx[j][i][k], fp);
-						read_value(&psi_vyx[j][i][k], fp);
-						read_value(&psi_vzx[j][i][k], fp);
-					}
-				}
-			}
-		}
 
-		if (POS[1]==NPROCX-1) {
-			for (j=1; j<=NY; j++) {
-				for (i=FW+1; i<=2*FW; i++) {
-					for (k=1; k<=NZ; k++) {
-						read_value(&psi_sxx_x[j][i][k], fp);
-						read_value(&psi_sxy_x[j][i][k], fp);
-						read_value(&psi_sxz_x[j][i][k], fp);
-
-						read_value(&psi_vxx[j][i][k], fp);
-						read_value(&psi_vyx[j][i][k], fp);
-						read_value(&psi_vzx[j][i][k], fp);
-					}
-				}
-			}
-		}
 
-		if (POS[2]==0 && FREE_SURF==0) {
-			for (j=1; j<=FW; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=NZ; k++) {
-						read_value(&psi_sxy_y[j][i][k], fp);
-						read_value(&psi_syy_y[j][i][k], fp);
-						read_value(&psi_syz_y[j][i][k], fp);
-
-						read_value(&psi_vxy[j][i][k], fp);
-						read_value(&psi_vyy[j][i][k], fp);
-						read_value(&psi_vzy[j][i][k], fp);
-					}
-				}
-			}
-		}
-		if (POS[2]==NPROCY-1) {
-			for (j=FW+1; j<=2*FW; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=NZ; k++) {
-						read_value(&psi_sxy_y[j][i][k], fp);
-						read_value(&psi_syy_y[j][i][k], fp);
-						read_value(&psi_syz_y[j][i][k], fp);
-
-						read_value(&psi_vxy[j][i][k], fp);
-						read_value(&psi_vyy[j][i][k], fp);
-						read_value(&psi_vzy[j][i][k], fp);
-					}
-				}
-			}
-		}
-
-		if (POS[3]==0) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=FW; k++) {
-						read_value(&psi_sxz_z[j][i][k], fp);
-						read_value(&psi_syz_z[j][i][k], fp);
-						read_value(&psi_szz_z[j][i][k], fp);
-
-						read_value(&psi_vxz[j][i][k], fp);
-						read_value(&psi_vyz[j][i][k], fp);
-						read_value(&psi_vzz[j][i][k], fp);
-					}
-				}
-			}
-		}
-		if (POS[3]==NPROCZ-1) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=FW+1; k<=2*FW; k++) {
-						read_value(&psi_sxz_z[j][i][k], fp);
-						read_value(&psi_syz_z[j][i][k], fp);
-						read_value(&psi_szz_z[j][i][k], fp);
-
-						read_value(&psi_vxz[j][i][k], fp);
-						read_value(&psi_vyz[j][i][k], fp);
-						read_value(&psi_vzz[j][i][k], fp);
-					}
-				}
-			}
-		}
-	} // end if (ABS_TYPE == 1)
+	/* uncompressed checkpoint: the values of the fields at a grid point are
+	   interleaved, one block per plane j */
+	read_points(fp,fields,9,nx1,nx2,ny1,ny2,nz1,nz2);
+	if (L) read_points(fp,rfields,6,1,NX,1,NY,1,NZ);
+	if (ABS_TYPE == 1) {
+		if (POS[1]==0) read_points(fp,psix,6,1,FW,1,NY,1,NZ);
+		if (POS[1]==NPROCX-1) read_points(fp,psix,6,FW+1,2*FW,1,NY,1,NZ);
+		if (POS[2]==0 && FREE_SURF==0) read_points(fp,psiy,6,1,NX,1,FW,1,NZ);
+		if (POS[2]==NPROCY-1) read_points(fp,psiy,6,1,NX,FW+1,2*FW,1,NZ);
+		if (POS[3]==0) read_points(fp,psiz,6,1,NX,1,NY,1,FW);
+		if (POS[3]==NPROCZ-1) read_points(fp,psiz,6,1,NX,1,NY,FW+1,2*FW);
+	}
 
 	fclose(fp);
 }
 
 /**
- * Read a float value from file fp and write it into dst.
+ * Read the values of the nf fields a[0..nf-1] at the grid points of the box,
+ * interleaved as written by save_checkpoint, with one fread per plane j.
  */
-static void read_value(float *dst, FILE *fp)
+static void read_points(FILE *fp, float ***a[], int nf, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2)
 {
     extern char CHECKPTFILE[STRING_SIZE];
 
-    size_t nelems = fread(dst, sizeof(float), 1, fp);
-
-    if (nelems != 1) {
-        char msg[STRING_SIZE];
-        sprintf(msg,
-                "Error occurred while reading from a checkpoint file '%s'",
-                CHECKPTFILE);
-        err(msg);
+    const int n = (nx2 - nx1 + 1) * (nz2 - nz1 + 1) * nf;
+    float *buf;
+    int i, j, k, l, m;
+
+    buf = vector(0, n - 1);
+    for (j = ny1; j <= ny2; j++) {
+        if (fread(buf, sizeof(float), n, fp) != (size_t) n) {
+            char msg[STRING_SIZE];
+            sprintf(msg,
+                    "Error occurred while reading from a checkpoint file '%s'",
+                    CHECKPTFILE);
+            err(msg);
+        }
+        m = 0;
+        for (i = nx1; i <= nx2; i++)
+            for (k = nz1; k <= nz2; k++)
+                for (l = 0; l < nf; l++)
+                    a[l][j][i][k] = buf[m++];
     }
+    free_vector(buf, 0, n - 1);
+}
+
+/**
+ * Read the box nx1..nx2, ny1..ny2, nz1..nz2 of a from one compressed record.
+ */
+static void read_field(FILE *fp, float ***a, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2)
+{
+    const int n = (nx2 - nx1 + 1) * (ny2 - ny1 + 1) * (nz2 - nz1 + 1);
+    float *buf;
+    int i, j, k, m = 0;
+
+    buf = vector(0, n - 1);
+    compress_read(fp, buf, n);
+    for (j = ny1; j <= ny2; j++)
+        for (i = nx1; i <= nx2; i++)
+            for (k = nz1; k <= nz2; k++)
+                a[j][i][k] = buf[m++];
+    free_vector(buf, 0, n - 1);
 }
@@ -53,6 +53,21 @@ int SOFI3DVERS; /* version of SOFI3D 33: current 3D isotropic elastic (SSG), ver
 int NP, NPSP, NPROC, NPROCX, NPROCY, NPROCZ, MYID, IENDX, IENDY, IENDZ;
 int POS[4], INDEX[7];
 const int TAG1 = 1, TAG2 = 2, TAG3 = 3, TAG4 = 4, TAG5 = 5, TAG6 = 6;
+int OVERLAP_COMM=0;
+int HALO_DATATYPE=0;
+int PERSISTENT_COMM=0;
+int HALO_SHM=0;
+int HALO_DEEP=0;
+int SIMD_KERNEL=0;
+int TILING=0, TILE_X=0, TILE_Y=0, TILE_Z=0;
+int FUSED_SWEEP=0;
+int FOLD_COEFF=0;
+int SNAP_MPIIO=0, SNAP_ASYNC=0, SNAP_ASYNC_MB=0;
+float COMPRESS_TOL=1e-4;
+int COMPRESS_REL=1, CHECKPT_COMPRESS=0, MODEL_COMPRESS=0;
+int SEIS_STREAM=0, SEIS_MPIIO=0;
+int CHECKPT_INTERVAL=0, CHECKPT_ASYNC=0;
+int DECOMP=0, REBALANCE=0, SLABX[NPROCX_MAX+1], SLABY[NPROCY_MAX+1], SLABZ[NPROCZ_MAX+1];
 
 float FC=0.0,AMP=1.0, REFSRC[3]={0.0, 0.0, 0.0}, SRC_DT, SRCTSHIFT=0.0;
 int SRC_MF=0, SIGNAL_FORMAT[6]={0, 0, 0, 0, 0, 0};
@@ -88,6 +103,21 @@ void read_par_json(FILE *fp, char *fileinp)
     extern char SEIS_FILE[STRING_SIZE];
     extern int NPROCX, NPROCY, NPROCZ, CHECKPTREAD, CHECKPTWRITE, OUTNTIMESTEPINFO, OUTSOURCEWAVELET;
     extern int ASCIIEBCDIC, LITTLEBIG, IEEEIBM;
+    extern int OVERLAP_COMM;
+    extern int HALO_DATATYPE;
+    extern int PERSISTENT_COMM;
+    extern int HALO_SHM;
+    extern int HALO_DEEP;
+    extern int SIMD_KERNEL;
+    extern int TILING, TILE_X, TILE_Y, TILE_Z;
+    extern int FUSED_SWEEP;
+    extern int FOLD_COEFF;
+    extern int SNAP_MPIIO, SNAP_ASYNC, SNAP_ASYNC_MB;
+    extern float COMPRESS_TOL;
+    extern int COMPRESS_REL, CHECKPT_COMPRESS, MODEL_COMPRESS;
+    extern int SEIS_STREAM, SEIS_MPIIO;
+    extern int CHECKPT_INTERVAL, CHECKPT_ASYNC;
+    extern int DECOMP, REBALANCE;
 
     // Model parameters for model generation.
     extern float VPV1, VSV1, EPSX1, EPSY1, DELX1, DELY1, DELXY1;
@@ -145,6 +175,48 @@ void read_par_json(FILE *fp, char *fileinp)
         err("Variable NPROCY could not be retrieved from the json input file!");
     if (get_int_from_objectlist("NPROCZ", number_readobjects, &NPROCZ, varname_list, value_list))
         err("Variable NPROCY could not be retrieved from the json input file!");
+    if (get_int_from_objectlist("DECOMP", number_readobjects, &DECOMP, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "DECOMP");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("REBALANCE", number_readobjects, &REBALANCE, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "REBALANCE");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("OVERLAP_COMM", number_readobjects, &OVERLAP_COMM, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "OVERLAP_COMM");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("HALO_DATATYPE", number_readobjects, &HALO_DATATYPE, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "HALO_DATATYPE");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("PERSISTENT_COMM", number_readobjects, &PERSISTENT_COMM, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "PERSISTENT_COMM");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("HALO_SHM", number_readobjects, &HALO_SHM, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "HALO_SHM");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("HALO_DEEP", number_readobjects, &HALO_DEEP, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "HALO_DEEP");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
     /*note that "y" is used for the vertical coordinate */
     if (get_int_from_objectlist("FDORDER", number_readobjects, &FDORDER, varname_list, value_list))
         err("Variable FDORDER could not be retrieved from the json input file!");
@@ -152,6 +224,48 @@ void read_par_json(FILE *fp, char *fileinp)
         err("Variable FDORDER_TIME could not be retrieved from the json input file!");
     if (get_int_from_objectlist("FDCOEFF", number_readobjects, &FDCOEFF, varname_list, value_list))
         err("Variable FDCOEFF could not be retrieved from the json input file!");
+    if (get_int_from_objectlist("SIMD_KERNEL", number_readobjects, &SIMD_KERNEL, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "SIMD_KERNEL");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TILING", number_readobjects, &TILING, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TILING");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TILE_X", number_readobjects, &TILE_X, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TILE_X");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TILE_Y", number_readobjects, &TILE_Y, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TILE_Y");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("TILE_Z", number_readobjects, &TILE_Z, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "TILE_Z");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("FUSED_SWEEP", number_readobjects, &FUSED_SWEEP, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "FUSED_SWEEP");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("FOLD_COEFF", number_readobjects, &FOLD_COEFF, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "FOLD_COEFF");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
     if (get_int_from_objectlist("NX", number_readobjects, &NX, varname_list, value_list))
         err("Variable NX could not be retrieved from the json input file!");
     if (get_int_from_objectlist("NY", number_readobjects, &NY, varname_list, value_list))
@@ -192,6 +306,24 @@ void read_par_json(FILE *fp, char *fileinp)
                 err("Variable TSNAPINC could not be retrieved from the json input file!");
             if (get_string_from_objectlist("SNAP_FILE", number_readobjects, SNAP_FILE, varname_list, value_list))
                 err("Variable SNAP_FILE could not be retrieved from the json input file!");
+            if (get_int_from_objectlist("SNAP_MPIIO", number_readobjects, &SNAP_MPIIO, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SNAP_MPIIO");
+                strcpy(value_tmp1, "0");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
+            if (get_int_from_objectlist("SNAP_ASYNC", number_readobjects, &SNAP_ASYNC, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SNAP_ASYNC");
+                strcpy(value_tmp1, "0");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
+            if (get_int_from_objectlist("SNAP_ASYNC_MB", number_readobjects, &SNAP_ASYNC_MB, varname_list, value_list))
+            {
+                strcpy(varname_tmp1, "SNAP_ASYNC_MB");
+                strcpy(value_tmp1, "0");
+                add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+            }
         }
     }
     /* increments are read in any case, because they will be also used as increment for model output */
@@ -310,6 +442,18 @@ void read_par_json(FILE *fp, char *fileinp)
                     strcpy(value_tmp1, "0");
                     add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
                 }
+                if (get_int_from_objectlist("SEIS_STREAM", number_readobjects, &SEIS_STREAM, varname_list, value_list))
+                {
+                    strcpy(varname_tmp1, "SEIS_STREAM");
+                    strcpy(value_tmp1, "0");
+                    add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+                }
+                if (get_int_from_objectlist("SEIS_MPIIO", number_readobjects, &SEIS_MPIIO, varname_list, value_list))
+                {
+                    strcpy(varname_tmp1, "SEIS_MPIIO");
+                    strcpy(value_tmp1, "0");
+                    add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+                }
 
                 if (SEIS_FORMAT[0] == 4)
                 {
@@ -630,6 +774,42 @@ void read_par_json(FILE *fp, char *fileinp)
         err("Variable CHECKPTREAD could not be retrieved from the json input file!");
     if (get_int_from_objectlist("CHECKPTWRITE", number_readobjects, &CHECKPTWRITE, varname_list, value_list))
         err("Variable CHECKPTWRITE could not be retrieved from the json input file!");
+    if (get_int_from_objectlist("CHECKPT_COMPRESS", number_readobjects, &CHECKPT_COMPRESS, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "CHECKPT_COMPRESS");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("CHECKPT_INTERVAL", number_readobjects, &CHECKPT_INTERVAL, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "CHECKPT_INTERVAL");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("CHECKPT_ASYNC", number_readobjects, &CHECKPT_ASYNC, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "CHECKPT_ASYNC");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("MODEL_COMPRESS", number_readobjects, &MODEL_COMPRESS, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "MODEL_COMPRESS");
+        strcpy(value_tmp1, "0");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_float_from_objectlist("COMPRESS_TOL", number_readobjects, &COMPRESS_TOL, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "COMPRESS_TOL");
+        strcpy(value_tmp1, "1e-4");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
+    if (get_int_from_objectlist("COMPRESS_REL", number_readobjects, &COMPRESS_REL, varname_list, value_list))
+    {
+        strcpy(varname_tmp1, "COMPRESS_REL");
+        strcpy(value_tmp1, "1");
+        add_object_tolist(varname_tmp1, value_tmp1, &number_defaultobjects, varnamedefault_list, valuedefault_list);
+    }
     if (get_int_from_objectlist("OUT_TIMESTEP_INFO", number_readobjects, &OUTNTIMESTEPINFO, varname_list, value_list))
     {
         strcpy(varname_tmp1, "OUT_TIMESTEP_INFO");
@@ -763,8 +943,9 @@ void read_par_json(FILE *fp, char *fileinp)
     }
 
     // Check that the grid size is large enough for the given width
-    // of the boundary frame.
-    {
+    // of the boundary frame (see decomp.c for DECOMP=1 and for the
+    // automatic process grid with NPROCX, NPROCY or NPROCZ = 0).
+    if (!DECOMP && NPROCX && NPROCY && NPROCZ) {
         if (NX / (float) NPROCX < FW) {
             err("Local grid resolution along X-axis %d is smaller than "
                 "boundary width (FW=%d)", (int) (NX / (float) NPROCX), FW);
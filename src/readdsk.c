@@ -44,3 +44,42 @@ float readdsk(FILE *fp_in, int format)
 
     return amp;
 }
+
+/*
+ * Read `n` float values a[0..n-1] from a given file in one of the formats
+ * of `readdsk`.  Binary data are read with a single call, so callers should
+ * pass whole columns or planes instead of calling `readdsk` for each value.
+ * Compressed files (format 6) are read record by record, and n must be the
+ * number of values written by one call of `writedsk_block`.
+ */
+void readdsk_block(FILE *fp_in, float *a, int n, int format)
+{
+    int i;
+
+    switch (format) {
+        case FILE_FORMAT_SU:
+            err(" Sorry, SU-format for snapshots not implemented yet. \n");
+            break;
+        case FILE_FORMAT_ASCII:
+            for (i = 0; i < n; i++) {
+                if (fscanf(fp_in, "%e\n", &a[i]) != 1) {
+                    err("[%s] Could not read an amplitude "
+                        "from a file in ASCII format\n", __func__);
+                }
+            }
+            break;
+        case FILE_FORMAT_BINARY:
+            if (fread(a, sizeof(float), n, fp_in) != (size_t) n) {
+                err("[%s] Could not read %d amplitudes "
+                    "from a file in binary format\n", __func__, n);
+            }
+            break;
+        case FILE_FORMAT_COMPRESSED:
+            compress_read(fp_in, a, n);
+            break;
+
+        default:
+            err("[%s] Unsupported file format. "
+                "Supported formats are SU, ASCII, and BINARY", __func__);
+    }
+}
@@ -1,6 +1,7 @@
 /*------------------------------------------------------------------------
  *   Read elastic model properties (vp,vs,density) from files
  *   if L>0 damping model (qp and qs) are from file read, too
+ *   Each PE reads only its subdomain with collective MPI-IO (see mpiio.c)
  *
  *  ----------------------------------------------------------------------*/
 #include <stdbool.h>
@@ -16,7 +17,7 @@ void readmod(float ***rho, float ***pi, float ***u,
 {
     // Global variables.
     extern float DT, *FL, TAU, TS, FREF;
-    extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], L, MYID;
+    extern int NX, NY, NZ, L, MYID;
     extern int WRITE_MODELFILES;
     extern char MFILE[STRING_SIZE];
     extern FILE *FP;
@@ -32,11 +33,12 @@ void readmod(float ***rho, float ***pi, float ***u,
     float *pts = NULL, sumu = 0.0, sumpi = 0.0, ws = 0.0;
     float ***pwavemod = NULL, ***swavemod = NULL;
     float ***qpmod = NULL, ***qsmod = NULL;
-    int i, j, k, l, ii, jj, kk;
+    int i, j, k, l;
 
-    FILE *fp_vs, *fp_vp, *fp_rho, *fp_qp = NULL, *fp_qs = NULL;
-    FILE *fp_C11, *fp_C22, *fp_C33, *fp_C44, *fp_C55, *fp_C66;
-    FILE *fp_C12, *fp_C13, *fp_C23;
+    // Local blocks of the model files, see mpiio_read_block.
+    float *blk_vs, *blk_vp, *blk_rho, *blk_qp = NULL, *blk_qs = NULL;
+    float *blk_C11, *blk_C22, *blk_C33, *blk_C44, *blk_C55, *blk_C66;
+    float *blk_C12, *blk_C13, *blk_C23;
 
     char filename[STRING_SIZE];
 
@@ -57,20 +59,19 @@ void readmod(float ***rho, float ***pi, float ***u,
     char fname_delxy[STRING_SIZE];
     char fname_gamx[STRING_SIZE];
     char fname_gamy[STRING_SIZE];
-    FILE *fp_epsx;
-    FILE *fp_epsy;
-    FILE *fp_delx;
-    FILE *fp_dely;
-    FILE *fp_delxy;
-    FILE *fp_gamx;
-    FILE *fp_gamy;
+    float *blk_epsx;
+    float *blk_epsy;
+    float *blk_delx;
+    float *blk_dely;
+    float *blk_delxy;
+    float *blk_gamx;
+    float *blk_gamy;
 
     bool flag_velocity_files_avail = false;
     bool flag_cij_files_avail = false;
 
-
-    /* choose data format: ASCII: format=2, BINARY: format=3*/
-    const int format = 3;
+    // Index of the local grid point (i, j, k) in the blocks.
+    int n;
 
     /*internal switch for writing all models to file (WRITE_MODELFILES=1)
 	 * or just density (WRITE_MODELFILES=0)
@@ -87,14 +88,16 @@ void readmod(float ***rho, float ***pi, float ***u,
     }
 
 
+    /* All PEs read the blocks of their subdomains from the model files
+     * with one collective call per file (see mpiio.c). */
     fprintf(FP, "\nReading model information from model files...\n");
 
     // Read density model.
     char fname_rho[STRING_SIZE];
     sprintf(fname_rho, "%s.rho", MFILE);
     fprintf(FP, "\tDensity: %s\n\n", fname_rho);
-    fp_rho = fopen(fname_rho, "r");
-    if (fp_rho == NULL) {
+    blk_rho = mpiio_read_block(fname_rho);
+    if (blk_rho == NULL) {
         err("Could not open model file containing density field!");
     }
 
@@ -103,24 +106,24 @@ void readmod(float ***rho, float ***pi, float ***u,
         char fname_vp[STRING_SIZE];
         sprintf(fname_vp, "%s.vp", MFILE);
         fprintf(FP, "\tP-wave velocities: %s\n", fname_vp);
-        fp_vp = fopen(fname_vp, "r");
+        blk_vp = mpiio_read_block(fname_vp);
 
         char fname_vs[STRING_SIZE];
         sprintf(fname_vs, "%s.vs", MFILE);
         fprintf(FP, "\tS-wave velocities: %s\n", fname_vs);
-        fp_vs = fopen(fname_vs, "r");
+        blk_vs = mpiio_read_block(fname_vs);
 
         // Checking that either model files for Vp and Vs are both present
         // or both absent, otherwise terminate with error.
-        if (fp_vp != NULL && fp_vs != NULL) {
+        if (blk_vp != NULL && blk_vs != NULL) {
             flag_velocity_files_avail = true;
             fprintf(FP,
                     "\tBoth P- and S-wave velocity models are readable\n\n"
             );
-        } else if (fp_vp == NULL && fp_vs != NULL) {
+        } else if (blk_vp == NULL && blk_vs != NULL) {
             err("Could not open model file for P-velocity "
                 "but model file for S-velocity is available.");
-        } else if (fp_vp != NULL && fp_vs == NULL) {
+        } else if (blk_vp != NULL && blk_vs == NULL) {
             err("Could not open model file for S-velocity "
                 "but model file for P-velocity is available.");
         } else {
@@ -131,40 +134,6 @@ void readmod(float ***rho, float ***pi, float ***u,
         }
     }
 
-    // Read anisotropic parameters.
-    {
-        fprintf(FP, "Try reading anisotropic parameters\n");
-
-        sprintf(fname_epsx, "%s.epsx", MFILE);
-        fprintf(FP, "\tepsx field: %s\n", fname_epsx);
-        fp_epsx = fopen(fname_epsx, "r");
-
-        sprintf(fname_epsy, "%s.epsy", MFILE);
-        fprintf(FP, "\tepsy field: %s\n", fname_epsy);
-        fp_epsy = fopen(fname_epsy, "r");
-
-        sprintf(fname_delx, "%s.delx", MFILE);
-        fprintf(FP, "\tdelx field: %s\n", fname_delx);
-        fp_delx = fopen(fname_delx, "r");
-
-        sprintf(fname_dely, "%s.dely", MFILE);
-        fprintf(FP, "\tdely field: %s\n", fname_dely);
-        fp_dely = fopen(fname_dely, "r");
-
-        sprintf(fname_delxy, "%s.delxy", MFILE);
-        fprintf(FP, "\tdelxy field: %s\n", fname_delxy);
-        fp_delxy = fopen(fname_delxy, "r");
-
-        sprintf(fname_gamx, "%s.gamx", MFILE);
-        fprintf(FP, "\tgamx field: %s\n", fname_gamx);
-        fp_gamx = fopen(fname_gamx, "r");
-
-        sprintf(fname_gamy, "%s.gamy", MFILE);
-        fprintf(FP, "\tgamy field: %s\n", fname_gamy);
-        fp_gamy = fopen(fname_gamy, "r");
-    }
-
-
     // Try to read model files for anistropic stiffness parameters Cij.
     // Check that either all 9 files for Cij fields are available for reading
     // or all of them are absent.
@@ -173,47 +142,47 @@ void readmod(float ***rho, float ***pi, float ***u,
     {
         sprintf(fname_C11, "%s.C11", MFILE);
         fprintf(FP, "\tC11 model: %s\n", fname_C11);
-        fp_C11 = fopen(fname_C11, "r");
+        blk_C11 = mpiio_read_block(fname_C11);
 
         sprintf(fname_C22, "%s.C22", MFILE);
         fprintf(FP, "\tC22: %s\n", fname_C22);
-        fp_C22 = fopen(fname_C22, "r");
+        blk_C22 = mpiio_read_block(fname_C22);
 
         sprintf(fname_C33, "%s.C33", MFILE);
         fprintf(FP, "\tC33: %s\n", fname_C33);
-        fp_C33 = fopen(fname_C33, "r");
+        blk_C33 = mpiio_read_block(fname_C33);
 
         sprintf(fname_C44, "%s.C44", MFILE);
         fprintf(FP, "\tC44: %s\n", fname_C44);
-        fp_C44 = fopen(fname_C44, "r");
+        blk_C44 = mpiio_read_block(fname_C44);
 
         sprintf(fname_C55, "%s.C55", MFILE);
         fprintf(FP, "\tC55: %s\n", fname_C55);
-        fp_C55 = fopen(fname_C55, "r");
+        blk_C55 = mpiio_read_block(fname_C55);
 
         sprintf(fname_C66, "%s.C66", MFILE);
         fprintf(FP, "\tC66: %s\n", fname_C66);
-        fp_C66 = fopen(fname_C66, "r");
+        blk_C66 = mpiio_read_block(fname_C66);
 
         sprintf(fname_C12, "%s.C12", MFILE);
         fprintf(FP, "\tC12: %s\n", fname_C12);
-        fp_C12 = fopen(fname_C12, "r");
+        blk_C12 = mpiio_read_block(fname_C12);
 
         sprintf(fname_C13, "%s.C13", MFILE);
         fprintf(FP, "\tC13: %s\n", fname_C13);
-        fp_C13 = fopen(fname_C13, "r");
+        blk_C13 = mpiio_read_block(fname_C13);
 
         sprintf(fname_C23, "%s.C23", MFILE);
         fprintf(FP, "\tC23: %s\n", fname_C23);
-        fp_C23 = fopen(fname_C23, "r");
+        blk_C23 = mpiio_read_block(fname_C23);
 
-        bool readable_1 = fp_C11 != NULL && fp_C22 != NULL && fp_C33 != NULL;
-        bool readable_2 = fp_C44 != NULL && fp_C55 != NULL && fp_C66 != NULL;
-        bool readable_3 = fp_C12 != NULL && fp_C13 != NULL && fp_C23 != NULL;
+        bool readable_1 = blk_C11 != NULL && blk_C22 != NULL && blk_C33 != NULL;
+        bool readable_2 = blk_C44 != NULL && blk_C55 != NULL && blk_C66 != NULL;
+        bool readable_3 = blk_C12 != NULL && blk_C13 != NULL && blk_C23 != NULL;
 
-        bool noreadable_1 = fp_C11 == NULL && fp_C22 == NULL && fp_C33 == NULL;
-        bool noreadable_2 = fp_C44 == NULL && fp_C55 == NULL && fp_C66 == NULL;
-        bool noreadable_3 = fp_C12 == NULL && fp_C13 == NULL && fp_C23 == NULL;
+        bool noreadable_1 = blk_C11 == NULL && blk_C22 == NULL && blk_C33 == NULL;
+        bool noreadable_2 = blk_C44 == NULL && blk_C55 == NULL && blk_C66 == NULL;
+        bool noreadable_3 = blk_C12 == NULL && blk_C13 == NULL && blk_C23 == NULL;
 
         if (readable_1 && readable_2 && readable_3) {
             flag_cij_files_avail = true;
@@ -223,18 +192,52 @@ void readmod(float ***rho, float ***pi, float ***u,
             fprintf(FP, "All Cij models are not readable\n\n");
         } else {
             fprintf(FP, "Some Cij models are readable and some are not\n");
-            if (fp_C11 == NULL) err("Could not open model file for C11!");
-            if (fp_C22 == NULL) err("Could not open model file for C22!");
-            if (fp_C33 == NULL) err("Could not open model file for C33!");
-            if (fp_C44 == NULL) err("Could not open model file for C44!");
-            if (fp_C55 == NULL) err("Could not open model file for C55!");
-            if (fp_C66 == NULL) err("Could not open model file for C66!");
-            if (fp_C12 == NULL) err("Could not open model file for C12!");
-            if (fp_C13 == NULL) err("Could not open model file for C13!");
-            if (fp_C23 == NULL) err("Could not open model file for C23!");
+            if (blk_C11 == NULL) err("Could not open model file for C11!");
+            if (blk_C22 == NULL) err("Could not open model file for C22!");
+            if (blk_C33 == NULL) err("Could not open model file for C33!");
+            if (blk_C44 == NULL) err("Could not open model file for C44!");
+            if (blk_C55 == NULL) err("Could not open model file for C55!");
+            if (blk_C66 == NULL) err("Could not open model file for C66!");
+            if (blk_C12 == NULL) err("Could not open model file for C12!");
+            if (blk_C13 == NULL) err("Could not open model file for C13!");
+            if (blk_C23 == NULL) err("Could not open model file for C23!");
         }
     }
 
+    // Read anisotropic parameters (only used without Cij models).
+    blk_epsx = blk_epsy = blk_delx = blk_dely = blk_delxy = blk_gamx = blk_gamy = NULL;
+    if ((L == 0) && !flag_cij_files_avail) {
+        fprintf(FP, "Try reading anisotropic parameters\n");
+
+        sprintf(fname_epsx, "%s.epsx", MFILE);
+        fprintf(FP, "\tepsx field: %s\n", fname_epsx);
+        blk_epsx = mpiio_read_block(fname_epsx);
+
+        sprintf(fname_epsy, "%s.epsy", MFILE);
+        fprintf(FP, "\tepsy field: %s\n", fname_epsy);
+        blk_epsy = mpiio_read_block(fname_epsy);
+
+        sprintf(fname_delx, "%s.delx", MFILE);
+        fprintf(FP, "\tdelx field: %s\n", fname_delx);
+        blk_delx = mpiio_read_block(fname_delx);
+
+        sprintf(fname_dely, "%s.dely", MFILE);
+        fprintf(FP, "\tdely field: %s\n", fname_dely);
+        blk_dely = mpiio_read_block(fname_dely);
+
+        sprintf(fname_delxy, "%s.delxy", MFILE);
+        fprintf(FP, "\tdelxy field: %s\n", fname_delxy);
+        blk_delxy = mpiio_read_block(fname_delxy);
+
+        sprintf(fname_gamx, "%s.gamx", MFILE);
+        fprintf(FP, "\tgamx field: %s\n", fname_gamx);
+        blk_gamx = mpiio_read_block(fname_gamx);
+
+        sprintf(fname_gamy, "%s.gamy", MFILE);
+        fprintf(FP, "\tgamy field: %s\n", fname_gamy);
+        blk_gamy = mpiio_read_block(fname_gamy);
+    }
+
     /*elastic simulation */
     if (L == 0) {
         float tmp;
@@ -246,180 +249,52 @@ void readmod(float ***rho, float ***pi, float ***u,
         float gamx = 0.0f;
         float gamy = 0.0f;
 
-/*((POS[1] == ((i - 1) / NX)) &&
-                        (POS[2] == ((j - 1) / NY)) &&
-                        (POS[3] == ((k - 1) / NZ))) { */
-
-        int offset_POS = (POS[3] * NZ * NXG * NYG + POS[1] * NX * NYG + POS[2] * NY)*sizeof(float);
-
-		fseek(fp_rho,   offset_POS, SEEK_SET);
-		if (flag_velocity_files_avail) {
-			fseek(fp_vp,    offset_POS, SEEK_SET);
-			fseek(fp_vs,    offset_POS, SEEK_SET);
-		}
-
-		if (flag_cij_files_avail) {
-			fseek(fp_C11,   offset_POS, SEEK_SET);
-			fseek(fp_C22,   offset_POS, SEEK_SET);
-			fseek(fp_C33,   offset_POS, SEEK_SET);
-			fseek(fp_C44,   offset_POS, SEEK_SET);
-			fseek(fp_C55,   offset_POS, SEEK_SET);
-			fseek(fp_C66,   offset_POS, SEEK_SET);
-			fseek(fp_C12,   offset_POS, SEEK_SET);
-			fseek(fp_C13,   offset_POS, SEEK_SET);
-			fseek(fp_C23,   offset_POS, SEEK_SET);
-		}
-		if (fp_epsx != NULL) {
-			fseek(fp_epsx,  offset_POS, SEEK_SET);
-		}
-		if (fp_epsy != NULL) {
-			fseek(fp_epsy,  offset_POS, SEEK_SET);
-		}
-		if (fp_delx != NULL) {
-			fseek(fp_delx,  offset_POS, SEEK_SET);
-		}
-		if (fp_dely != NULL) {
-			fseek(fp_dely,  offset_POS, SEEK_SET);
-		}
-		if (fp_delxy != NULL) {
-			fseek(fp_delxy, offset_POS, SEEK_SET);
-		}
-		if (fp_gamx != NULL) {
-			fseek(fp_gamx,  offset_POS, SEEK_SET);
-		}
-		if (fp_gamy != NULL) {
-			fseek(fp_gamy,  offset_POS, SEEK_SET);
-		}
-            
-        
-        /* loop over local grid */
+        /* loop over local grid in the order of the model files */
+        n = 0;
         for (k = 1; k <= NZ; k++) {
-            int offset_Z = offset_POS + ((k-1) * NXG * NYG * sizeof(float));
-			int cur_offset = offset_Z;
-			fseek(fp_rho,   cur_offset, SEEK_SET);
-			if (flag_velocity_files_avail) {
-				fseek(fp_vp,    cur_offset, SEEK_SET);
-				fseek(fp_vs,    cur_offset, SEEK_SET);
-			}
-
-			if (flag_cij_files_avail) {
-				fseek(fp_C11,   cur_offset, SEEK_SET);
-				fseek(fp_C22,   cur_offset, SEEK_SET);
-				fseek(fp_C33,   cur_offset, SEEK_SET);
-				fseek(fp_C44,   cur_offset, SEEK_SET);
-				fseek(fp_C55,   cur_offset, SEEK_SET);
-				fseek(fp_C66,   cur_offset, SEEK_SET);
-				fseek(fp_C12,   cur_offset, SEEK_SET);
-				fseek(fp_C13,   cur_offset, SEEK_SET);
-				fseek(fp_C23,   cur_offset, SEEK_SET);
-			}
-			if (fp_epsx != NULL) {
-				fseek(fp_epsx,  cur_offset, SEEK_SET);
-			}
-			if (fp_epsy != NULL) {
-				fseek(fp_epsy,  cur_offset, SEEK_SET);
-			}
-			if (fp_delx != NULL) {
-				fseek(fp_delx,  cur_offset, SEEK_SET);
-			}
-			if (fp_dely != NULL) {
-				fseek(fp_dely,  cur_offset, SEEK_SET);
-			}
-			if (fp_delxy != NULL) {
-				fseek(fp_delxy, cur_offset, SEEK_SET);
-			}
-			if (fp_gamx != NULL) {
-				fseek(fp_gamx,  cur_offset, SEEK_SET);
-			}
-			if (fp_gamy != NULL) {
-				fseek(fp_gamy,  cur_offset, SEEK_SET);
-			}
-            fprintf(FP, "k = %d\n", k);
-            
             for (i = 1; i <= NX; i++) {
-				int cur_offset = (i-1)*NYG*sizeof(float) + offset_Z;
-
-				fseek(fp_rho,   cur_offset, SEEK_SET);
-				if (flag_velocity_files_avail) {
-					fseek(fp_vp,    cur_offset, SEEK_SET);
-					fseek(fp_vs,    cur_offset, SEEK_SET);
-				}
-
-				if (flag_cij_files_avail) {
-					fseek(fp_C11,   cur_offset, SEEK_SET);
-					fseek(fp_C22,   cur_offset, SEEK_SET);
-					fseek(fp_C33,   cur_offset, SEEK_SET);
-					fseek(fp_C44,   cur_offset, SEEK_SET);
-					fseek(fp_C55,   cur_offset, SEEK_SET);
-					fseek(fp_C66,   cur_offset, SEEK_SET);
-					fseek(fp_C12,   cur_offset, SEEK_SET);
-					fseek(fp_C13,   cur_offset, SEEK_SET);
-					fseek(fp_C23,   cur_offset, SEEK_SET);
-				}
-				if (fp_epsx != NULL) {
-					fseek(fp_epsx,  cur_offset, SEEK_SET);
-				}
-				if (fp_epsy != NULL) {
-					fseek(fp_epsy,  cur_offset, SEEK_SET);
-				}
-				if (fp_delx != NULL) {
-					fseek(fp_delx,  cur_offset, SEEK_SET);
-				}
-				if (fp_dely != NULL) {
-					fseek(fp_dely,  cur_offset, SEEK_SET);
-				}
-				if (fp_delxy != NULL) {
-					fseek(fp_delxy, cur_offset, SEEK_SET);
-				}
-				if (fp_gamx != NULL) {
-					fseek(fp_gamx,  cur_offset, SEEK_SET);
-				}
-				if (fp_gamy != NULL) {
-					fseek(fp_gamy,  cur_offset, SEEK_SET);
-				}
-
-                for (j = 1; j <= NY; j++) {
-                    Rho = readdsk(fp_rho, format);
+                for (j = 1; j <= NY; j++, n++) {
+                    Rho = blk_rho[n];
 
                     if (flag_velocity_files_avail) {
-                        Vp = readdsk(fp_vp, format);
-                        Vs = readdsk(fp_vs, format);
+                        Vp = blk_vp[n];
+                        Vs = blk_vs[n];
 
                         muv = Vs * Vs * Rho;
                         piv = Vp * Vp * Rho;
                     }
 
                     if (flag_cij_files_avail) {
-                        C_11 = readdsk(fp_C11, format);
-                        C_22 = readdsk(fp_C22, format);
-                        C_33 = readdsk(fp_C33, format);
-                        C_44 = readdsk(fp_C44, format);
-                        C_55 = readdsk(fp_C55, format);
-                        C_66 = readdsk(fp_C66, format);
-                        C_12 = readdsk(fp_C12, format);
-                        C_13 = readdsk(fp_C13, format);
-                        C_23 = readdsk(fp_C23, format);
+                        C_11 = blk_C11[n];
+                        C_22 = blk_C22[n];
+                        C_33 = blk_C33[n];
+                        C_44 = blk_C44[n];
+                        C_55 = blk_C55[n];
+                        C_66 = blk_C66[n];
+                        C_12 = blk_C12[n];
+                        C_13 = blk_C13[n];
+                        C_23 = blk_C23[n];
                     } else {
-                        if (fp_epsx != NULL) {
-                            epsx = readdsk(fp_epsx, format);
+                        if (blk_epsx != NULL) {
+                            epsx = blk_epsx[n];
                         }
-                        if (fp_epsy != NULL) {
-                            epsy = readdsk(fp_epsy, format);
+                        if (blk_epsy != NULL) {
+                            epsy = blk_epsy[n];
                         }
-                        if (fp_delx != NULL) {
-                            delx = readdsk(fp_delx, format);
+                        if (blk_delx != NULL) {
+                            delx = blk_delx[n];
                         }
-                        if (fp_dely != NULL) {
-                            dely = readdsk(fp_dely, format);
+                        if (blk_dely != NULL) {
+                            dely = blk_dely[n];
                         }
-                        if (fp_delxy != NULL) {
-                            delxy = readdsk(fp_delxy, format);
+                        if (blk_delxy != NULL) {
+                            delxy = blk_delxy[n];
                         }
-                        if (fp_gamx != NULL) {
-                            gamx = readdsk(fp_gamx, format);
+                        if (blk_gamx != NULL) {
+                            gamx = blk_gamx[n];
                         }
-                        if (fp_gamy != NULL) {
-                            gamy = readdsk(fp_gamy, format);
+                        if (blk_gamy != NULL) {
+                            gamy = blk_gamy[n];
                         }
                         // clang-format off
                         C_33 = Rho * Vp * Vp;
@@ -470,19 +345,21 @@ void readmod(float ***rho, float ***pi, float ***u,
 
     if (L) { /*viscoelastic simulation */
 
+        if (!flag_velocity_files_avail)
+            err("Could not open model files for P- and S-velocity!");
 
         /* if TAU is specified in input file, q-files will NOT be read-in separately
 		thus a constant q-model will be assumed */
         if (TAU == 0.0) {
             fprintf(FP, "\t Qp:\n\t %s.qp\n\n", MFILE);
             sprintf(filename, "%s.qp", MFILE);
-            fp_qp = fopen(filename, "r");
-            if (fp_qp == NULL) err(" Could not open model file for Qp-values ! ");
+            blk_qp = mpiio_read_block(filename);
+            if (blk_qp == NULL) err(" Could not open model file for Qp-values ! ");
 
             fprintf(FP, "\t Qs:\n\t %s.qs\n\n", MFILE);
             sprintf(filename, "%s.qs", MFILE);
-            fp_qs = fopen(filename, "r");
-            if (fp_qs == NULL) err(" Could not open model file for Qs-values ! ");
+            blk_qs = mpiio_read_block(filename);
+            if (blk_qs == NULL) err(" Could not open model file for Qs-values ! ");
         }
 
         /* vector for maxwellbodies */
@@ -499,18 +376,19 @@ void readmod(float ***rho, float ***pi, float ***u,
         else
             ws = 2.0 * PI * FREF;
 
-        /* loop over global grid */
-        for (k = 1; k <= NZG; k++) {
-            for (i = 1; i <= NXG; i++) {
-                for (j = 1; j <= NYG; j++) {
-                    Vp = readdsk(fp_vp, format);
-                    Vs = readdsk(fp_vs, format);
-                    Rho = readdsk(fp_rho, format);
+        /* loop over local grid in the order of the model files */
+        n = 0;
+        for (k = 1; k <= NZ; k++) {
+            for (i = 1; i <= NX; i++) {
+                for (j = 1; j <= NY; j++, n++) {
+                    Vp = blk_vp[n];
+                    Vs = blk_vs[n];
+                    Rho = blk_rho[n];
 
                     /*calculation of taus and taup by read-in q-files*/
                     if (TAU == 0.0) {
-                        Qp = readdsk(fp_qp, format);
-                        Qs = readdsk(fp_qs, format);
+                        Qp = blk_qp[n];
+                        Qs = blk_qs[n];
                     } else {
                         /*constant q (damping) case:*/
                         Qp = 2.0 / TAU;
@@ -527,28 +405,18 @@ void readmod(float ***rho, float ***pi, float ***u,
                     muv = Vs * Vs * Rho / (1.0 + sumu);
                     piv = Vp * Vp * Rho / (1.0 + sumpi);
 
-                    /* only the PE which belongs to the current global gridpoint
-						is saving model parameters in his local arrays */
-                    if ((POS[1] == ((i - 1) / NX)) &&
-                        (POS[2] == ((j - 1) / NY)) &&
-                        (POS[3] == ((k - 1) / NZ))) {
-                        ii = i - POS[1] * NX;
-                        jj = j - POS[2] * NY;
-                        kk = k - POS[3] * NZ;
-
-                        u[jj][ii][kk] = muv;
-                        rho[jj][ii][kk] = Rho;
-                        pi[jj][ii][kk] = piv;
-
-                        taus[jj][ii][kk] = 2.0 / Qs;
-                        taup[jj][ii][kk] = 2.0 / Qp;
-
-                        if (WRITE_MODELFILES) {
-                            pwavemod[jj][ii][kk] = Vp;
-                            swavemod[jj][ii][kk] = Vs;
-                            qsmod[jj][ii][kk] = 2 / taus[jj][ii][kk];
-                            qpmod[jj][ii][kk] = 2 / taup[jj][ii][kk];
-                        }
+                    u[j][i][k] = muv;
+                    rho[j][i][k] = Rho;
+                    pi[j][i][k] = piv;
+
+                    taus[j][i][k] = 2.0 / Qs;
+                    taup[j][i][k] = 2.0 / Qp;
+
+                    if (WRITE_MODELFILES) {
+                        pwavemod[j][i][k] = Vp;
+                        swavemod[j][i][k] = Vs;
+                        qsmod[j][i][k] = 2 / taus[j][i][k];
+                        qpmod[j][i][k] = 2 / taup[j][i][k];
                     }
                 }
             }
@@ -556,13 +424,27 @@ void readmod(float ***rho, float ***pi, float ***u,
     }
 
 
-    fclose(fp_vp);
-    fclose(fp_vs);
-    fclose(fp_rho);
-    if ((L) && (TAU == 0.0)) {
-        fclose(fp_qp);
-        fclose(fp_qs);
-    }
+    mpiio_free_block(blk_vp);
+    mpiio_free_block(blk_vs);
+    mpiio_free_block(blk_rho);
+    mpiio_free_block(blk_qp);
+    mpiio_free_block(blk_qs);
+    mpiio_free_block(blk_C11);
+    mpiio_free_block(blk_C22);
+    mpiio_free_block(blk_C33);
+    mpiio_free_block(blk_C44);
+    mpiio_free_block(blk_C55);
+    mpiio_free_block(blk_C66);
+    mpiio_free_block(blk_C12);
+    mpiio_free_block(blk_C13);
+    mpiio_free_block(blk_C23);
+    mpiio_free_block(blk_epsx);
+    mpiio_free_block(blk_epsy);
+    mpiio_free_block(blk_delx);
+    mpiio_free_block(blk_dely);
+    mpiio_free_block(blk_delxy);
+    mpiio_free_block(blk_gamx);
+    mpiio_free_block(blk_gamy);
 
     /* each PE writes his model to disk */
 
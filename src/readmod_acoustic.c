@@ -12,19 +12,18 @@ void readmod_acoustic(float  ***  rho, float ***  pi, int ishot){
 	/*--------------------------------------------------------------------------*/
 	/* extern variables */
 
-	extern int NX, NY, NZ, NXG, NYG, NZG, POS[4], MYID;
+	extern int NX, NY, NZ, MYID;
 	extern char  MFILE[STRING_SIZE];
 	extern FILE *FP;
 
 	/* local variables */
 	float piv;
 	float Vp, Rho;
-	float * rhobuffer, * vpbuffer;
-	int i, j, k, ii, jj, kk, N, ind;
-	FILE  *fp_vp=NULL, *fp_rho=NULL;
+	float * rhoblock, * vpblock;
+	int i, j, k, n;
 	char filename[STRING_SIZE];
 	char fname_vp[STRING_SIZE], fname_rho[STRING_SIZE];
-	double 	time1=0.0, time2=0.0, time3=0.0, time4=0.0;
+	double 	time1=0.0;
 
 	/*-----------------------------------------------------------------------*/
 
@@ -33,92 +32,37 @@ void readmod_acoustic(float  ***  rho, float ***  pi, int ishot){
 	sprintf(fname_vp,"%s_shot%d.vp",MFILE,ishot);
 	sprintf(fname_rho,"%s_shot%d.rho",MFILE,ishot);
 
-	if (MYID==0) {
-		printf(" PE %d: opening model file %s ...",MYID,fname_vp);
-		fp_vp=fopen(fname_vp,"rb");
-		if (fp_vp==NULL) err(" could not open file vp-file ");
-
-		printf(" PE %d: opening model file %s ...",MYID,fname_rho);
-		fp_rho=fopen(fname_rho,"rb");
-		if (fp_rho==NULL) err(" could not open file rho-file ");
-	}
-
-
-
-	/* loop over global grid */
-
+	/* each PE reads its subdomain with collective MPI-IO (see mpiio.c) */
 	if (MYID==0) time1=MPI_Wtime();
 
-	N=NYG*NXG;
-	rhobuffer=(float *)malloc(N*4);
-	if (rhobuffer==NULL) err(" allocation failure rhobuffer!");
-	vpbuffer=(float *)malloc(N*4);
-	if (vpbuffer==NULL) err(" allocation failure vpbuffer!");
-
-    size_t N_actual;
+	if (MYID==0) printf(" PE %d: opening model file %s ...",MYID,fname_vp);
+	vpblock=mpiio_read_block(fname_vp);
+	if (vpblock==NULL) err(" could not open file vp-file ");
 
-	for (k=1;k<=NZG;k++){
-		if (MYID==0) {
-			time2=MPI_Wtime();
-			fprintf(FP," reading k=%d\n",k);
-			fprintf(FP," real time : %4.2f s.\n",time2-time1);
-			time1=time2;
+	if (MYID==0) printf(" PE %d: opening model file %s ...",MYID,fname_rho);
+	rhoblock=mpiio_read_block(fname_rho);
+	if (rhoblock==NULL) err(" could not open file rho-file ");
 
-			N_actual = fread(vpbuffer, 4, N, fp_vp);
-            if (N_actual != (size_t) N) {
-                warning("Possible error while reading model for 'Vp'");
-            }
+	if (MYID==0) fprintf(FP," reading model files : %4.2f s.\n",MPI_Wtime()-time1);
 
-			N_actual = fread(rhobuffer, 4, N, fp_rho);
-            if (N_actual != (size_t) N) {
-                warning("Possible error while reading model for 'Vp'");
-            }
-
-		}
-
-		if (MYID==0){
-			fprintf(FP," broadcasting buffer arrays %d bytes...",2*N*4);
-			time3=MPI_Wtime();
-		}
-		MPI_Bcast(vpbuffer,N,MPI_FLOAT,0,MPI_COMM_WORLD);
-		MPI_Bcast(rhobuffer,N,MPI_FLOAT,0,MPI_COMM_WORLD);
-		MPI_Barrier(MPI_COMM_WORLD);
-		time4=MPI_Wtime();
-		if (MYID==0){
-			time4=MPI_Wtime();
-			fprintf(FP," real time : %4.2f s.\n",time4-time3);
-		}
-		for (i=1;i<=NXG;i++){
-			for (j=1;j<=NYG;j++){
-				ind=(i-1)*NYG +j;
-				Vp=vpbuffer[ind-1];
-				Rho=rhobuffer[ind-1];
+	/* loop over local grid in the order of the model files */
+	n=0;
+	for (k=1;k<=NZ;k++){
+		for (i=1;i<=NX;i++){
+			for (j=1;j<=NY;j++,n++){
+				Vp=vpblock[n];
+				Rho=rhoblock[n];
 
 				piv=Vp*Vp*Rho;
 
-				/* only the PE which belongs to the current global gridpoint
-				  is saving model parameters in his local arrays */
-				if ((POS[1]==((i-1)/NX)) &&
-						(POS[2]==((j-1)/NY)) &&
-						(POS[3]==((k-1)/NZ))){
-					ii=i-POS[1]*NX;
-					jj=j-POS[2]*NY;
-					kk=k-POS[3]*NZ;
-
-					rho[jj][ii][kk]=Rho;
-					pi[jj][ii][kk]=piv;
-				}
+				rho[j][i][k]=Rho;
+				pi[j][i][k]=piv;
 			}
 		}
 	}
 
-	if (MYID==0) {
-		fclose(fp_vp);
-		fclose(fp_rho);
-	}
-
-	free(rhobuffer);
-	free(vpbuffer);
+	mpiio_free_block(rhoblock);
+	mpiio_free_block(vpblock);
 
 
 
@@ -6,6 +6,7 @@
 /*	         (no other suitable computer for further test available)      */
 /*                                                                            */
 /*               Some routines are not optimized for speed!                   */
+/*               (the conversion of the samples is, see below)                */
 /******************************************************************************/
 #include <stdio.h>
 #include <math.h>
@@ -16,6 +17,11 @@
 
 #include "globvar.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#define ASOFI_SIMD_X86
+#include <immintrin.h>
+#endif
+
 #ifndef STRING_SIZE
 #define STRING_SIZE 74
 #endif
@@ -42,6 +48,7 @@ static inline float myfsign(float x){ if (x>0.0) return 1; else if (x<0.0) retur
 	unsigned char e2a(unsigned char ein);
 	char * a2ev(char * inout, int len);
 	char * e2av(char * inout, int len);
+	const char * rwsegy_simd_ini(int request);
 	float * float2native(float * indata, int len, int lbendian, int ieeeibm, int meterfeet);
 	float * native2float(float * outdata, int len, int lbendian, int ieeeibm, int meterfeet);
 	/* const int a2etab[128]; */	
@@ -492,7 +499,14 @@ int DDN_rtraceh(FILE * instream, int lbendian, int ieeeibm, int meterfeet, int s
 	return n;
 }
 
-int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int susegy, int ns, float dt, float dtshift, float srctime, int traceno, int globrecno, int shotno, int recno, int comp, int trid, int ntraces, int **recpos, int **recpos_loc, float ** srcpos, int nsrc, float xcoo, float ycoo){
+/* copies len bytes of a header word to the header buffer, returns len */
+static int DDN_hput(char * hbuf, const void * word, int len){
+	memcpy(hbuf,word,len);
+	return len;
+}
+
+int DDN_etraceh(char * hbuf, int lbendian, int ieeeibm, int meterfeet, int susegy, int ns, float dt, float dtshift, float srctime, int traceno, int globrecno, int shotno, int recno, int comp, int trid, int ntraces, int **recpos, int **recpos_loc, float ** srcpos, int nsrc, float xcoo, float ycoo){
+	/* encodes the 240-byte trace header to hbuf (written by DDN_wtraceh or collectively by outseis_mpiio) */
 	/* sructure from segy.h is not used in order to access variable data portion independently */
 	/* however, using segy.h probably makes the code faster */
 
@@ -581,21 +595,21 @@ int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int
 		swap2((short *) &uns);
 	}
 	/*   1-  4 int tracl;    */ ih=tracl;  if (doswap) swap4(&ih);
-	   n+=fwrite(&ih,1,4,outstream); /* trace sequence number within line --- FOR SEISMOGRAMS: RECEIVER NO. FOR THIS SHOT */
+	   n+=DDN_hput(&hbuf[n],&ih,4); /* trace sequence number within line --- FOR SEISMOGRAMS: RECEIVER NO. FOR THIS SHOT */
 	/*   5-  8 int tracr;    */ ih=traceno;    if (doswap) swap4(&ih);
-	   n+=fwrite(&ih,1,4,outstream); /* trace sequence number within reel (jth trace in file) */
+	   n+=DDN_hput(&hbuf[n],&ih,4); /* trace sequence number within reel (jth trace in file) */
 	/*   9- 12 int fldr;     */ ih=shotno;     if (doswap) swap4(&ih);
-	   n+=fwrite(&ih,1,4,outstream); /* field record number --- FOR SEISMOGRAMS: CURENT SHOT NO. */
+	   n+=DDN_hput(&hbuf[n],&ih,4); /* field record number --- FOR SEISMOGRAMS: CURENT SHOT NO. */
 	/*  13- 16 int tracf;    */ ih=globrecno;  if (doswap) swap4(&ih);
-	   n+=fwrite(&ih,1,4,outstream); /* trace number within field record --- RECEIVER NO. */
+	   n+=DDN_hput(&hbuf[n],&ih,4); /* trace number within field record --- RECEIVER NO. */
 	/*  17- 20 int ep;       */ ih=comp;       if (doswap) swap4(&ih); 
-	   n+=fwrite(&ih,1,4,outstream); /* energy source point no. --- FOR SEISMOGRAMS: component, WARNING: ORIGINAL MEANING IS SOURCE POINT! */
+	   n+=DDN_hput(&hbuf[n],&ih,4); /* energy source point no. --- FOR SEISMOGRAMS: component, WARNING: ORIGINAL MEANING IS SOURCE POINT! */
 	/*  21- 24 int cdp;      */ ih=tracl;  if (doswap) swap4(&ih);
-	   n+=fwrite(&ih,1,4,outstream); /* CDP ensemble number --- FOR SEISMOGRAMS: RECEIVER NO. FOR THIS SHOT */
+	   n+=DDN_hput(&hbuf[n],&ih,4); /* CDP ensemble number --- FOR SEISMOGRAMS: RECEIVER NO. FOR THIS SHOT */
 	/*  25- 28 int cdpt;     */ 
-	   n+=fwrite(&ione,1,4,outstream);  /* trace number within CDP ensemble */
+	   n+=DDN_hput(&hbuf[n],&ione,4);  /* trace number within CDP ensemble */
 	/*  29- 30 short trid;   */ sh=trid;       if (doswap) swap2(&sh); 
-	   n+=fwrite(&sh,1,2,outstream); /* trace identification code:
+	   n+=DDN_hput(&hbuf[n],&sh,2); /* trace identification code:
 			1 = seismic data (SEISMOGRAM)
 			2 = dead (RECEIVER OUTSIDE MODEL)
 			3 = dummy (SOURCE and possibly receiver OUTSIDE MODEL)
@@ -615,43 +629,43 @@ int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int
 			15 = Rotated multicomponent seismic sensor - Vertical component
 			16 = Rotated multicomponent seismic sensor - Transverse component
 			17 = Rotated multicomponent seismic sensor - Radial component */
-	/*  31- 32 short nvs;    */ n+=fwrite(&sone,1,2,outstream); /* number of vertically summed traces (see vscode in bhed structure) */
-	/*  33- 34 short nhs;    */ n+=fwrite(&sone,1,2,outstream); /* number of horizontally summed traces (see vscode in bhed structure) */
-	/*  35- 36 short duse;   */ n+=fwrite(&snull,1,2,outstream); /* data use: 1 = production, 2 = test */
-	/*  37- 40 int offset;   */ n+=fwrite(&offset,1,4,outstream); /* distance from source point to receiver group 
+	/*  31- 32 short nvs;    */ n+=DDN_hput(&hbuf[n],&sone,2); /* number of vertically summed traces (see vscode in bhed structure) */
+	/*  33- 34 short nhs;    */ n+=DDN_hput(&hbuf[n],&sone,2); /* number of horizontally summed traces (see vscode in bhed structure) */
+	/*  35- 36 short duse;   */ n+=DDN_hput(&hbuf[n],&snull,2); /* data use: 1 = production, 2 = test */
+	/*  37- 40 int offset;   */ n+=DDN_hput(&hbuf[n],&offset,4); /* distance from source point to receiver group 
 	                                 (CAUTION: should be negative if opposite to direction in which the line was shot) */
-	/*  41- 44 int gelev;    */ n+=fwrite(&gcoo[2],1,4,outstream); /* receiver group elevation from sea level (above sea level is positive)
+	/*  41- 44 int gelev;    */ n+=DDN_hput(&hbuf[n],&gcoo[2],4); /* receiver group elevation from sea level (above sea level is positive)
 									  --- CAUTION: SEISMOGRAMS: Y rec. coordinate */
-	/*  45- 48 int selev;    */ n+=fwrite(&scoo[2],1,4,outstream); /* source elevation from sea level (above sea level is positive)
+	/*  45- 48 int selev;    */ n+=DDN_hput(&hbuf[n],&scoo[2],4); /* source elevation from sea level (above sea level is positive)
 									  --- CAUTION: SEISMOGRAMS: Y source coordinate  */
-	/*  49- 52 int sdepth;   */ n+=fwrite(&scoo[2],1,4,outstream); /* source depth (positive) --- SEISMOGRAMS: Y source coordinate  */
-	/*  53- 56 int gdel;     */ n+=fwrite(&gdel,1,4,outstream);    /* datum elevation at receiver group 
+	/*  49- 52 int sdepth;   */ n+=DDN_hput(&hbuf[n],&scoo[2],4); /* source depth (positive) --- SEISMOGRAMS: Y source coordinate  */
+	/*  53- 56 int gdel;     */ n+=DDN_hput(&hbuf[n],&gdel,4);    /* datum elevation at receiver group 
 									  --- WARNING: SEISMOGRAMS: DIRECTIVITY NON-STANDARD */
-	/*  57- 60 int sdel;     */ n+=fwrite(&inull,1,4,outstream);    /* datum elevation at source */
-	/*  61- 64 int swdep;    */ n+=fwrite(&inull,1,4,outstream); /* water depth at source */
-	/*  65- 68 int gwdep;    */ n+=fwrite(&gwdep,1,4,outstream); /* water depth at receiver group 
+	/*  57- 60 int sdel;     */ n+=DDN_hput(&hbuf[n],&inull,4);    /* datum elevation at source */
+	/*  61- 64 int swdep;    */ n+=DDN_hput(&hbuf[n],&inull,4); /* water depth at source */
+	/*  65- 68 int gwdep;    */ n+=DDN_hput(&hbuf[n],&gwdep,4); /* water depth at receiver group 
 									--- WARNING: SEISMOGRAMS: DIRECTIVITY NON-STANDARD */
-	/*  69- 70 short scalel; */ n+=fwrite(&scalef,1,2,outstream); /* scale factor for previous 7 entries with value plus or minus 10 to the
+	/*  69- 70 short scalel; */ n+=DDN_hput(&hbuf[n],&scalef,2); /* scale factor for previous 7 entries with value plus or minus 10 to the
 			                                               power 0, 1, 2, 3, or 4 (if positive, multiply, if negative divide) */
-	/*  71- 72 short scalco; */ n+=fwrite(&scalef,1,2,outstream); /* scale factor for next 4 entries with value plus or minus 10 to the
+	/*  71- 72 short scalco; */ n+=DDN_hput(&hbuf[n],&scalef,2); /* scale factor for next 4 entries with value plus or minus 10 to the
 			                                               power 0, 1, 2, 3, or 4 (if positive, multiply, if negative divide) */
-	/*  73- 76 int  sx;      */ n+=fwrite(&scoo[0],1,4,outstream); /* X source coordinate */
-	/*  77- 80 int  sy;      */ n+=fwrite(&scoo[1],1,4,outstream); /* Y source coordinate */
-	/*  81- 84 int  gx;      */ n+=fwrite(&gcoo[0],1,4,outstream); /* X group coordinate  */
-	/*  85- 88 int  gy;      */ n+=fwrite(&gcoo[1],1,4,outstream); /* Y group coordinate  */
-	/*  89- 90 short counit; */ n+=fwrite(&sone,1,2,outstream); /* coordinate units code: for previous four entries
+	/*  73- 76 int  sx;      */ n+=DDN_hput(&hbuf[n],&scoo[0],4); /* X source coordinate */
+	/*  77- 80 int  sy;      */ n+=DDN_hput(&hbuf[n],&scoo[1],4); /* Y source coordinate */
+	/*  81- 84 int  gx;      */ n+=DDN_hput(&hbuf[n],&gcoo[0],4); /* X group coordinate  */
+	/*  85- 88 int  gy;      */ n+=DDN_hput(&hbuf[n],&gcoo[1],4); /* Y group coordinate  */
+	/*  89- 90 short counit; */ n+=DDN_hput(&hbuf[n],&sone,2); /* coordinate units code: for previous four entries
 				1 = length (meters or feet),
 				2 = seconds of arc (X = longitude; Y = latitude,
 				    a positive value designates the number of seconds east of Greenwich	or north of the equator) */
-	/*  91- 92 short wevel;  */ n+=fwrite(&snull,1,2,outstream); /* weathering velocity */
-	/*  93- 94 short swevel; */ n+=fwrite(&snull,1,2,outstream); /* subweathering velocity */
-	/*  95- 96 short sut;    */ n+=fwrite(&snull,1,2,outstream); /* uphole time at source */
-	/*  97- 98 short gut;    */ n+=fwrite(&snull,1,2,outstream); /* uphole time at receiver group */
-	/*  99-100 short sstat;	 */ n+=fwrite(&snull,1,2,outstream); /* source static correction */
-	/* 101-102 short gstat;	 */ n+=fwrite(&snull,1,2,outstream); /* group static correction */
-	/* 103-104 short tstat;	 */ n+=fwrite(&snull,1,2,outstream); /* total static applied */
+	/*  91- 92 short wevel;  */ n+=DDN_hput(&hbuf[n],&snull,2); /* weathering velocity */
+	/*  93- 94 short swevel; */ n+=DDN_hput(&hbuf[n],&snull,2); /* subweathering velocity */
+	/*  95- 96 short sut;    */ n+=DDN_hput(&hbuf[n],&snull,2); /* uphole time at source */
+	/*  97- 98 short gut;    */ n+=DDN_hput(&hbuf[n],&snull,2); /* uphole time at receiver group */
+	/*  99-100 short sstat;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* source static correction */
+	/* 101-102 short gstat;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* group static correction */
+	/* 103-104 short tstat;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* total static applied */
 	sh=(int)-floor(dtshift*1e6+0.5); if (doswap) swap2(&sh); /* time break = strat of the modeling = 0 */
-	/* 105-106 short laga;   */ n+=fwrite(&sh,1,2,outstream);
+	/* 105-106 short laga;   */ n+=DDN_hput(&hbuf[n],&sh,2);
 			/* lag time A, time in ms between end of 240-
 			   byte trace identification header and time
 			   break, positive if time break occurs after
@@ -660,85 +674,85 @@ int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int
 			   on an auxiliary trace or as otherwise
 			   specified by the recording system */
 	sh=(int)floor(srctime*1e6+0.5); if (doswap) swap2(&sh);		   
-	/* 107-108 short lagb;   */ n+=fwrite(&sh,1,2,outstream);
+	/* 107-108 short lagb;   */ n+=DDN_hput(&hbuf[n],&sh,2);
 			/* lag time B, time in ms between the time break
 			   and the initiation time of the energy source,
 			   may be positive or negative */
 	sh=(int)floor((dtshift-srctime)*1e6+0.5); if (doswap) swap2(&sh);		   
-	/* 109-110 short delrt;  */ n+=fwrite(&sh,1,2,outstream);
+	/* 109-110 short delrt;  */ n+=DDN_hput(&hbuf[n],&sh,2);
 			/* delay recording time, time in ms between
 			   initiation time of energy source and time
 			   when recording of data samples begins
 			   (for deep water work if recording does not
 			   start at zero time) */
-	/* 111-112 short muts;   */ n+=fwrite(&snull,1,2,outstream); /* mute time--start */
-	/* 113-114 short mute;   */ n+=fwrite(&snull,1,2,outstream); /* mute time--end */
-	/* 115-116 unsigned short ns; */ n+=fwrite(&uns,1,2,outstream); /* number of samples in this trace */
-	/* 117-118 unsigned short dt; */ n+=fwrite(&udt,1,2,outstream); /* sample interval; in micro-seconds */
-	/* 119-120 short gain;	 */ n+=fwrite(&snull,1,2,outstream); /* gain type of field instruments code:
+	/* 111-112 short muts;   */ n+=DDN_hput(&hbuf[n],&snull,2); /* mute time--start */
+	/* 113-114 short mute;   */ n+=DDN_hput(&hbuf[n],&snull,2); /* mute time--end */
+	/* 115-116 unsigned short ns; */ n+=DDN_hput(&hbuf[n],&uns,2); /* number of samples in this trace */
+	/* 117-118 unsigned short dt; */ n+=DDN_hput(&hbuf[n],&udt,2); /* sample interval; in micro-seconds */
+	/* 119-120 short gain;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* gain type of field instruments code:
 				1 = fixed,2 = binary, 3 = floating point, 4 ---- N = optional use */
-	/* 121-122 short igc;	 */ n+=fwrite(&snull,1,2,outstream); /* instrument gain constant */
-	/* 123-124 short igi;	 */ n+=fwrite(&snull,1,2,outstream); /* instrument early or initial gain */
-	/* 125-126 short corr;	 */ n+=fwrite(&sone,1,2,outstream); /* correlated: 1 = no, 2 = yes */
-	/* 127-128 short sfs;	 */ n+=fwrite(&snull,1,2,outstream); /* sweep frequency at start */
-	/* 129-130 short sfe;	 */ n+=fwrite(&snull,1,2,outstream); /* sweep frequency at end */
-	/* 131-132 short slen;	 */ n+=fwrite(&snull,1,2,outstream); /* sweep length in ms */
-	/* 133-134 short styp;	 */ n+=fwrite(&snull,1,2,outstream); /* sweep type code:
+	/* 121-122 short igc;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* instrument gain constant */
+	/* 123-124 short igi;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* instrument early or initial gain */
+	/* 125-126 short corr;	 */ n+=DDN_hput(&hbuf[n],&sone,2); /* correlated: 1 = no, 2 = yes */
+	/* 127-128 short sfs;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* sweep frequency at start */
+	/* 129-130 short sfe;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* sweep frequency at end */
+	/* 131-132 short slen;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* sweep length in ms */
+	/* 133-134 short styp;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* sweep type code:
 				1 = linear, 2 = parapolic,   3 = exponential, 4 = other */
-	/* 135-136 short stas;   */ n+=fwrite(&snull,1,2,outstream); /* sweep trace taper length at start in ms */
-	/* 137-138 short stae;   */ n+=fwrite(&snull,1,2,outstream); /* sweep trace taper length at end in ms */
-	/* 139-140 short tatyp;  */ n+=fwrite(&snull,1,2,outstream); /* sweep taper type code : 1=linear, 2=cos^2, 3=other */
-	/* 141-142 short afilf;  */ n+=fwrite(&snull,1,2,outstream); /* alias filter frequency if used */
-	/* 143-144 short afils;  */ n+=fwrite(&snull,1,2,outstream); /* alias filter slope */
-	/* 145-146 short nofilf; */ n+=fwrite(&snull,1,2,outstream); /* notch filter frequency if used */
-	/* 147-148 short nofils; */ n+=fwrite(&snull,1,2,outstream); /* notch filter slope */
-	/* 149-150 short lcf;	 */ n+=fwrite(&snull,1,2,outstream); /* low cut frequency if used */
-	/* 151-152 short hcf;	 */ n+=fwrite(&snull,1,2,outstream); /* high cut frequncy if used */
-	/* 153-154 short lcs;	 */ n+=fwrite(&snull,1,2,outstream); /* low cut slope */
-	/* 155-156 short hcs;	 */ n+=fwrite(&snull,1,2,outstream); /* high cut slope */
-	/* 157-158 short year;   */ n+=fwrite(&snull,1,2,outstream); /* year data recorded */
-	/* 159-160 short day;	 */ n+=fwrite(&snull,1,2,outstream); /* day of year */
-	/* 161-162 short hour;   */ n+=fwrite(&snull,1,2,outstream); /* hour of day (24 hour clock) */
-	/* 163-164 short minute; */ n+=fwrite(&snull,1,2,outstream); /* minute of hour */
-	/* 165-166 short sec;	 */ n+=fwrite(&snull,1,2,outstream); /* second of minute */
-	/* 167-168 short timbas; */ n+=fwrite(&snull,1,2,outstream); /* time basis code: 1 = local, 2 = GMT, 3 = other */
-	/* 169-170 short trwf;	 */ n+=fwrite(&snull,1,2,outstream); /* trace weighting factor, i.e. 1/2^N  volts for the least sigificant bit */
-	/* 171-172 short grnors; */ n+=fwrite(&snull,1,2,outstream); /* geophone group number of roll switch  position one */
-	/* 173-174 short grnofr; */ n+=fwrite(&snull,1,2,outstream); /* geophone group number of trace one within original field record */
-	/* 175-176 short grnlof; */ n+=fwrite(&snull,1,2,outstream); /* geophone group number of last trace within original field record */
-	/* 177-178 short gaps;	 */ n+=fwrite(&snull,1,2,outstream); /* gap size (total number of groups dropped) */
-	/* 179-180 short otrav;	 */ n+=fwrite(&snull,1,2,outstream); /* overtravel taper code: 1 = down (or behind), 2 = up (or ahead) */
+	/* 135-136 short stas;   */ n+=DDN_hput(&hbuf[n],&snull,2); /* sweep trace taper length at start in ms */
+	/* 137-138 short stae;   */ n+=DDN_hput(&hbuf[n],&snull,2); /* sweep trace taper length at end in ms */
+	/* 139-140 short tatyp;  */ n+=DDN_hput(&hbuf[n],&snull,2); /* sweep taper type code : 1=linear, 2=cos^2, 3=other */
+	/* 141-142 short afilf;  */ n+=DDN_hput(&hbuf[n],&snull,2); /* alias filter frequency if used */
+	/* 143-144 short afils;  */ n+=DDN_hput(&hbuf[n],&snull,2); /* alias filter slope */
+	/* 145-146 short nofilf; */ n+=DDN_hput(&hbuf[n],&snull,2); /* notch filter frequency if used */
+	/* 147-148 short nofils; */ n+=DDN_hput(&hbuf[n],&snull,2); /* notch filter slope */
+	/* 149-150 short lcf;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* low cut frequency if used */
+	/* 151-152 short hcf;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* high cut frequncy if used */
+	/* 153-154 short lcs;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* low cut slope */
+	/* 155-156 short hcs;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* high cut slope */
+	/* 157-158 short year;   */ n+=DDN_hput(&hbuf[n],&snull,2); /* year data recorded */
+	/* 159-160 short day;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* day of year */
+	/* 161-162 short hour;   */ n+=DDN_hput(&hbuf[n],&snull,2); /* hour of day (24 hour clock) */
+	/* 163-164 short minute; */ n+=DDN_hput(&hbuf[n],&snull,2); /* minute of hour */
+	/* 165-166 short sec;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* second of minute */
+	/* 167-168 short timbas; */ n+=DDN_hput(&hbuf[n],&snull,2); /* time basis code: 1 = local, 2 = GMT, 3 = other */
+	/* 169-170 short trwf;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* trace weighting factor, i.e. 1/2^N  volts for the least sigificant bit */
+	/* 171-172 short grnors; */ n+=DDN_hput(&hbuf[n],&snull,2); /* geophone group number of roll switch  position one */
+	/* 173-174 short grnofr; */ n+=DDN_hput(&hbuf[n],&snull,2); /* geophone group number of trace one within original field record */
+	/* 175-176 short grnlof; */ n+=DDN_hput(&hbuf[n],&snull,2); /* geophone group number of last trace within original field record */
+	/* 177-178 short gaps;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* gap size (total number of groups dropped) */
+	/* 179-180 short otrav;	 */ n+=DDN_hput(&hbuf[n],&snull,2); /* overtravel taper code: 1 = down (or behind), 2 = up (or ahead) */
 	if (susegy==1){
 	 ih=(int)floor(xcoo*scalefac+0.5); if (doswap) swap4(&ih); /* 1st horizontal coordinate for models (in SOFI3D ususally X) */
-	 /* 181-184 int ???;      */ n+=fwrite(&ih,1,4,outstream);   /* X coordinate of ensemble (CDP) position of this trace (scalar in Trace
+	 /* 181-184 int ???;      */ n+=DDN_hput(&hbuf[n],&ih,4);   /* X coordinate of ensemble (CDP) position of this trace (scalar in Trace
 									 Header bytes 71-72 applies). The coordinate reference system should be
 									 identified through an extended header Location Data stanza. */
 	 ih=(int)floor(ycoo*scalefac+0.5); if (doswap) swap4(&ih); /* 2nd horizontal coordinate for models (in SOFI3D ususally Z) */
-	 /* 185-188 int ???;      */ n+=fwrite(&ih,1,4,outstream);   /* Y coordinate of ensemble (CDP) position of this trace (scalar in Trace
+	 /* 185-188 int ???;      */ n+=DDN_hput(&hbuf[n],&ih,4);   /* Y coordinate of ensemble (CDP) position of this trace (scalar in Trace
 									 Header bytes 71-72 applies). The coordinate reference system should be
 									 identified through an extended header Location Data stanza. */
-	 /* 189-192 int ???;      */ n+=fwrite(&inull,1,4,outstream);   /* For 3-D poststack data, this field should be used for the in-line
+	 /* 189-192 int ???;      */ n+=DDN_hput(&hbuf[n],&inull,4);   /* For 3-D poststack data, this field should be used for the in-line
 	 								 number. If one in-line per SEG Y file is being recorded, this value 
 									 should be the same for all traces in the file and the same value will 
 									 be recorded in bytes 3205-3208 of the Binary File Header. */
-	 /* 193-196 int ???;      */ n+=fwrite(&inull,1,4,outstream);   /* For 3-D poststack data, this field should be used for the cross-line
+	 /* 193-196 int ???;      */ n+=DDN_hput(&hbuf[n],&inull,4);   /* For 3-D poststack data, this field should be used for the cross-line
 									 number.  This will typically be the same value as the ensemble (CDP)
 									 number in Trace Header bytes 21-24, but this does not have to be the 
 									 case. */
 	 ih=shotno; if (doswap) swap4(&ih);
-	 /* 197-200 int ???;      */ n+=fwrite(&ih,1,4,outstream);     /* Shotpoint number - This is probably only applicable to 2-D poststack 
+	 /* 197-200 int ???;      */ n+=DDN_hput(&hbuf[n],&ih,4);     /* Shotpoint number - This is probably only applicable to 2-D poststack 
 									 data. - Note that it is assumed that the shotpoint number refers to the
 									 source location nearest to the ensemble (CDP) location for a particular
 									 trace.  If this is not the case, there should be a comment in the Textual
 									 File Header explaining what the  shotpoint number actually refers to. */
-	 /* 201-202 short ???;    */ n+=fwrite(&snull,1,2,outstream);   /* Scalar to be applied to the shotpoint number in Trace Header bytes 
+	 /* 201-202 short ???;    */ n+=DDN_hput(&hbuf[n],&snull,2);   /* Scalar to be applied to the shotpoint number in Trace Header bytes 
 									 197-200 to  give the real value. If positive, scalar is used as 
 									 multiplier; if negative as a divisor; if zero the shotpoint number is not
 									 scaled (i.e. it is an integer. A typical value will be -10, allowing
 									 shotpoint numbers with one decimal digit to the right of the decimal
 									 point). */
 									 
-	 /* 203-204 short ???;    */ n+=fwrite(&snull,1,2,outstream);   /* Trace value measurement unit:  
+	 /* 203-204 short ???;    */ n+=DDN_hput(&hbuf[n],&snull,2);   /* Trace value measurement unit:  
 									 -1 = Other (should be described in Data Sample Measurement Units Stanza) 
 								          0 = Unknown    
 									  1 = Pascal (Pa)    
@@ -751,15 +765,15 @@ int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int
 									  8 = Newton (N) 
 									  9 = Watt (W) 	*/
 									  
-	 /* 205-208 int ???;    */ n+=fwrite(&inull,1,4,outstream);     /* see bytes 209-210! */
-	 /* 209-210 short ???;  */ n+=fwrite(&snull,1,2,outstream);     /* Transduction Constant - The multiplicative constant used to convert the 
+	 /* 205-208 int ???;    */ n+=DDN_hput(&hbuf[n],&inull,4);     /* see bytes 209-210! */
+	 /* 209-210 short ???;  */ n+=DDN_hput(&hbuf[n],&snull,2);     /* Transduction Constant - The multiplicative constant used to convert the 
 									 Data  Trace samples to the Transduction Units (specified in Trace Header
 									 bytes 211- 212).  The constant is encoded as a four-byte, two's 
 									 complement integer (bytes 205-208) which is the mantissa and a two-byte,
 									 two's complement integer (bytes 209-210) which is the power of ten
 									 exponent (i.e. Bytes 205-208 * 10**Bytes  209-210).  */
 									 
-	 /* 211-212 short ???;  */ n+=fwrite(&snull,1,2,outstream);     /* Transduction Units - The unit of measurement of the Data Trace samples
+	 /* 211-212 short ???;  */ n+=DDN_hput(&hbuf[n],&snull,2);     /* Transduction Units - The unit of measurement of the Data Trace samples
 									 after  they have been multiplied by the Transduction Constant specified 
 									 in Trace  Header bytes 205-210.
 									 0 = Unknown    
@@ -772,18 +786,18 @@ int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int
 									 7 = Meters per second squared (m/s2)
 									 8 = Newton (N) 
 									 9 = Watt (W)  */
-	 /* 213-214 short ???;  */ n+=fwrite(&snull,1,2,outstream);     /* Device/Trace Identifier ? The unit number or id number of the device
+	 /* 213-214 short ???;  */ n+=DDN_hput(&hbuf[n],&snull,2);     /* Device/Trace Identifier ? The unit number or id number of the device
 									 associated  with the Data Trace (i.e. 4368 for vibrator serial number 
 									 4368 or 20316 for gun 16 on string 3 on vessel 2).  This field allows
 									 traces to be associated across trace ensembles independently of the 
 									 trace number (Trace Header bytes 25-28). */
-	 /* 215-216 short ???;  */ n+=fwrite(&snull,1,2,outstream);     /* Scalar to be applied to times specified in Trace Header bytes 95-114 to
+	 /* 215-216 short ???;  */ n+=DDN_hput(&hbuf[n],&snull,2);     /* Scalar to be applied to times specified in Trace Header bytes 95-114 to
 									 give the  true time value in milliseconds.  Scalar = 1, +10, +100, +1000,
 									 or +10,000.  If positive, scalar is used as a multiplier; if negative,
 									 scalar is used as divisor.  A  value of zero is assumed to be a scalar
 									 value of 1. */
 									 
-	 /* 217-218 short ???;  */ n+=fwrite(&snull,1,2,outstream);     /* Source Type/Orientation ? Defines the type and the orientation of the
+	 /* 217-218 short ???;  */ n+=DDN_hput(&hbuf[n],&snull,2);     /* Source Type/Orientation ? Defines the type and the orientation of the
 									 energy  source.  The terms vertical, cross-line and in-line refer to the
 									 three axes of an  orthogonal coordinate system.  The absolute azimuthal
 									 orientation of the  coordinate system axes can be defined in the Bin Grid
@@ -799,13 +813,13 @@ int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int
 									 7 = Distributed Impulsive - Vertical orientation 
 									 8 = Distributed Impulsive - Cross-line orientation 
 									 9 = Distributed Impulsive - In-line orientation */
- 	 /* 219-224 ?!?!? ???;  */ n+=fwrite(&snull,1,2,outstream);
-		    		  n+=fwrite(&inull,1,4,outstream);     /* Source Energy Direction with respect to the source orientation  - The
+ 	 /* 219-224 ?!?!? ???;  */ n+=DDN_hput(&hbuf[n],&snull,2);
+		    		  n+=DDN_hput(&hbuf[n],&inull,4);     /* Source Energy Direction with respect to the source orientation  - The
 									 positive  orientation direction is defined in Bytes 217-218 of the Trace
 									 Header.  The energy direction is encoded in tenths of degrees 
 									 (i.e. 347.8� is encoded as 3478). */ 							 
-	 /* 225-228 int ???;    */ n+=fwrite(&inull,1,4,outstream);     /* see bytes 229-230! */
-	 /* 229-230 short ???;  */ n+=fwrite(&snull,1,2,outstream);     /* Measurement - Describes the source effort used to generate the
+	 /* 225-228 int ???;    */ n+=DDN_hput(&hbuf[n],&inull,4);     /* see bytes 229-230! */
+	 /* 229-230 short ???;  */ n+=DDN_hput(&hbuf[n],&snull,2);     /* Measurement - Describes the source effort used to generate the
 									 trace.   The measurement can be simple, qualitative measurements such as
 									 the total  weight of explosive used or the peak air gun pressure or the
 									 number of vibrators  	times the sweep duration.  Although these simple
@@ -815,7 +829,7 @@ int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int
 									 two's complement integer (bytes 209-230) which is the power of ten
 									 exponent (i.e. Bytes 225-228 * 10**Bytes 229- 230). */
 									 
-	 /* 231-232 short ???;  */ n+=fwrite(&snull,1,2,outstream);     /* Source Measurement Unit - The unit used for the Source Measurement, 
+	 /* 231-232 short ???;  */ n+=DDN_hput(&hbuf[n],&snull,2);     /* Source Measurement Unit - The unit used for the Source Measurement, 
 	 								   Trace header bytes 225-230.  
 									 -1 = Other (should be described in Source Measurement Unit stanza)   
 									  0 = Unknown    
@@ -827,28 +841,37 @@ int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int
 									  5 = Newton (N) 
 									  6 = Kilograms (kg) */
   
-	 /* 233-240 int[2] ???;    */ n+=fwrite(&inull,1,4,outstream); 
-	 			     n+=fwrite(&inull,1,4,outstream);  /* Unassigned ? For optional information. */
+	 /* 233-240 int[2] ???;    */ n+=DDN_hput(&hbuf[n],&inull,4); 
+	 			     n+=DDN_hput(&hbuf[n],&inull,4);  /* Unassigned ? For optional information. */
 	}
 	else { /* local SU assignments */
 		/* 181-184 float d1;     */ fh=dt; native2float(&fh, 1, lbendian, ieeeibm, 0);
-	   	   			    n+=fwrite(&fh,1,4,outstream); /* sample spacing for non-seismic data */
-		/* 185-188 float f1;     */ n+=fwrite(&fnull,1,4,outstream); /* first sample location for non-seismic data */
-		/* 189-192 float d2;     */ n+=fwrite(&fnull,1,4,outstream); /* sample spacing between traces */
-		/* 193-296 float f2;     */ n+=fwrite(&fnull,1,4,outstream); /* first trace location */
-		/* 197-200 float ungpow; */ n+=fwrite(&fnull,1,4,outstream); /* negative of power used for dynamic range compression */
-		/* 201-204 float unscale;*/ n+=fwrite(&fnull,1,4,outstream); /* reciprocal of scaling factor to normalize range */
+	   	   			    n+=DDN_hput(&hbuf[n],&fh,4); /* sample spacing for non-seismic data */
+		/* 185-188 float f1;     */ n+=DDN_hput(&hbuf[n],&fnull,4); /* first sample location for non-seismic data */
+		/* 189-192 float d2;     */ n+=DDN_hput(&hbuf[n],&fnull,4); /* sample spacing between traces */
+		/* 193-296 float f2;     */ n+=DDN_hput(&hbuf[n],&fnull,4); /* first trace location */
+		/* 197-200 float ungpow; */ n+=DDN_hput(&hbuf[n],&fnull,4); /* negative of power used for dynamic range compression */
+		/* 201-204 float unscale;*/ n+=DDN_hput(&hbuf[n],&fnull,4); /* reciprocal of scaling factor to normalize range */
 		/* 205-208 int ntr;      */ ih=ntraces;  if (doswap) swap4(&ih);
-		   n+=fwrite(&ih,1,4,outstream); /* number of traces --- NUMBER OF TRACE IN FILE */
-		/* 209-210 short mark;   */ n+=fwrite(&snull,1,2,outstream); /* mark selected traces */
-       		/* 211-212 short shortpad; */ n+=fwrite(&snull,1,2,outstream); /* alignment padding */
-		/* 213-240 short unass[14] */ for (m=0;m<14;m++) n+=fwrite(&snull,1,2,outstream); /* unassigned */
+		   n+=DDN_hput(&hbuf[n],&ih,4); /* number of traces --- NUMBER OF TRACE IN FILE */
+		/* 209-210 short mark;   */ n+=DDN_hput(&hbuf[n],&snull,2); /* mark selected traces */
+       		/* 211-212 short shortpad; */ n+=DDN_hput(&hbuf[n],&snull,2); /* alignment padding */
+		/* 213-240 short unass[14] */ for (m=0;m<14;m++) n+=DDN_hput(&hbuf[n],&snull,2); /* unassigned */
 	}
-	if (n!=240) fprintf(curerr,"Warning [wtraceh]: segy-header consists of %d bytes instead of 240?!\n",n);
+	if (n!=240) fprintf(curerr,"Warning [etraceh]: segy-header consists of %d bytes instead of 240?!\n",n);
 	return n;
 }
 
 	
+int DDN_wtraceh(FILE * outstream, int lbendian, int ieeeibm, int meterfeet, int susegy, int ns, float dt, float dtshift, float srctime, int traceno, int globrecno, int shotno, int recno, int comp, int trid, int ntraces, int **recpos, int **recpos_loc, float ** srcpos, int nsrc, float xcoo, float ycoo){
+	/* writes the trace header encoded by DDN_etraceh */
+	char hbuf[240];
+	int n;
+	if (outstream==NULL) return 0;
+	n=DDN_etraceh(hbuf, lbendian, ieeeibm, meterfeet, susegy, ns, dt, dtshift, srctime, traceno, globrecno, shotno, recno, comp, trid, ntraces, recpos, recpos_loc, srcpos, nsrc, xcoo, ycoo);
+	return fwrite(hbuf,1,n,outstream);
+}
+
 /* reading and writing binary data */
 
 int DDN_rbindata(FILE * instream, int inlen, float * outdata, int outlen, int first, int step, int padding, int lbendian, int ieeeibm, int meterfeet){
@@ -1341,6 +1364,73 @@ float * ft2m(float * iovec, int len){
 }
 
 
+/* vectorized conversion of the samples
+
+   The byte swap and the conversion between IEEE and IBM floats of whole
+   traces are done with AVX2 (8 samples per iteration) if the CPU supports
+   it; the remaining samples are converted by the scalar loops.  The results
+   are identical to the scalar loops.  The kernels are compiled with target
+   attributes, so no special compiler flags are needed.  See segybench.c for
+   a microbenchmark. */
+
+static int simd=-1; /* 1: AVX2, 0: scalar loops, -1: not selected yet */
+
+const char * rwsegy_simd_ini(int request){ /* 0: fastest available, 1: scalar loops, 2: AVX2 */
+	simd=0;
+#ifdef ASOFI_SIMD_X86
+	if (request!=1) {
+		__builtin_cpu_init();
+		simd=__builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+#else
+	(void) request;
+#endif
+	return simd ? "AVX2" : "none (scalar loops)";
+}
+
+static inline int rwsegy_simd(void){
+	if (simd<0) rwsegy_simd_ini(0);
+	return simd;
+}
+
+#ifdef ASOFI_SIMD_X86
+__attribute__((target("avx2")))
+static int swap4v_avx2(int * ip, int n){ /* returns the number of swapped values */
+	const __m256i rev=_mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+	                                   3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+	int i;
+	for (i=0;i+8<=n;i+=8)
+		_mm256_storeu_si256((__m256i *)&ip[i],
+			_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)&ip[i]),rev));
+	return i;
+}
+
+__attribute__((target("avx2")))
+static int ieee2ibmv_avx2(int * ieee, int n){ /* returns the number of converted values */
+	const __m256i zero=_mm256_setzero_si256(), three=_mm256_set1_epi32(3);
+	const __m256i sign=_mm256_set1_epi32((int)0x80000000), nosign=_mm256_set1_epi32(0x7fffffff);
+	const __m256i frac=_mm256_set1_epi32(0x007fffff), hidden=_mm256_set1_epi32(0x00800000);
+	const __m256i expo=_mm256_set1_epi32(0x7f800000);
+	const __m256i c64=_mm256_set1_epi32(64), c126=_mm256_set1_epi32(126);
+	__m256i h, m, d, s, r;
+	int i;
+	for (i=0;i+8<=n;i+=8) {
+		h=_mm256_loadu_si256((const __m256i *)&ieee[i]);
+		m=_mm256_or_si256(_mm256_and_si256(h,frac),hidden);
+		d=_mm256_sub_epi32(_mm256_srli_epi32(_mm256_and_si256(h,expo),23),c126);
+		/* shift of the mantissa to a base-16 exponent: s=(-d)&3 */
+		s=_mm256_and_si256(_mm256_sub_epi32(zero,d),three);
+		m=_mm256_srlv_epi32(m,s);
+		d=_mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(d,s),2),c64);
+		r=_mm256_or_si256(_mm256_or_si256(_mm256_and_si256(h,sign),_mm256_slli_epi32(d,24)),m);
+		r=_mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(h,nosign),zero),r);
+		_mm256_storeu_si256((__m256i *)&ieee[i],r);
+	}
+	return i;
+}
+#endif
+
+
 /* swapping bytes */
 
 short * swap2(short * ip) { /* swap bytes of any 2-bytes pointer */
@@ -1354,8 +1444,11 @@ int * swap4(int * ip) { /* swap bytes of any 4-bytes pointer */
 }
 
 float * swap4fv(float * fp, int len){/* swap bytes of a vector of 4-bytes floats */
-	int n;
-	for (n=0;n<len;n++) swap4((int *)&fp[n]);
+	int n=0;
+#ifdef ASOFI_SIMD_X86
+	if (rwsegy_simd()) n=swap4v_avx2((int *)fp, len);
+#endif
+	for (;n<len;n++) swap4((int *)&fp[n]);
 	return (float *)fp;
 }
 
@@ -1363,8 +1456,7 @@ float * swap4fv(float * fp, int len){/* swap bytes of a vector of 4-bytes floats
 /* converting any 4-byte floats to native 4-byte floats and vice versa (meter (SI system) = native) */
 
 float * float2native(float * indata, int len, int lbendian, int ieeeibm, int meterfeet){
-	int n;
-	if (lbendian!=LITTLEBIG) for (n=0;n<len;n++) swap4((int *) &indata[n]);
+	if (lbendian!=LITTLEBIG) swap4fv(indata, len);
 	if ((!ieeeibm)&&IEEEIBM) ieee2ibmv((int*) indata, len);
 	else if ((ieeeibm)&&(!IEEEIBM)) ibm2ieeev((int*) indata, len);
 	if (meterfeet) m2ft(indata, len);
@@ -1372,11 +1464,10 @@ float * float2native(float * indata, int len, int lbendian, int ieeeibm, int met
 }
 
 float * native2float(float * outdata, int len, int lbendian, int ieeeibm, int meterfeet){
-	int n;
 	if (meterfeet) ft2m(outdata, len);
 	if ((!ieeeibm)&&IEEEIBM) ibm2ieeev((int*) outdata, len);
 	else if ((ieeeibm)&&(!IEEEIBM)) ieee2ibmv((int*) outdata, len);
-	if (lbendian!=LITTLEBIG) for (n=0;n<len;n++) swap4((int *) &outdata[n]);
+	if (lbendian!=LITTLEBIG) swap4fv(outdata, len);
 	return outdata;
 }
 
@@ -1391,36 +1482,36 @@ int * ieee2ibmv(int * ieee, int n) /* converting a vector of ieee floats into ib
 		fprintf(curerr,"Error [ieee2ibm]: sizeof(int)!=4. \n");	return NULL;}
 	if (sizeof(float)!=4) {
 		fprintf(curerr,"Error [ieee2ibm]: sizeof(float)!=4. \n"); return NULL;}			
-	for (i=0;i<n;++i) {
+	i=0;
+#ifdef ASOFI_SIMD_X86
+	if (rwsegy_simd()) i=ieee2ibmv_avx2(ieee, n);
+#endif
+	for (;i<n;++i) {
 		h=ieee[i];
-		if (h) {
+		if (h&0x7fffffff) {
 	    		m=(0x007fffff&h)|0x00800000;
 	    		d=(int)((0x7f800000&h)>>23)-126;
 	    		while (d&0x3) {m>>=1; d++;}
 	    		h=(0x80000000&h)|(((d>>2)+64)<< 24)|m;
 		}
+		else h=0; /* -0.0 as well */
 		ieee[i]=h;
 	}
 	return ieee;
 }
 
 
-int * ibm2ieeev(int * ibm, int n) /* converting a vector of ibm floats into ieee floats */
+static void ibm2ieee_scalar(int * ibm, int i1, int i2) /* converting ibm[i1] ... ibm[i2-1] */
 {
 	int h, m, i, d;
-	if (curerr==NULL) curerr=FP;
-	if (sizeof(int)!=4) {
-		fprintf(curerr,"Error [ibm2ieee]: sizeof(int)!=4. \n");	return NULL;}
-	if (sizeof(float)!=4) {
-		fprintf(curerr,"Error [ibm2ieee]: sizeof(float)!=4. \n"); return NULL;}		
-	for (i=0;i<n;++i) {
-		h=ibm[i];		
+	for (i=i1;i<i2;++i) {
+		h=ibm[i];
 	if (h) {
 		m=0x00ffffff&h;
-		if (m) {	
+		if (m) {
 			d=(int)((0x7f000000&h)>>22)-130;
 			while (!(m&0x00800000)) {
-				m<<=1;			
+				m<<=1;
 				d--;
 			}
 			if (d>254) h=(0x80000000&h)|0x7f7fffff;
@@ -1434,6 +1525,55 @@ int * ibm2ieeev(int * ibm, int n) /* converting a vector of ibm floats into ieee
 	}
 	ibm[i]=h;
 	}
+}
+
+#ifdef ASOFI_SIMD_X86
+__attribute__((target("avx2")))
+static void ibm2ieee_avx2(int * ibm, int n)
+{
+	const __m256i zero=_mm256_setzero_si256(), one=_mm256_set1_epi32(1);
+	const __m256i sign=_mm256_set1_epi32((int)0x80000000), mant=_mm256_set1_epi32(0x00ffffff);
+	const __m256i frac=_mm256_set1_epi32(0x007fffff), expo=_mm256_set1_epi32(0x7f000000);
+	const __m256i huge=_mm256_set1_epi32(0x7f7fffff), c23=_mm256_set1_epi32(23);
+	const __m256i c127=_mm256_set1_epi32(127), c130=_mm256_set1_epi32(130), c254=_mm256_set1_epi32(254);
+	__m256i h, m, mz, lz, d, r;
+	int i;
+	for (i=0;i+8<=n;i+=8) {
+		h=_mm256_loadu_si256((const __m256i *)&ibm[i]);
+		m=_mm256_and_si256(h,mant);
+		mz=_mm256_cmpeq_epi32(m,zero);
+		/* nonzero values without mantissa are reported by the scalar loop */
+		if (_mm256_movemask_epi8(_mm256_andnot_si256(_mm256_cmpeq_epi32(h,zero),mz))) {
+			ibm2ieee_scalar(ibm,i,i+8);
+			continue;
+		}
+		/* normalization: the leading zeros of the 24-bit mantissa follow from
+		   the exponent of its (exact) float value */
+		lz=_mm256_sub_epi32(c23,_mm256_sub_epi32(_mm256_srli_epi32(
+			_mm256_castps_si256(_mm256_cvtepi32_ps(m)),23),c127));
+		m=_mm256_sllv_epi32(m,lz);
+		d=_mm256_sub_epi32(_mm256_sub_epi32(_mm256_srli_epi32(_mm256_and_si256(h,expo),22),c130),lz);
+		r=_mm256_or_si256(_mm256_slli_epi32(d,23),_mm256_and_si256(m,frac));
+		r=_mm256_blendv_epi8(r,huge,_mm256_cmpgt_epi32(d,c254));
+		r=_mm256_andnot_si256(_mm256_or_si256(_mm256_cmpgt_epi32(one,d),mz),
+			_mm256_or_si256(_mm256_and_si256(h,sign),r));
+		_mm256_storeu_si256((__m256i *)&ibm[i],r);
+	}
+	ibm2ieee_scalar(ibm,i,n);
+}
+#endif
+
+int * ibm2ieeev(int * ibm, int n) /* converting a vector of ibm floats into ieee floats */
+{
+	if (curerr==NULL) curerr=FP;
+	if (sizeof(int)!=4) {
+		fprintf(curerr,"Error [ibm2ieee]: sizeof(int)!=4. \n");	return NULL;}
+	if (sizeof(float)!=4) {
+		fprintf(curerr,"Error [ibm2ieee]: sizeof(float)!=4. \n"); return NULL;}
+#ifdef ASOFI_SIMD_X86
+	if (rwsegy_simd()) {ibm2ieee_avx2(ibm, n); return ibm;}
+#endif
+	ibm2ieee_scalar(ibm, 0, n);
 	return ibm;
 }
 
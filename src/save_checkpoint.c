@@ -6,6 +6,46 @@
 #include "fd.h"
 #include "globvar.h"
 
+/* write the box nx1..nx2, ny1..ny2, nz1..nz2 of a as one compressed record */
+static void write_field(FILE *fp, float ***a, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2)
+{
+	extern float COMPRESS_TOL;
+	extern int COMPRESS_REL;
+
+	const int n = (nx2 - nx1 + 1) * (ny2 - ny1 + 1) * (nz2 - nz1 + 1);
+	float *buf;
+	int i, j, k, m = 0;
+
+	buf = vector(0, n - 1);
+	for (j = ny1; j <= ny2; j++)
+		for (i = nx1; i <= nx2; i++)
+			for (k = nz1; k <= nz2; k++)
+				buf[m++] = a[j][i][k];
+	compress_write(fp, buf, n, COMPRESS_TOL, COMPRESS_REL);
+	free_vector(buf, 0, n - 1);
+}
+
+/* write the values of the nf fields a[0..nf-1] at the grid points of the box
+   interleaved, with one fwrite per plane j */
+static void write_points(FILE *fp, float ***a[], int nf, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2)
+{
+	const int n = (nx2 - nx1 + 1) * (nz2 - nz1 + 1) * nf;
+	float *buf;
+	int i, j, k, l, m;
+
+	buf = vector(0, n - 1);
+	for (j = ny1; j <= ny2; j++) {
+		m = 0;
+		for (i = nx1; i <= nx2; i++)
+			for (k = nz1; k <= nz2; k++)
+				for (l = 0; l < nf; l++)
+					buf[m++] = a[l][j][i][k];
+		if (fwrite(buf, sizeof(float), n, fp) != (size_t) n)
+			err("Error occurred while writing to the checkpoint file !");
+	}
+	free_vector(buf, 0, n - 1);
+}
+
 void save_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         Velocity *v, Tensor3d *s, Tensor3d *r,
         float *** psi_sxx_x, float *** psi_sxy_x, float *** psi_sxz_x, float *** psi_sxy_y,
@@ -13,13 +53,12 @@ void save_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         float *** psi_vxx, float *** psi_vyx, float *** psi_vzx, float *** psi_vxy, float *** psi_vyy, float *** psi_vzy,
         float *** psi_vxz, float *** psi_vyz, float *** psi_vzz) {
 
-	int i,j, k;
-	char myid[5];
+	int n;
+	char myid[12];
 	FILE *fp;
 	char checkptfile[STRING_SIZE];
-	extern int MYID;
 	extern int ABS_TYPE, NX,NY,NZ,FW,POS[4],NPROCX,NPROCY,NPROCZ,FREE_SURF;
-	extern int L;
+	extern int L, CHECKPT_COMPRESS;
 	extern char  CHECKPTFILE[STRING_SIZE];
 
         float ***vx = v->x;
@@ -40,8 +79,15 @@ void save_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         float ***ryz = r->yz;
         float ***rxz = r->xz;
 
+	float ***fields[9] = {vx, vy, vz, sxx, syy, szz, sxy, syz, sxz};
+	float ***rfields[6] = {rxx, ryy, rzz, rxy, ryz, rxz};
+	float ***psix[6] = {psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_vxx, psi_vyx, psi_vzx};
+	float ***psiy[6] = {psi_sxy_y, psi_syy_y, psi_syz_y, psi_vxy, psi_vyy, psi_vzy};
+	float ***psiz[6] = {psi_sxz_z, psi_syz_z, psi_szz_z, psi_vxz, psi_vyz, psi_vzz};
+
 	sprintf(checkptfile,"%s",CHECKPTFILE);
-	sprintf(myid,".%d",MYID);
+	/* named by the subdomain, the ranks may be reordered */
+	sprintf(myid,".%d",checkpoint_pe());
 	strcat(checkptfile,myid);
 
 
@@ -51,128 +97,37 @@ void save_checkpoint(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		err("CHECKPTFILE can't be opened !");
 	}
 
-
-	for (j=ny1; j<=ny2; j++) {
-		for (i=nx1; i<=nx2; i++) {
-			for (k=nz1; k<=nz2; k++) {
-				fwrite(&vx[j][i][k],sizeof(float),1,fp);
-				fwrite(&vy[j][i][k],sizeof(float),1,fp);
-				fwrite(&vz[j][i][k],sizeof(float),1,fp);
-				fwrite(&sxx[j][i][k],sizeof(float),1,fp);
-				fwrite(&syy[j][i][k],sizeof(float),1,fp);
-				fwrite(&szz[j][i][k],sizeof(float),1,fp);
-				fwrite(&sxy[j][i][k],sizeof(float),1,fp);
-				fwrite(&syz[j][i][k],sizeof(float),1,fp);
-				fwrite(&sxz[j][i][k],sizeof(float),1,fp);
-			}
-		}
-	}
-
-	if (L) {
-		for (j=1; j<=NY; j++) {
-			for (i=1; i<=NX; i++) {
-				for (k=1; k<=NZ; k++) {
-					fwrite(&rxx[j][i][k],sizeof(float),1,fp);
-					fwrite(&ryy[j][i][k],sizeof(float),1,fp);
-					fwrite(&rzz[j][i][k],sizeof(float),1,fp);
-					fwrite(&rxy[j][i][k],sizeof(float),1,fp);
-					fwrite(&ryz[j][i][k],sizeof(float),1,fp);
-					fwrite(&rxz[j][i][k],sizeof(float),1,fp);
-				}
+	/* compressed checkpoint: the same boxes as below, one record per field */
+	if (CHECKPT_COMPRESS) {
+		for (n=0; n<9; n++) write_field(fp,fields[n],nx1,nx2,ny1,ny2,nz1,nz2);
+		if (L) for (n=0; n<6; n++) write_field(fp,rfields[n],1,NX,1,NY,1,NZ);
+		if (ABS_TYPE == 1) {
+			for (n=0; n<6; n++) {
+				if (POS[1]==0) write_field(fp,psix[n],1,FW,1,NY,1,NZ);
+				if (POS[1]==NPROCX-1) write_field(fp,psix[n],FW+1,2*FW,1,NY,1,NZ);
+				if (POS[2]==0 && FREE_SURF==0) write_field(fp,psiy[n],1,NX,1,FW,1,NZ);
+				if (POS[2]==NPROCY-1) write_field(fp,psiy[n],1,NX,FW+1,2*FW,1,NZ);
+				if (POS[3]==0) write_field(fp,psiz[n],1,NX,1,NY,1,FW);
+				if (POS[3]==NPROCZ-1) write_field(fp,psiz[n],1,NX,1,NY,FW+1,2*FW);
 			}
 		}
+		fclose(fp);
+		return;
 	}
 
-	if (ABS_TYPE == 1) {
-
-		if (POS[1]==0) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=FW; i++) {
-					for (k=1; k<=NZ; k++) {
-						fwrite(&psi_sxx_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_sxy_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_sxz_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxx[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyx[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzx[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-
-		if (POS[1]==NPROCX-1) {
-			for (j=1; j<=NY; j++) {
-				for (i=FW+1; i<=2*FW; i++) {
-					for (k=1; k<=NZ; k++) {
-						fwrite(&psi_sxx_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_sxy_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_sxz_x[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxx[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyx[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzx[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-
-		if (POS[2]==0 && FREE_SURF==0) {
-			for (j=1; j<=FW; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=NZ; k++) {
-						fwrite(&psi_sxy_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syy_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syz_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxy[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyy[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzy[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-		if (POS[2]==NPROCY-1) {
-			for (j=FW+1; j<=2*FW; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=NZ; k++) {
-						fwrite(&psi_sxy_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syy_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syz_y[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxy[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyy[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzy[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
 
-		if (POS[3]==0) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=1; k<=FW; k++) {
-						fwrite(&psi_sxz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_szz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxz[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyz[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzz[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
-		if (POS[3]==NPROCZ-1) {
-			for (j=1; j<=NY; j++) {
-				for (i=1; i<=NX; i++) {
-					for (k=FW+1; k<=2*FW; k++) {
-						fwrite(&psi_sxz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_syz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_szz_z[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vxz[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vyz[j][i][k],sizeof(float),1,fp);
-						fwrite(&psi_vzz[j][i][k],sizeof(float),1,fp);
-					}
-				}
-			}
-		}
 
+	/* uncompressed checkpoint: the values of the fields at a grid point are
+	   interleaved, one block per plane j */
+	write_points(fp,fields,9,nx1,nx2,ny1,ny2,nz1,nz2);
+	if (L) write_points(fp,rfields,6,1,NX,1,NY,1,NZ);
+	if (ABS_TYPE == 1) {
+		if (POS[1]==0) write_points(fp,psix,6,1,FW,1,NY,1,NZ);
+		if (POS[1]==NPROCX-1) write_points(fp,psix,6,FW+1,2*FW,1,NY,1,NZ);
+		if (POS[2]==0 && FREE_SURF==0) write_points(fp,psiy,6,1,NX,1,FW,1,NZ);
+		if (POS[2]==NPROCY-1) write_points(fp,psiy,6,1,NX,FW+1,2*FW,1,NZ);
+		if (POS[3]==0) write_points(fp,psiz,6,1,NX,1,NY,1,FW);
+		if (POS[3]==NPROCZ-1) write_points(fp,psiz,6,1,NX,1,NY,FW+1,2*FW);
 	}
 
 	fclose(fp);
@@ -83,3 +83,65 @@ void saveseis_glob(FILE *fp, float **sectiondata, int **recpos, int ntr,
 		break;
 	}
 }
+
+
+/* write the seismograms of the quantity sectiondatatype of all PEs with
+   MPI-IO (SEIS_MPIIO=1), collective; section holds the ns samples of the
+   local traces (or the last block of the streamed seismograms) */
+static void saveseis_mpiio(FILE *fp, float **section, int *recswitch, int **recpos, int ntr_glob,
+        float ** srcpos, int ishot, int ns, int sectiondatatype){
+
+	extern int SEIS_FORMAT[6], RUN_MULTIPLE_SHOTS, SEIS_STREAM, MYID;
+	extern char  SEIS_FILE[STRING_SIZE];
+
+	/* quantities and their components (see saveseis_glob) */
+	const char *quant[7] = {"", "vx", "vy", "vz", "p", "div", "curl"};
+	const int comp[7] = {0, 1, 2, 3, 0, 0, 0};
+	char file[STRING_SIZE], file_ext[5];
+	float **data = section;
+	int i, ntr = 0;
+
+	switch (SEIS_FORMAT[0]){
+	case 1: sprintf(file_ext,"su");  break;
+	case 3: sprintf(file_ext,"bin"); break;
+	default: sprintf(file_ext,"sgy"); break;
+	}
+
+	if (RUN_MULTIPLE_SHOTS)
+		sprintf(file,"%s_%s.%s.shot%d",SEIS_FILE,quant[sectiondatatype],file_ext,ishot);
+	else
+		sprintf(file,"%s_%s.%s",SEIS_FILE,quant[sectiondatatype],file_ext);
+
+	/* all samples of the local traces from the scratch file of the streamed seismograms */
+	if (SEIS_STREAM > 0){
+		for (i=1;i<=ntr_glob;i++) if (recswitch[i]) ntr++;
+		data = fmatrix(1, max(ntr,1), 1, ns);
+		seisstream_read_local(data, sectiondatatype);
+	}
+
+	if (MYID==0)
+		fprintf(fp,"\n All PEs are writing %d seismogram traces (%s) to %s",ntr_glob,quant[sectiondatatype],file);
+	outseis_mpiio(fp,file,data,recswitch,recpos,ntr_glob,srcpos,1,ns,SEIS_FORMAT,comp[sectiondatatype]);
+
+	if (SEIS_STREAM > 0) free_matrix(data, 1, max(ntr,1), 1, ns);
+}
+
+/**
+ * Write the seismograms of the quantity sectiondatatype (1=vx, 2=vy, 3=vz,
+ * 4=p, 5=div, 6=curl) recorded by the PEs in section: gathered on PE 0 and
+ * written by saveseis_glob, or with SEIS_MPIIO by all PEs.  Collective
+ * over MPI_COMM_WORLD; fulldata is used on PE 0 only.
+ */
+void saveseis_all(FILE *fp, float **section, float **fulldata, int *recswitch, int **recpos,
+        int ntr_glob, float ** srcpos, int ishot, int ns, int sectiondatatype){
+
+	extern int SEIS_MPIIO, MYID;
+
+	if (SEIS_MPIIO){
+		saveseis_mpiio(fp,section,recswitch,recpos,ntr_glob,srcpos,ishot,ns,sectiondatatype);
+	}
+	else {
+		catseis(section,fulldata,recswitch,ntr_glob,ns,sectiondatatype);
+		if (MYID==0) saveseis_glob(fp,fulldata,recpos,ntr_glob,srcpos,ishot,ns,sectiondatatype);
+	}
+}
@@ -0,0 +1,124 @@
+/*------------------------------------------------------------------------
+ *   Microbenchmark of the conversion of seismogram samples in rwsegy.c:
+ *   byte swap, IEEE to IBM and IBM to IEEE floats.
+ *
+ *   Each conversion of n samples is timed with the scalar loops and with
+ *   the SIMD kernels selected for the CPU (see rwsegy_simd_ini) and the
+ *   results are checked to be identical.  A copy of the samples is timed
+ *   for comparison: a conversion that runs at about the speed of the copy
+ *   is memory-bound.  Exits with status 1 if the results differ.
+ *
+ *   Syntax: ../bin/segybench [n [repetitions]]
+ *
+ *  ----------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/* declaration of extern functions from rwsegy.c */
+extern const char * rwsegy_simd_ini(int request);
+extern float * swap4fv(float * fp, int len);
+extern int * ieee2ibmv(int * ieee, int n);
+extern int * ibm2ieeev(int * ibm, int n);
+
+
+static double seconds(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/* time the conversion `kind` (0: copy, 1: swap, 2: IEEE to IBM,
+   3: IBM to IEEE) of in into out, best of nrep repetitions */
+static double segybench_time(int kind, const float *in, float *out, int n, int nrep)
+{
+    double t, best = 0.0;
+    int r;
+
+    for (r = 0; r < nrep; r++) {
+        t = seconds();
+        memcpy(out, in, n * sizeof(float));
+        switch (kind) {
+        case 1: swap4fv(out, n); break;
+        case 2: ieee2ibmv((int *) out, n); break;
+        case 3: ibm2ieeev((int *) out, n); break;
+        }
+        t = seconds() - t;
+        if ((r == 0) || (t < best)) best = t;
+    }
+
+    return best;
+}
+
+
+int main(int argc, char **argv)
+{
+    const char *name[4] = {"copy", "byte swap", "IEEE -> IBM", "IBM -> IEEE"};
+    float *ieee, *ibm, *ref, *out;
+    double t0, t1, mb;
+    int i, kind, n = 1 << 24, nrep = 10, fail = 0;
+
+    extern FILE *FP;
+
+    FP = stdout;
+    if (argc > 1) n = atoi(argv[1]);
+    if (argc > 2) nrep = atoi(argv[2]);
+    if ((n < 1) || (nrep < 1)) {
+        printf("USAGE:\n");
+        printf("    segybench [n [repetitions]]\n");
+        exit(1);
+    }
+
+    ieee = vector(0, n - 1);
+    ibm = vector(0, n - 1);
+    ref = vector(0, n - 1);
+    out = vector(0, n - 1);
+
+    /* samples of a wide dynamic range, zeros and negative values included,
+       and some arbitrary bit patterns (denormalized, infinite, out of range) */
+    srand(1);
+    for (i = 0; i < n; i++) {
+        ieee[i] = (rand() - RAND_MAX / 2) * (float) pow(10.0, rand() % 41 - 20) / RAND_MAX;
+        if (i % 97 == 0) ieee[i] = 0.0;
+        if (i % 101 == 0) ieee[i] = -0.0;
+        if (i % 7 == 0) ((unsigned *) ieee)[i] = ((unsigned) rand() << 16) ^ (unsigned) rand();
+    }
+    memcpy(ibm, ieee, n * sizeof(float));
+    rwsegy_simd_ini(1);
+    ieee2ibmv((int *) ibm, n);
+    /* unnormalized IBM floats (nonzero ones without mantissa are reported) */
+    for (i = 5; i < n; i += 11)
+        ((unsigned *) ibm)[i] = (((unsigned) rand() << 16) ^ (unsigned) rand()) | 1;
+
+    mb = 2.0 * n * sizeof(float) / (1024.0 * 1024.0); /* read and written */
+    printf(" %d samples, best of %d repetitions, SIMD kernels: %s\n\n", n, nrep, rwsegy_simd_ini(0));
+    printf(" %-12s %12s %12s %9s\n", "conversion", "scalar MB/s", "SIMD MB/s", "speedup");
+
+    for (kind = 0; kind < 4; kind++) {
+        rwsegy_simd_ini(1);
+        t0 = segybench_time(kind, (kind == 3) ? ibm : ieee, ref, n, nrep);
+        rwsegy_simd_ini(0);
+        t1 = segybench_time(kind, (kind == 3) ? ibm : ieee, out, n, nrep);
+
+        printf(" %-12s %12.1f %12.1f %9.2f", name[kind], mb / t0, mb / t1, t0 / t1);
+        if (memcmp(ref, out, n * sizeof(float))) {
+            printf("   results differ!");
+            fail = 1;
+        }
+        printf("\n");
+    }
+
+    free_vector(ieee, 0, n - 1);
+    free_vector(ibm, 0, n - 1);
+    free_vector(ref, 0, n - 1);
+    free_vector(out, 0, n - 1);
+
+    return fail;
+}
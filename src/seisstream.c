@@ -0,0 +1,283 @@
+/*------------------------------------------------------------------------
+ *   Streaming output of the seismograms during the time stepping
+ *   (SEIS_STREAM=K > 0).
+ *
+ *   The seismogram sections of the PEs hold only K samples per trace
+ *   instead of all ns samples, so that the memory for the receivers does
+ *   not grow with the recording length.  Whenever K samples are recorded,
+ *   all PEs write the block of their traces collectively to a scratch file
+ *   per quantity, which is time-major: block b holds the samples
+ *   b*K+1 ... b*K+K of all ntr_glob traces in the order of the receivers,
+ *
+ *       position ((b*ntr_glob + (g-1))*K + (n-1)  of sample n of trace g.
+ *
+ *   After the time stepping `catseis` reads the blocks back into the
+ *   section of PE 0, i.e. transposes them to trace-major order for
+ *   `saveseis_glob`, and deletes the scratch files.  With SEIS_MPIIO=1
+ *   each PE reads back the blocks of its own traces instead.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/* quantities of the sections for SEISMO=1...4, see `seismo` (types of
+   `saveseis_glob`: 1=vx, 2=vy, 3=vz, 4=p, 5=div, 6=curl) */
+static const int seisstream_quant[5][7] = {
+    {0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 1, 1, 0, 0, 0},
+    {0, 0, 0, 0, 1, 0, 0},
+    {0, 0, 0, 0, 0, 1, 1},
+    {0, 1, 1, 1, 1, 1, 1}};
+static const char *seisstream_name[7] = {"", "vx", "vy", "vz", "p", "div", "curl"};
+
+static int nblock = 0, nloc = 0, nglob = 0, nsamp = 0, shot = 0;
+static MPI_File fh[7];
+static MPI_Datatype blocktype = MPI_DATATYPE_NULL;
+
+
+static void seisstream_file(char *file, int type)
+{
+    extern char SEIS_FILE[STRING_SIZE];
+
+    sprintf(file, "%s_%s.stream.shot%d", SEIS_FILE, seisstream_name[type], shot);
+}
+
+/**
+ * Number of samples per trace of the seismogram sections of the PEs: ns,
+ * or SEIS_STREAM if the seismograms are streamed.  recswitch marks the
+ * ntr of the ntr_glob receivers located in the subdomain of the PE.
+ */
+int seisstream_ini(int ntr, int ntr_glob, int *recswitch, int ns)
+{
+    extern int SEISMO, SEIS_STREAM, MYID;
+    extern FILE *FP;
+
+    MPI_Datatype traces;
+    int i, k, *displ;
+
+    if (!SEISMO || (SEIS_STREAM <= 0) || (ns <= 0))
+        return ns;
+
+    nblock = min(SEIS_STREAM, ns);
+    nloc = ntr;
+    nglob = ntr_glob;
+    nsamp = ns;
+
+    /* the traces of the PE in the blocks of the scratch files */
+    displ = ivector(0, max(ntr, 1) - 1);
+    k = 0;
+    for (i = 1; i <= ntr_glob; i++)
+        if (recswitch[i])
+            displ[k++] = (i - 1) * nblock;
+    if (k != ntr)
+        err(" seisstream_ini: %d of %d local receivers found ! ", k, ntr);
+
+    MPI_Type_create_indexed_block(ntr, nblock, displ, MPI_FLOAT, &traces);
+    MPI_Type_create_resized(traces, 0, (MPI_Aint) ntr_glob * nblock * sizeof(float), &blocktype);
+    MPI_Type_commit(&blocktype);
+    MPI_Type_free(&traces);
+    free_ivector(displ, 0, max(ntr, 1) - 1);
+
+    if (MYID == 0)
+        fprintf(FP, " Seismograms are streamed to disk in blocks of %d samples.\n", nblock);
+
+    return nblock;
+}
+
+/**
+ * Column of the sample nlsamp (starting with 1) in the sections.
+ */
+int seisstream_col(int nlsamp)
+{
+    return nblock ? (nlsamp - 1) % nblock + 1 : nlsamp;
+}
+
+/**
+ * Open the scratch files of the shot ishot for the samples from nlsamp on.
+ * The blocks before nlsamp are kept if the shot is continued from a
+ * checkpoint (see checkpoint.c).  Collective over MPI_COMM_WORLD.
+ */
+void seisstream_open(int ishot, int nlsamp)
+{
+    extern int SEISMO;
+
+    char file[STRING_SIZE];
+    int type;
+
+    if (!nblock)
+        return;
+
+    shot = ishot;
+    for (type = 1; type <= 6; type++) {
+        if (!seisstream_quant[SEISMO][type])
+            continue;
+        seisstream_file(file, type);
+        if (MPI_File_open(MPI_COMM_WORLD, file, MPI_MODE_RDWR | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fh[type]) != MPI_SUCCESS)
+            err(" Could not open seismogram scratch file %s ! ", file);
+        if (nlsamp == 1)
+            MPI_File_set_size(fh[type], 0);
+        MPI_File_set_view(fh[type], 0, MPI_FLOAT, blocktype, "native", MPI_INFO_NULL);
+    }
+}
+
+/**
+ * Write the block of the sections to the scratch files after the sample
+ * nlsamp is recorded, if the block is complete.  Collective over
+ * MPI_COMM_WORLD, i.e. called by all PEs (sections may be NULL on PEs
+ * without receivers).
+ */
+void seisstream_write(int nlsamp, float **sectionvx, float **sectionvy, float **sectionvz,
+        float **sectionp, float **sectiondiv, float **sectioncurl)
+{
+    extern int SEISMO;
+
+    float **section[7] = {NULL, sectionvx, sectionvy, sectionvz, sectionp, sectiondiv, sectioncurl};
+    MPI_Offset offset;
+    MPI_Status status;
+    int type, count;
+
+    if (!nblock || ((nlsamp % nblock) && (nlsamp != nsamp)))
+        return;
+
+    /* the block number in units of the blocks of the PE (see the view) */
+    offset = (MPI_Offset) ((nlsamp - 1) / nblock) * nloc * nblock;
+    for (type = 1; type <= 6; type++) {
+        if (!seisstream_quant[SEISMO][type])
+            continue;
+        MPI_File_write_at_all(fh[type], offset, (nloc > 0) ? &section[type][1][1] : NULL,
+                nloc * nblock, MPI_FLOAT, &status);
+        MPI_Get_count(&status, MPI_FLOAT, &count);
+        if (count != nloc * nblock)
+            err(" Could not write %d seismogram samples to scratch file (%d written) ! ",
+                nloc * nblock, count);
+    }
+}
+
+/**
+ * Transfer the blocks written so far to disk (before a checkpoint).
+ * Collective over MPI_COMM_WORLD.
+ */
+void seisstream_sync(void)
+{
+    extern int SEISMO;
+
+    int type;
+
+    if (!nblock)
+        return;
+
+    for (type = 1; type <= 6; type++)
+        if (seisstream_quant[SEISMO][type])
+            MPI_File_sync(fh[type]);
+}
+
+/**
+ * Close the scratch files after the time stepping.  Collective over
+ * MPI_COMM_WORLD.
+ */
+void seisstream_close(void)
+{
+    extern int SEISMO;
+
+    int type;
+
+    if (!nblock)
+        return;
+
+    for (type = 1; type <= 6; type++)
+        if (seisstream_quant[SEISMO][type])
+            MPI_File_close(&fh[type]);
+}
+
+/**
+ * Read the scratch file of the quantity type into the section fulldata of
+ * all ntr_glob traces and ns samples and delete it (PE 0 only).  Returns 0
+ * if the seismograms are not streamed.
+ */
+int seisstream_read(float **fulldata, int type)
+{
+    char file[STRING_SIZE];
+    float *buf;
+    FILE *fp;
+    int b, g, n, m;
+
+    if (!nblock)
+        return 0;
+
+    seisstream_file(file, type);
+    fp = fopen(file, "rb");
+    if (fp == NULL)
+        err(" Could not open seismogram scratch file %s ! ", file);
+
+    buf = vector(0, nglob * nblock - 1);
+    for (b = 0; b * nblock < nsamp; b++) {
+        if (fread(buf, sizeof(float), nglob * nblock, fp) != (size_t) (nglob * nblock))
+            err(" Could not read block %d of seismogram scratch file %s ! ", b + 1, file);
+        m = min(nblock, nsamp - b * nblock);
+        for (g = 1; g <= nglob; g++)
+            for (n = 1; n <= m; n++)
+                fulldata[g][b * nblock + n] = buf[(g - 1) * nblock + n - 1];
+    }
+    free_vector(buf, 0, nglob * nblock - 1);
+
+    fclose(fp);
+    remove(file);
+
+    return 1;
+}
+
+/**
+ * Read all samples of the local traces of the quantity type from the
+ * scratch file into data (ntr x ns) and delete it.  Collective over
+ * MPI_COMM_WORLD, used for the output with MPI-IO (SEIS_MPIIO=1).
+ */
+void seisstream_read_local(float **data, int type)
+{
+    char file[STRING_SIZE];
+    float *buf = NULL;
+    MPI_File fhr;
+    MPI_Status status;
+    int b, itr, n, m, count;
+
+    if (!nblock)
+        return;
+
+    seisstream_file(file, type);
+    if (MPI_File_open(MPI_COMM_WORLD, file, MPI_MODE_RDONLY | MPI_MODE_DELETE_ON_CLOSE,
+                MPI_INFO_NULL, &fhr) != MPI_SUCCESS)
+        err(" Could not open seismogram scratch file %s ! ", file);
+    MPI_File_set_view(fhr, 0, MPI_FLOAT, blocktype, "native", MPI_INFO_NULL);
+
+    if (nloc > 0)
+        buf = vector(0, nloc * nblock - 1);
+    for (b = 0; b * nblock < nsamp; b++) {
+        MPI_File_read_at_all(fhr, (MPI_Offset) b * nloc * nblock, buf, nloc * nblock,
+                MPI_FLOAT, &status);
+        MPI_Get_count(&status, MPI_FLOAT, &count);
+        if (count != nloc * nblock)
+            err(" Could not read block %d of seismogram scratch file %s ! ", b + 1, file);
+        m = min(nblock, nsamp - b * nblock);
+        for (itr = 1; itr <= nloc; itr++)
+            for (n = 1; n <= m; n++)
+                data[itr][b * nblock + n] = buf[(itr - 1) * nblock + n - 1];
+    }
+    if (nloc > 0)
+        free_vector(buf, 0, nloc * nblock - 1);
+
+    MPI_File_close(&fhr);
+}
+
+/**
+ * Free the file view of the local traces.
+ */
+void seisstream_free(void)
+{
+    if (!nblock)
+        return;
+
+    MPI_Type_free(&blocktype);
+    nblock = 0;
+}
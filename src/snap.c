@@ -8,6 +8,55 @@
 #include "globvar.h"
 
 
+/* file of a snapshot component; nothing is opened if the whole subdomain
+   is written at once (SNAP_MPIIO or SNAP_ASYNC) */
+static FILE *snap_open(const char *file, const char *wm)
+{
+	extern int SNAP_MPIIO, SNAP_ASYNC;
+
+	return (SNAP_MPIIO || SNAP_ASYNC) ? NULL : fopen(file,wm);
+}
+
+/* close the file, or write the subdomain buf[0..n-1] to the file */
+static void snap_close(FILE *fp, const char *file, const float *buf, int n, int nsnap, int format)
+{
+	extern int SNAP_MPIIO, SNAP_ASYNC;
+
+	if (SNAP_ASYNC)
+		snap_async_write(file,buf,n,nsnap,format);
+	else if (SNAP_MPIIO)
+		mpiio_write_snap(file,buf,n,nsnap);
+	else
+		fclose(fp);
+}
+
+
+/**
+ * Name of the snapshot file of the quantity quant ("vx", "div", ...): the
+ * global file (SNAP_MPIIO), named like the files merged by snapmerge, or
+ * the file of the PE.
+ */
+void snap_file(char *file, int format, const char *quant)
+{
+	extern char SNAP_FILE[STRING_SIZE];
+	extern int POS[4], SNAP_MPIIO;
+
+	const char *ext = "";
+
+	switch(format){
+	case 1: ext=".su"; break;
+	case 2: ext=".asc"; break;
+	case 3: ext=".bin"; break;
+	case 6: ext=".cmp"; break;
+	}
+
+	if (SNAP_MPIIO)
+		sprintf(file,"%s%s.%s",SNAP_FILE,ext,quant);
+	else
+		sprintf(file,"%s%s.%s.%i.%i.%i",SNAP_FILE,ext,quant,POS[1],POS[2],POS[3]);
+}
+
+
 void snap(FILE *fp, int nt, int nsnap, int format, int type, 
         Velocity *v, Tensor3d *s,
         float ***u, float ***pi,
@@ -31,16 +80,16 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
 
 	
 	char xfile[STRING_SIZE], yfile[STRING_SIZE], zfile[STRING_SIZE];
-	char rotfile[STRING_SIZE], ext[8], wm[2];
+	char rotfile[STRING_SIZE], wm[2];
 	char  divfile[STRING_SIZE], pfile[STRING_SIZE];
 	FILE *fpx1, *fpy1, *fpz1, *fpx2, *fpy2, *fpp;
-	int i,j,k;
+	int i,j,k,n,nplane,whole;
+	float *plane[4];
 	float a=0.0, amp, dh24x, dh24y, dh24z, vyx, vxy, vxx, vyy, vzx, vyz, vxz, vzy, vzz;
 
 
 	extern float DX, DY, DZ, DT;
-	extern char SNAP_FILE[STRING_SIZE];
-	extern int MYID, POS[4], SNAP_PLANE, LOG;
+	extern int MYID, SNAP_PLANE, LOG, SNAP_MPIIO, SNAP_ASYNC;
 
         float ***vx = v->x;
         float ***vy = v->y;
@@ -50,25 +99,12 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
         float ***syy = s->yy;
         float ***szz = s->zz;
 
-	switch(format){
-	case 1: 
-		sprintf(ext,".su");
-		break;
-	case 2: 
-		sprintf(ext,".asc");
-		break;
-	case 3: 
-		sprintf(ext,".bin");
-		break;
-	}
-
-
-	sprintf(xfile,"%s%s.vx.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(yfile,"%s%s.vy.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(zfile,"%s%s.vz.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(divfile,"%s%s.div.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(rotfile,"%s%s.curl.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(pfile,"%s%s.p.%i.%i.%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
+	snap_file(xfile,format,"vx");
+	snap_file(yfile,format,"vy");
+	snap_file(zfile,format,"vz");
+	snap_file(divfile,format,"div");
+	snap_file(rotfile,format,"curl");
+	snap_file(pfile,format,"p");
 
         if (LOG){
 	fprintf(fp,"\n\n PE %d is writing snapshot-data at T=%fs to \n",MYID,nt*DT);}
@@ -79,80 +115,110 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
 	else 
 		sprintf(wm,"a");
 
+	/* the snapshot of the PE is written plane by plane, with SNAP_MPIIO or
+	   SNAP_ASYNC the whole subdomain is written at once */
+	whole=SNAP_MPIIO || SNAP_ASYNC;
+	nplane=((nx2-nx1)/idx+1)*((ny2-ny1)/idy+1);
+	if (whole) nplane*=(nz2-nz1)/idz+1;
+	for (n=0;n<4;n++) plane[n]=vector(0,nplane-1);
+
 	switch(type){
 	case 1 :
 		fprintf(fp,"\t%s\n", xfile);
 		fprintf(fp,"\t%s\n", yfile);
 		fprintf(fp,"\t%s\n\n", zfile);
-		fpx1=fopen(xfile,wm);
-		fpy1=fopen(yfile,wm);
-		fpz1=fopen(zfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
+		fpx1=snap_open(xfile,wm);
+		fpy1=snap_open(yfile,wm);
+		fpz1=snap_open(zfile,wm);
+		n=0;
+		for (k=nz1;k<=nz2;k+=idz){
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
 				
 			
-					writedsk(fpx1,vx[j][i][k],format);
-					writedsk(fpy1,vy[j][i][k],format);
-					writedsk(fpz1,vz[j][i][k],format);
-					
-					
+					plane[0][n]=vx[j][i][k];
+					plane[1][n]=vy[j][i][k];
+					plane[2][n]=vz[j][i][k];
+					n++;
 				}
-		fclose(fpx1);
-		fclose(fpy1);
-		fclose(fpz1);
+			if (!whole){
+				writedsk_block(fpx1,plane[0],n,format);
+				writedsk_block(fpy1,plane[1],n,format);
+				writedsk_block(fpz1,plane[2],n,format);
+				n=0;
+			}
+		}
+		snap_close(fpx1,xfile,plane[0],n,nsnap,format);
+		snap_close(fpy1,yfile,plane[1],n,nsnap,format);
+		snap_close(fpz1,zfile,plane[2],n,nsnap,format);
 		break;
 	case 2 :
 		fprintf(fp,"\t%s\n\n", pfile);
-		fpp=fopen(pfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
+		fpp=snap_open(pfile,wm);
+		n=0;
+		for (k=nz1;k<=nz2;k+=idz){
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
 					amp=-sxx[j][i][k]-syy[j][i][k]-szz[j][i][k];
 					
 				
-					writedsk(fpp,amp,format);
-
+					plane[0][n]=amp;
+					n++;
 				}
-		fclose(fpp);
+			if (!whole){
+				writedsk_block(fpp,plane[0],n,format);
+				n=0;
+			}
+		}
+		snap_close(fpp,pfile,plane[0],n,nsnap,format);
 		break;
 	case 4 :
 		fprintf(fp,"\t%s\n", xfile);
 		fprintf(fp,"\t%s\n", yfile);
 		fprintf(fp,"\t%s\n\n", zfile);
 		fprintf(fp,"\t%s\n\n", pfile);
-		fpx1=fopen(xfile,wm);
-		fpy1=fopen(yfile,wm);
-		fpz1=fopen(zfile,wm);
-		fpp=fopen(pfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
+		fpx1=snap_open(xfile,wm);
+		fpy1=snap_open(yfile,wm);
+		fpz1=snap_open(zfile,wm);
+		fpp=snap_open(pfile,wm);
+		n=0;
+		for (k=nz1;k<=nz2;k+=idz){
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
 					amp=-sxx[j][i][k]-syy[j][i][k]-szz[j][i][k];
 
-					writedsk(fpx1,vx[j][i][k],format);
-					writedsk(fpy1,vy[j][i][k],format);
-					writedsk(fpz1,vz[j][i][k],format);
-					writedsk(fpp,amp,format);
-					
+					plane[0][n]=vx[j][i][k];
+					plane[1][n]=vy[j][i][k];
+					plane[2][n]=vz[j][i][k];
+					plane[3][n]=amp;
+					n++;
 				}
-		fclose(fpx1);
-		fclose(fpy1);
-		fclose(fpz1);
-		fclose(fpp);
+			if (!whole){
+				writedsk_block(fpx1,plane[0],n,format);
+				writedsk_block(fpy1,plane[1],n,format);
+				writedsk_block(fpz1,plane[2],n,format);
+				writedsk_block(fpp,plane[3],n,format);
+				n=0;
+			}
+		}
+		snap_close(fpx1,xfile,plane[0],n,nsnap,format);
+		snap_close(fpy1,yfile,plane[1],n,nsnap,format);
+		snap_close(fpz1,zfile,plane[2],n,nsnap,format);
+		snap_close(fpp,pfile,plane[3],n,nsnap,format);
 	case 3 :
 		/* output of the curl of the velocity field according to Dougherty and
 		                  Stephen (PAGEOPH, 1988) */
 		fprintf(fp,"\t%s\n", divfile);
 		fprintf(fp,"\t%s\n\n", rotfile);
-		fpx2=fopen(divfile,wm);
-		fpy2=fopen(rotfile,wm);
+		fpx2=snap_open(divfile,wm);
+		fpy2=snap_open(rotfile,wm);
 		
 		dh24x=1.0/DX;
 		dh24y=1.0/DY;
 		dh24z=1.0/DZ;
 		
-		for (k=nz1;k<=nz2;k+=idz)
+		n=0;
+		for (k=nz1;k<=nz2;k+=idz){
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
 					vxy=(vx[j+1][i][k]-vx[j][i][k])*(dh24y);
@@ -198,16 +264,21 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
 					
 					}
 					
-					writedsk(fpy2,a,format);
-					   
-
+					plane[0][n]=a;
+					n++;
 				}
+			if (!whole){
+				writedsk_block(fpy2,plane[0],n,format);
+				n=0;
+			}
+		}
 
 
 
 		/* output of the divergence of the velocity field according to Dougherty and
 		                  Stephen (PAGEOPH, 1988) */
-		for (k=nz1;k<=nz2;k+=idz)
+		n=0;
+		for (k=nz1;k<=nz2;k+=idz){
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
 					vxx=(vx[j][i][k]-vx[j][i-1][k])*(dh24x);
@@ -236,13 +307,19 @@ void snap(FILE *fp, int nt, int nsnap, int format, int type,
 						break;
 					}
 					
-					writedsk(fpx2,a,format);
+					plane[1][n]=a;
+					n++;
 				}
+			if (!whole){
+				writedsk_block(fpx2,plane[1],n,format);
+				n=0;
+			}
+		}
 
-		fclose(fpx2);
-		fclose(fpy2);
+		snap_close(fpx2,divfile,plane[1],n,nsnap,format);
+		snap_close(fpy2,rotfile,plane[0],n,nsnap,format);
 		break;
 	}
-}
-
 
+	for (n=0;n<4;n++) free_vector(plane[n],0,nplane-1);
+}
@@ -8,6 +8,29 @@
 #include "globvar.h"
 
 
+/* file of a snapshot component; nothing is opened if the whole subdomain
+   is written at once (SNAP_MPIIO or SNAP_ASYNC) */
+static FILE *snap_open(const char *file, const char *wm)
+{
+	extern int SNAP_MPIIO, SNAP_ASYNC;
+
+	return (SNAP_MPIIO || SNAP_ASYNC) ? NULL : fopen(file,wm);
+}
+
+/* close the file, or write the subdomain buf[0..n-1] to the file */
+static void snap_close(FILE *fp, const char *file, const float *buf, int n, int nsnap, int format)
+{
+	extern int SNAP_MPIIO, SNAP_ASYNC;
+
+	if (SNAP_ASYNC)
+		snap_async_write(file,buf,n,nsnap,format);
+	else if (SNAP_MPIIO)
+		mpiio_write_snap(file,buf,n,nsnap);
+	else
+		fclose(fp);
+}
+
+
 void snap_acoustic(FILE *fp, int nt, int nsnap, int format, int type, 
 Velocity *v, float ***sxx,
 int idx, int idy, int idz, int nx1, int ny1, int nz1, int nx2, 
@@ -33,13 +56,14 @@ int ny2, int nz2) {
 	char rotfile[STRING_SIZE], ext[8], wm[2];
 	char  divfile[STRING_SIZE], pfile[STRING_SIZE];
 	FILE *fpx1, *fpy1, *fpz1, *fpp /*, *fpx2, *fpy2*/;
-	int i,j,k;
+	int i,j,k,n,nplane,whole;
+	float *plane[4];
 	float /*a=0.0,*/ amp; /* dh24x, dh24y, dh24z, vyx, vxy, vxx, vyy, vzx, vyz, vxz, vzy, vzz not used here*/
 
 
 	extern float /*DX, DY, DZ,*/ DT;
 	extern char SNAP_FILE[STRING_SIZE];
-	extern int MYID, POS[4], LOG; /* SNAP_PLANE not used here*/
+	extern int MYID, POS[4], LOG, SNAP_MPIIO, SNAP_ASYNC; /* SNAP_PLANE not used here*/
 
         float ***vx = v->x;
         float ***vy = v->y;
@@ -56,15 +80,29 @@ int ny2, int nz2) {
 	case 3: 
 		sprintf(ext,".bin");
 		break;
+	case 6: 
+		sprintf(ext,".cmp");
+		break;
 	}
 
 
-	sprintf(xfile,"%s%s.x.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(yfile,"%s%s.z.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(zfile,"%s%s.y.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(divfile,"%s%s.div.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(rotfile,"%s%s.rot.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
-	sprintf(pfile,"%s%s.p.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
+	if (SNAP_MPIIO){
+		/* global files, named like the files merged by snapmerge */
+		sprintf(xfile,"%s%s.vx",SNAP_FILE,ext);
+		sprintf(yfile,"%s%s.vy",SNAP_FILE,ext);
+		sprintf(zfile,"%s%s.vz",SNAP_FILE,ext);
+		sprintf(divfile,"%s%s.div",SNAP_FILE,ext);
+		sprintf(rotfile,"%s%s.curl",SNAP_FILE,ext);
+		sprintf(pfile,"%s%s.p",SNAP_FILE,ext);
+	}
+	else {
+		sprintf(xfile,"%s%s.x.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
+		sprintf(yfile,"%s%s.z.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
+		sprintf(zfile,"%s%s.y.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
+		sprintf(divfile,"%s%s.div.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
+		sprintf(rotfile,"%s%s.rot.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
+		sprintf(pfile,"%s%s.p.%i%i%i",SNAP_FILE,ext,POS[1],POS[2],POS[3]);
+	}
 
         if (LOG){
 	fprintf(fp,"\n\n PE %d is writing snapshot-data at T=%fs to \n",MYID,nt*DT);}
@@ -75,70 +113,100 @@ int ny2, int nz2) {
 	else 
 		sprintf(wm,"a");
 
+	/* the snapshot of the PE is written plane by plane, with SNAP_MPIIO or
+	   SNAP_ASYNC the whole subdomain is written at once */
+	whole=SNAP_MPIIO || SNAP_ASYNC;
+	nplane=((nx2-nx1)/idx+1)*((ny2-ny1)/idy+1);
+	if (whole) nplane*=(nz2-nz1)/idz+1;
+	for (n=0;n<4;n++) plane[n]=vector(0,nplane-1);
+
 	switch(type){
 	case 1 :
 		fprintf(fp,"\t%s\n", xfile);
 		fprintf(fp,"\t%s\n", yfile);
 		fprintf(fp,"\t%s\n\n", zfile);
-		fpx1=fopen(xfile,wm);
-		fpy1=fopen(yfile,wm);
-		fpz1=fopen(zfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
+		fpx1=snap_open(xfile,wm);
+		fpy1=snap_open(yfile,wm);
+		fpz1=snap_open(zfile,wm);
+		n=0;
+		for (k=nz1;k<=nz2;k+=idz){
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
 				
 			
-					writedsk(fpx1,vx[j][i][k],format);
-					writedsk(fpy1,vy[j][i][k],format);
-					writedsk(fpz1,vz[j][i][k],format);
-					
-					
+					plane[0][n]=vx[j][i][k];
+					plane[1][n]=vy[j][i][k];
+					plane[2][n]=vz[j][i][k];
+					n++;
 				}
-		fclose(fpx1);
-		fclose(fpy1);
-		fclose(fpz1);
+			if (!whole){
+				writedsk_block(fpx1,plane[0],n,format);
+				writedsk_block(fpy1,plane[1],n,format);
+				writedsk_block(fpz1,plane[2],n,format);
+				n=0;
+			}
+		}
+		snap_close(fpx1,xfile,plane[0],n,nsnap,format);
+		snap_close(fpy1,yfile,plane[1],n,nsnap,format);
+		snap_close(fpz1,zfile,plane[2],n,nsnap,format);
 		break;
 	case 2 :
 		fprintf(fp,"\t%s\n\n", pfile);
-		fpp=fopen(pfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
+		fpp=snap_open(pfile,wm);
+		n=0;
+		for (k=nz1;k<=nz2;k+=idz){
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
 					amp=-3.0*sxx[j][i][k];
 					
 				
-					writedsk(fpp,amp,format);
-
+					plane[0][n]=amp;
+					n++;
 				}
-		fclose(fpp);
+			if (!whole){
+				writedsk_block(fpp,plane[0],n,format);
+				n=0;
+			}
+		}
+		snap_close(fpp,pfile,plane[0],n,nsnap,format);
 		break;
 	case 4 :
 		fprintf(fp,"\t%s\n", xfile);
 		fprintf(fp,"\t%s\n", yfile);
 		fprintf(fp,"\t%s\n\n", zfile);
 		fprintf(fp,"\t%s\n\n", pfile);
-		fpx1=fopen(xfile,wm);
-		fpy1=fopen(yfile,wm);
-		fpz1=fopen(zfile,wm);
-		fpp=fopen(pfile,wm);
-		for (k=nz1;k<=nz2;k+=idz)
+		fpx1=snap_open(xfile,wm);
+		fpy1=snap_open(yfile,wm);
+		fpz1=snap_open(zfile,wm);
+		fpp=snap_open(pfile,wm);
+		n=0;
+		for (k=nz1;k<=nz2;k+=idz){
 			for (i=nx1;i<=nx2;i+=idx)
 				for (j=ny1;j<=ny2;j+=idy){
 					amp=-3.0*sxx[j][i][k];
 
-					writedsk(fpx1,vx[j][i][k],format);
-					writedsk(fpy1,vy[j][i][k],format);
-					writedsk(fpz1,vz[j][i][k],format);
+					plane[0][n]=vx[j][i][k];
+					plane[1][n]=vy[j][i][k];
+					plane[2][n]=vz[j][i][k];
 					
-					writedsk(fpp,amp,format);
+					plane[3][n]=amp;
+					n++;
 				}
-		fclose(fpx1);
-		fclose(fpy1);
-		fclose(fpz1);
-		fclose(fpp);
+			if (!whole){
+				writedsk_block(fpx1,plane[0],n,format);
+				writedsk_block(fpy1,plane[1],n,format);
+				writedsk_block(fpz1,plane[2],n,format);
+				writedsk_block(fpp,plane[3],n,format);
+				n=0;
+			}
+		}
+		snap_close(fpx1,xfile,plane[0],n,nsnap,format);
+		snap_close(fpy1,yfile,plane[1],n,nsnap,format);
+		snap_close(fpz1,zfile,plane[2],n,nsnap,format);
+		snap_close(fpp,pfile,plane[3],n,nsnap,format);
 		break;
 		
 	}
-}
-
 
+	for (n=0;n<4;n++) free_vector(plane[n],0,nplane-1);
+}
@@ -0,0 +1,261 @@
+/*------------------------------------------------------------------------
+ *   Asynchronous output of the snapshots (SNAP_ASYNC=1).
+ *
+ *   `snap` computes the (decimated) quantities of the local subdomain as
+ *   usual and hands each of them to `snap_async_write`, which copies it to
+ *   a staging buffer and returns, so that the time stepping continues while
+ *   the snapshot is written:
+ *
+ *   - into the files of the PE (SNAP_MPIIO=0) by an I/O thread, which also
+ *     does the formatting of ASCII output;
+ *   - into the global files (SNAP_MPIIO=1) by nonblocking collective
+ *     MPI-IO started by the master thread.
+ *
+ *   The staging buffers (slots) are used in turn.  Their number follows from
+ *   the memory budget SNAP_ASYNC_MB (default: two complete snapshots, i.e.
+ *   double buffering).  If all slots are in flight, `snap_async_write` waits
+ *   for the oldest one.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include <pthread.h>
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/* staging buffer of one quantity of a snapshot */
+typedef struct {
+    char file[STRING_SIZE];
+    float *buf;
+    int n, nsnap, format;
+    MPI_File fh;
+    MPI_Request req;
+} SnapSlot;
+
+static SnapSlot *slot = NULL;
+static int nslot = 0, nvalue = 0, nplane = 0;
+
+/* ring of slots in flight: slot[tail], ..., slot[head-1] (count slots) */
+static int head = 0, tail = 0, count = 0, done = 0;
+/* a file that the I/O thread could not open (reported by the master thread) */
+static char failed[STRING_SIZE] = "";
+static pthread_t writer;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+
+/* I/O thread: write the slots to the files of the PE in the order of arrival,
+   plane by plane like `snap` (compressed files consist of one record per plane) */
+static void *snap_async_writer(void *arg)
+{
+    SnapSlot *sl;
+    FILE *fp;
+    int n;
+
+    (void) arg;
+
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        while ((count == 0) && !done)
+            pthread_cond_wait(&cond, &lock);
+        if (count == 0) {
+            pthread_mutex_unlock(&lock);
+            break;
+        }
+        sl = &slot[tail];
+        pthread_mutex_unlock(&lock);
+
+        fp = fopen(sl->file, (sl->nsnap == 1) ? "w" : "a");
+        if (fp != NULL) {
+            for (n = 0; n < sl->n; n += nplane)
+                writedsk_block(fp, sl->buf + n, nplane, sl->format);
+            fclose(fp);
+        }
+
+        pthread_mutex_lock(&lock);
+        if (fp == NULL)
+            strcpy(failed, sl->file);
+        tail = (tail + 1) % nslot;
+        count--;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+
+    return NULL;
+}
+
+/* report a failure of the I/O thread (MPI is called by the master thread only) */
+static void snap_async_check(void)
+{
+    char file[STRING_SIZE];
+
+    pthread_mutex_lock(&lock);
+    strcpy(file, failed);
+    pthread_mutex_unlock(&lock);
+
+    if (file[0] != '\0')
+        err(" Could not open snapshot file %s for writing! ", file);
+}
+
+/* complete the MPI-IO of the oldest slot, collective like its start */
+static void snap_async_complete(void)
+{
+    SnapSlot *sl = &slot[tail];
+    MPI_Status status;
+    int n;
+
+    MPI_Wait(&sl->req, &status);
+    MPI_Get_count(&status, MPI_FLOAT, &n);
+    MPI_File_close(&sl->fh);
+
+    if (n != sl->n)
+        err("Could not write the subdomain to snapshot file %s "
+            "(%d of %d values)!", sl->file, n, sl->n);
+
+    tail = (tail + 1) % nslot;
+    count--;
+}
+
+/**
+ * Allocate the staging buffers and start the I/O thread.  Called after the
+ * domain decomposition.
+ */
+void snap_async_ini(void)
+{
+    extern int SNAP, SNAP_ASYNC, SNAP_ASYNC_MB, SNAP_MPIIO;
+    extern int NX, NY, NZ, IDX, IDY, IDZ, MYID;
+    extern FILE *FP;
+
+    /* quantities of a snapshot for SNAP=1...4, see `snap` */
+    const int nquant[5] = {0, 3, 1, 2, 6};
+    long budget;
+    int n;
+
+    if (!SNAP || !SNAP_ASYNC)
+        return;
+
+    if (SNAP_ASYNC_MB < 0)
+        err(" SNAP_ASYNC_MB must not be negative ! ");
+
+    nplane = ((NX - 1) / IDX + 1) * ((NY - 1) / IDY + 1);
+    nvalue = nplane * ((NZ - 1) / IDZ + 1);
+    if (SNAP_ASYNC_MB > 0) {
+        budget = (long) SNAP_ASYNC_MB * 1024 * 1024;
+        nslot = (int) max(budget / ((long) nvalue * (long) sizeof(float)), 1);
+    } else {
+        nslot = 2 * nquant[(SNAP >= 1 && SNAP <= 4) ? SNAP : 4];
+    }
+
+    slot = malloc(nslot * sizeof(SnapSlot));
+    if (slot == NULL)
+        err(" Allocation of the snapshot staging buffers failed ! ");
+    for (n = 0; n < nslot; n++)
+        slot[n].buf = vector(0, nvalue - 1);
+    head = tail = count = done = 0;
+
+    if (!SNAP_MPIIO)
+        if (pthread_create(&writer, NULL, snap_async_writer, NULL))
+            err(" Could not start the snapshot I/O thread ! ");
+
+    if (MYID == 0)
+        fprintf(FP, " Snapshots are written asynchronously with %d staging buffers of %.2f MB each.\n",
+                nslot, nvalue * sizeof(float) / (1024.0 * 1024.0));
+}
+
+/**
+ * Write the n values of buf, one quantity of the local subdomain in the
+ * order of `snap`, as snapshot number nsnap to `file` in the background.
+ * With SNAP_MPIIO collective over MPI_COMM_WORLD.
+ */
+void snap_async_write(const char *file, const float *buf, int n, int nsnap, int format)
+{
+    extern int SNAP_MPIIO;
+
+    SnapSlot *sl;
+
+    if (n != nvalue)
+        err("Snapshot of %d values does not fit the staging buffer of %d values!", n, nvalue);
+
+    /* wait for a free slot */
+    if (SNAP_MPIIO) {
+        if (count == nslot)
+            snap_async_complete();
+    } else {
+        pthread_mutex_lock(&lock);
+        while (count == nslot)
+            pthread_cond_wait(&cond, &lock);
+        pthread_mutex_unlock(&lock);
+        snap_async_check();
+    }
+
+    /* the slot at head is not in flight, so it is filled without locking */
+    sl = &slot[head];
+    strncpy(sl->file, file, STRING_SIZE - 1);
+    sl->file[STRING_SIZE - 1] = '\0';
+    memcpy(sl->buf, buf, n * sizeof(float));
+    sl->n = n;
+    sl->nsnap = nsnap;
+    sl->format = format;
+
+    if (SNAP_MPIIO) {
+        mpiio_iwrite_snap(sl->file, sl->buf, n, nsnap, &sl->fh, &sl->req);
+        head = (head + 1) % nslot;
+        count++;
+    } else {
+        pthread_mutex_lock(&lock);
+        head = (head + 1) % nslot;
+        count++;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+/**
+ * Wait until all snapshots handed to `snap_async_write` are written.
+ */
+void snap_async_wait(void)
+{
+    extern int SNAP_MPIIO;
+
+    if (slot == NULL)
+        return;
+
+    if (SNAP_MPIIO) {
+        while (count > 0)
+            snap_async_complete();
+    } else {
+        pthread_mutex_lock(&lock);
+        while (count > 0)
+            pthread_cond_wait(&cond, &lock);
+        pthread_mutex_unlock(&lock);
+        snap_async_check();
+    }
+}
+
+/**
+ * Write the remaining snapshots, stop the I/O thread and free the buffers.
+ */
+void snap_async_free(void)
+{
+    extern int SNAP_MPIIO;
+
+    int n;
+
+    if (slot == NULL)
+        return;
+
+    snap_async_wait();
+    if (!SNAP_MPIIO) {
+        pthread_mutex_lock(&lock);
+        done = 1;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&lock);
+        pthread_join(writer, NULL);
+    }
+
+    for (n = 0; n < nslot; n++)
+        free_vector(slot[n].buf, 0, nvalue - 1);
+    free(slot);
+    slot = NULL;
+}
@@ -64,9 +64,13 @@ static int snapmerge(int argc, char **argv)
     NXG = NX;
     NYG = NY;
     NZG = NZ;
-    NX = NXG / NPROCX;
-    NY = NYG / NPROCY;
-    NZ = NZG / NPROCZ;
+
+    /* subdomains of the PEs, written by the solver for DECOMP=1 and for
+       the automatic process grid if there are snapshots to merge */
+    if ((DECOMP || !NPROCX || !NPROCY || !NPROCZ) && SNAP && !SNAP_MPIIO)
+        decomp_read();
+    else
+        decomp_uniform();
 
     if (TSNAP2 > TIME) {
         fprintf(FP,
@@ -79,6 +83,13 @@ static int snapmerge(int argc, char **argv)
     nsnap = 1 + floor((TSNAP2 - TSNAP1) / TSNAPINC);
     fprintf(FP, "Number of snapshots to be saved: nsnap = %d\n", nsnap);
 
+    if (SNAP_MPIIO) {
+        fprintf(FP,
+            "Snapshots were written to global files (SNAP_MPIIO=1), "
+            "nothing to merge.\n");
+        return 0;
+    }
+
     switch (SNAP) {
         case 1: /*particle velocity*/
             merge(nsnap, 1);
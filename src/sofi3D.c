@@ -14,16 +14,25 @@
 #include "fd.h"
 #include "globvar.h"
 //#include "openacc.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 int main(int argc, char **argv)
 {
     // TODO: this needs to be moved to the json - ask Mahesh
     int RTM_FLAG = 0;
-    int ns, nt, nseismograms = 0, nf1, nf2;
+    int ns, nsect, nt, nseismograms = 0, nf1, nf2;
     int lsnap, nsnap = 0, lsamp = 0, nlsamp = 0, buffsize;
     int ntr = 0, ntr_loc = 0, ntr_glob = 0, nsrc = 0, nsrc_loc = 0;
     int ishot, nshots;
+    // Position in the time loop of a checkpoint, see checkpoint.c.
+    CheckptPos cpos;
+    int nt1 = 1, ishot1 = 1, resume = 0;
+    // Subdomains rebalanced after a shot (REBALANCE), see `decomp_rebalance`.
+    int rebalanced = 0;
+    double tloop, tsnap, tbusy;
 
     // Sizes of arrays containing 3D data.
     // "R" - rows, "C" - columns, "D" - depth.
@@ -33,9 +42,13 @@ int main(int argc, char **argv)
     int NCL, NCH;
     int NDL, NDH;
 
-    double time1 = 0.0, time2 = 0.0, time3 = 0.0, time4 = 0.0;
+    double time1 = 0.0, time2 = 0.0, time3 = 0.0, time4 = 0.0, time5 = 0.0;
     double *time_v_update, *time_s_update, *time_s_exchange, *time_v_exchange, *time_timestep;
     int *xb, *yb, *zb, l;
+    // Ghost planes of the wavefields and depth of the deep halo (HALO_DEEP), see halo_deep.c.
+    int hg, dg;
+    // Update boxes extended into the deep ghost zones, see `halo_deep_box`.
+    int vb[6], sb[6];
 
     float ***absorb_coeff = NULL;
 
@@ -85,6 +98,8 @@ int main(int argc, char **argv)
     float ***C66ipjp, ***C44jpkp, ***C55ipkp, ***tausipjp = NULL, ***tausjpkp = NULL, ***tausipkp = NULL, ***rjp, ***rkp, ***rip;
 
     OrthoPar op;
+    // Update coefficients of the viscoelastic medium (L > 0).
+    ViscoPar vp;
 
     // Global sources positions, local sources positions.
     float **srcpos = NULL, **srcpos_loc = NULL, **srcpos1 = NULL;
@@ -100,14 +115,34 @@ int main(int argc, char **argv)
 
 
     // Buffers that exchanges velocity on the subdomain boundaries.
-    float ***bufferlef_to_rig, ***bufferrig_to_lef;
-    float ***buffertop_to_bot, ***bufferbot_to_top;
-    float ***bufferfro_to_bac, ***bufferbac_to_fro;
+    float ***bufferlef_to_rig = NULL, ***bufferrig_to_lef = NULL;
+    float ***buffertop_to_bot = NULL, ***bufferbot_to_top = NULL;
+    float ***bufferfro_to_bac = NULL, ***bufferbac_to_fro = NULL;
 
     // Buffers that exchange stress tensor on the subdomain boundaries.
-    float ***sbufferlef_to_rig, ***sbufferrig_to_lef;
-    float ***sbuffertop_to_bot, ***sbufferbot_to_top;
-    float ***sbufferfro_to_bac, ***sbufferbac_to_fro;
+    float ***sbufferlef_to_rig = NULL, ***sbufferrig_to_lef = NULL;
+    float ***sbuffertop_to_bot = NULL, ***sbufferbot_to_top = NULL;
+    float ***sbufferfro_to_bac = NULL, ***sbufferbac_to_fro = NULL;
+
+    // Datatypes of the zero-copy exchange, used instead of the buffers (HALO_DATATYPE).
+    MPI_Datatype vtype_send[REQUEST_COUNT], vtype_rec[REQUEST_COUNT];
+    MPI_Datatype stype_send[REQUEST_COUNT], stype_rec[REQUEST_COUNT];
+    // Datatypes of the exchange of the deep halo of both fields (HALO_DEEP).
+    MPI_Datatype dtype_send[REQUEST_COUNT], dtype_rec[REQUEST_COUNT];
+
+    // Receive buffers and requests of the non-blocking exchange (OVERLAP_COMM, PERSISTENT_COMM).
+    float ***rbufferlef_to_rig = NULL, ***rbufferrig_to_lef = NULL;
+    float ***rbuffertop_to_bot = NULL, ***rbufferbot_to_top = NULL;
+    float ***rbufferfro_to_bac = NULL, ***rbufferbac_to_fro = NULL;
+    float ***rsbufferlef_to_rig = NULL, ***rsbufferrig_to_lef = NULL;
+    float ***rsbuffertop_to_bot = NULL, ***rsbufferbot_to_top = NULL;
+    float ***rsbufferfro_to_bac = NULL, ***rsbufferbac_to_fro = NULL;
+    MPI_Request req_send[REQUEST_COUNT], req_rec[REQUEST_COUNT];
+    MPI_Request sreq_send[REQUEST_COUNT], sreq_rec[REQUEST_COUNT];
+    // Inner box and boundary shell of the local grid, see `halo_split`.
+    int box[7][6], ibox, s_exchange_pending = 0;
+    // Boxes and slabs of the velocity and stress update in one sweep, see `wavefront_ini`.
+    int sbox[7][6], fbox[7][6], wf[4], *ub;
 
     // Seismogram data collected from all MPI processes.
     float **seismo_fulldata = NULL;
@@ -132,7 +167,17 @@ int main(int argc, char **argv)
     // MYID is initialized to the index of the process (from 0 to NP-1).
     extern int NP;
     extern int MYID;
-    MPI_Init(&argc, &argv);
+    // Only the master thread of each process calls MPI, the update
+    // kernels are threaded in between the exchanges and snapshots may be
+    // written by an I/O thread (SNAP_ASYNC).
+    int mpi_thread_level;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &mpi_thread_level);
+#ifdef _OPENMP
+    // One thread per process unless OMP_NUM_THREADS asks for more, so that
+    // the usual one process per core runs are not oversubscribed.
+    if ((getenv("OMP_NUM_THREADS") == NULL) || (mpi_thread_level < MPI_THREAD_FUNNELED))
+        omp_set_num_threads(1);
+#endif
     MPI_Comm_size(MPI_COMM_WORLD, &NP);
     MPI_Comm_rank(MPI_COMM_WORLD, &MYID);
 
@@ -148,6 +193,11 @@ int main(int argc, char **argv)
     /* Print program name, version, author etc to stdout. */
     if (MYID == 0)
         info(stdout);
+#ifdef _OPENMP
+    if (MYID == 0)
+        fprintf(stdout, " Running %d MPI process(es) with %d OpenMP thread(s) each.\n\n",
+                NP, omp_get_max_threads());
+#endif
     SOFI3DVERS = 33; /* 3D isotropic elastic */
 
     /* PE 0 is reading the parameters from the input file, default is ASOFI3D.json */
@@ -178,6 +228,28 @@ int main(int argc, char **argv)
     /* PE 0 will broadcast the parameters to all others PEs */
     exchange_par();
 
+    /* without MPI_THREAD_FUNNELED no thread may run besides the one calling
+       MPI: the kernels are not threaded (see above), and the snapshots and
+       checkpoints are written without the I/O threads */
+    if (mpi_thread_level < MPI_THREAD_FUNNELED) {
+        if (MYID == 0)
+            warning(" The MPI library does not support MPI_THREAD_FUNNELED: one thread per process, no snapshot and checkpoint I/O threads (SNAP_ASYNC=0, CHECKPT_ASYNC=0). ");
+        if (!SNAP_MPIIO)
+            SNAP_ASYNC = 0;
+        CHECKPT_ASYNC = 0;
+    }
+
+    /* select the update kernels for FDORDER, FDORDER_TIME and this CPU */
+    update_v_kernel_ini();
+    update_s_elastic_kernel_ini();
+    update_s_kernel_ini();
+    if (MYID == 0) {
+        fprintf(stdout, " Stress update kernel: %s\n", update_s_elastic_simd_name());
+        if (FOLD_COEFF && (FDORDER_TIME == 2) && (FDORDER > 2))
+            fprintf(stdout, " DT and grid spacing are folded into the FD coefficients.\n");
+        fprintf(stdout, "\n");
+    }
+
     /* Print info on log-files to stdout */
     if (MYID == 0)
         note(stdout);
@@ -211,8 +283,20 @@ int main(int argc, char **argv)
 
     fprintf(FP, " This is the log-file generated by PE %d \n\n", MYID);
 
+    /* NXG, NYG NZG denote size of the entire (global) grid */
+    NXG = NX;
+    NYG = NY;
+    NZG = NZ;
+
+    /* global receiver locations, weighted by the domain decomposition */
+    if (SEISMO)
+    {
+        fprintf(FP, "\n ------------------ READING RECEIVER PARAMETERS ----------------- \n");
+        recpos = receiver(FP, &ntr);
+    }
+
     /* domain decomposition */
-    initproc();
+    initproc(recpos, ntr);
 
     /* set some time counters */
     NT = (int)ceil(TIME / DT); /* number of timesteps - replaces: NT=iround(TIME/DT); */
@@ -237,1208 +321,1696 @@ int main(int argc, char **argv)
     if (MYID == 0)
         writepar(FP, ns);
 
-    /* NXG, NYG NZG denote size of the entire (global) grid */
-    NXG = NX;
-    NYG = NY;
-    NZG = NZ;
-
-    /* In the following, NX, MY, NZ denote size of the local grid ! */
-    NX = IENDX;
-    NY = IENDY;
-    NZ = IENDZ;
-
-    /* compute receiver locations within each subgrid and
-       store local receiver coordinates in recpos_loc */
-    if (SEISMO)
+    /* the shots are simulated in epochs of the same subdomains, a new epoch
+       starts after the subdomains have been rebalanced (REBALANCE=1) */
+    do
     {
-        fprintf(FP, "\n ------------------ READING RECEIVER PARAMETERS ----------------- \n");
-        recpos = receiver(FP, &ntr);
-        recswitch = ivector(1, ntr);
-        recpos_loc = splitrec(recpos, &ntr_loc, ntr, recswitch);
-        ntr_glob = ntr;
-        ntr = ntr_loc;
-        fprintf(FP,"SEISMO = %d, ntr = %d\n\n", ntr, SEISMO);
-    }
+        /* In the following, NX, MY, NZ denote size of the local grid ! */
+        NX = IENDX;
+        NY = IENDY;
+        NZ = IENDZ;
 
-    /* number of seismogram sections which have to be stored in core memory*/
-    /* allocation of memory for seismogramm merge */
-    switch (SEISMO)
-    {
-        case 1: /* particle velocities only */
-            nseismograms = 3;
-            break;
-        case 2: /* pressure only */
-            nseismograms = 1;
-            break;
-        case 3: /* curl and div only */
-            nseismograms = 2;
-            break;
-        case 4: /* everything */
-            nseismograms = 6;
-            break;
-        default:
-            nseismograms = 0;
-            break;
-    }
+        /* cache blocking of the wavefield updates */
+        tile_ini();
 
-    /*allocate memory for dynamic, static and buffer arrays */
-    fac1 = (NZ + FDORDER) * (NY + FDORDER) * (NX + FDORDER);
-    fac2 = sizeof(float) * pow(2.0, -20.0);
+        /* staging buffers of asynchronous snapshot output */
+        snap_async_ini();
 
-    if (L > 0)
-    { /*viscoelastic case*/
-        if (FDORDER_TIME == 2)
+        /* compute receiver locations within each subgrid and
+           store local receiver coordinates in recpos_loc */
+        if (SEISMO)
         {
-            memdyn = 15.0 * fac1 * fac2;
-            memmodel = 16.0 * fac1 * fac2;
+            recswitch = ivector(1, ntr);
+            recpos_loc = splitrec(recpos, &ntr_loc, ntr, recswitch);
+            ntr_glob = ntr;
+            ntr = ntr_loc;
+            fprintf(FP,"SEISMO = %d, ntr = %d\n\n", ntr, SEISMO);
         }
-        else
+
+        /* number of samples of the seismogram sections of the PEs (all ns samples,
+           or the blocks of SEIS_STREAM samples streamed to disk, see seisstream.c) */
+        nsect = seisstream_ini(ntr, ntr_glob, recswitch, ns);
+
+        /* number of seismogram sections which have to be stored in core memory*/
+        /* allocation of memory for seismogramm merge */
+        switch (SEISMO)
         {
-            if (FDORDER_TIME == 3)
+            case 1: /* particle velocities only */
+                nseismograms = 3;
+                break;
+            case 2: /* pressure only */
+                nseismograms = 1;
+                break;
+            case 3: /* curl and div only */
+                nseismograms = 2;
+                break;
+            case 4: /* everything */
+                nseismograms = 6;
+                break;
+            default:
+                nseismograms = 0;
+                break;
+        }
+
+        /*allocate memory for dynamic, static and buffer arrays */
+        fac1 = (NZ + FDORDER) * (NY + FDORDER) * (NX + FDORDER);
+        fac2 = sizeof(float) * pow(2.0, -20.0);
+
+        if (L > 0)
+        { /*viscoelastic case*/
+            if (FDORDER_TIME == 2)
             {
-                memdyn = 57 * fac1 * fac2;
-                memmodel = 16.0 * fac1 * fac2;
+                memdyn = 15.0 * fac1 * fac2;
+                memmodel = 26.0 * fac1 * fac2;
             }
             else
             {
-                memdyn = 78 * fac1 * fac2;
-                memmodel = 16.0 * fac1 * fac2;
+                if (FDORDER_TIME == 3)
+                {
+                    memdyn = 57 * fac1 * fac2;
+                    memmodel = 26.0 * fac1 * fac2;
+                }
+                else
+                {
+                    memdyn = 78 * fac1 * fac2;
+                    memmodel = 26.0 * fac1 * fac2;
+                }
             }
         }
-    }
-    else
-    { /* elastic case*/
-        if (FDORDER_TIME == 2)
-        {
-            memdyn = 9.0 * fac1 * fac2;
-            memmodel = 10.0 * fac1 * fac2;
-        }
         else
-        {
-            if (FDORDER_TIME == 3)
+        { /* elastic case*/
+            if (FDORDER_TIME == 2)
             {
-                memdyn = 39 * fac1 * fac2;
+                memdyn = 9.0 * fac1 * fac2;
                 memmodel = 10.0 * fac1 * fac2;
             }
             else
             {
-                memdyn = 49 * fac1 * fac2;
-                memmodel = 10.0 * fac1 * fac2;
+                if (FDORDER_TIME == 3)
+                {
+                    memdyn = 39 * fac1 * fac2;
+                    memmodel = 10.0 * fac1 * fac2;
+                }
+                else
+                {
+                    memdyn = 49 * fac1 * fac2;
+                    memmodel = 10.0 * fac1 * fac2;
+                }
             }
         }
-    }
-
-    memseismograms = nseismograms * ntr_glob * ns * fac2 + nseismograms * ntr * ns * fac2;
-    membuffer = (2.0 * (3.0 * FDORDER / 2 - 1) * (NY * NZ + NX * NZ + NY * NX) + 2.0 * (3.0 * FDORDER / 2 - 2) * (NY * NZ + NX * NZ + NY * NX)) * fac2;
-    membuffer = 4.0 * 6.0 * ((NX * NZ) + (NY * NZ) + (NX * NY)) * fac2;
-    if (ABS_TYPE == 1)
-        memcpml = 2.0 * FW * 6.0 * (NY * NZ + NX * NZ + NY * NX) * fac2 + 24.0 * 2.0 * FW * fac2;
-    buffsize = (FDORDER)*4.0 * 6.0 * (max((NX * NZ), max((NY * NZ), (NX * NY)))) * sizeof(MPI_FLOAT);
-    memtotal = memdyn + memmodel + memseismograms + membuffer + memcpml + (buffsize * pow(2.0, -20.0));
 
-    if (MYID == 0)
-    {
-        fprintf(FP, "\n ----------------------------------------------------------------");
-        fprintf(FP, "\n ------------------ MEMORY ALLOCATION --------------------------- \n");
-        fprintf(FP, "\n **Message from main (printed by PE %d):\n", MYID);
-        fprintf(FP, " Size of local grids: NX=%d \t NY=%d \t NZ=%d \n", NX, NY, NZ);
-        fprintf(FP, " Each process is now trying to allocate memory for:\n");
-        fprintf(FP, " Dynamic variables: \t\t %6.2f MB\n", memdyn);
-        fprintf(FP, " Static variables: \t\t %6.2f MB\n", memmodel);
-        fprintf(FP, " Seismograms: \t\t\t %6.2f MB\n", memseismograms);
+        memseismograms = nseismograms * ntr_glob * ns * fac2 + nseismograms * ntr * nsect * fac2;
+        membuffer = (2.0 * (3.0 * FDORDER / 2 - 1) * (NY * NZ + NX * NZ + NY * NX) + 2.0 * (3.0 * FDORDER / 2 - 2) * (NY * NZ + NX * NZ + NY * NX)) * fac2;
+        membuffer = 4.0 * 6.0 * ((NX * NZ) + (NY * NZ) + (NX * NY)) * fac2;
+        if (HALO_DATATYPE)
+            membuffer = 0.0;
         if (ABS_TYPE == 1)
-            fprintf(FP, " CPML memory variables : \t %6.2f MB\n", memcpml);
-        fprintf(FP, " Buffer arrays for grid exchange:%6.2f MB\n", membuffer);
-        fprintf(FP, " Network Buffer for MPI_Bsend: \t %6.2f MB\n\n", buffsize * pow(2.0, -20.0));
-        fprintf(FP, " Total memory required: \t %6.2f MB.\n", memtotal);
-        fprintf(FP, " Please note that the memory consumption is only a good estimate! ");
-        fprintf(FP, "\n ---------------------------------------------------------------- \n\n");
-    }
-
-    /* allocate buffer for buffering messages */
-    buff_addr = malloc(buffsize);
-    if (!buff_addr)
-        err("allocation failure for buffer for MPI_Bsend !");
-    MPI_Buffer_attach(buff_addr, buffsize);
-
-    /* allocation for timing arrays used for performance analysis */
-    time_v_update = dvector(1, NT);
-    time_s_update = dvector(1, NT);
-    time_s_exchange = dvector(1, NT);
-    time_v_exchange = dvector(1, NT);
-    time_timestep = dvector(1, NT);
-
-    l = 1;
-    if (ABS_TYPE == 1 && FDORDER == 2)
-    {
-        l = 2;
-    }
-
-    // ------------------------------------------------------------------------
-    // Memory allocation for the dynamic (wavefield) arrays.
-    if (POS[2] == 0)
-    {
-        NRL = 0 - FDORDER / 2;
-    } else {
-        NRL = 1 - l * FDORDER / 2;
-    }
-
-    NRH = NY + l * FDORDER / 2;
-    NCL = 1 - l * FDORDER / 2;
-    NCH = NX + l * FDORDER / 2;
-    NDL = 1 - l * FDORDER / 2;
-    NDH = NZ + l * FDORDER / 2;
-    init_velocity(&v, NRL, NRH, NCL, NCH, NDL, NDH);
-
-    if (FDORDER_TIME != 2)
-    {
-        // Allocate memory for the quantities necessary
-        // for the Adams-Bashforth method. */
-        init_velocity_derivatives_tensor(&dv, NRL, NRH, NCL, NCH, NDL, NDH);
-        init_velocity_derivatives_tensor(&dv_2, NRL, NRH, NCL, NCH, NDL, NDH);
-        init_velocity_derivatives_tensor(&dv_3, NRL, NRH, NCL, NCH, NDL, NDH);
+            memcpml = 2.0 * FW * 6.0 * (NY * NZ + NX * NZ + NY * NX) * fac2 + 24.0 * 2.0 * FW * fac2;
+        buffsize = (FDORDER)*4.0 * 6.0 * (max((NX * NZ), max((NY * NZ), (NX * NY)))) * sizeof(MPI_FLOAT);
+        memtotal = memdyn + memmodel + memseismograms + membuffer + memcpml + (buffsize * pow(2.0, -20.0));
 
-        init_stress_derivatives_wrt_velocity(&ds_dv, NRL, NRH, NCL, NCH, NDL, NDH);
-        init_stress_derivatives_wrt_velocity(&ds_dv_2, NRL, NRH, NCL, NCH, NDL, NDH);
-        init_stress_derivatives_wrt_velocity(&ds_dv_3, NRL, NRH, NCL, NCH, NDL, NDH);
-
-        if (FDORDER_TIME == 4)
+        if (MYID == 0)
         {
-            init_stress_derivatives_wrt_velocity(&ds_dv_4, NRL, NRH, NCL, NCH, NDL, NDH);
-            init_velocity_derivatives_tensor(&dv_4, NRL, NRH, NCL, NCH, NDL, NDH);
+            fprintf(FP, "\n ----------------------------------------------------------------");
+            fprintf(FP, "\n ------------------ MEMORY ALLOCATION --------------------------- \n");
+            fprintf(FP, "\n **Message from main (printed by PE %d):\n", MYID);
+            fprintf(FP, " Size of local grids: NX=%d \t NY=%d \t NZ=%d \n", NX, NY, NZ);
+            fprintf(FP, " Each process is now trying to allocate memory for:\n");
+            fprintf(FP, " Dynamic variables: \t\t %6.2f MB\n", memdyn);
+            fprintf(FP, " Static variables: \t\t %6.2f MB\n", memmodel);
+            fprintf(FP, " Seismograms: \t\t\t %6.2f MB\n", memseismograms);
+            if (ABS_TYPE == 1)
+                fprintf(FP, " CPML memory variables : \t %6.2f MB\n", memcpml);
+            fprintf(FP, " Buffer arrays for grid exchange:%6.2f MB\n", membuffer);
+            fprintf(FP, " Network Buffer for MPI_Bsend: \t %6.2f MB\n\n", buffsize * pow(2.0, -20.0));
+            fprintf(FP, " Total memory required: \t %6.2f MB.\n", memtotal);
+            fprintf(FP, " Please note that the memory consumption is only a good estimate! ");
+            fprintf(FP, "\n ---------------------------------------------------------------- \n\n");
         }
-    }
 
-    s.xy = f3tensor(NRL, NRH, NCL, NCH, NDL, NDH);
-    s.yz = f3tensor(NRL, NRH, NCL, NCH, NDL, NDH);
+        /* allocate buffer for buffering messages */
+        buff_addr = malloc(buffsize);
+        if (!buff_addr)
+            err("allocation failure for buffer for MPI_Bsend !");
+        MPI_Buffer_attach(buff_addr, buffsize);
+
+        /* allocation for timing arrays used for performance analysis */
+        time_v_update = dvector(1, NT);
+        time_s_update = dvector(1, NT);
+        time_s_exchange = dvector(1, NT);
+        time_v_exchange = dvector(1, NT);
+        time_timestep = dvector(1, NT);
+
+        l = 1;
+        if (ABS_TYPE == 1 && FDORDER == 2)
+        {
+            l = 2;
+        }
 
-    s.xz = f3tensor(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    s.xx = f3tensor(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    s.yy = f3tensor(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    s.zz = f3tensor(1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+        /* the redundant update of HALO_DEEP needs deeper ghost zones */
+        dg = halo_deep_depth();
+        hg = dg ? dg : l * FDORDER / 2;
 
-    xb = ivector(0, 1);
-    yb = ivector(0, 1);
-    zb = ivector(0, 1);
+        // ------------------------------------------------------------------------
+        // Memory allocation for the dynamic (wavefield) arrays.
+        if (POS[2] == 0)
+        {
+            NRL = min(0 - FDORDER / 2, 1 - hg);
+        } else {
+            NRL = 1 - hg;
+        }
 
-    if (L)
-    { /* no allocation in case of purely elastic simulation */
-        /* memory allocation for dynamic (model) arrays */
-        init_tensor3d(&r, 1, NY, 1, NX, 1, NZ);
+        NRH = NY + hg;
+        NCL = 1 - hg;
+        NCH = NX + hg;
+        NDL = 1 - hg;
+        NDH = NZ + hg;
+        init_velocity(&v, NRL, NRH, NCL, NCH, NDL, NDH);
 
-        // Allocate memory for Adams-Bashforth method.
         if (FDORDER_TIME != 2)
         {
-            init_tensor3d(&r_2, 1, NY, 1, NX, 1, NZ);
-            init_tensor3d(&r_3, 1, NY, 1, NX, 1, NZ);
+            // Allocate memory for the quantities necessary
+            // for the Adams-Bashforth method. */
+            init_velocity_derivatives_tensor(&dv, NRL, NRH, NCL, NCH, NDL, NDH);
+            init_velocity_derivatives_tensor(&dv_2, NRL, NRH, NCL, NCH, NDL, NDH);
+            init_velocity_derivatives_tensor(&dv_3, NRL, NRH, NCL, NCH, NDL, NDH);
+
+            init_stress_derivatives_wrt_velocity(&ds_dv, NRL, NRH, NCL, NCH, NDL, NDH);
+            init_stress_derivatives_wrt_velocity(&ds_dv_2, NRL, NRH, NCL, NCH, NDL, NDH);
+            init_stress_derivatives_wrt_velocity(&ds_dv_3, NRL, NRH, NCL, NCH, NDL, NDH);
 
             if (FDORDER_TIME == 4)
             {
-                init_tensor3d(&r_4, 1, NY, 1, NX, 1, NZ);
+                init_stress_derivatives_wrt_velocity(&ds_dv_4, NRL, NRH, NCL, NCH, NDL, NDH);
+                init_velocity_derivatives_tensor(&dv_4, NRL, NRH, NCL, NCH, NDL, NDH);
             }
         }
 
-        /* memory allocation for static (model) arrays */
-        taus = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-        taup = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-        tausipjp = f3tensor(1, NY, 1, NX, 1, NZ);
-        tausjpkp = f3tensor(1, NY, 1, NX, 1, NZ);
-        tausipkp = f3tensor(1, NY, 1, NX, 1, NZ);
-        eta = vector(1, L);
-    }
+        s.xy = f3tensor_aligned(NRL, NRH, NCL, NCH, NDL, NDH);
+        s.yz = f3tensor_aligned(NRL, NRH, NCL, NCH, NDL, NDH);
 
-    /* memory allocation for static (model) arrays */
-    rho = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    pi = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    // adding Cij variables by VK
-    C11 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C12 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C13 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C22 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C23 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C33 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C44 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C55 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    C66 = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-
-    // still keeping u = mu and pi = lambda + 2*mu (just in case) ;)
-    u = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
-
-    absorb_coeff = f3tensor(1, NY, 1, NX, 1, NZ);
-
-    /* averaged material parameters */
-    C66ipjp = f3tensor(1, NY, 1, NX, 1, NZ);
-    C44jpkp = f3tensor(1, NY, 1, NX, 1, NZ);
-    C55ipkp = f3tensor(1, NY, 1, NX, 1, NZ);
-    rjp = f3tensor(1, NY, 1, NX, 1, NZ);
-    rkp = f3tensor(1, NY, 1, NX, 1, NZ);
-    rip = f3tensor(1, NY, 1, NX, 1, NZ);
-
-    /* memory allocation for CPML variables*/
-    if (ABS_TYPE == 1)
-    {
-        K_x = vector(1, 2 * FW);
-        alpha_prime_x = vector(1, 2 * FW);
-        a_x = vector(1, 2 * FW);
-        b_x = vector(1, 2 * FW);
-        K_x_half = vector(1, 2 * FW);
-        alpha_prime_x_half = vector(1, 2 * FW);
-        a_x_half = vector(1, 2 * FW);
-        b_x_half = vector(1, 2 * FW);
-
-        K_y = vector(1, 2 * FW);
-        alpha_prime_y = vector(1, 2 * FW);
-        a_y = vector(1, 2 * FW);
-        b_y = vector(1, 2 * FW);
-        K_y_half = vector(1, 2 * FW);
-        alpha_prime_y_half = vector(1, 2 * FW);
-        a_y_half = vector(1, 2 * FW);
-        b_y_half = vector(1, 2 * FW);
-
-        K_z = vector(1, 2 * FW);
-        alpha_prime_z = vector(1, 2 * FW);
-        a_z = vector(1, 2 * FW);
-        b_z = vector(1, 2 * FW);
-        K_z_half = vector(1, 2 * FW);
-        alpha_prime_z_half = vector(1, 2 * FW);
-        a_z_half = vector(1, 2 * FW);
-        b_z_half = vector(1, 2 * FW);
-
-        psi_sxx_x = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
-        psi_sxy_x = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
-        psi_sxz_x = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
-        psi_syy_y = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
-        psi_sxy_y = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
-        psi_syz_y = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
-        psi_szz_z = f3tensor(1, NY, 1, NX, 1, 2 * FW);
-        psi_sxz_z = f3tensor(1, NY, 1, NX, 1, 2 * FW);
-        psi_syz_z = f3tensor(1, NY, 1, NX, 1, 2 * FW);
-
-        psi_vxx = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
-        psi_vyy = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
-        psi_vzz = f3tensor(1, NY, 1, NX, 1, 2 * FW);
-        psi_vxy = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
-        psi_vxz = f3tensor(1, NY, 1, NX, 1, 2 * FW);
-        psi_vyx = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
-        psi_vyz = f3tensor(1, NY, 1, NX, 1, 2 * FW);
-        psi_vzx = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
-        psi_vzy = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
-    }
+        s.xz = f3tensor_aligned(1 - hg, NRH, NCL, NCH, NDL, NDH);
+        s.xx = f3tensor_aligned(1 - hg, NRH, NCL, NCH, NDL, NDH);
+        s.yy = f3tensor_aligned(1 - hg, NRH, NCL, NCH, NDL, NDH);
+        s.zz = f3tensor_aligned(1 - hg, NRH, NCL, NCH, NDL, NDH);
 
-    /* memory allocation for buffer arrays in which the wavefield information which is exchanged between neighboring PEs is stored */
+        xb = ivector(0, 1);
+        yb = ivector(0, 1);
+        zb = ivector(0, 1);
 
-    /* number of wavefield parameters that need to be exchanged - see exchange_v.c */
-    nf1 = (3 * FDORDER / 2) - 1;
-    nf2 = nf1 - 1;
+        if (L)
+        { /* no allocation in case of purely elastic simulation */
+            /* memory allocation for dynamic (model) arrays */
+            init_tensor3d(&r, 1, NY, 1, NX, 1, NZ);
 
-    bufferlef_to_rig = f3tensor(1, NY, 1, NZ, 1, nf1);
-    bufferrig_to_lef = f3tensor(1, NY, 1, NZ, 1, nf2);
-    buffertop_to_bot = f3tensor(1, NX, 1, NZ, 1, nf1);
-    bufferbot_to_top = f3tensor(1, NX, 1, NZ, 1, nf2);
-    bufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf1);
-    bufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf2);
+            // Allocate memory for Adams-Bashforth method.
+            if (FDORDER_TIME != 2)
+            {
+                init_tensor3d(&r_2, 1, NY, 1, NX, 1, NZ);
+                init_tensor3d(&r_3, 1, NY, 1, NX, 1, NZ);
 
-    sbufferlef_to_rig = f3tensor(1, NY, 1, NZ, 1, nf2);
-    sbufferrig_to_lef = f3tensor(1, NY, 1, NZ, 1, nf1);
-    sbuffertop_to_bot = f3tensor(1, NX, 1, NZ, 1, nf2);
-    sbufferbot_to_top = f3tensor(1, NX, 1, NZ, 1, nf1);
-    sbufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf2);
-    sbufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf1);
+                if (FDORDER_TIME == 4)
+                {
+                    init_tensor3d(&r_4, 1, NY, 1, NX, 1, NZ);
+                }
+            }
 
-    /* allocate buffer for seismogram output, merged seismogram section of all PEs */
-    if (SEISMO)
-        seismo_fulldata = fmatrix(1, ntr_glob, 1, ns);
+            /* memory allocation for static (model) arrays, after the rebalancing
+               the model of the previous subdomains is moved to the new ones */
+            if (rebalanced)
+            {
+                taus = decomp_redistribute(taus, 0);
+                taup = decomp_redistribute(taup, 0);
+            }
+            else
+            {
+                taus = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                taup = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                eta = vector(1, L);
+            }
+            tausipjp = f3tensor(1, NY, 1, NX, 1, NZ);
+            tausjpkp = f3tensor(1, NY, 1, NX, 1, NZ);
+            tausipkp = f3tensor(1, NY, 1, NX, 1, NZ);
+            init_visco_par(&vp, 1, NY, 1, NX, 1, NZ);
+        }
 
-    /* allocate buffer for seismogram output, seismogram section of each PE */
-    if (ntr > 0)
-    {
-        switch (SEISMO)
+        /* memory allocation for static (model) arrays */
+        if (rebalanced)
         {
-            case 1: /* particle velocities only */
-                sectionvx = fmatrix(1, ntr, 1, ns);
-                sectionvy = fmatrix(1, ntr, 1, ns);
-                sectionvz = fmatrix(1, ntr, 1, ns);
-                break;
-            case 2: /* pressure only */
-                sectionp = fmatrix(1, ntr, 1, ns);
-                break;
-            case 3: /* curl and div only */
-                sectioncurl = fmatrix(1, ntr, 1, ns);
-                sectiondiv = fmatrix(1, ntr, 1, ns);
-                break;
-            case 4: /* everything */
-                sectionvx = fmatrix(1, ntr, 1, ns);
-                sectionvy = fmatrix(1, ntr, 1, ns);
-                sectionvz = fmatrix(1, ntr, 1, ns);
-                sectioncurl = fmatrix(1, ntr, 1, ns);
-                sectiondiv = fmatrix(1, ntr, 1, ns);
-                sectionp = fmatrix(1, ntr, 1, ns);
-                break;
+            rho = decomp_redistribute(rho, 1);
+            pi = decomp_redistribute(pi, 1);
+            u = decomp_redistribute(u, 1);
+            C11 = decomp_redistribute(C11, 1);
+            C12 = decomp_redistribute(C12, 1);
+            C13 = decomp_redistribute(C13, 1);
+            C22 = decomp_redistribute(C22, 1);
+            C23 = decomp_redistribute(C23, 1);
+            C33 = decomp_redistribute(C33, 1);
+            C44 = decomp_redistribute(C44, 1);
+            C55 = decomp_redistribute(C55, 1);
+            C66 = decomp_redistribute(C66, 1);
         }
-    }
-    int irtm;
-    for (irtm = 0; irtm <= RTM_FLAG; irtm++)
-    {
-        if (irtm>0)
+        else
         {
-            lsnap =  iround(TSNAP1 / DT);
+            rho = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            pi = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            // adding Cij variables by VK
+            C11 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            C12 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            C13 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            C22 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            C23 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            C33 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            C44 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            C55 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            C66 = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+
+            // still keeping u = mu and pi = lambda + 2*mu (just in case) ;)
+            u = f3tensor_aligned(-dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
         }
-        if (MYID == 0)
-            fprintf(FP, " ... memory allocation for PE %d was successfull.\n\n", MYID);
 
-        /* memory for source position definition */
-        srcpos1 = fmatrix(1, 6, 1, 1);
+        absorb_coeff = f3tensor(1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
 
-        /* Reading source positions from SOURCE_FILE */
-        fprintf(FP, "\n ------------------ READING SOURCE PARAMETERS ------------------- \n");
-        switch (SRCREC)
-        {
-            case 0:
-                if (MYID == 0)
-                    err("SRCREC parameter is invalid (SRCREC!=1)! No source parameters specified!");
-                break;
-            case 1:
-                if (MYID == 0)
-                {
-                    fprintf(FP, "\n Reading source parameters from file: %s (ASOFI3D source format)\n", SOURCE_FILE);
+        /* averaged material parameters */
+        C66ipjp = f3tensor_aligned(1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        C44jpkp = f3tensor_aligned(1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        C55ipkp = f3tensor_aligned(1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        rjp = f3tensor_aligned(1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        rkp = f3tensor_aligned(1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        rip = f3tensor_aligned(1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
 
-                    if ((fpsrc = fopen(SOURCE_FILE, "r")) == NULL)
-                        err(" Source file could not be opened !");
-                    while (fgets(buffer, STRING_SIZE, fpsrc))
-                    {
-                        sscanf(buffer, "%s", bufferstring);
-                        /* checks if the line contains a '%'character which indicates a comment line,
-                           and if the reading of a string was successful, which is not the case for an empty line*/
-                        if ((strchr(buffer, '#') == 0) && (sscanf(buffer, "%s", bufferstring) == 1))
-                            ++(nsrc);
-                    }
-                    rewind(fpsrc);
-                    if ((nsrc) == 0)
-                        fprintf(FP, "\n WARNING: Could not determine number of sources parameter sets in input file. Assuming %d.\n", (nsrc = 0));
-                    else
-                        fprintf(FP, " Number of source positions specified in %s : %d \n", SOURCE_FILE, nsrc);
-                }
+        /* memory allocation for CPML variables*/
+        if (ABS_TYPE == 1)
+        {
+            K_x = vector(1, 2 * FW);
+            alpha_prime_x = vector(1, 2 * FW);
+            a_x = vector(1, 2 * FW);
+            b_x = vector(1, 2 * FW);
+            K_x_half = vector(1, 2 * FW);
+            alpha_prime_x_half = vector(1, 2 * FW);
+            a_x_half = vector(1, 2 * FW);
+            b_x_half = vector(1, 2 * FW);
+
+            K_y = vector(1, 2 * FW);
+            alpha_prime_y = vector(1, 2 * FW);
+            a_y = vector(1, 2 * FW);
+            b_y = vector(1, 2 * FW);
+            K_y_half = vector(1, 2 * FW);
+            alpha_prime_y_half = vector(1, 2 * FW);
+            a_y_half = vector(1, 2 * FW);
+            b_y_half = vector(1, 2 * FW);
+
+            K_z = vector(1, 2 * FW);
+            alpha_prime_z = vector(1, 2 * FW);
+            a_z = vector(1, 2 * FW);
+            b_z = vector(1, 2 * FW);
+            K_z_half = vector(1, 2 * FW);
+            alpha_prime_z_half = vector(1, 2 * FW);
+            a_z_half = vector(1, 2 * FW);
+            b_z_half = vector(1, 2 * FW);
+
+            psi_sxx_x = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
+            psi_sxy_x = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
+            psi_sxz_x = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
+            psi_syy_y = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
+            psi_sxy_y = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
+            psi_syz_y = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
+            psi_szz_z = f3tensor(1, NY, 1, NX, 1, 2 * FW);
+            psi_sxz_z = f3tensor(1, NY, 1, NX, 1, 2 * FW);
+            psi_syz_z = f3tensor(1, NY, 1, NX, 1, 2 * FW);
+
+            psi_vxx = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
+            psi_vyy = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
+            psi_vzz = f3tensor(1, NY, 1, NX, 1, 2 * FW);
+            psi_vxy = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
+            psi_vxz = f3tensor(1, NY, 1, NX, 1, 2 * FW);
+            psi_vyx = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
+            psi_vyz = f3tensor(1, NY, 1, NX, 1, 2 * FW);
+            psi_vzx = f3tensor(1, NY, 1, 2 * FW, 1, NZ);
+            psi_vzy = f3tensor(1, 2 * FW, 1, NX, 1, NZ);
+        }
 
-                MPI_Barrier(MPI_COMM_WORLD);
-                MPI_Bcast(&nsrc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        /* memory allocation for buffer arrays in which the wavefield information which is exchanged between neighboring PEs is stored */
 
-                stype = ivector(1, nsrc);
-                srcpos = sources(fpsrc, &nsrc, stype);
+        /* number of wavefield parameters that need to be exchanged - see exchange_v.c */
+        nf1 = (3 * FDORDER / 2) - 1;
+        nf2 = nf1 - 1;
 
-                /*originally, SOURCE_TYPE=stype is defined in the source file, if not, SOURCE_TYPE is taken from the input file */
-                /*if (stype==NULL) printf("PE%d: Source type(s) undefined?! \n",MYID);*/
+        if (HALO_DATATYPE)
+        {
+            /* MPI reads and writes the ghost planes of the wavefields directly */
+            exchange_v_types(&v, vtype_send, vtype_rec);
+            exchange_s_types(&s, stype_send, stype_rec);
+        }
+        else if (dg)
+        {
+            /* ghost zones of both fields exchanged every HALO_DEEP time steps */
+            halo_deep_ini(&v, &s, dtype_send, dtype_rec);
+        }
+        else if (HALO_SHM)
+        {
+            /* buffers in shared memory, read directly by the neighbours on the node */
+            halo_shm_ini(HALO_SHM_V, nf1, nf2);
+            halo_shm_ini(HALO_SHM_S, nf2, nf1);
+        }
+        else
+        {
+            bufferlef_to_rig = f3tensor(1, NY, 1, NZ, 1, nf1);
+            bufferrig_to_lef = f3tensor(1, NY, 1, NZ, 1, nf2);
+            buffertop_to_bot = f3tensor(1, NX, 1, NZ, 1, nf1);
+            bufferbot_to_top = f3tensor(1, NX, 1, NZ, 1, nf2);
+            bufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf1);
+            bufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf2);
+
+            sbufferlef_to_rig = f3tensor(1, NY, 1, NZ, 1, nf2);
+            sbufferrig_to_lef = f3tensor(1, NY, 1, NZ, 1, nf1);
+            sbuffertop_to_bot = f3tensor(1, NX, 1, NZ, 1, nf2);
+            sbufferbot_to_top = f3tensor(1, NX, 1, NZ, 1, nf1);
+            sbufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf2);
+            sbufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf1);
+        }
 
-                break;
-            case 2:
-                if ((PLANE_WAVE_DEPTH > 0))
-                {
-                    if (MYID == 0)
-                    {
-                        /*stype=(int *)malloc(nsrc*sizeof(int));*/ /* for unknown reasons, the pointer does not point to memory that has been allocated by a subroutine this way */
+        /* separate receive buffers for the non-blocking exchange */
+        if ((OVERLAP_COMM || PERSISTENT_COMM) && !HALO_DATATYPE)
+        {
+            rbufferlef_to_rig = f3tensor(1, NY, 1, NZ, 1, nf1);
+            rbufferrig_to_lef = f3tensor(1, NY, 1, NZ, 1, nf2);
+            rbuffertop_to_bot = f3tensor(1, NX, 1, NZ, 1, nf1);
+            rbufferbot_to_top = f3tensor(1, NX, 1, NZ, 1, nf2);
+            rbufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf1);
+            rbufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf2);
+
+            rsbufferlef_to_rig = f3tensor(1, NY, 1, NZ, 1, nf2);
+            rsbufferrig_to_lef = f3tensor(1, NY, 1, NZ, 1, nf1);
+            rsbuffertop_to_bot = f3tensor(1, NX, 1, NZ, 1, nf2);
+            rsbufferbot_to_top = f3tensor(1, NX, 1, NZ, 1, nf1);
+            rsbufferfro_to_bac = f3tensor(1, NY, 1, NX, 1, nf2);
+            rsbufferbac_to_fro = f3tensor(1, NY, 1, NX, 1, nf1);
+        }
 
-                        /*determining the number of sources in the specified plane normal/tilted to the surface/upper model boundary*/
-                        nsrc = (NXG - 2 * FW + 1) * (NZG - 2 * FW + 1);
-                        /*fprintf(FP,"\n nsrc= %i with NGX=%i, NYG=%i and FW=%i. \n",nsrc,NXG,NYG,FW);*/
-                    }
+        /* comunication initialisation for persistent communication */
+        if (PERSISTENT_COMM)
+        {
+            comm_ini(bufferlef_to_rig, bufferrig_to_lef,
+                    buffertop_to_bot, bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro,
+                    rbufferlef_to_rig, rbufferrig_to_lef,
+                    rbuffertop_to_bot, rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro,
+                    HALO_DATATYPE ? vtype_send : NULL, HALO_DATATYPE ? vtype_rec : NULL,
+                    req_send, req_rec);
+            comm_ini_s(sbufferlef_to_rig, sbufferrig_to_lef,
+                    sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac, sbufferbac_to_fro,
+                    rsbufferlef_to_rig, rsbufferrig_to_lef,
+                    rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac, rsbufferbac_to_fro,
+                    HALO_DATATYPE ? stype_send : NULL, HALO_DATATYPE ? stype_rec : NULL,
+                    sreq_send, sreq_rec);
+        }
 
-                    MPI_Barrier(MPI_COMM_WORLD);
-                    MPI_Bcast(&nsrc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        /* allocate buffer for seismogram output, merged seismogram section of all PEs
+           (gathered on PE 0 only, see catseis; not needed with SEIS_MPIIO) */
+        if (SEISMO && (MYID == 0) && !SEIS_MPIIO)
+            seismo_fulldata = fmatrix(1, ntr_glob, 1, ns);
 
-                    stype = ivector(1, nsrc);
-                    srcpos = pwsources(&nsrc, stype);
-                }
-                else
-                {
-                    err("SRCREC parameter specifies PLANE_WAVE excitation, but PLANE_WAVE_DEPTH<=0!");
-                }
-                break;
-                /*more source file formats or source file options can be implemented here*/
-            default:
-                err("SRCREC parameter is invalid (SRCREC!=1 or SRCREC!=2)! No source parameters specified!");
-                break;
+        /* allocate buffer for seismogram output, seismogram section of each PE */
+        if (ntr > 0)
+        {
+            switch (SEISMO)
+            {
+                case 1: /* particle velocities only */
+                    sectionvx = fmatrix(1, ntr, 1, nsect);
+                    sectionvy = fmatrix(1, ntr, 1, nsect);
+                    sectionvz = fmatrix(1, ntr, 1, nsect);
+                    break;
+                case 2: /* pressure only */
+                    sectionp = fmatrix(1, ntr, 1, nsect);
+                    break;
+                case 3: /* curl and div only */
+                    sectioncurl = fmatrix(1, ntr, 1, nsect);
+                    sectiondiv = fmatrix(1, ntr, 1, nsect);
+                    break;
+                case 4: /* everything */
+                    sectionvx = fmatrix(1, ntr, 1, nsect);
+                    sectionvy = fmatrix(1, ntr, 1, nsect);
+                    sectionvz = fmatrix(1, ntr, 1, nsect);
+                    sectioncurl = fmatrix(1, ntr, 1, nsect);
+                    sectiondiv = fmatrix(1, ntr, 1, nsect);
+                    sectionp = fmatrix(1, ntr, 1, nsect);
+                    break;
+            }
         }
 
-        // Source term field distributed in the computational domain.
-        float ***source_field = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        /* register the arrays of the periodic checkpoints (CHECKPT_INTERVAL, CHECKPTREAD=2) */
+        if ((CHECKPT_INTERVAL > 0) || (CHECKPTREAD == 2))
+        {
+            float ***psi[18] = {psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_vxx, psi_vyx, psi_vzx,
+                    psi_sxy_y, psi_syy_y, psi_syz_y, psi_vxy, psi_vyy, psi_vzy,
+                    psi_sxz_z, psi_syz_z, psi_szz_z, psi_vxz, psi_vyz, psi_vzz};
+
+            checkpoint_wavefield(&v, &s, &r, psi, NRL, NRH, NCL, NCH, NDL, NDH, 1 - hg);
+            checkpoint_section(sectionvx, ntr, nsect);
+            checkpoint_section(sectionvy, ntr, nsect);
+            checkpoint_section(sectionvz, ntr, nsect);
+            checkpoint_section(sectionp, ntr, nsect);
+            checkpoint_section(sectioncurl, ntr, nsect);
+            checkpoint_section(sectiondiv, ntr, nsect);
+            checkpoint_ini();
+        }
 
-        /* create model grids check the function readmod*/
-        fprintf(FP, "\n-------- MODEL CREATION OR READING --------\n");
-        if (READMOD == 1)
-            readmod(rho, pi, u, C11, C12, C13, C22, C23, C33, C44, C55, C66, taus, taup, eta);
-        else
+        int irtm;
+        for (irtm = 0; irtm <= RTM_FLAG; irtm++)
         {
-            if (L == 0) {
-                model_elastic(rho, pi, u, C11, C12, C13, C22, C23, C33, C44, C55, C66); /* elastic modeling, L is specified in input file*/
-            }
-            else
+            if (irtm>0)
             {
-                model_visco(rho, pi, u, taus, taup, eta); /* viscoelastic modeling, L is specified in input file*/
+                lsnap =  iround(TSNAP1 / DT);
             }
-        }
+            if (MYID == 0)
+                fprintf(FP, " ... memory allocation for PE %d was successfull.\n\n", MYID);
 
+            /* memory for source position definition */
+            srcpos1 = fmatrix(1, 6, 1, 1);
 
+            // Source term field distributed in the computational domain.
+            float ***source_field = f3tensor(0, NY + 1, 0, NX + 1, 0, NZ + 1);
 
-        fprintf(FP,"\n \n MYID %d rsf %d rsfden %s", MYID,RSF,RSFDEN);
+            /* the sources and the model are read before the first shot only,
+               the rebalanced subdomains hold the redistributed model */
+            if (!rebalanced)
+            {
+                /* Reading source positions from SOURCE_FILE */
+                fprintf(FP, "\n ------------------ READING SOURCE PARAMETERS ------------------- \n");
+                switch (SRCREC)
+                {
+                    case 0:
+                        if (MYID == 0)
+                            err("SRCREC parameter is invalid (SRCREC!=1)! No source parameters specified!");
+                        break;
+                    case 1:
+                        if (MYID == 0)
+                        {
+                            fprintf(FP, "\n Reading source parameters from file: %s (ASOFI3D source format)\n", SOURCE_FILE);
+
+                            if ((fpsrc = fopen(SOURCE_FILE, "r")) == NULL)
+                                err(" Source file could not be opened !");
+                            while (fgets(buffer, STRING_SIZE, fpsrc))
+                            {
+                                sscanf(buffer, "%s", bufferstring);
+                                /* checks if the line contains a '%'character which indicates a comment line,
+                                   and if the reading of a string was successful, which is not the case for an empty line*/
+                                if ((strchr(buffer, '#') == 0) && (sscanf(buffer, "%s", bufferstring) == 1))
+                                    ++(nsrc);
+                            }
+                            rewind(fpsrc);
+                            if ((nsrc) == 0)
+                                fprintf(FP, "\n WARNING: Could not determine number of sources parameter sets in input file. Assuming %d.\n", (nsrc = 0));
+                            else
+                                fprintf(FP, " Number of source positions specified in %s : %d \n", SOURCE_FILE, nsrc);
+                        }
+
+                        MPI_Barrier(MPI_COMM_WORLD);
+                        MPI_Bcast(&nsrc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+                        stype = ivector(1, nsrc);
+                        srcpos = sources(fpsrc, &nsrc, stype);
+
+                        /*originally, SOURCE_TYPE=stype is defined in the source file, if not, SOURCE_TYPE is taken from the input file */
+                        /*if (stype==NULL) printf("PE%d: Source type(s) undefined?! \n",MYID);*/
 
+                        break;
+                    case 2:
+                        if ((PLANE_WAVE_DEPTH > 0))
+                        {
+                            if (MYID == 0)
+                            {
+                                /*stype=(int *)malloc(nsrc*sizeof(int));*/ /* for unknown reasons, the pointer does not point to memory that has been allocated by a subroutine this way */
+
+                                /*determining the number of sources in the specified plane normal/tilted to the surface/upper model boundary*/
+                                nsrc = (NXG - 2 * FW + 1) * (NZG - 2 * FW + 1);
+                                /*fprintf(FP,"\n nsrc= %i with NGX=%i, NYG=%i and FW=%i. \n",nsrc,NXG,NYG,FW);*/
+                            }
+
+                            MPI_Barrier(MPI_COMM_WORLD);
+                            MPI_Bcast(&nsrc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+                            stype = ivector(1, nsrc);
+                            srcpos = pwsources(&nsrc, stype);
+                        }
+                        else
+                        {
+                            err("SRCREC parameter specifies PLANE_WAVE excitation, but PLANE_WAVE_DEPTH<=0!");
+                        }
+                        break;
+                        /*more source file formats or source file options can be implemented here*/
+                    default:
+                        err("SRCREC parameter is invalid (SRCREC!=1 or SRCREC!=2)! No source parameters specified!");
+                        break;
+                }
 
-        // Madagascar
+                /* create model grids check the function readmod*/
+                fprintf(FP, "\n-------- MODEL CREATION OR READING --------\n");
+                if (READMOD == 1)
+                    readmod(rho, pi, u, C11, C12, C13, C22, C23, C33, C44, C55, C66, taus, taup, eta);
+                else
+                {
+                    if (L == 0) {
+                        model_elastic(rho, pi, u, C11, C12, C13, C22, C23, C33, C44, C55, C66); /* elastic modeling, L is specified in input file*/
+                    }
+                    else
+                    {
+                        model_visco(rho, pi, u, taus, taup, eta); /* viscoelastic modeling, L is specified in input file*/
+                    }
+                }
 
-        if (RSF) madinput(RSFDEN,rho);
 
-        if (RUN_MULTIPLE_SHOTS)
-            nshots = nsrc;
-        else
-            nshots = 1;
-        checkfd(FP, rho, pi, u, taus, taup, eta, srcpos, nsrc, recpos, ntr_glob);
 
-        /* calculate damping coefficients for CPML boundary*/
-        if (ABS_TYPE == 1)
-        {
-            CPML_coeff(K_x, alpha_prime_x, a_x, b_x, K_x_half, alpha_prime_x_half, a_x_half, b_x_half, K_y, alpha_prime_y, a_y, b_y, K_y_half, alpha_prime_y_half, a_y_half, b_y_half, K_z, alpha_prime_z, a_z, b_z, K_z_half, alpha_prime_z_half, a_z_half, b_z_half);
-        }
+                fprintf(FP,"\n \n MYID %d rsf %d rsfden %s", MYID,RSF,RSFDEN);
 
-        /* calculate 3-D array for exponential damping of reflections
-           at the edges of the numerical mesh */
-        if (ABS_TYPE == 2)
-        {
-            absorb(absorb_coeff);
-        }
 
-        /* For the calculation of the material parameters between gridpoints
-           the parameters have to be averaged. For this, values lying at 0 and NX+1,
-           for example, are required on the local grid. These are now copied from the
-           neighbouring grids */
-        matcopy(rho, pi, u, C11, C12, C13, C22, C23, C33, C44, C55, C66, taus, taup);
+                // Madagascar
 
-        /* spatial averaging of material parameters, i.e. Tau for S-waves, shear modulus, and density */
-        av_mat(rho, C44, C55, C66, taus, C66ipjp, C44jpkp, C55ipkp, tausipjp, tausjpkp, tausipkp, rjp, rkp, rip);
+                if (RSF) madinput(RSFDEN,rho);
 
-        MPI_Barrier(MPI_COMM_WORLD);
+                if (RUN_MULTIPLE_SHOTS)
+                    nshots = nsrc;
+                else
+                    nshots = 1;
+                checkfd(FP, rho, pi, u, taus, taup, eta, srcpos, nsrc, recpos, ntr_glob);
+            }
 
-        if (CHECKPTREAD)
-        {
-            if (MYID == 0)
+            /* calculate damping coefficients for CPML boundary*/
+            if (ABS_TYPE == 1)
             {
-                time3 = MPI_Wtime();
-                fprintf(FP, " Reading wavefield from check-point file %s \n", CHECKPTFILE);
+                CPML_coeff(K_x, alpha_prime_x, a_x, b_x, K_x_half, alpha_prime_x_half, a_x_half, b_x_half, K_y, alpha_prime_y, a_y, b_y, K_y_half, alpha_prime_y_half, a_y_half, b_y_half, K_z, alpha_prime_z, a_z, b_z, K_z_half, alpha_prime_z_half, a_z_half, b_z_half);
             }
 
-            read_checkpoint(-1, NX + 2, -1, NY + 2, -1, NZ + 2, &v, &s, &r,
-                    psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z,
-                    psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
-            MPI_Barrier(MPI_COMM_WORLD);
-            if (MYID == 0)
+            /* calculate 3-D array for exponential damping of reflections
+               at the edges of the numerical mesh */
+            if (ABS_TYPE == 2)
             {
-                time4 = MPI_Wtime();
-                fprintf(FP, " finished (real time: %4.2f s).\n", time4 - time3);
+                absorb(absorb_coeff);
             }
-        }
 
-        /* comunication initialisation for persistent communication */
-        /*comm_ini(bufferlef_to_rig, bufferrig_to_lef,
-          buffertop_to_bot, bufferbot_to_top, bufferfro_to_bac,
-          bufferbac_to_fro, req_send, req_rec);
+            /* For the calculation of the material parameters between gridpoints
+               the parameters have to be averaged. For this, values lying at 0 and NX+1,
+               for example, are required on the local grid. These are now copied from the
+               neighbouring grids */
+            matcopy(rho, pi, u, C11, C12, C13, C22, C23, C33, C44, C55, C66, taus, taup);
 
-          comm_ini_s(sbufferlef_to_rig, sbufferrig_to_lef,
-          sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
-          sbufferbac_to_fro, sreq_send, sreq_rec);*/
+            /* spatial averaging of material parameters, i.e. Tau for S-waves, shear modulus, and density */
+            av_mat(rho, C44, C55, C66, taus, C66ipjp, C44jpkp, C55ipkp, tausipjp, tausjpkp, tausipkp, rjp, rkp, rip);
 
-        /* initialisation of PML and ABS domain */
-        if (ABS_TYPE == 1)
-        {
-            CPML_ini_elastic(xb, yb, zb);
-        }
+            /* the redundant update of the ghost zones (HALO_DEEP) needs the model there, too */
+            if (dg)
+            {
+                float ***model[15] = {pi, u, C11, C12, C13, C22, C23, C33,
+                        C66ipjp, C44jpkp, C55ipkp, rjp, rkp, rip, absorb_coeff};
 
-        if (ABS_TYPE == 2)
-        {
-            xb[0] = 1;
-            xb[1] = NX;
-            yb[0] = 1;
-            yb[1] = NY;
-            zb[0] = 1;
-            zb[1] = NZ;
-        }
+                halo_deep_model(model, 15);
+            }
 
-        if (MYID == 0)
-        {
-            time2 = MPI_Wtime();
-            fprintf(FP, "\n\n\n **************************************************\n");
-            fprintf(FP, " *********** STARTING TIME STEPPING ***************\n");
-            fprintf(FP, " **************************************************\n");
-            fprintf(FP, " real time before starting time loop: %4.2f s.\n", time2 - time1);
-        }
+            /* update coefficients of the viscoelastic stress update */
+            if (L)
+                visco_coeff(&vp, pi, u, C66ipjp, C44jpkp, C55ipkp, taus, tausipjp, tausjpkp, tausipkp, taup, eta);
 
-        // for (int irtm = 0; irtm <= RTM_FLAG; irtm++)
-        // {
-        //if (RSF) madinput(RSFDEN,rho);
-
-        op.C11 = C11;
-        op.C22 = C22;
-        op.C33 = C33;
-        op.C12 = C12;
-        op.C13 = C13;
-        op.C23 = C23;
-        op.C44 = C44;
-        op.C55 = C55;
-        op.C66 = C66;
-        op.rho = rho;
-        op.C66ipjp = C66ipjp;
-        op.C44jpkp = C44jpkp;
-        op.C55ipkp = C55ipkp;
-
-        for (ishot = 1; ishot <= nshots; ishot++)
-        {
-            fprintf(FP, "\n MYID=%d *****  Starting simulation for shot %d of %d  ********** \n", MYID, ishot, nshots);
-            for (nt = 1; nt <= 6; nt++)
-                srcpos1[nt][1] = srcpos[nt][ishot];
-            if (RUN_MULTIPLE_SHOTS)
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            if (CHECKPTREAD == 1)
             {
-                /* find this single source positions on subdomains */
-                if (nsrc_loc > 0)
-                    free_matrix(srcpos_loc, 1, 6, 1, 1);
-                if (stype_loc == NULL)
-                    stype_loc = ivector(1, nsrc);
-                srcpos_loc = splitsrc(srcpos1, &nsrc_loc, 1, stype_loc, stype);
+                if (MYID == 0)
+                {
+                    time3 = MPI_Wtime();
+                    fprintf(FP, " Reading wavefield from check-point file %s \n", CHECKPTFILE);
+                }
+
+                read_checkpoint(-1, NX + 2, -1, NY + 2, -1, NZ + 2, &v, &s, &r,
+                        psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z,
+                        psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
+                MPI_Barrier(MPI_COMM_WORLD);
+                if (MYID == 0)
+                {
+                    time4 = MPI_Wtime();
+                    fprintf(FP, " finished (real time: %4.2f s).\n", time4 - time3);
+                }
             }
-            else
+
+            /* restart at the last periodic checkpoint */
+            if (CHECKPTREAD == 2)
             {
-                /* Distribute multiple source positions on subdomains */
-                if (stype_loc == NULL)
-                    stype_loc = ivector(1, nsrc);
-                srcpos_loc = splitsrc(srcpos, &nsrc_loc, nsrc, stype_loc, stype);
+                checkpoint_read(&cpos);
+                ishot1 = cpos.ishot;
+                resume = 1;
             }
 
-            /* calculate wavelet for each source point */
-            signals = wavelet(srcpos_loc, nsrc_loc);
-
-            /* output of calculated wavelet for each source point */
-
-            if ((OUTSOURCEWAVELET != 0) && (nsrc_loc > 0))
+            /* initialisation of PML and ABS domain */
+            if (ABS_TYPE == 1)
             {
-                char source_signal_file[STRING_SIZE];
-                sprintf(source_signal_file, "source_signal.MYID%d.shot%d.su", MYID, ishot);
-                fprintf(FP, "\n PE %d outputs source time function in SU format to %s \n ", MYID, source_signal_file);
-                output_source_signal(fopen(source_signal_file, "w"), signals, NT, 1);
+                CPML_ini_elastic(xb, yb, zb);
             }
 
-            /* initialize wavefield with zero */
-            if ((L == 1) && (ABS_TYPE == 2) && (CHECKPTREAD == 0))
+            if (ABS_TYPE == 2)
             {
-                zero(1 - FDORDER / 2, NX + FDORDER / 2, 1 - FDORDER / 2, NY + FDORDER / 2, 1 - FDORDER / 2, NZ + FDORDER / 2, &v, &s, &dv,
-                        &dv_2, &dv_3, &dv_4,
-                        &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4,
-                        &r, &r_2, &r_3, &r_4);
+                xb[0] = 1;
+                xb[1] = NX;
+                yb[0] = 1;
+                yb[1] = NY;
+                zb[0] = 1;
+                zb[1] = NZ;
             }
 
-            if ((L == 0) && (ABS_TYPE == 2) && (CHECKPTREAD == 0))
+            /* boxes for overlapping the halo exchange with the wavefield update */
+            if (OVERLAP_COMM)
+                halo_split(xb, yb, zb, FDORDER / 2, box);
+
+            /* boxes for updating velocity and stress in one sweep (FUSED_SWEEP) */
+            wavefront_ini(xb, yb, zb, sbox, fbox);
+
+            if (MYID == 0)
             {
-                zero_elastic(1 - FDORDER / 2, NX + FDORDER / 2, 1 - FDORDER / 2, NY + FDORDER / 2, 1 - FDORDER / 2, NZ + FDORDER / 2,
-                        &v, &s,
-                        &dv, &dv_2, &dv_3, &dv_4,
-                        &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                time2 = MPI_Wtime();
+                fprintf(FP, "\n\n\n **************************************************\n");
+                fprintf(FP, " *********** STARTING TIME STEPPING ***************\n");
+                fprintf(FP, " **************************************************\n");
+                fprintf(FP, " real time before starting time loop: %4.2f s.\n", time2 - time1);
             }
-            if ((ABS_TYPE == 1) && (CHECKPTREAD == 0))
+
+            // for (int irtm = 0; irtm <= RTM_FLAG; irtm++)
+            // {
+            //if (RSF) madinput(RSFDEN,rho);
+
+            op.C11 = C11;
+            op.C22 = C22;
+            op.C33 = C33;
+            op.C12 = C12;
+            op.C13 = C13;
+            op.C23 = C23;
+            op.C44 = C44;
+            op.C55 = C55;
+            op.C66 = C66;
+            op.rho = rho;
+            op.C66ipjp = C66ipjp;
+            op.C44jpkp = C44jpkp;
+            op.C55ipkp = C55ipkp;
+
+            for (ishot = ishot1; ishot <= nshots; ishot++)
             {
-                zero_elastic_CPML(NX, NY, NZ, &v, &s, &r,
-                        psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z, psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz,
-                        &r_2, &r_3, &r_4);
-            }
+                fprintf(FP, "\n MYID=%d *****  Starting simulation for shot %d of %d  ********** \n", MYID, ishot, nshots);
+                for (nt = 1; nt <= 6; nt++)
+                    srcpos1[nt][1] = srcpos[nt][ishot];
+                if (RUN_MULTIPLE_SHOTS)
+                {
+                    /* find this single source positions on subdomains */
+                    if (nsrc_loc > 0)
+                        free_matrix(srcpos_loc, 1, 6, 1, 1);
+                    if (stype_loc == NULL)
+                        stype_loc = ivector(1, nsrc);
+                    srcpos_loc = splitsrc(srcpos1, &nsrc_loc, 1, stype_loc, stype, dg);
+                }
+                else
+                {
+                    /* Distribute multiple source positions on subdomains */
+                    if (stype_loc == NULL)
+                        stype_loc = ivector(1, nsrc);
+                    srcpos_loc = splitsrc(srcpos, &nsrc_loc, nsrc, stype_loc, stype, dg);
+                }
+
+                /* calculate wavelet for each source point */
+                signals = wavelet(srcpos_loc, nsrc_loc);
+
+                /* output of calculated wavelet for each source point */
+
+                if ((OUTSOURCEWAVELET != 0) && (nsrc_loc > 0))
+                {
+                    char source_signal_file[STRING_SIZE];
+                    sprintf(source_signal_file, "source_signal.MYID%d.shot%d.su", MYID, ishot);
+                    fprintf(FP, "\n PE %d outputs source time function in SU format to %s \n ", MYID, source_signal_file);
+                    output_source_signal(fopen(source_signal_file, "w"), signals, NT, 1);
+                }
 
-            /* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
-            /* start of loop over time steps */
+                /* initialize wavefield with zero */
+                if ((L == 1) && (ABS_TYPE == 2) && (CHECKPTREAD != 1))
+                {
+                    zero(1 - FDORDER / 2, NX + FDORDER / 2, 1 - FDORDER / 2, NY + FDORDER / 2, 1 - FDORDER / 2, NZ + FDORDER / 2, &v, &s, &dv,
+                            &dv_2, &dv_3, &dv_4,
+                            &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4,
+                            &r, &r_2, &r_3, &r_4);
+                }
+
+                if ((L == 0) && (ABS_TYPE == 2) && (CHECKPTREAD != 1))
+                {
+                    zero_elastic(1 - hg, NX + hg, 1 - hg, NY + hg, 1 - hg, NZ + hg,
+                            &v, &s,
+                            &dv, &dv_2, &dv_3, &dv_4,
+                            &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                }
+                if ((ABS_TYPE == 1) && (CHECKPTREAD != 1))
+                {
+                    zero_elastic_CPML(NX, NY, NZ, &v, &s, &r,
+                            psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z, psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz,
+                            &r_2, &r_3, &r_4);
+                }
 
-            lsamp = NDTSHIFT + 1;
-            nlsamp = 1;
+                /* +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+                /* start of loop over time steps */
 
+                lsamp = NDTSHIFT + 1;
+                nlsamp = 1;
+                nt1 = 1;
+                if (resume)
+                {
+                    /* continue after the time step of the checkpoint */
+                    checkpoint_restore();
+                    nt1 = cpos.nt + 1;
+                    nsnap = cpos.nsnap;
+                    lsnap = cpos.lsnap;
+                    nlsamp = cpos.nlsamp;
+                    lsamp = cpos.lsamp;
+                    for (nt = 1; nt < nt1; nt++)
+                        time_v_update[nt] = time_s_update[nt] = time_v_exchange[nt] = time_s_exchange[nt] = time_timestep[nt] = 0.0;
+                    resume = 0;
+                }
+                seisstream_open(ishot, nlsamp);
 
 
-            //#pragma acc data copyin(vx[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vy[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vz[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1])
 
-            /*
+                //#pragma acc data copyin(vx[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vy[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vz[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1])
 
+                /*
 
-               vxyyx, vyzzy, vxzzx, vxxyyzz, vyyzz, vxxzz, vxxyy,
-               vxyyx_2, vyzzy_2, vxzzx_2, vxxyyzz_2, vyyzz_2, vxxzz_2, vxxyy_2, vxyyx_3, vyzzy_3, vxzzx_3, vxxyyzz_3, vyyzz_3, vxxzz_3, vxxyy_3, vxyyx_4, vyzzy_4, vxzzx_4, vxxyyzz_4, vyyzz_4, vxxzz_4, vxxyy_4
 
-in:
-out: sxx, syy, szz, sxy, syz, sxz,*/
+                   vxyyx, vyzzy, vxzzx, vxxyyzz, vyyzz, vxxzz, vxxyy,
+                   vxyyx_2, vyzzy_2, vxzzx_2, vxxyyzz_2, vyyzz_2, vxxzz_2, vxxyy_2, vxyyx_3, vyzzy_3, vxzzx_3, vxxyyzz_3, vyyzz_3, vxxzz_3, vxxyy_3, vxyyx_4, vyzzy_4, vxzzx_4, vxxyyzz_4, vyyzz_4, vxxzz_4, vxxyy_4
 
-            //#pragma acc data copyin (C11,C12,C13,C33,C22,C23,C66ipjp,C44jpkp,C55ipkp)
-            //#pragma acc data copyout(sxy,syz,sxz,sxx,syy,szz)
-            /*
-#pragma acc data copyin(xb[0],xb[1],yb[0],yb[1],zb[0],zb[1],nt)
-#pragma acc data copyin(vx[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(vy[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(vz[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C11[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C12[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C13[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C22[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C23[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C33[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C66ipjp[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C44jpkp[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyin(C55ipkp[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-*/
-            /*
-#pragma acc data copyout(sxx[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyout(syy[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyout(szz[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyout(sxy[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyout(syz[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-#pragma acc data copyout(sxz[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
-*/
+    in:
+    out: sxx, syy, szz, sxy, syz, sxz,*/
 
+                //#pragma acc data copyin (C11,C12,C13,C33,C22,C23,C66ipjp,C44jpkp,C55ipkp)
+                //#pragma acc data copyout(sxy,syz,sxz,sxx,syy,szz)
+                /*
+    #pragma acc data copyin(xb[0],xb[1],yb[0],yb[1],zb[0],zb[1],nt)
+    #pragma acc data copyin(vx[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(vy[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(vz[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C11[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C12[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C13[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C22[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C23[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C33[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C66ipjp[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C44jpkp[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyin(C55ipkp[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    */
+                /*
+    #pragma acc data copyout(sxx[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyout(syy[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyout(szz[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyout(sxy[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyout(syz[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    #pragma acc data copyout(sxz[yb[0]-1:yb[1]+1][xb[0]-1:xb[1]+1][zb[0]-1:zb[1]+1])
+    */
 
 
-            for (nt = 1; nt <= NT; nt++)
-            {
-                time_v_update[nt] = 0.0;
-                time_s_update[nt] = 0.0;
-                time_v_exchange[nt] = 0.0;
-                time_s_exchange[nt] = 0.0;
 
-                /* Check if simulation is still stable */
-                if (isnan(v.y[NY / 2][NX / 2][NZ / 2]))
-                    err(" Simulation is unstable !"); /* maybe just breaking the loop would be better */
+                /* busy time of this PE in the time loop for the rebalancing */
+                tloop = MPI_Wtime();
+                tsnap = 0.0;
 
-                if (LOG)
-                    if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
+                for (nt = nt1; nt <= NT; nt++)
+                {
+                    time_v_update[nt] = 0.0;
+                    time_s_update[nt] = 0.0;
+                    time_v_exchange[nt] = 0.0;
+                    time_s_exchange[nt] = 0.0;
+
+                    /* Check if simulation is still stable */
+                    if (isnan(v.y[NY / 2][NX / 2][NZ / 2]))
+                        err(" Simulation is unstable !"); /* maybe just breaking the loop would be better */
+
+                    if (LOG)
+                        if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
+                        {
+                            fprintf(FP, "\n Computing timestep %d of %d \n", nt, NT);
+                            time2 = MPI_Wtime();
+                        }
+
+                    /* boxes of the plain update, extended into the ghost zones with HALO_DEEP */
+                    halo_deep_box(nt, 1, xb, yb, zb, vb);
+                    halo_deep_box(nt, 0, xb, yb, zb, sb);
+
+                    /* update of particle velocities */
+                    if (FUSED_SWEEP)
                     {
-                        fprintf(FP, "\n Computing timestep %d of %d \n", nt, NT);
-                        time2 = MPI_Wtime();
+                        /* the stress of the inner box sbox[0] is updated in the
+                         * same sweep (see wavefront.c), its time is included */
+                        time5 = MPI_Wtime();
+                        if (wavefront_first(fbox[0], sbox[0], wf))
+                            do
+                            {
+                                update_v_kernel(fbox[0][0], fbox[0][1], wf[0], wf[1], fbox[0][4], fbox[0][5],
+                                        &v, &s, rjp, rkp, rip,
+                                        &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                                update_v_point_forces(fbox[0][0], fbox[0][1], wf[0], wf[1], fbox[0][4], fbox[0][5], nt,
+                                        &v, rjp, rkp, rip, srcpos_loc, signals, nsrc_loc, stype_loc);
+                                if (wf[3] < wf[2])
+                                    continue;
+                                if (L > 0)
+                                    update_s_kernel(sbox[0][0], sbox[0][1], wf[2], wf[3], sbox[0][4], sbox[0][5],
+                                            &v, &s, &r,
+                                            &vp, eta,
+                                            &dv, &dv_2, &dv_3, &dv_4,
+                                            &r_2, &r_3, &r_4);
+                                else
+                                    update_s_elastic_kernel(sbox[0][0], sbox[0][1], wf[2], wf[3], sbox[0][4], sbox[0][5],
+                                            &v, &s,
+                                            pi, u, &op,
+                                            &dv, &dv_2, &dv_3, &dv_4);
+                            } while (wavefront_next(fbox[0], sbox[0], wf));
+
+                        /* with OVERLAP_COMM the shell of the velocity box
+                         * follows once the stress halo has arrived */
+                        for (ibox = 1; OVERLAP_COMM && (ibox <= 6); ibox++)
+                        {
+                            if ((ibox == 1) && s_exchange_pending)
+                            {
+                                time_s_exchange[nt - 1] += exchange_s_finish(
+                                        nt - 1, &s,
+                                        rsbufferlef_to_rig, rsbufferrig_to_lef,
+                                        rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                                        rsbufferbac_to_fro, sreq_send, sreq_rec,
+                                        HALO_DATATYPE ? stype_rec : NULL);
+                                s_exchange_pending = 0;
+                            }
+                            update_v_kernel(box[ibox][0], box[ibox][1], box[ibox][2], box[ibox][3], box[ibox][4], box[ibox][5],
+                                    &v, &s, rjp, rkp, rip,
+                                    &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                        }
+                        for (ibox = 1; ibox <= 6; ibox++)
+                            update_v_point_forces(fbox[ibox][0], fbox[ibox][1], fbox[ibox][2], fbox[ibox][3], fbox[ibox][4], fbox[ibox][5], nt,
+                                    &v, rjp, rkp, rip, srcpos_loc, signals, nsrc_loc, stype_loc);
+                        /* damping only, the body forces have been added */
+                        update_v_body_forces(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt,
+                                &v, &s,
+                                rjp, rkp, rip, srcpos_loc, signals, 0, absorb_coeff, stype_loc);
+                        time_v_update[nt] = MPI_Wtime() - time5;
+                    }
+                    else if (OVERLAP_COMM)
+                    {
+                        time5 = MPI_Wtime();
+                        for (ibox = 0; ibox <= 6; ibox++)
+                        {
+                            /* only the inner box is updated while the stress halo
+                             * of the previous time step is still in transit */
+                            if ((ibox == 1) && s_exchange_pending)
+                            {
+                                time_s_exchange[nt - 1] += exchange_s_finish(
+                                        nt - 1, &s,
+                                        rsbufferlef_to_rig, rsbufferrig_to_lef,
+                                        rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                                        rsbufferbac_to_fro, sreq_send, sreq_rec,
+                                        HALO_DATATYPE ? stype_rec : NULL);
+                                s_exchange_pending = 0;
+                            }
+                            update_v_kernel(box[ibox][0], box[ibox][1], box[ibox][2], box[ibox][3], box[ibox][4], box[ibox][5],
+                                    &v, &s, rjp, rkp, rip,
+                                    &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                        }
+                        update_v_body_forces(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt,
+                                &v, &s,
+                                rjp, rkp, rip, srcpos_loc, signals, nsrc_loc, absorb_coeff, stype_loc);
+                        time_v_update[nt] = MPI_Wtime() - time5;
+                    }
+                    else
+                    {
+                        time_v_update[nt] = update_v(vb[0], vb[1], vb[2], vb[3], vb[4], vb[5], nt,
+                                &v, &s,
+                                rjp, rkp, rip, srcpos_loc, signals, nsrc_loc, absorb_coeff, stype_loc,
+                                &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
                     }
 
-                /* update of particle velocities */
-                time_v_update[nt] = update_v(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt,
-                        &v, &s,
-                        rjp, rkp, rip, srcpos_loc, signals, nsrc_loc, absorb_coeff, stype_loc,
-                        &ds_dv, &ds_dv_2, &ds_dv_3, &ds_dv_4);
+                    if (ABS_TYPE == 1)
+                    {
+                        update_v_CPML(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
+                                &s,
+                                rjp, rkp, rip,
+                                K_x, a_x, b_x, K_x_half, a_x_half, b_x_half,
+                                K_y, a_y, b_y, K_y_half, a_y_half, b_y_half,
+                                K_z, a_z, b_z, K_z_half, a_z_half, b_z_half,
+                                psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z);
+                    };
+
+                    // Shift spatial derivatives of the stress one time step back.
+                    if (FDORDER_TIME == 4)
+                    {
+                        shift_s1 = ds_dv_4.x;
+                        ds_dv_4.x = ds_dv_3.x;
+                        ds_dv_3.x = ds_dv_2.x;
+                        ds_dv_2.x = ds_dv.x;
+                        ds_dv.x = shift_s1;
+                        shift_s2 = ds_dv_4.y;
+                        ds_dv_4.y = ds_dv_3.y;
+                        ds_dv_3.y = ds_dv_2.y;
+                        ds_dv_2.y = ds_dv.y;
+                        ds_dv.y = shift_s2;
+                        shift_s3 = ds_dv_4.z;
+                        ds_dv_4.z = ds_dv_3.z;
+                        ds_dv_3.z = ds_dv_2.z;
+                        ds_dv_2.z = ds_dv.z;
+                        ds_dv.z = shift_s3;
+                    }
+                    if (FDORDER_TIME == 3)
+                    {
+                        shift_s1 = ds_dv_3.x;
+                        ds_dv_3.x = ds_dv_2.x;
+                        ds_dv_2.x = ds_dv.x;
+                        ds_dv.x = shift_s1;
+                        shift_s2 = ds_dv_3.y;
+                        ds_dv_3.y = ds_dv_2.y;
+                        ds_dv_2.y = ds_dv.y;
+                        ds_dv.y = shift_s2;
+                        shift_s3 = ds_dv_3.z;
+                        ds_dv_3.z = ds_dv_2.z;
+                        ds_dv_2.z = ds_dv.z;
+                        ds_dv.z = shift_s3;
+                    }
 
-                if (ABS_TYPE == 1)
-                {
-                    update_v_CPML(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
-                            &s,
-                            rjp, rkp, rip,
-                            K_x, a_x, b_x, K_x_half, a_x_half, b_x_half,
-                            K_y, a_y, b_y, K_y_half, a_y_half, b_y_half,
-                            K_z, a_z, b_z, K_z_half, a_z_half, b_z_half,
-                            psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z);
-                };
-
-                // Shift spatial derivatives of the stress one time step back.
-                if (FDORDER_TIME == 4)
-                {
-                    shift_s1 = ds_dv_4.x;
-                    ds_dv_4.x = ds_dv_3.x;
-                    ds_dv_3.x = ds_dv_2.x;
-                    ds_dv_2.x = ds_dv.x;
-                    ds_dv.x = shift_s1;
-                    shift_s2 = ds_dv_4.y;
-                    ds_dv_4.y = ds_dv_3.y;
-                    ds_dv_3.y = ds_dv_2.y;
-                    ds_dv_2.y = ds_dv.y;
-                    ds_dv.y = shift_s2;
-                    shift_s3 = ds_dv_4.z;
-                    ds_dv_4.z = ds_dv_3.z;
-                    ds_dv_3.z = ds_dv_2.z;
-                    ds_dv_2.z = ds_dv.z;
-                    ds_dv.z = shift_s3;
-                }
-                if (FDORDER_TIME == 3)
-                {
-                    shift_s1 = ds_dv_3.x;
-                    ds_dv_3.x = ds_dv_2.x;
-                    ds_dv_2.x = ds_dv.x;
-                    ds_dv.x = shift_s1;
-                    shift_s2 = ds_dv_3.y;
-                    ds_dv_3.y = ds_dv_2.y;
-                    ds_dv_2.y = ds_dv.y;
-                    ds_dv.y = shift_s2;
-                    shift_s3 = ds_dv_3.z;
-                    ds_dv_3.z = ds_dv_2.z;
-                    ds_dv_2.z = ds_dv.z;
-                    ds_dv.z = shift_s3;
-                }
+                    /* exchange values of particle velocities at grid boundaries between PEs */
+
+                    if (OVERLAP_COMM || PERSISTENT_COMM)
+                        time_v_exchange[nt] = exchange_v_start(
+                                nt, &v,
+                                bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+                                bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro,
+                                rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+                                rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro,
+                                req_send, req_rec,
+                                HALO_DATATYPE ? vtype_send : NULL, HALO_DATATYPE ? vtype_rec : NULL);
+                    else if (HALO_DATATYPE)
+                        time_v_exchange[nt] = exchange_v_dt(nt, vtype_send, vtype_rec);
+                    else if (HALO_SHM)
+                        time_v_exchange[nt] = exchange_v_shm(nt, &v);
+                    else if (!dg) /* the deep halo is exchanged with the stress */
+                        time_v_exchange[nt] = exchange_v(
+                                nt, &v,
+                                bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
+                                bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+
+                    /* without overlap the persistent exchange is completed at once */
+                    if (PERSISTENT_COMM && !OVERLAP_COMM)
+                        time_v_exchange[nt] += exchange_v_finish(
+                                nt, &v,
+                                rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+                                rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro,
+                                req_send, req_rec,
+                                HALO_DATATYPE ? vtype_rec : NULL);
+
+                    /* update of components of stress tensor */
+
+                    /* update NON PML boundaries */
+                    if (OVERLAP_COMM || FUSED_SWEEP)
+                    {
+                        time5 = MPI_Wtime();
+                        /* with FUSED_SWEEP the inner box has been updated with the velocities */
+                        for (ibox = FUSED_SWEEP ? 1 : 0; ibox <= 6; ibox++)
+                        {
+                            ub = FUSED_SWEEP ? sbox[ibox] : box[ibox];
+                            /* only the inner box is updated while the velocity
+                             * halo is still in transit */
+                            if ((ibox == 1) && OVERLAP_COMM)
+                                time_v_exchange[nt] += exchange_v_finish(
+                                        nt, &v,
+                                        rbufferlef_to_rig, rbufferrig_to_lef, rbuffertop_to_bot,
+                                        rbufferbot_to_top, rbufferfro_to_bac, rbufferbac_to_fro,
+                                        req_send, req_rec,
+                                        HALO_DATATYPE ? vtype_rec : NULL);
+                            if (L > 0)
+                                update_s_kernel(ub[0], ub[1], ub[2], ub[3], ub[4], ub[5],
+                                        &v, &s, &r,
+                                        &vp, eta,
+                                        &dv, &dv_2, &dv_3, &dv_4,
+                                        &r_2, &r_3, &r_4);
+                            else
+                                update_s_elastic_kernel(ub[0], ub[1], ub[2], ub[3], ub[4], ub[5],
+                                        &v, &s,
+                                        pi, u, &op,
+                                        &dv, &dv_2, &dv_3, &dv_4);
+                        }
+                        time_s_update[nt] = MPI_Wtime() - time5;
+                    }
+                    if (L > 0)
+                    {
+                        if (!OVERLAP_COMM && !FUSED_SWEEP)
+                            time_s_update[nt] = update_s(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
+                                    &s, &r,
+                                    &vp, eta,
+                                    &dv, &dv_2, &dv_3, &dv_4,
+                                    &r_2, &r_3, &r_4);
+                        if (ABS_TYPE == 1)
+                            update_s_CPML(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
+                                    &s, &r, &vp, eta, K_x, a_x, b_x, K_x_half, a_x_half,
+                                    b_x_half, K_y, a_y, b_y, K_y_half, a_y_half, b_y_half, K_z, a_z, b_z, K_z_half, a_z_half, b_z_half,
+                                    psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
+                    }
+                    else
+                    {
+                        if (!OVERLAP_COMM && !FUSED_SWEEP)
+                            time_s_update[nt] = update_s_elastic(sb[0], sb[1], sb[2], sb[3], sb[4], sb[5], nt, &v,
+                                    &s,
+                                    pi, u, &op,
+                                    &dv, &dv_2, &dv_3, &dv_4);
+                        if (ABS_TYPE == 1)
+                            update_s_CPML_elastic(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
+                                    &s, &op,
+                                    K_x, a_x, b_x, K_x_half, a_x_half,
+                                    b_x_half, K_y, a_y, b_y, K_y_half, a_y_half, b_y_half, K_z, a_z, b_z, K_z_half, a_z_half, b_z_half,
+                                    psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
+                    }
 
-                /* exchange values of particle velocities at grid boundaries between PEs */
+                    // Shift spatial derivatives of velocity one time step back.
+                    if (FDORDER_TIME == 4)
+                    {
+                        shift_v1 = dv_4.xyyx;
+                        dv_4.xyyx = dv_3.xyyx;
+                        dv_3.xyyx = dv_2.xyyx;
+                        dv_2.xyyx = dv.xyyx;
+                        dv.xyyx = shift_v1;
+                        shift_v2 = dv_4.yzzy;
+                        dv_4.yzzy = dv_3.yzzy;
+                        dv_3.yzzy = dv_2.yzzy;
+                        dv_2.yzzy = dv.yzzy;
+                        dv.yzzy = shift_v2;
+                        shift_v3 = dv_4.xzzx;
+                        dv_4.xzzx = dv_3.xzzx;
+                        dv_3.xzzx = dv_2.xzzx;
+                        dv_2.xzzx = dv.xzzx;
+                        dv.xzzx = shift_v3;
+                        shift_v4 = dv_4.xxyyzz;
+                        dv_4.xxyyzz = dv_3.xxyyzz;
+                        dv_3.xxyyzz = dv_2.xxyyzz;
+                        dv_2.xxyyzz = dv.xxyyzz;
+                        dv.xxyyzz = shift_v4;
+                        shift_v5 = dv_4.yyzz;
+                        dv_4.yyzz = dv_3.yyzz;
+                        dv_3.yyzz = dv_2.yyzz;
+                        dv_2.yyzz = dv.yyzz;
+                        dv.yyzz = shift_v5;
+                        shift_v6 = dv_4.xxzz;
+                        dv_4.xxzz = dv_3.xxzz;
+                        dv_3.xxzz = dv_2.xxzz;
+                        dv_2.xxzz = dv.xxzz;
+                        dv.xxzz = shift_v6;
+                        shift_v7 = dv_4.xxyy;
+                        dv_4.xxyy = dv_3.xxyy;
+                        dv_3.xxyy = dv_2.xxyy;
+                        dv_2.xxyy = dv.xxyy;
+                        dv.xxyy = shift_v7;
+                        if (L == 1)
+                        {
+                            shift_r1 = r_4.xy;
+                            r_4.xy = r_3.xy;
+                            r_3.xy = r_2.xy;
+                            r_2.xy = r.xy;
+                            r.xy = shift_r1;
+                            shift_r2 = r_4.yz;
+                            r_4.yz = r_3.yz;
+                            r_3.yz = r_2.yz;
+                            r_2.yz = r.yz;
+                            r.yz = shift_r2;
+                            shift_r3 = r_4.xz;
+                            r_4.xz = r_3.xz;
+                            r_3.xz = r_2.xz;
+                            r_2.xz = r.xz;
+                            r.xz = shift_r3;
+                            shift_r4 = r_4.xx;
+                            r_4.xx = r_3.xx;
+                            r_3.xx = r_2.xx;
+                            r.xx = r.xx;
+                            r.xx = shift_r4;
+                            shift_r5 = r_4.yy;
+                            r_4.yy = r_3.yy;
+                            r_3.yy = r_2.yy;
+                            r_2.yy = r.yy;
+                            r.yy = shift_r5;
+                            shift_r6 = r_4.zz;
+                            r_4.zz = r_3.zz;
+                            r_3.zz = r_2.zz;
+                            r_2.zz = r.zz;
+                            r.zz = shift_r6;
+                        }
+                    }
+                    if (FDORDER_TIME == 3)
+                    {
+                        shift_v1 = dv_3.xyyx;
+                        dv_3.xyyx = dv_2.xyyx;
+                        dv_2.xyyx = dv.xyyx;
+                        dv.xyyx = shift_v1;
+                        shift_v2 = dv_3.yzzy;
+                        dv_3.yzzy = dv_2.yzzy;
+                        dv_2.yzzy = dv.yzzy;
+                        dv.yzzy = shift_v2;
+                        shift_v3 = dv_3.xzzx;
+                        dv_3.xzzx = dv_2.xzzx;
+                        dv_2.xzzx = dv.xzzx;
+                        dv.xzzx = shift_v3;
+                        shift_v4 = dv_3.xxyyzz;
+                        dv_3.xxyyzz = dv_2.xxyyzz;
+                        dv_2.xxyyzz = dv.xxyyzz;
+                        dv.xxyyzz = shift_v4;
+                        shift_v5 = dv_3.yyzz;
+                        dv_3.yyzz = dv_2.yyzz;
+                        dv_2.yyzz = dv.yyzz;
+                        dv.yyzz = shift_v5;
+                        shift_v6 = dv_3.xxzz;
+                        dv_3.xxzz = dv_2.xxzz;
+                        dv_2.xxzz = dv.xxzz;
+                        dv.xxzz = shift_v6;
+                        shift_v7 = dv_3.xxyy;
+                        dv_3.xxyy = dv_2.xxyy;
+                        dv_2.xxyy = dv.xxyy;
+                        dv.xxyy = shift_v7;
+                        if (L == 1)
+                        {
+                            shift_r1 = r_3.xy;
+                            r_3.xy = r_2.xy;
+                            r_2.xy = r.xy;
+                            r.xy = shift_r1;
+                            shift_r2 = r_3.yz;
+                            r_3.yz = r_2.yz;
+                            r_2.yz = r.yz;
+                            r.yz = shift_r2;
+                            shift_r3 = r_3.xz;
+                            r_3.xz = r_2.xz;
+                            r_2.xz = r.xz;
+                            r.xz = shift_r3;
+                            shift_r4 = r_3.xx;
+                            r_3.xx = r_2.xx;
+                            r_2.xx = r.xx;
+                            r.xx = shift_r4;
+                            shift_r5 = r_3.yy;
+                            r_3.yy = r_2.yy;
+                            r_2.yy = r.yy;
+                            r.yy = shift_r5;
+                            shift_r6 = r_3.zz;
+                            r_3.zz = r_2.zz;
+                            r_2.zz = r.zz;
+                            r.zz = shift_r6;
+                        }
+                    }
 
-                time_v_exchange[nt] = exchange_v(
-                        nt, &v,
-                        bufferlef_to_rig, bufferrig_to_lef, buffertop_to_bot,
-                        bufferbot_to_top, bufferfro_to_bac, bufferbac_to_fro);
+                    /* explosive source */
+                    if (CHECKPTREAD != 1)
+                    {
+                        psource(nt, &s, srcpos_loc, signals, nsrc_loc, stype_loc);
+                        /* eqsource is a implementation of moment tensor points sources. */
+                        eqsource(nt, &s, srcpos_loc, signals, nsrc_loc, stype_loc,
+                                amon, str, dip, rake);
 
-                /* update of components of stress tensor */
+                        source_moment_tensor(nt, &s, srcpos_loc,
+                                signals, nsrc_loc, stype_loc);
 
-                /* update NON PML boundaries */
-                if (L > 0)
-                {
-                    time_s_update[nt] = update_s(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
-                            &s, &r,
-                            pi, u, C66ipjp, C44jpkp, C55ipkp, taus, tausipjp, tausjpkp, tausipkp, taup, eta,
-                            &dv, &dv_2, &dv_3, &dv_4,
-                            &r_2, &r_3, &r_4);
-                    if (ABS_TYPE == 1)
-                        update_s_CPML(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
-                                &s, &r, pi, u,
-                                C66ipjp, C44jpkp, C55ipkp, taus, tausipjp, tausjpkp, tausipkp, taup, eta, K_x, a_x, b_x, K_x_half, a_x_half,
-                                b_x_half, K_y, a_y, b_y, K_y_half, a_y_half, b_y_half, K_z, a_z, b_z, K_z_half, a_z_half, b_z_half,
-                                psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
-                }
-                else
-                {
-                    time_s_update[nt] = update_s_elastic(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
-                            &s,
-                            pi, u, &op,
-                            &dv, &dv_2, &dv_3, &dv_4);
-                    if (ABS_TYPE == 1)
-                        update_s_CPML_elastic(xb[0], xb[1], yb[0], yb[1], zb[0], zb[1], nt, &v,
-                                &s, &op,
-                                K_x, a_x, b_x, K_x_half, a_x_half,
-                                b_x_half, K_y, a_y, b_y, K_y_half, a_y_half, b_y_half, K_z, a_z, b_z, K_z_half, a_z_half, b_z_half,
-                                psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
-                }
+                        source_random(nt, &s, source_field);
+                    }
 
-                // Shift spatial derivatives of velocity one time step back.
-                if (FDORDER_TIME == 4)
-                {
-                    shift_v1 = dv_4.xyyx;
-                    dv_4.xyyx = dv_3.xyyx;
-                    dv_3.xyyx = dv_2.xyyx;
-                    dv_2.xyyx = dv.xyyx;
-                    dv.xyyx = shift_v1;
-                    shift_v2 = dv_4.yzzy;
-                    dv_4.yzzy = dv_3.yzzy;
-                    dv_3.yzzy = dv_2.yzzy;
-                    dv_2.yzzy = dv.yzzy;
-                    dv.yzzy = shift_v2;
-                    shift_v3 = dv_4.xzzx;
-                    dv_4.xzzx = dv_3.xzzx;
-                    dv_3.xzzx = dv_2.xzzx;
-                    dv_2.xzzx = dv.xzzx;
-                    dv.xzzx = shift_v3;
-                    shift_v4 = dv_4.xxyyzz;
-                    dv_4.xxyyzz = dv_3.xxyyzz;
-                    dv_3.xxyyzz = dv_2.xxyyzz;
-                    dv_2.xxyyzz = dv.xxyyzz;
-                    dv.xxyyzz = shift_v4;
-                    shift_v5 = dv_4.yyzz;
-                    dv_4.yyzz = dv_3.yyzz;
-                    dv_3.yyzz = dv_2.yyzz;
-                    dv_2.yyzz = dv.yyzz;
-                    dv.yyzz = shift_v5;
-                    shift_v6 = dv_4.xxzz;
-                    dv_4.xxzz = dv_3.xxzz;
-                    dv_3.xxzz = dv_2.xxzz;
-                    dv_2.xxzz = dv.xxzz;
-                    dv.xxzz = shift_v6;
-                    shift_v7 = dv_4.xxyy;
-                    dv_4.xxyy = dv_3.xxyy;
-                    dv_3.xxyy = dv_2.xxyy;
-                    dv_2.xxyy = dv.xxyy;
-                    dv.xxyy = shift_v7;
-                    if (L == 1)
+                    /* stress free surface ? */
+                    if ((FREE_SURF) && (POS[2] == 0))
                     {
-                        shift_r1 = r_4.xy;
-                        r_4.xy = r_3.xy;
-                        r_3.xy = r_2.xy;
-                        r_2.xy = r.xy;
-                        r.xy = shift_r1;
-                        shift_r2 = r_4.yz;
-                        r_4.yz = r_3.yz;
-                        r_3.yz = r_2.yz;
-                        r_2.yz = r.yz;
-                        r.yz = shift_r2;
-                        shift_r3 = r_4.xz;
-                        r_4.xz = r_3.xz;
-                        r_3.xz = r_2.xz;
-                        r_2.xz = r.xz;
-                        r.xz = shift_r3;
-                        shift_r4 = r_4.xx;
-                        r_4.xx = r_3.xx;
-                        r_3.xx = r_2.xx;
-                        r.xx = r.xx;
-                        r.xx = shift_r4;
-                        shift_r5 = r_4.yy;
-                        r_4.yy = r_3.yy;
-                        r_3.yy = r_2.yy;
-                        r_2.yy = r.yy;
-                        r.yy = shift_r5;
-                        shift_r6 = r_4.zz;
-                        r_4.zz = r_3.zz;
-                        r_3.zz = r_2.zz;
-                        r_2.zz = r.zz;
-                        r.zz = shift_r6;
+                        if (L)
+                            surface(1, u, pi, taus, taup, eta, &s, &r, &v, K_x, a_x, b_x,
+                                    K_z, a_z, b_z, psi_vxx, psi_vzz);
+                        else
+                            surface_elastic(1, min(sb[0], 1), max(sb[1], NX), min(sb[4], 1), max(sb[5], NZ),
+                                    u, pi, &s, &v, K_x, a_x, b_x,
+                                    K_z, a_z, b_z, psi_vxx, psi_vzz);
                     }
-                }
-                if (FDORDER_TIME == 3)
-                {
-                    shift_v1 = dv_3.xyyx;
-                    dv_3.xyyx = dv_2.xyyx;
-                    dv_2.xyyx = dv.xyyx;
-                    dv.xyyx = shift_v1;
-                    shift_v2 = dv_3.yzzy;
-                    dv_3.yzzy = dv_2.yzzy;
-                    dv_2.yzzy = dv.yzzy;
-                    dv.yzzy = shift_v2;
-                    shift_v3 = dv_3.xzzx;
-                    dv_3.xzzx = dv_2.xzzx;
-                    dv_2.xzzx = dv.xzzx;
-                    dv.xzzx = shift_v3;
-                    shift_v4 = dv_3.xxyyzz;
-                    dv_3.xxyyzz = dv_2.xxyyzz;
-                    dv_2.xxyyzz = dv.xxyyzz;
-                    dv.xxyyzz = shift_v4;
-                    shift_v5 = dv_3.yyzz;
-                    dv_3.yyzz = dv_2.yyzz;
-                    dv_2.yyzz = dv.yyzz;
-                    dv.yyzz = shift_v5;
-                    shift_v6 = dv_3.xxzz;
-                    dv_3.xxzz = dv_2.xxzz;
-                    dv_2.xxzz = dv.xxzz;
-                    dv.xxzz = shift_v6;
-                    shift_v7 = dv_3.xxyy;
-                    dv_3.xxyy = dv_2.xxyy;
-                    dv_2.xxyy = dv.xxyy;
-                    dv.xxyy = shift_v7;
-                    if (L == 1)
+
+                    /* exchange values of stress at boundaries between PEs */
+                    if (OVERLAP_COMM || PERSISTENT_COMM)
                     {
-                        shift_r1 = r_3.xy;
-                        r_3.xy = r_2.xy;
-                        r_2.xy = r.xy;
-                        r.xy = shift_r1;
-                        shift_r2 = r_3.yz;
-                        r_3.yz = r_2.yz;
-                        r_2.yz = r.yz;
-                        r.yz = shift_r2;
-                        shift_r3 = r_3.xz;
-                        r_3.xz = r_2.xz;
-                        r_2.xz = r.xz;
-                        r.xz = shift_r3;
-                        shift_r4 = r_3.xx;
-                        r_3.xx = r_2.xx;
-                        r_2.xx = r.xx;
-                        r.xx = shift_r4;
-                        shift_r5 = r_3.yy;
-                        r_3.yy = r_2.yy;
-                        r_2.yy = r.yy;
-                        r.yy = shift_r5;
-                        shift_r6 = r_3.zz;
-                        r_3.zz = r_2.zz;
-                        r_2.zz = r.zz;
-                        r.zz = shift_r6;
+                        /* with OVERLAP_COMM completed during the velocity update of the next time step */
+                        time_s_exchange[nt] = exchange_s_start(
+                                nt, &s,
+                                sbufferlef_to_rig, sbufferrig_to_lef,
+                                sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
+                                sbufferbac_to_fro,
+                                rsbufferlef_to_rig, rsbufferrig_to_lef,
+                                rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                                rsbufferbac_to_fro, sreq_send, sreq_rec,
+                                HALO_DATATYPE ? stype_send : NULL, HALO_DATATYPE ? stype_rec : NULL);
+                        s_exchange_pending = 1;
                     }
-                }
+                    else if (HALO_DATATYPE)
+                        time_s_exchange[nt] = exchange_s_dt(nt, stype_send, stype_rec);
+                    else if (HALO_SHM)
+                        time_s_exchange[nt] = exchange_s_shm(nt, &s);
+                    else if (dg)
+                        time_s_exchange[nt] = exchange_deep(nt, dtype_send, dtype_rec);
+                    else
+                        time_s_exchange[nt] = exchange_s(
+                                nt, &s,
+                                sbufferlef_to_rig, sbufferrig_to_lef,
+                                sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
+                                sbufferbac_to_fro);
 
-                /* explosive source */
-                if (!CHECKPTREAD)
-                {
-                    psource(nt, &s, srcpos_loc, signals, nsrc_loc, stype_loc);
-                    /* eqsource is a implementation of moment tensor points sources. */
-                    eqsource(nt, &s, srcpos_loc, signals, nsrc_loc, stype_loc,
-                            amon, str, dip, rake);
+                    if (PERSISTENT_COMM && !OVERLAP_COMM)
+                    {
+                        time_s_exchange[nt] += exchange_s_finish(
+                                nt, &s,
+                                rsbufferlef_to_rig, rsbufferrig_to_lef,
+                                rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                                rsbufferbac_to_fro, sreq_send, sreq_rec,
+                                HALO_DATATYPE ? stype_rec : NULL);
+                        s_exchange_pending = 0;
+                    }
 
-                    source_moment_tensor(nt, &s, srcpos_loc,
-                            signals, nsrc_loc, stype_loc);
+                    /* store amplitudes at receivers in e.g. sectionvx, sectionvz, sectiondiv, ...*/
+                    if ((SEISMO) && (nt == lsamp))
+                    {
+                        if (ntr > 0)
+                            seismo(seisstream_col(nlsamp), ntr, recpos_loc, sectionvx, sectionvy, sectionvz,
+                                    sectiondiv, sectioncurl, sectionp, &v, &s, pi, u);
+                        seisstream_write(nlsamp, sectionvx, sectionvy, sectionvz,
+                                sectionp, sectiondiv, sectioncurl);
+                        nlsamp++;
+                        lsamp += NDT;
+                    }
 
-                    source_random(nt, &s, source_field);
-                }
+                    /* save snapshot in file */
+                    // Add unity in the last condition below to make sure
+                    // that a snapshot is recorded at time `TSNAP2`.
+                    if ((SNAP) && (nt == lsnap) && (nt <= iround(TSNAP2/DT)+1)) {
+                        time5 = MPI_Wtime();
+                        snap(FP, nt, ++nsnap, SNAP_FORMAT, SNAP, &v, &s, u, pi,
+                                IDX, IDY, IDZ, 1, 1, 1, NX, NY, NZ);
+                        tsnap += MPI_Wtime() - time5;
+                        lsnap = lsnap + iround(TSNAPINC / DT);
+                    }
 
-                /* stress free surface ? */
-                if ((FREE_SURF) && (POS[2] == 0))
-                {
-                    if (L)
-                        surface(1, u, pi, taus, taup, eta, &s, &r, &v, K_x, a_x, b_x,
-                                K_z, a_z, b_z, psi_vxx, psi_vzz);
-                    else
-                        surface_elastic(1, u, pi, &s, &v, K_x, a_x, b_x,
-                                K_z, a_z, b_z, psi_vxx, psi_vzz);
-                }
+                    /* periodic checkpoint of the wavefield after this time step */
+                    if (checkpoint_due(nt))
+                    {
+                        if (s_exchange_pending)
+                        {
+                            time_s_exchange[nt] += exchange_s_finish(
+                                    nt, &s,
+                                    rsbufferlef_to_rig, rsbufferrig_to_lef,
+                                    rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                                    rsbufferbac_to_fro, sreq_send, sreq_rec,
+                                    HALO_DATATYPE ? stype_rec : NULL);
+                            s_exchange_pending = 0;
+                        }
+                        cpos.ishot = ishot;
+                        cpos.nt = nt;
+                        cpos.nsnap = nsnap;
+                        cpos.lsnap = lsnap;
+                        cpos.nlsamp = nlsamp;
+                        cpos.lsamp = lsamp;
+                        checkpoint_write(&cpos);
+                    }
 
-                /* exchange values of stress at boundaries between PEs */
-                time_s_exchange[nt] = exchange_s(
-                        nt, &s,
-                        sbufferlef_to_rig, sbufferrig_to_lef,
-                        sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
-                        sbufferbac_to_fro);
+                    if (LOG)
+                        if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
+                        {
+                            time3 = MPI_Wtime();
+                            time_timestep[nt] = (time3 - time2);
+                            fprintf(FP, " total real time for timestep %d : \t\t %4.2f s.\n", nt, time3 - time2);
+                        }
 
-                /* store amplitudes at receivers in e.g. sectionvx, sectionvz, sectiondiv, ...*/
-                if ((SEISMO) && (ntr > 0) && (nt == lsamp))
+                } /* end of loop over timesteps */
+
+                /* complete the stress exchange of the last time step */
+                if (s_exchange_pending)
                 {
-                    seismo(nlsamp, ntr, recpos_loc, sectionvx, sectionvy, sectionvz,
-                            sectiondiv, sectioncurl, sectionp, &v, &s, pi, u);
-                    nlsamp++;
-                    lsamp += NDT;
+                    time_s_exchange[NT] += exchange_s_finish(
+                            NT, &s,
+                            rsbufferlef_to_rig, rsbufferrig_to_lef,
+                            rsbuffertop_to_bot, rsbufferbot_to_top, rsbufferfro_to_bac,
+                            rsbufferbac_to_fro, sreq_send, sreq_rec,
+                            HALO_DATATYPE ? stype_rec : NULL);
+                    s_exchange_pending = 0;
                 }
 
-                /* save snapshot in file */
-                // Add unity in the last condition below to make sure
-                // that a snapshot is recorded at time `TSNAP2`.
-                if ((SNAP) && (nt == lsnap) && (nt <= iround(TSNAP2/DT)+1)) {
-                    snap(FP, nt, ++nsnap, SNAP_FORMAT, SNAP, &v, &s, u, pi,
-                            IDX, IDY, IDZ, 1, 1, 1, NX, NY, NZ);
-                    lsnap = lsnap + iround(TSNAPINC / DT);
-                }
+                tbusy = MPI_Wtime() - tloop - tsnap;
+                for (nt = nt1; nt <= NT; nt++)
+                    tbusy -= time_v_exchange[nt] + time_s_exchange[nt];
 
-                if (LOG)
-                    if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
+                /* complete the output of the snapshots and seismograms of this shot */
+                snap_async_wait();
+                seisstream_close();
+                /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
+
+                fprintf(FP, "\n\n *********** Finish TIME STEPPING ****************\n");
+                fprintf(FP, " **************************************************\n\n");
+
+                /* write seismograms to file(s) */
+                if (SEISMO)
+                {
+                    /* merge of seismogram data from all PE and output data collectively */
+                    switch (SEISMO)
                     {
-                        time3 = MPI_Wtime();
-                        time_timestep[nt] = (time3 - time2);
-                        fprintf(FP, " total real time for timestep %d : \t\t %4.2f s.\n", nt, time3 - time2);
+                        case 1: /* particle velocities only */
+                            saveseis_all(FP, sectionvx, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 1);
+                            saveseis_all(FP, sectionvy, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 2);
+                            saveseis_all(FP, sectionvz, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 3);
+
+                            break;
+                        case 2: /* pressure only */
+                            saveseis_all(FP, sectionp, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 4);
+
+                            break;
+                        case 3: /* curl and div only */
+                            saveseis_all(FP, sectiondiv, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 5);
+                            saveseis_all(FP, sectioncurl, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 6);
+
+                            break;
+                        case 4: /* everything */
+                            saveseis_all(FP, sectionvx, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 1);
+                            saveseis_all(FP, sectionvy, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 2);
+                            saveseis_all(FP, sectionvz, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 3);
+                            saveseis_all(FP, sectionp, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 4);
+                            saveseis_all(FP, sectiondiv, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 5);
+                            saveseis_all(FP, sectioncurl, seismo_fulldata, recswitch, recpos, ntr_glob, srcpos, ishot, ns, 6);
+
+                            break;
+                        default:
+                            break;
                     }
+                    fprintf(FP, "\n\n");
+                }
 
-            } /* end of loop over timesteps */
-            /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
-
-            fprintf(FP, "\n\n *********** Finish TIME STEPPING ****************\n");
-            fprintf(FP, " **************************************************\n\n");
+                /* output timing information (real times for update and exchange) */
+                if (LOG)
+                    if (MYID == 0)
+                        timing(time_v_update, time_s_update, time_s_exchange, time_v_exchange, time_timestep, ishot);
 
-            /* write seismograms to file(s) */
-            if (SEISMO)
-            {
-                /* merge of seismogram data from all PE and output data collectively */
-                switch (SEISMO)
+                /* rebalance the subdomains for the following shots with the measured times */
+                rebalanced = REBALANCE && RUN_MULTIPLE_SHOTS && (ishot < nshots)
+                          && decomp_rebalance(ishot, tbusy, recpos, ntr_glob);
+                if (rebalanced)
                 {
-                    case 1: /* particle velocities only */
-                        catseis(sectionvx, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 1);
-                        catseis(sectionvy, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 2);
-                        catseis(sectionvz, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 3);
+                    ishot1 = ishot + 1;
+                    break;
+                }
 
-                        break;
-                    case 2: /* pressure only */
-                        catseis(sectionp, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 4);
+            } /* end of loop over shots */
 
-                        break;
-                    case 3: /* curl and div only */
-                        catseis(sectiondiv, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 5);
-                        catseis(sectioncurl, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 6);
+            free_f3tensor(source_field, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        }
 
-                        break;
-                    case 4: /* everything */
-                        catseis(sectionvx, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 1);
-                        catseis(sectionvy, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 2);
-                        catseis(sectionvz, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 3);
-                        catseis(sectionp, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 4);
-                        catseis(sectiondiv, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 5);
-                        catseis(sectioncurl, seismo_fulldata, recswitch, ntr_glob, ns);
-                        if (MYID == 0)
-                            saveseis_glob(FP, seismo_fulldata, recpos, ntr_glob, srcpos, ishot, ns, 6);
 
-                        break;
-                    default:
-                        break;
-                }
-                fprintf(FP, "\n\n");
-            }
 
-            /* output timing information (real times for update and exchange) */
-            if (LOG)
-                if (MYID == 0)
-                    timing(time_v_update, time_s_update, time_s_exchange, time_v_exchange, time_timestep, ishot);
 
-        } /* end of loop over shots */
-    }
+        if (CHECKPTWRITE)
+        {
+            if (MYID == 0)
+            {
+                time3 = MPI_Wtime();
+                fprintf(FP, " Saving wavefield to check-point file %s \n", CHECKPTFILE);
+            }
 
+            save_checkpoint(-1, NX + 2, -1, NY + 2, -1, NZ + 2, &v, &s, &r,
+                    psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z,
+                    psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
+            MPI_Barrier(MPI_COMM_WORLD);
+            if (MYID == 0)
+            {
+                time4 = MPI_Wtime();
+                fprintf(FP, " finished (real time: %4.2f s).\n", time4 - time3);
+            }
+        }
 
+        l = 1;
+        if (ABS_TYPE == 1 && FDORDER == 2)
+        {
+            l = 2;
+        }
 
+        /* ------------------------------------------------------------------------
+         * Deallocation of memory.
+         */
+        free_velocity(&v, NRL, NRH, NCL, NCH, NDL, NDH);
 
-    if (CHECKPTWRITE)
-    {
-        if (MYID == 0)
+        if (FDORDER_TIME != 2)
         {
-            time3 = MPI_Wtime();
-            fprintf(FP, " Saving wavefield to check-point file %s \n", CHECKPTFILE);
+            free_velocity_derivatives_tensor(&dv, NRL, NRH, NCL, NCH, NDL, NDH);
+            free_velocity_derivatives_tensor(&dv_2, NRL, NRH, NCL, NCH, NDL, NDH);
+            free_velocity_derivatives_tensor(&dv_3, NRL, NRH, NCL, NCH, NDL, NDH);
+
+            free_stress_derivatives_wrt_velocity(&ds_dv, NRL, NRH, NCL, NCH, NDL, NDH);
+            free_stress_derivatives_wrt_velocity(&ds_dv_2, NRL, NRH, NCL, NCH, NDL, NDH);
+            free_stress_derivatives_wrt_velocity(&ds_dv_3, NRL, NRH, NCL, NCH, NDL, NDH);
+
+            if (FDORDER_TIME == 4)
+            {
+                free_velocity_derivatives_tensor(&dv_4, NRL, NRH, NCL, NCH, NDL, NDH);
+                free_stress_derivatives_wrt_velocity(&ds_dv_4, NRL, NRH, NCL, NCH, NDL, NDH);
+            }
         }
 
-        save_checkpoint(-1, NX + 2, -1, NY + 2, -1, NZ + 2, &v, &s, &r,
-                psi_sxx_x, psi_sxy_x, psi_sxz_x, psi_sxy_y, psi_syy_y, psi_syz_y, psi_sxz_z, psi_syz_z, psi_szz_z,
-                psi_vxx, psi_vyx, psi_vzx, psi_vxy, psi_vyy, psi_vzy, psi_vxz, psi_vyz, psi_vzz);
-        MPI_Barrier(MPI_COMM_WORLD);
-        if (MYID == 0)
+        free_f3tensor_aligned(s.xy, NRL, NRH, NCL, NCH, NDL, NDH);
+        free_f3tensor_aligned(s.yz, NRL, NRH, NCL, NCH, NDL, NDH);
+
+        free_f3tensor_aligned(s.xz, 1 - hg, NRH, NCL, NCH, NDL, NDH);
+        free_f3tensor_aligned(s.xx, 1 - hg, NRH, NCL, NCH, NDL, NDH);
+        free_f3tensor_aligned(s.yy, 1 - hg, NRH, NCL, NCH, NDL, NDH);
+        free_f3tensor_aligned(s.zz, 1 - hg, NRH, NCL, NCH, NDL, NDH);
+
+        if (ABS_TYPE == 1)
         {
-            time4 = MPI_Wtime();
-            fprintf(FP, " finished (real time: %4.2f s).\n", time4 - time3);
+            free_vector(K_x, 1, 2 * FW);
+            free_vector(alpha_prime_x, 1, 2 * FW);
+            free_vector(a_x, 1, 2 * FW);
+            free_vector(b_x, 1, 2 * FW);
+            free_vector(K_x_half, 1, 2 * FW);
+            free_vector(alpha_prime_x_half, 1, 2 * FW);
+            free_vector(a_x_half, 1, 2 * FW);
+            free_vector(b_x_half, 1, 2 * FW);
+
+            free_vector(K_y, 1, 2 * FW);
+            free_vector(alpha_prime_y, 1, 2 * FW);
+            free_vector(a_y, 1, 2 * FW);
+            free_vector(b_y, 1, 2 * FW);
+            free_vector(K_y_half, 1, 2 * FW);
+            free_vector(alpha_prime_y_half, 1, 2 * FW);
+            free_vector(a_y_half, 1, 2 * FW);
+            free_vector(b_y_half, 1, 2 * FW);
+
+            free_vector(K_z, 1, 2 * FW);
+            free_vector(alpha_prime_z, 1, 2 * FW);
+            free_vector(a_z, 1, 2 * FW);
+            free_vector(b_z, 1, 2 * FW);
+            free_vector(K_z_half, 1, 2 * FW);
+            free_vector(alpha_prime_z_half, 1, 2 * FW);
+            free_vector(a_z_half, 1, 2 * FW);
+            free_vector(b_z_half, 1, 2 * FW);
+
+            free_f3tensor(psi_sxx_x, 1, NY, 1, 2 * FW, 1, NZ);
+            free_f3tensor(psi_syy_y, 1, 2 * FW, 1, NX, 1, NZ);
+            free_f3tensor(psi_szz_z, 1, NY, 1, NX, 1, 2 * FW);
+            free_f3tensor(psi_sxy_x, 1, NY, 1, 2 * FW, 1, NZ);
+            free_f3tensor(psi_sxy_y, 1, 2 * FW, 1, NX, 1, NZ);
+            free_f3tensor(psi_sxz_x, 1, NY, 1, 2 * FW, 1, NZ);
+            free_f3tensor(psi_sxz_z, 1, NY, 1, NX, 1, 2 * FW);
+            free_f3tensor(psi_syz_y, 1, 2 * FW, 1, NX, 1, NZ);
+            free_f3tensor(psi_syz_z, 1, NY, 1, NX, 1, 2 * FW);
+
+            free_f3tensor(psi_vxx, 1, NY, 1, 2 * FW, 1, NZ);
+            free_f3tensor(psi_vyy, 1, 2 * FW, 1, NX, 1, NZ);
+            free_f3tensor(psi_vzz, 1, NY, 1, NX, 1, 2 * FW);
+            free_f3tensor(psi_vxy, 1, 2 * FW, 1, NX, 1, NZ);
+            free_f3tensor(psi_vyx, 1, NY, 1, 2 * FW, 1, NZ);
+            free_f3tensor(psi_vxz, 1, NY, 1, NX, 1, 2 * FW);
+            free_f3tensor(psi_vzx, 1, NY, 1, 2 * FW, 1, NZ);
+            free_f3tensor(psi_vyz, 1, NY, 1, NX, 1, 2 * FW);
+            free_f3tensor(psi_vzy, 1, 2 * FW, 1, NX, 1, NZ);
         }
-    }
 
-    l = 1;
-    if (ABS_TYPE == 1 && FDORDER == 2)
-    {
-        l = 2;
-    }
+        if (L)
+        {
+            free_tensor3d(&r, 1, NY, 1, NX, 1, NZ);
+
+            if (FDORDER_TIME > 2)
+            {
+                free_tensor3d(&r_2, 1, NY, 1, NX, 1, NZ);
+                free_tensor3d(&r_3, 1, NY, 1, NX, 1, NZ);
+                if (FDORDER_TIME == 4)
+                {
+                    free_tensor3d(&r_4, 1, NY, 1, NX, 1, NZ);
+                }
+            }
 
-    /* ------------------------------------------------------------------------
-     * Deallocation of memory.
-     */
-    free_velocity(&v, NRL, NRH, NCL, NCH, NDL, NDH);
+            /* the model is kept for the rebalanced subdomains */
+            if (!rebalanced)
+            {
+                free_f3tensor(taus, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                free_f3tensor(taup, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+                free_vector(eta, 1, L);
+            }
+            free_f3tensor(tausipjp, 1, NY, 1, NX, 1, NZ);
+            free_f3tensor(tausjpkp, 1, NY, 1, NX, 1, NZ);
+            free_f3tensor(tausipkp, 1, NY, 1, NX, 1, NZ);
+            free_visco_par(&vp, 1, NY, 1, NX, 1, NZ);
+        }
 
-    if (FDORDER_TIME != 2)
-    {
-        free_velocity_derivatives_tensor(&dv, NRL, NRH, NCL, NCH, NDL, NDH);
-        free_velocity_derivatives_tensor(&dv_2, NRL, NRH, NCL, NCH, NDL, NDH);
-        free_velocity_derivatives_tensor(&dv_3, NRL, NRH, NCL, NCH, NDL, NDH);
+        /* the model is kept for the rebalanced subdomains */
+        if (!rebalanced)
+        {
+            //isotropic parameters releasing
+
+            free_f3tensor_aligned(rho, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(pi, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(u, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+
+            //anisotropic parameters releasing
+
+            free_f3tensor_aligned(C11, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(C12, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(C13, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(C22, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(C23, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(C33, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(C44, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(C55, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+            free_f3tensor_aligned(C66, -dg, NY + 1 + dg, -dg, NX + 1 + dg, -dg, NZ + 1 + dg);
+        }
+        free_f3tensor(absorb_coeff, 1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
 
-        free_stress_derivatives_wrt_velocity(&ds_dv, NRL, NRH, NCL, NCH, NDL, NDH);
-        free_stress_derivatives_wrt_velocity(&ds_dv_2, NRL, NRH, NCL, NCH, NDL, NDH);
-        free_stress_derivatives_wrt_velocity(&ds_dv_3, NRL, NRH, NCL, NCH, NDL, NDH);
+        /* averaged material parameters */
+        free_f3tensor_aligned(C66ipjp, 1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        free_f3tensor_aligned(C44jpkp, 1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        free_f3tensor_aligned(C55ipkp, 1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
 
-        if (FDORDER_TIME == 4)
+        free_f3tensor_aligned(rjp, 1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        free_f3tensor_aligned(rkp, 1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+        free_f3tensor_aligned(rip, 1 - dg, NY + dg, 1 - dg, NX + dg, 1 - dg, NZ + dg);
+
+        if (nsrc_loc > 0)
         {
-            free_velocity_derivatives_tensor(&dv_4, NRL, NRH, NCL, NCH, NDL, NDH);
-            free_stress_derivatives_wrt_velocity(&ds_dv_4, NRL, NRH, NCL, NCH, NDL, NDH);
+            free_matrix(signals, 1, nsrc_loc, 1, NT);
+            free_matrix(srcpos_loc, 1, 6, 1, nsrc_loc);
+            nsrc_loc = 0;
         }
-    }
 
-    free_f3tensor(s.xy, NRL, NRH, NCL, NCH, NDL, NDH);
-    free_f3tensor(s.yz, NRL, NRH, NCL, NCH, NDL, NDH);
+        if (PERSISTENT_COMM)
+        {
+            halo_requests_free(req_send);
+            halo_requests_free(req_rec);
+            halo_requests_free(sreq_send);
+            halo_requests_free(sreq_rec);
+        }
 
-    free_f3tensor(s.xz, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    free_f3tensor(s.xx, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    free_f3tensor(s.yy, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
-    free_f3tensor(s.zz, 1 - l * FDORDER / 2, NRH, NCL, NCH, NDL, NDH);
+        if (HALO_DATATYPE)
+        {
+            halo_types_free(vtype_send);
+            halo_types_free(vtype_rec);
+            halo_types_free(stype_send);
+            halo_types_free(stype_rec);
+        }
+        else if (dg)
+        {
+            halo_types_free(dtype_send);
+            halo_types_free(dtype_rec);
+        }
+        else if (HALO_SHM)
+        {
+            halo_shm_free(HALO_SHM_V);
+            halo_shm_free(HALO_SHM_S);
+        }
+        else
+        {
+            free_f3tensor(bufferlef_to_rig, 1, NY, 1, NZ, 1, nf1);
+            free_f3tensor(bufferrig_to_lef, 1, NY, 1, NZ, 1, nf2);
+            free_f3tensor(buffertop_to_bot, 1, NX, 1, NZ, 1, nf1);
+            free_f3tensor(bufferbot_to_top, 1, NX, 1, NZ, 1, nf2);
+            free_f3tensor(bufferfro_to_bac, 1, NY, 1, NX, 1, nf1);
+            free_f3tensor(bufferbac_to_fro, 1, NY, 1, NX, 1, nf2);
+
+            free_f3tensor(sbufferlef_to_rig, 1, NY, 1, NZ, 1, nf2);
+            free_f3tensor(sbufferrig_to_lef, 1, NY, 1, NZ, 1, nf1);
+            free_f3tensor(sbuffertop_to_bot, 1, NX, 1, NZ, 1, nf2);
+            free_f3tensor(sbufferbot_to_top, 1, NX, 1, NZ, 1, nf1);
+            free_f3tensor(sbufferfro_to_bac, 1, NY, 1, NX, 1, nf2);
+            free_f3tensor(sbufferbac_to_fro, 1, NY, 1, NX, 1, nf1);
+        }
 
-    if (ABS_TYPE == 1)
-    {
-        free_vector(K_x, 1, 2 * FW);
-        free_vector(alpha_prime_x, 1, 2 * FW);
-        free_vector(a_x, 1, 2 * FW);
-        free_vector(b_x, 1, 2 * FW);
-        free_vector(K_x_half, 1, 2 * FW);
-        free_vector(alpha_prime_x_half, 1, 2 * FW);
-        free_vector(a_x_half, 1, 2 * FW);
-        free_vector(b_x_half, 1, 2 * FW);
-
-        free_vector(K_y, 1, 2 * FW);
-        free_vector(alpha_prime_y, 1, 2 * FW);
-        free_vector(a_y, 1, 2 * FW);
-        free_vector(b_y, 1, 2 * FW);
-        free_vector(K_y_half, 1, 2 * FW);
-        free_vector(alpha_prime_y_half, 1, 2 * FW);
-        free_vector(a_y_half, 1, 2 * FW);
-        free_vector(b_y_half, 1, 2 * FW);
-
-        free_vector(K_z, 1, 2 * FW);
-        free_vector(alpha_prime_z, 1, 2 * FW);
-        free_vector(a_z, 1, 2 * FW);
-        free_vector(b_z, 1, 2 * FW);
-        free_vector(K_z_half, 1, 2 * FW);
-        free_vector(alpha_prime_z_half, 1, 2 * FW);
-        free_vector(a_z_half, 1, 2 * FW);
-        free_vector(b_z_half, 1, 2 * FW);
-
-        free_f3tensor(psi_sxx_x, 1, NY, 1, 2 * FW, 1, NZ);
-        free_f3tensor(psi_syy_y, 1, 2 * FW, 1, NX, 1, NZ);
-        free_f3tensor(psi_szz_z, 1, NY, 1, NX, 1, 2 * FW);
-        free_f3tensor(psi_sxy_x, 1, NY, 1, 2 * FW, 1, NZ);
-        free_f3tensor(psi_sxy_y, 1, 2 * FW, 1, NX, 1, NZ);
-        free_f3tensor(psi_sxz_x, 1, NY, 1, 2 * FW, 1, NZ);
-        free_f3tensor(psi_sxz_z, 1, NY, 1, NX, 1, 2 * FW);
-        free_f3tensor(psi_syz_y, 1, 2 * FW, 1, NX, 1, NZ);
-        free_f3tensor(psi_syz_z, 1, NY, 1, NX, 1, 2 * FW);
-
-        free_f3tensor(psi_vxx, 1, NY, 1, 2 * FW, 1, NZ);
-        free_f3tensor(psi_vyy, 1, 2 * FW, 1, NX, 1, NZ);
-        free_f3tensor(psi_vzz, 1, NY, 1, NX, 1, 2 * FW);
-        free_f3tensor(psi_vxy, 1, 2 * FW, 1, NX, 1, NZ);
-        free_f3tensor(psi_vyx, 1, NY, 1, 2 * FW, 1, NZ);
-        free_f3tensor(psi_vxz, 1, NY, 1, NX, 1, 2 * FW);
-        free_f3tensor(psi_vzx, 1, NY, 1, 2 * FW, 1, NZ);
-        free_f3tensor(psi_vyz, 1, NY, 1, NX, 1, 2 * FW);
-        free_f3tensor(psi_vzy, 1, 2 * FW, 1, NX, 1, NZ);
-    }
+        if ((OVERLAP_COMM || PERSISTENT_COMM) && !HALO_DATATYPE)
+        {
+            free_f3tensor(rbufferlef_to_rig, 1, NY, 1, NZ, 1, nf1);
+            free_f3tensor(rbufferrig_to_lef, 1, NY, 1, NZ, 1, nf2);
+            free_f3tensor(rbuffertop_to_bot, 1, NX, 1, NZ, 1, nf1);
+            free_f3tensor(rbufferbot_to_top, 1, NX, 1, NZ, 1, nf2);
+            free_f3tensor(rbufferfro_to_bac, 1, NY, 1, NX, 1, nf1);
+            free_f3tensor(rbufferbac_to_fro, 1, NY, 1, NX, 1, nf2);
+
+            free_f3tensor(rsbufferlef_to_rig, 1, NY, 1, NZ, 1, nf2);
+            free_f3tensor(rsbufferrig_to_lef, 1, NY, 1, NZ, 1, nf1);
+            free_f3tensor(rsbuffertop_to_bot, 1, NX, 1, NZ, 1, nf2);
+            free_f3tensor(rsbufferbot_to_top, 1, NX, 1, NZ, 1, nf1);
+            free_f3tensor(rsbufferfro_to_bac, 1, NY, 1, NX, 1, nf2);
+            free_f3tensor(rsbufferbac_to_fro, 1, NY, 1, NX, 1, nf1);
+        }
 
-    if (L)
-    {
-        free_tensor3d(&r, 1, NY, 1, NX, 1, NZ);
+        if ((SEISMO > 0) && (MYID == 0) && !SEIS_MPIIO)
+            free_matrix(seismo_fulldata, 1, ntr_glob, 1, ns);
 
-        if (FDORDER_TIME > 2)
+        if ((ntr > 0) && (SEISMO > 0))
         {
-            free_tensor3d(&r_2, 1, NY, 1, NX, 1, NZ);
-            free_tensor3d(&r_3, 1, NY, 1, NX, 1, NZ);
-            if (FDORDER_TIME == 4)
+            free_imatrix(recpos_loc, 1, 3, 1, ntr);
+
+            switch (SEISMO)
             {
-                free_tensor3d(&r_4, 1, NY, 1, NX, 1, NZ);
+                case 1: /* particle velocities only */
+                    free_matrix(sectionvx, 1, ntr, 1, nsect);
+                    free_matrix(sectionvy, 1, ntr, 1, nsect);
+                    free_matrix(sectionvz, 1, ntr, 1, nsect);
+                    break;
+                case 2: /* pressure only */
+                    free_matrix(sectionp, 1, ntr, 1, nsect);
+                    break;
+                case 3: /* curl and div only */
+                    free_matrix(sectioncurl, 1, ntr, 1, nsect);
+                    free_matrix(sectiondiv, 1, ntr, 1, nsect);
+                    break;
+                case 4: /* everything */
+                    free_matrix(sectionvx, 1, ntr, 1, nsect);
+                    free_matrix(sectionvy, 1, ntr, 1, nsect);
+                    free_matrix(sectionvz, 1, ntr, 1, nsect);
+                    free_matrix(sectionp, 1, ntr, 1, nsect);
+                    free_matrix(sectioncurl, 1, ntr, 1, nsect);
+                    free_matrix(sectiondiv, 1, ntr, 1, nsect);
+                    break;
             }
         }
 
-        free_f3tensor(taus, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-        free_f3tensor(taup, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-        free_vector(eta, 1, L);
-        free_f3tensor(tausipjp, 1, NY, 1, NX, 1, NZ);
-        free_f3tensor(tausjpkp, 1, NY, 1, NX, 1, NZ);
-        free_f3tensor(tausipkp, 1, NY, 1, NX, 1, NZ);
-    }
-
-    //isotropic parameters releasing
-
-    free_f3tensor(rho, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(pi, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(u, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
+        /* free memory for source position definition */
+        free_matrix(srcpos1, 1, 6, 1, 1);
 
-    //anisotropic parameters releasing
+        /* de-allocate buffer for messages */
+        MPI_Buffer_detach(buff_addr, &buffsize);
 
-    free_f3tensor(C11, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C12, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C13, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C22, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C23, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C33, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C44, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C55, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(C66, 0, NY + 1, 0, NX + 1, 0, NZ + 1);
-    free_f3tensor(absorb_coeff, 1, NY, 1, NX, 1, NZ);
+        MPI_Barrier(MPI_COMM_WORLD);
 
-    /* averaged material parameters */
-    free_f3tensor(C66ipjp, 1, NY, 1, NX, 1, NZ);
-    free_f3tensor(C44jpkp, 1, NY, 1, NX, 1, NZ);
-    free_f3tensor(C55ipkp, 1, NY, 1, NX, 1, NZ);
+        /* merge snapshot files created by the PEs into one file */
+        /* if ((SNAP) && (MYID==0)) snapmerge(nsnap);*/
 
-    free_f3tensor(rjp, 1, NY, 1, NX, 1, NZ);
-    free_f3tensor(rkp, 1, NY, 1, NX, 1, NZ);
-    free_f3tensor(rip, 1, NY, 1, NX, 1, NZ);
+        snap_async_free();
+        seisstream_free();
+        checkpoint_free();
 
-    if (nsrc_loc > 0)
-    {
-        free_matrix(signals, 1, nsrc_loc, 1, NT);
-        free_matrix(srcpos_loc, 1, 6, 1, nsrc_loc);
-    }
+        /* the local receivers of the next subdomains are found among all receivers */
+        if (SEISMO > 0)
+        {
+            free_ivector(recswitch, 1, ntr_glob);
+            ntr = ntr_glob;
+        }
 
-    free_f3tensor(bufferlef_to_rig, 1, NY, 1, NZ, 1, nf1);
-    free_f3tensor(bufferrig_to_lef, 1, NY, 1, NZ, 1, nf2);
-    free_f3tensor(buffertop_to_bot, 1, NX, 1, NZ, 1, nf1);
-    free_f3tensor(bufferbot_to_top, 1, NX, 1, NZ, 1, nf2);
-    free_f3tensor(bufferfro_to_bac, 1, NY, 1, NX, 1, nf1);
-    free_f3tensor(bufferbac_to_fro, 1, NY, 1, NX, 1, nf2);
+        free_ivector(xb, 0, 1);
+        free_ivector(yb, 0, 1);
+        free_ivector(zb, 0, 1);
 
-    free_f3tensor(sbufferlef_to_rig, 1, NY, 1, NZ, 1, nf2);
-    free_f3tensor(sbufferrig_to_lef, 1, NY, 1, NZ, 1, nf1);
-    free_f3tensor(sbuffertop_to_bot, 1, NX, 1, NZ, 1, nf2);
-    free_f3tensor(sbufferbot_to_top, 1, NX, 1, NZ, 1, nf1);
-    free_f3tensor(sbufferfro_to_bac, 1, NY, 1, NX, 1, nf2);
-    free_f3tensor(sbufferbac_to_fro, 1, NY, 1, NX, 1, nf1);
+        /* free timing arrays */
+        free_dvector(time_v_update, 1, NT);
+        free_dvector(time_s_update, 1, NT);
+        free_dvector(time_s_exchange, 1, NT);
+        free_dvector(time_v_exchange, 1, NT);
+        free_dvector(time_timestep, 1, NT);
+    } while (rebalanced);
 
     /* free memory for global receiver source positions */
     if (SEISMO > 0)
@@ -1448,61 +2020,9 @@ out: sxx, syy, szz, sxy, syz, sxz,*/
 
     /* free memory for global source positions */
     free_matrix(srcpos, 1, 6, 1, nsrc);
-
-    if ((ntr > 0) && (SEISMO > 0))
-    {
-        free_imatrix(recpos_loc, 1, 3, 1, ntr);
-        free_matrix(seismo_fulldata, 1, ntr_glob, 1, ns);
-
-        switch (SEISMO)
-        {
-            case 1: /* particle velocities only */
-                free_matrix(sectionvx, 1, ntr, 1, ns);
-                free_matrix(sectionvy, 1, ntr, 1, ns);
-                free_matrix(sectionvz, 1, ntr, 1, ns);
-                break;
-            case 2: /* pressure only */
-                free_matrix(sectionp, 1, ntr, 1, ns);
-                break;
-            case 3: /* curl and div only */
-                free_matrix(sectioncurl, 1, ntr, 1, ns);
-                free_matrix(sectiondiv, 1, ntr, 1, ns);
-                break;
-            case 4: /* everything */
-                free_matrix(sectionvx, 1, ntr, 1, ns);
-                free_matrix(sectionvy, 1, ntr, 1, ns);
-                free_matrix(sectionvz, 1, ntr, 1, ns);
-                free_matrix(sectionp, 1, ntr, 1, ns);
-                free_matrix(sectioncurl, 1, ntr, 1, ns);
-                free_matrix(sectiondiv, 1, ntr, 1, ns);
-                break;
-        }
-    }
-
-    /* free memory for source position definition */
-    free_matrix(srcpos1, 1, 6, 1, 1);
     free_ivector(stype, 1, nsrc);
     free_ivector(stype_loc, 1, nsrc);
 
-    /* de-allocate buffer for messages */
-    MPI_Buffer_detach(buff_addr, &buffsize);
-
-    MPI_Barrier(MPI_COMM_WORLD);
-
-    /* merge snapshot files created by the PEs into one file */
-    /* if ((SNAP) && (MYID==0)) snapmerge(nsnap);*/
-
-    free_ivector(xb, 0, 1);
-    free_ivector(yb, 0, 1);
-    free_ivector(zb, 0, 1);
-
-    /* free timing arrays */
-    free_dvector(time_v_update, 1, NT);
-    free_dvector(time_s_update, 1, NT);
-    free_dvector(time_s_exchange, 1, NT);
-    free_dvector(time_v_exchange, 1, NT);
-    free_dvector(time_timestep, 1, NT);
-
     if (MYID == 0)
     {
         fprintf(FP, "\n **Info from main (written by PE %d): \n", MYID);
@@ -26,9 +26,12 @@
 #include "fd.h"
 #include "globvar.h"
 #include "data_structures.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 int main(int argc, char **argv){
-	int ns, nt, nseismograms=0, nf1, nf2, i;
+	int ns, nsect, nt, nseismograms=0, nf1, nf2, i;
 	int lsnap, nsnap=0, lsamp=0, nlsamp=0, buffsize;
 	int ntr=0, ntr_loc=0, ntr_glob=0, nsrc=0, nsrc_loc=0, ishot, nshots, h;
 
@@ -76,7 +79,13 @@ int main(int argc, char **argv){
 	FILE * fpsrc=NULL;
 
 	/* Initialize MPI environment */
-	MPI_Init(&argc,&argv);
+	/* only the master thread calls MPI (besides OpenMP, there may be a
+	   snapshot I/O thread), one thread per process by default */
+	int mpi_thread_level;
+	MPI_Init_thread(&argc,&argv,MPI_THREAD_FUNNELED,&mpi_thread_level);
+#ifdef _OPENMP
+	if ((getenv("OMP_NUM_THREADS")==NULL) || (mpi_thread_level<MPI_THREAD_FUNNELED)) omp_set_num_threads(1);
+#endif
 	MPI_Comm_size(MPI_COMM_WORLD,&NP);
 	MPI_Comm_rank(MPI_COMM_WORLD,&MYID);
 
@@ -92,6 +101,9 @@ int main(int argc, char **argv){
 
 	/* print program name, version etc to stdout*/
 	if (MYID == 0) info(stdout);
+#ifdef _OPENMP
+	if (MYID == 0) fprintf(stdout," Running %d MPI process(es) with %d OpenMP thread(s) each.\n\n",NP,omp_get_max_threads());
+#endif
 	SOFI3DVERS=32; /* 3D isotropic acoustic */
 
 	/* PE 0 is reading the parameters from the input file sofi3D.inp */
@@ -118,6 +130,14 @@ int main(int argc, char **argv){
 	/* PE 0 will broadcast the parameters to all others PEs */
 	exchange_par();
 
+	/* without MPI_THREAD_FUNNELED no thread may run besides the one calling
+	   MPI: one thread per process (see above), no snapshot I/O thread */
+	if (mpi_thread_level<MPI_THREAD_FUNNELED){
+		if (MYID==0)
+			warning(" The MPI library does not support MPI_THREAD_FUNNELED: one thread per process, no snapshot I/O thread (SNAP_ASYNC=0). ");
+		if (!SNAP_MPIIO) SNAP_ASYNC=0;
+	}
+
 	if (MYID == 0) note(stdout);
 
 	sprintf(ext,".%i",MYID);  
@@ -137,8 +157,18 @@ int main(int argc, char **argv){
 
 	fprintf(FP," This is the log-file generated by PE %d \n\n",MYID);
 
-	/* domain decomposition */
-	initproc();
+	/* NXG, NYG NZG denote size of the entire (global) grid */
+	NXG=NX;
+	NYG=NY;
+	NZG=NZ;
+
+	/* domain decomposition (uniform slabs) */
+	if (DECOMP)
+		err(" The cost-weighted domain decomposition (DECOMP=1) is available for the elastic modelling only ! ");
+	initproc(NULL,0);
+
+	/* cache blocking of the wavefield updates */
+	tile_ini();
 
 	/* set some time counters */
 	NT=(int)ceil(TIME/DT); /* number of timesteps - replaces: NT=iround(TIME/DT); */
@@ -150,16 +180,14 @@ int main(int argc, char **argv){
 	/* output of parameters to stdout: */
 	/*if (MYID==0) writepar(FP,recpos, ns);*/
 	if (MYID==0) writepar(FP, ns);
-	/* NXG, NYG NZG denote size of the entire (global) grid */
-	NXG=NX;
-	NYG=NY;
-	NZG=NZ;
-
 	/* In the following, NX, MY, NZ denote size of the local grid ! */
 	NX = IENDX;
 	NY = IENDY;
 	NZ = IENDZ;
 
+	/* staging buffers of asynchronous snapshot output */
+	snap_async_ini();
+
 	/* compute receiver locations within each subgrid and
 	   store local receiver coordinates in recpos_loc */	
 	if (SEISMO){
@@ -171,9 +199,14 @@ int main(int argc, char **argv){
 		ntr=ntr_loc;
 	}
 
+	/* number of samples of the seismogram sections of the PEs (all ns samples,
+	   or the blocks of SEIS_STREAM samples streamed to disk, see seisstream.c) */
+	nsect=seisstream_ini(ntr,ntr_glob,recswitch,ns);
 
-	/* allocate buffer for seismogram output, merged seismogram section of all PEs */
-	if (SEISMO) seismo_fulldata=fmatrix(1,ntr_glob,1,ns);
+
+	/* allocate buffer for seismogram output, merged seismogram section of all PEs
+	   (gathered on PE 0 only, see catseis; not needed with SEIS_MPIIO) */
+	if (SEISMO && (MYID==0) && !SEIS_MPIIO) seismo_fulldata=fmatrix(1,ntr_glob,1,ns);
 
 	/* allocate buffer for seismogram output, seismogram section of each PE */
 	/* allocation of memory for seismogramm merge */
@@ -201,7 +234,7 @@ int main(int argc, char **argv){
 	if(ABS_TYPE==1){ 
 		memdyn=22.0*fac1*fac2;
 		memmodel=5.0*fac1*fac2;
-		memseismograms=nseismograms*ntr*ns*fac2;
+		memseismograms=nseismograms*ntr*nsect*fac2;
 		membuffer=2.0*5.0*((NX*NZ)+(NY*NZ)+(NX*NY))*fac2;
 		buffsize=(FDORDER/2)*4.0*6.0*(max((NX*NZ),max((NY*NZ),(NX*NY))))*sizeof(MPI_FLOAT);
 		memtotal=memdyn+memmodel+memseismograms+membuffer+(buffsize*pow(2.0,-20.0));
@@ -223,7 +256,7 @@ int main(int argc, char **argv){
 	if(ABS_TYPE==2){
 		memdyn=4.0*fac1*fac2;
 		memmodel=3.0*fac1*fac2;
-		memseismograms=nseismograms*ntr*ns*fac2;
+		memseismograms=nseismograms*ntr*nsect*fac2;
 		membuffer=2.0*5.0*((NX*NZ)+(NY*NZ)+(NX*NY))*fac2;
 		buffsize=(FDORDER/2)*4.0*6.0*(max((NX*NZ),max((NY*NZ),(NX*NY))))*sizeof(MPI_FLOAT);
 		memtotal=memdyn+memmodel+memseismograms+membuffer+(buffsize*pow(2.0,-20.0));
@@ -333,24 +366,24 @@ int main(int argc, char **argv){
 	if ((ntr>0)){
 		switch (SEISMO){
 		case 1 : /* particle velocities only */
-			sectionvx=fmatrix(1,ntr,1,ns);
-			sectionvy=fmatrix(1,ntr,1,ns);
-			sectionvz=fmatrix(1,ntr,1,ns);
+			sectionvx=fmatrix(1,ntr,1,nsect);
+			sectionvy=fmatrix(1,ntr,1,nsect);
+			sectionvz=fmatrix(1,ntr,1,nsect);
 			break;
 		case 2 : /* pressure only */
-			sectionp=fmatrix(1,ntr,1,ns);
+			sectionp=fmatrix(1,ntr,1,nsect);
 			break;
 		case 3 : /* curl and div only */
-			sectioncurl=fmatrix(1,ntr,1,ns);
-			sectiondiv=fmatrix(1,ntr,1,ns);
+			sectioncurl=fmatrix(1,ntr,1,nsect);
+			sectiondiv=fmatrix(1,ntr,1,nsect);
 			break;
 		case 4 : /* everything */
-			sectionvx=fmatrix(1,ntr,1,ns);
-			sectionvy=fmatrix(1,ntr,1,ns);
-			sectionvz=fmatrix(1,ntr,1,ns);
-			sectioncurl=fmatrix(1,ntr,1,ns);
-			sectiondiv=fmatrix(1,ntr,1,ns);
-			sectionp=fmatrix(1,ntr,1,ns);
+			sectionvx=fmatrix(1,ntr,1,nsect);
+			sectionvy=fmatrix(1,ntr,1,nsect);
+			sectionvz=fmatrix(1,ntr,1,nsect);
+			sectioncurl=fmatrix(1,ntr,1,nsect);
+			sectiondiv=fmatrix(1,ntr,1,nsect);
+			sectionp=fmatrix(1,ntr,1,nsect);
 			break;
 		}
 	}	
@@ -447,16 +480,16 @@ int main(int argc, char **argv){
 
 			/* find this single source positions on subdomains */
 			if (nsrc_loc>0) free_matrix(srcpos_loc,1,6,1,1);
-			srcpos_loc=splitsrc(srcpos1,&nsrc_loc, 1, stype_loc, stype);
+			srcpos_loc=splitsrc(srcpos1,&nsrc_loc, 1, stype_loc, stype, 0);
 			if (stype_loc==NULL) stype_loc = ivector(1,nsrc);;
-			srcpos_loc=splitsrc(srcpos1,&nsrc_loc, 1, stype_loc, stype);
+			srcpos_loc=splitsrc(srcpos1,&nsrc_loc, 1, stype_loc, stype, 0);
 		}
 
 
 		else{
 			/* Distribute multiple source positions on subdomains */
 			if (stype_loc==NULL) stype_loc = ivector(1,nsrc);
-			srcpos_loc = splitsrc(srcpos,&nsrc_loc, nsrc, stype_loc, stype);
+			srcpos_loc = splitsrc(srcpos,&nsrc_loc, nsrc, stype_loc, stype, 0);
 		}
 
 
@@ -495,17 +528,6 @@ int main(int argc, char **argv){
 
 
 
-		/* comunication initialisation for persistent communication */
-		/*comm_ini(bufferlef_to_rig, bufferrig_to_lef,
-	    buffertop_to_bot, bufferbot_to_top, bufferfro_to_bac,
-	    bufferbac_to_fro, req_send, req_rec);
-
-	comm_ini_acoustic(sbufferlef_to_rig, sbufferrig_to_lef,
-	    sbuffertop_to_bot, sbufferbot_to_top, sbufferfro_to_bac,
-	    sbufferbac_to_fro, sreq_send, sreq_rec);*/
-
-
-
 		/* calculate wavelet for each source point */
 		signals=wavelet(srcpos_loc,nsrc_loc);
 
@@ -524,6 +546,7 @@ int main(int argc, char **argv){
 
 		lsamp=NDTSHIFT+1;
 		nlsamp=1;
+		seisstream_open(ishot, 1);
 		for (nt=1;nt<=NT;nt++){
 
 			time_v_update[nt]=0.0;
@@ -624,9 +647,10 @@ int main(int argc, char **argv){
 
 
 			/* store amplitudes at receivers in sectionvx-sectionvz */
-			if ((SEISMO) && (ntr>0) && (nt==lsamp)){
-				seismo_acoustic(nlsamp,ntr,recpos_loc,sectionvx,sectionvy,sectionvz,
+			if ((SEISMO) && (nt==lsamp)){
+				if (ntr>0) seismo_acoustic(seisstream_col(nlsamp),ntr,recpos_loc,sectionvx,sectionvy,sectionvz,
 						sectiondiv,sectioncurl,sectionp, &v,sxx,pi);
+				seisstream_write(nlsamp,sectionvx,sectionvy,sectionvz,sectionp,sectiondiv,sectioncurl);
 				nlsamp++;
 				lsamp+=NDT;
 			}
@@ -649,6 +673,10 @@ int main(int argc, char **argv){
 
 
 		} /* end of loop over timesteps */
+
+		/* complete the output of the snapshots and seismograms of this shot */
+		snap_async_wait();
+		seisstream_close();
 		/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ */
 		fprintf(FP, "\n\n *********** Finish TIME STEPPING ****************\n");
 		fprintf(FP, " **************************************************\n\n");
@@ -659,39 +687,27 @@ int main(int argc, char **argv){
 			/* merge of seismogram data from all PE and output data collectively */
 			switch (SEISMO){
 			case 1 : /* particle velocities only */
-				catseis(sectionvx, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,1);
-				catseis(sectionvy, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,2);
-				catseis(sectionvz, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,3);
+				saveseis_all(FP,sectionvx,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,1);
+				saveseis_all(FP,sectionvy,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,2);
+				saveseis_all(FP,sectionvz,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,3);
 
 				break;
 			case 2 : /* pressure only */
-				catseis(sectionp, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,4);
+				saveseis_all(FP,sectionp,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,4);
 
 				break;
 			case 3 : /* curl and div only */
-				catseis(sectiondiv, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,5);
-				catseis(sectioncurl, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,6);
+				saveseis_all(FP,sectiondiv,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,5);
+				saveseis_all(FP,sectioncurl,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,6);
 
 				break;
 			case 4 : /* everything */
-				catseis(sectionvx, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,1);
-				catseis(sectionvy, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,2);
-				catseis(sectionvz, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,3);
-				catseis(sectionp, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,4);
-				catseis(sectiondiv, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,5);
-				catseis(sectioncurl, seismo_fulldata, recswitch, ntr_glob,ns);
-				if (MYID==0) saveseis_glob(FP,seismo_fulldata,recpos, ntr_glob,srcpos,ishot,ns,6);
+				saveseis_all(FP,sectionvx,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,1);
+				saveseis_all(FP,sectionvy,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,2);
+				saveseis_all(FP,sectionvz,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,3);
+				saveseis_all(FP,sectionp,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,4);
+				saveseis_all(FP,sectiondiv,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,5);
+				saveseis_all(FP,sectioncurl,seismo_fulldata,recswitch,recpos,ntr_glob,srcpos,ishot,ns,6);
 
 				break;
 			default :	break;
@@ -795,30 +811,31 @@ int main(int argc, char **argv){
 	free_matrix(srcpos,1,6,1,nsrc);
 
 
+	if (SEISMO && (MYID==0) && !SEIS_MPIIO) free_matrix(seismo_fulldata,1,ntr_glob,1,ns);
+
 	if ((ntr>0) && (SEISMO)){	
-		free_matrix(seismo_fulldata,1,ntr_glob,1,ns);
 		free_imatrix(recpos_loc,1,3,1,ntr);
 
 		switch (SEISMO){
 		case 1 : /* particle velocities only */
-			free_matrix(sectionvx,1,ntr,1,ns);
-			free_matrix(sectionvy,1,ntr,1,ns);		
-			free_matrix(sectionvz,1,ntr,1,ns);		
+			free_matrix(sectionvx,1,ntr,1,nsect);
+			free_matrix(sectionvy,1,ntr,1,nsect);		
+			free_matrix(sectionvz,1,ntr,1,nsect);		
 			break;	
 		case 2 : /* pressure only */
-			free_matrix(sectionp,1,ntr,1,ns);
+			free_matrix(sectionp,1,ntr,1,nsect);
 			break;	
 		case 3 : /* curl and div only */
-			free_matrix(sectioncurl,1,ntr,1,ns);
-			free_matrix(sectiondiv,1,ntr,1,ns);
+			free_matrix(sectioncurl,1,ntr,1,nsect);
+			free_matrix(sectiondiv,1,ntr,1,nsect);
 			break;	
 		case 4 : /* everything */
-			free_matrix(sectionvx,1,ntr,1,ns);
-			free_matrix(sectionvy,1,ntr,1,ns);
-			free_matrix(sectionvz,1,ntr,1,ns);
-			free_matrix(sectionp,1,ntr,1,ns);
-			free_matrix(sectioncurl,1,ntr,1,ns);
-			free_matrix(sectiondiv,1,ntr,1,ns);		
+			free_matrix(sectionvx,1,ntr,1,nsect);
+			free_matrix(sectionvy,1,ntr,1,nsect);
+			free_matrix(sectionvz,1,ntr,1,nsect);
+			free_matrix(sectionp,1,ntr,1,nsect);
+			free_matrix(sectioncurl,1,ntr,1,nsect);
+			free_matrix(sectiondiv,1,ntr,1,nsect);		
 			break;
 		}	
 
@@ -838,6 +855,9 @@ int main(int argc, char **argv){
 	/* merge snapshot files created by the PEs into one file */
 	/* if ((SNAP) && (MYID==0)) snapmerge(nsnap);*/
 
+	snap_async_free();
+	seisstream_free();
+
 
 	/* free PML indices */
 	free_ivector(xa,0,5);
@@ -1,36 +1,50 @@
 /*  ----------------------------------------------------------------------
  * Computation of local source coordinates
- * 
+ *
+ * The sources within g grid points outside of the faces with a neighbour
+ * are included, too (ghost zones of HALO_DEEP, see halo_deep.c).
  ----------------------------------------------------------------------*/
 
 #include "fd.h"
 #include "globvar.h"
 
 
-float **splitsrc(float **srcpos,int *nsrc_loc, int nsrc, int * stype_loc, int *stype)
+float **splitsrc(float **srcpos,int *nsrc_loc, int nsrc, int * stype_loc, int *stype, int g)
 {
 
-	extern int IENDX, IENDY, IENDZ, MYID, POS[4];
+	extern int NPROCX, NPROCY, NPROCZ, MYID, POS[4];
+	extern int NX, NY, NZ;
 	extern float DX, DY, DZ;
 	extern FILE *FP;
 
-	int a,b,c,i=0,j,k;
+	int a,b,c,i=0,j,k,x,y,z;
+	int lo[4], hi[4];
 	float ** srcpos_dummy, **srcpos_local=NULL;
 	int * stype_dummy;
 	srcpos_dummy = fmatrix(1,6,1,nsrc);
 	stype_dummy  = ivector(1,nsrc);
 
+	/* local grid with the ghost zones towards the neighbours */
+	lo[1]=1-((POS[1]>0) ? g : 0); hi[1]=NX+((POS[1]<NPROCX-1) ? g : 0);
+	lo[2]=1-((POS[2]>0) ? g : 0); hi[2]=NY+((POS[2]<NPROCY-1) ? g : 0);
+	lo[3]=1-((POS[3]>0) ? g : 0); hi[3]=NZ+((POS[3]<NPROCZ-1) ? g : 0);
+
 	for (j=1;j<=nsrc;j++) {
-		a=(iround(srcpos[1][j]/DX)-1)/IENDX;
-		b=(iround(srcpos[2][j]/DY)-1)/IENDY;
-		c=(iround(srcpos[3][j]/DZ)-1)/IENDZ;
+		a=decomp_owner(SLABX,NPROCX,iround(srcpos[1][j]/DX));
+		b=decomp_owner(SLABY,NPROCY,iround(srcpos[2][j]/DY));
+		c=decomp_owner(SLABZ,NPROCZ,iround(srcpos[3][j]/DZ));
 
+		/* local grid coordinates */
+		x=iround(srcpos[1][j]/DX)-SLABX[POS[1]];
+		y=iround(srcpos[2][j]/DY)-SLABY[POS[2]];
+		z=iround(srcpos[3][j]/DZ)-SLABZ[POS[3]];
 
-		if ((POS[1]==a)&&(POS[2]==b)&&(POS[3]==c)) {
+		if (((POS[1]==a)&&(POS[2]==b)&&(POS[3]==c)) ||
+		    ((g>0)&&(x>=lo[1])&&(x<=hi[1])&&(y>=lo[2])&&(y<=hi[2])&&(z>=lo[3])&&(z<=hi[3]))) {
 			i++;
-			srcpos_dummy[1][i] = (float)(((iround(srcpos[1][j]/DX)-1)%IENDX)+1);
-			srcpos_dummy[2][i] = (float)(((iround(srcpos[2][j]/DY)-1)%IENDY)+1);
-			srcpos_dummy[3][i] = (float)(((iround(srcpos[3][j]/DZ)-1)%IENDZ)+1);
+			srcpos_dummy[1][i] = (float)x;
+			srcpos_dummy[2][i] = (float)y;
+			srcpos_dummy[3][i] = (float)z;
 			srcpos_dummy[4][i] = srcpos[4][j];
 			srcpos_dummy[5][i] = srcpos[5][j];
 			srcpos_dummy[6][i] = srcpos[6][j];
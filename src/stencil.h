@@ -0,0 +1,78 @@
+/*------------------------------------------------------------------------
+ *  stencil.h - staggered grid FD operators shared by the update kernels
+ *
+ *  The kernels for FDORDER_TIME=2 are generated from one definition for
+ *  every order in FD_ORDER_LIST: a kernel body is written once as an
+ *  FD_INLINE function of the number of coefficients `nb`, and a
+ *  specialised function with constant `nb` is instantiated for each order,
+ *  so that the compiler unrolls the sums over the coefficients.  The
+ *  kernel for the current FDORDER is selected once at startup.
+ *
+ *  To support another order, add its coefficients to `fd_coeff` and the
+ *  order to FD_ORDER_LIST (and raise FD_MAX_NB if needed).
+ *
+ *  The kernels get one row of coefficients per direction (see
+ *  `fd_coeff_fold`).  With FOLD_COEFF=1 the rows are scaled by DT/DX,
+ *  DT/DY and DT/DZ at startup and the kernels instantiated with `fold` = 1
+ *  neither divide by the grid spacing nor multiply by DT.  This saves 9
+ *  divisions per grid point of the stress update but changes the rounding,
+ *  so it is optional.
+ *  ---------------------------------------------------------------------*/
+#ifndef STENCIL_H
+#define STENCIL_H
+
+#include <stddef.h>
+
+/* Maximum number of FD coefficients (FDORDER/2). */
+#define FD_MAX_NB 6
+
+/* Orders for which specialised kernels are generated, X(FDORDER). */
+#define FD_ORDER_LIST(X) X(4) X(6) X(8) X(10) X(12)
+
+#if defined(__GNUC__)
+    #define FD_INLINE static inline __attribute__((always_inline))
+#else
+    #define FD_INLINE static inline
+#endif
+
+/* Rows of the coefficients for the derivatives along x, y and z. */
+#define FD_BX(b) (b)
+#define FD_BY(b) ((b) + FD_MAX_NB)
+#define FD_BZ(b) ((b) + 2 * FD_MAX_NB)
+
+/*
+ * Staggered grid derivatives of `f` at index `k` along the direction with
+ * stride `s`, not yet divided by the grid spacing:
+ *   fd_fwd = sum_n b[n]*(f[k+(n+1)*s]-f[k-n*s])
+ *   fd_bwd = sum_n b[n]*(f[k+n*s]-f[k-(n+1)*s])
+ * The terms are summed from n=0 on, like in the original kernels.
+ */
+FD_INLINE float fd_fwd(const float *f, ptrdiff_t k, ptrdiff_t s,
+        int nb, const float *b)
+{
+    float d = b[0] * (f[k+s] - f[k]);
+    for (int n = 1; n < nb; n++)
+        d = d + b[n] * (f[k+(n+1)*s] - f[k-n*s]);
+    return d;
+}
+
+FD_INLINE float fd_bwd(const float *f, ptrdiff_t k, ptrdiff_t s,
+        int nb, const float *b)
+{
+    float d = b[0] * (f[k] - f[k-s]);
+    for (int n = 1; n < nb; n++)
+        d = d + b[n] * (f[k+n*s] - f[k-(n+1)*s]);
+    return d;
+}
+
+/* d/h, or d if the coefficients are folded */
+FD_INLINE float fd_scale(float d, float h, int fold)
+{
+    return fold ? d : d / h;
+}
+
+int fd_coeff(int fdorder, int fdcoeff, float *b);
+
+int fd_coeff_fold(int fdorder, int fdcoeff, int fold, float *b);
+
+#endif
@@ -1,5 +1,6 @@
 /*------------------------------------------------------------------------
- *   stress free surface condition, elastic case
+ *   stress free surface condition, elastic case, applied to the grid
+ *   points i=nx1...nx2, k=nz1...nz2 of the surface
  *
  *  ----------------------------------------------------------------------*/
 
@@ -8,7 +9,8 @@
 #include "globvar.h"
 
 
-void surface_elastic(int ndepth, float *** u, float *** pi,
+void surface_elastic(int ndepth, int nx1, int nx2, int nz1, int nz2,
+        float *** u, float *** pi,
         Tensor3d *s,
         Velocity *v,
         float * K_x, float * a_x, float * b_x, float * K_z, float * a_z, float * b_z, 
@@ -39,8 +41,8 @@ void surface_elastic(int ndepth, float *** u, float *** pi,
 	switch (FDORDER){
 	case 2 :
 
-		for (k=1;k<=NZ;k++){
-			for (i=1;i<=NX;i++){
+		for (k=nz1;k<=nz2;k++){
+			for (i=nx1;i<=nx2;i++){
 
 
 				/*Mirroring the components of the stress tensor to make
@@ -99,8 +101,8 @@ void surface_elastic(int ndepth, float *** u, float *** pi,
 		if(FDCOEFF==2){
 			b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
 
-		for (k=1;k<=NZ;k++){
-			for (i=1;i<=NX;i++){
+		for (k=nz1;k<=nz2;k++){
+			for (i=nx1;i<=nx2;i++){
 
 
 				/*Mirroring the components of the stress tensor to make
@@ -157,8 +159,8 @@ void surface_elastic(int ndepth, float *** u, float *** pi,
 		if(FDCOEFF==2){
 			b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
 
-		for (k=1;k<=NZ;k++){
-			for (i=1;i<=NX;i++){
+		for (k=nz1;k<=nz2;k++){
+			for (i=nx1;i<=nx2;i++){
 
 
 				/*Mirroring the components of the stress tensor to make
@@ -201,8 +203,8 @@ void surface_elastic(int ndepth, float *** u, float *** pi,
 		if(FDCOEFF==2){
 			b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
 
-		for (k=1;k<=NZ;k++){
-			for (i=1;i<=NX;i++){
+		for (k=nz1;k<=nz2;k++){
+			for (i=nx1;i<=nx2;i++){
 
 
 				/*Mirroring the components of the stress tensor to make
@@ -250,8 +252,8 @@ void surface_elastic(int ndepth, float *** u, float *** pi,
 		if(FDCOEFF==2){
 			b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
 
-		for (k=1;k<=NZ;k++){
-			for (i=1;i<=NX;i++){
+		for (k=nz1;k<=nz2;k++){
+			for (i=nx1;i<=nx2;i++){
 
 
 				/*Mirroring the components of the stress tensor to make
@@ -302,8 +304,8 @@ void surface_elastic(int ndepth, float *** u, float *** pi,
 		if(FDCOEFF==2){
 			b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
 
-		for (k=1;k<=NZ;k++){
-			for (i=1;i<=NX;i++){
+		for (k=nz1;k<=nz2;k++){
+			for (i=nx1;i<=nx2;i++){
 
 
 				/*Mirroring the components of the stress tensor to make
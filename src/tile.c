@@ -0,0 +1,135 @@
+/*------------------------------------------------------------------------
+ *   Cache blocking (tiling) of the wavefield updates.
+ *
+ *   The update kernels may be applied to disjoint boxes of the local grid
+ *   in any order.  If tiling is enabled (TILING > 0), each kernel splits
+ *   the box it is called for into tiles of at most TILE_X*TILE_Y*TILE_Z
+ *   grid points (0 = no splitting in this direction) and updates them one
+ *   after the other:
+ *
+ *       int t[6];
+ *       if (tile_first(nx1, nx2, ny1, ny2, nz1, nz2, t)) {
+ *           do
+ *               kernel(t[0], t[1], t[2], t[3], t[4], t[5], ...);
+ *           while (tile_next(nx1, nx2, ny1, ny2, nz1, nz2, t));
+ *           return;
+ *       }
+ *
+ *   The tiles are traversed with y (the outer loop of the kernels) running
+ *   fastest, so that with TILE_Y=0 a tile is a column of full height
+ *   that is swept plane by plane and the planes of the wavefields read by
+ *   the stencil stay in the cache (2.5-D blocking).
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include <unistd.h>
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/* Cache size assumed if it cannot be determined. */
+#define TILE_CACHE_DEFAULT (1024 * 1024)
+
+/* the tile containing the grid point (x1, y1, z1) of the box */
+static void tile_set(int nx2, int ny2, int nz2, int x1, int y1, int z1, int *t)
+{
+    extern int TILE_X, TILE_Y, TILE_Z;
+
+    t[0] = x1; t[1] = (TILE_X > 0) ? min(x1 + TILE_X - 1, nx2) : nx2;
+    t[2] = y1; t[3] = (TILE_Y > 0) ? min(y1 + TILE_Y - 1, ny2) : ny2;
+    t[4] = z1; t[5] = (TILE_Z > 0) ? min(z1 + TILE_Z - 1, nz2) : nz2;
+}
+
+/**
+ * First tile t = {x1, x2, y1, y2, z1, z2} of the box
+ * [nx1...nx2][ny1...ny2][nz1...nz2].
+ *
+ * Returns 0 if the box need not be split, i.e. tiling is disabled or the
+ * box (possibly empty) fits into a single tile.
+ */
+int tile_first(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int *t)
+{
+    extern int TILING;
+
+    if (!TILING || (nx2 < nx1) || (ny2 < ny1) || (nz2 < nz1))
+        return 0;
+
+    tile_set(nx2, ny2, nz2, nx1, ny1, nz1, t);
+    return (t[1] < nx2) || (t[3] < ny2) || (t[5] < nz2);
+}
+
+/**
+ * Advance t to the next tile of the box.  Returns 0 after the last tile.
+ */
+int tile_next(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int *t)
+{
+    (void) nx1;
+
+    if (t[3] < ny2)
+        tile_set(nx2, ny2, nz2, t[0], t[3] + 1, t[4], t);
+    else if (t[5] < nz2)
+        tile_set(nx2, ny2, nz2, t[0], ny1, t[5] + 1, t);
+    else if (t[1] < nx2)
+        tile_set(nx2, ny2, nz2, t[1] + 1, ny1, nz1, t);
+    else
+        return 0;
+
+    return 1;
+}
+
+/**
+ * Set up tiling after the domain decomposition.
+ *
+ * TILING=1 uses TILE_X, TILE_Y and TILE_Z from the input file.  TILING=2
+ * chooses columns of full height (TILE_Y=0) such that FDORDER+1 planes
+ * of three wavefields of a column, i.e. the planes read by the stencil of
+ * the velocity or stress update, fill about half of the L2 cache.
+ * Columns span the full local width in z if possible, otherwise TILE_Z is
+ * reduced in multiples of 16.
+ */
+void tile_ini(void)
+{
+    extern int TILING, TILE_X, TILE_Y, TILE_Z;
+    extern int IENDX, IENDZ, FDORDER, MYID;
+    extern FILE *FP;
+
+    long cache = 0, planes, tx, tz;
+
+    if (TILING == 0) {
+        TILE_X = TILE_Y = TILE_Z = 0;
+        return;
+    }
+
+    if (TILING == 2) {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        cache = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        if (cache <= 0)
+            cache = TILE_CACHE_DEFAULT;
+
+        planes = 3L * (FDORDER + 1) * (long) sizeof(float);
+        tz = IENDZ;
+        for (;;) {
+            tx = cache / 2 / (planes * (tz + FDORDER)) - FDORDER;
+            if ((tx >= 16) || (tz <= 16))
+                break;
+            tz = ((tz + 1) / 2 + 15) / 16 * 16;
+        }
+
+        TILE_X = (int) max(tx, 4);
+        TILE_Y = 0;
+        TILE_Z = (int) tz;
+        if (TILE_X >= IENDX)
+            TILE_X = 0;
+        if (TILE_Z >= IENDZ)
+            TILE_Z = 0;
+    }
+
+    if ((TILE_X < 0) || (TILE_Y < 0) || (TILE_Z < 0))
+        err(" TILE_X, TILE_Y and TILE_Z must not be negative ! ");
+
+    if (MYID == 0)
+        fprintf(FP, " Wavefields are updated in tiles of %d x %d x %d grid points (0: no tiling in this direction).\n",
+                TILE_X, TILE_Y, TILE_Z);
+}
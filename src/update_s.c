@@ -1,6 +1,7 @@
 #include "fd.h"
 #include "data_structures.h"
 #include "globvar.h"
+#include "stencil.h"
 
 
 /**
@@ -21,13 +22,10 @@
  *      Stress tensor.
  *  r :
  *      Relaxation tensor.
- *  pi :
- *      P-wave modulus ($\lambda + 2\mu$).
- *  u :
- *      Shear modulus ($\mu$).
- *  uipjp, ujpkp, uipkp :
- *      Shifts of the shear modulus due to the staggered grid.
- *  taus, tausipjp, tausjpkp, tausipkp, taup, eta :
+ *  vp :
+ *      Update coefficients computed from the material and relaxation
+ *      parameters, see `visco_coeff`.
+ *  eta :
  *      Relaxation parameters.
  *  dv, dv_2, dv_3, dv_4 :
  *      Derivatives of the velocity on time steps nt, nt-1, nt-2, and nt-3,
@@ -40,10 +38,7 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
         Velocity *v,
         Tensor3d *s,
         Tensor3d *r,
-        float ***pi, float ***u,
-		float ***uipjp, float ***ujpkp, float ***uipkp,
-        float ***taus, float ***tausipjp, float ***tausjpkp,
-		float ***tausipkp, float ***taup, float *eta,
+        ViscoPar *vp, float *eta,
         VelocityDerivativesTensor *dv,
         VelocityDerivativesTensor *dv_2,
         VelocityDerivativesTensor *dv_3,
@@ -52,11 +47,196 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
         Tensor3d *r_3,
         Tensor3d *r_4) {
 
-    extern float DT, DX, DY, DZ;
-    extern int L, MYID, FDORDER,FDORDER_TIME, LOG, FDCOEFF;
+    extern int MYID, LOG;
     extern FILE *FP;
     extern int OUTNTIMESTEPINFO;
 
+    double time=0.0, time1=0.0, time2=0.0;
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
+
+    update_s_kernel(nx1, nx2, ny1, ny2, nz1, nz2, v, s, r, vp, eta,
+            dv, dv_2, dv_3, dv_4, r_2, r_3, r_4);
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0){
+			time2=MPI_Wtime();
+			time=time2-time1;
+			fprintf(FP," Real time for stress tensor update: \t\t %4.2f s.\n",time);
+		}
+	return time;
+
+}
+
+
+/*
+ * Viscoelastic stress update for FDORDER_TIME=2 with `nb` = FDORDER/2
+ * coefficients `b` per direction (one relaxation mechanism, see
+ * update_s_kernel), instantiated for each order in FD_ORDER_LIST (see
+ * stencil.h).  The material coefficients of `vp` contain DT, so the FD
+ * coefficients are never folded.
+ */
+FD_INLINE void update_s_fd2(int nb,
+        int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, Tensor3d *r, ViscoPar *vp, float *eta, const float *b) {
+
+    extern float DT, DX, DY, DZ;
+
+    const float *bx = FD_BX(b), *by = FD_BY(b), *bz = FD_BZ(b);
+    const float dthalbe = DT/2.0;
+    /* only one relaxation mechanism (l=1) */
+    const float bl = 1.0/(1.0+(eta[1]*0.5));
+    const float cl = 1.0-(eta[1]*0.5);
+
+    float ***vx = v->x, ***vy = v->y, ***vz = v->z;
+
+    const ptrdiff_t si = vx[1][2] - vx[1][1];
+    const ptrdiff_t sj = vx[2][1] - vx[1][1];
+    int i, j, k;
+    float vxx,vxy,vxz,vyx,vyy,vyz,vzx,vzy,vzz;
+    float vxyyx_T2,vyzzy_T2,vxzzx_T2,vxxyyzz_T2,vyyzz_T2,vxxzz_T2,vxxyy_T2;
+    float g,f,e,d;
+
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, d, e, f, g, vxx, vxxyy_T2, vxxyyzz_T2, vxxzz_T2, vxy, vxyyx_T2, vxz, vxzzx_T2, vyx, vyy, vyyzz_T2, vyz, vyzzy_T2, vzx, vzy, vzz)
+#endif
+    for (j=ny1;j<=ny2;j++){
+        for (i=nx1;i<=nx2;i++){
+            float *restrict sxx_ji = s->xx[j][i], *restrict syy_ji = s->yy[j][i], *restrict szz_ji = s->zz[j][i];
+            float *restrict sxy_ji = s->xy[j][i], *restrict syz_ji = s->yz[j][i], *restrict sxz_ji = s->xz[j][i];
+            float *restrict rxx_ji = r->xx[j][i], *restrict ryy_ji = r->yy[j][i], *restrict rzz_ji = r->zz[j][i];
+            float *restrict rxy_ji = r->xy[j][i], *restrict ryz_ji = r->yz[j][i], *restrict rxz_ji = r->xz[j][i];
+            const float *restrict vx_ji = vx[j][i], *restrict vy_ji = vy[j][i], *restrict vz_ji = vz[j][i];
+            const float *restrict fipjp_ji = vp->fipjp[j][i], *restrict fjpkp_ji = vp->fjpkp[j][i], *restrict fipkp_ji = vp->fipkp[j][i];
+            const float *restrict dipjp_ji = vp->dipjp[j][i], *restrict djpkp_ji = vp->djpkp[j][i], *restrict dipkp_ji = vp->dipkp[j][i];
+            const float *restrict g_ji = vp->g[j][i], *restrict f_ji = vp->f[j][i];
+            const float *restrict d_ji = vp->d[j][i], *restrict e_ji = vp->e[j][i];
+
+            for (k=nz1;k<=nz2;k++){
+
+                /* spatial derivatives of the components of the velocities
+                 are computed */
+                vxx = fd_bwd(vx_ji, k, si, nb, bx)/DX;
+                vxy = fd_fwd(vx_ji, k, sj, nb, by)/DY;
+                vxz = fd_fwd(vx_ji, k, 1, nb, bz)/DZ;
+                vyx = fd_fwd(vy_ji, k, si, nb, bx)/DX;
+                vyy = fd_bwd(vy_ji, k, sj, nb, by)/DY;
+                vyz = fd_fwd(vy_ji, k, 1, nb, bz)/DZ;
+                vzx = fd_fwd(vz_ji, k, si, nb, bx)/DX;
+                vzy = fd_fwd(vz_ji, k, sj, nb, by)/DY;
+                vzz = fd_bwd(vz_ji, k, 1, nb, bz)/DZ;
+
+                /* updating components of the stress tensor, partially,
+                 with the old memory variables */
+                g=g_ji[k];
+                f=f_ji[k];
+
+                vxyyx_T2=vxy+vyx;
+                vyzzy_T2=vyz+vzy;
+                vxzzx_T2=vxz+vzx;
+                vxxyyzz_T2=vxx+vyy+vzz;
+                vyyzz_T2=vyy+vzz;
+                vxxzz_T2=vxx+vzz;
+                vxxyy_T2=vxx+vyy;
+
+                sxy_ji[k]+=(fipjp_ji[k]*vxyyx_T2)+(dthalbe*rxy_ji[k]);
+                syz_ji[k]+=(fjpkp_ji[k]*vyzzy_T2)+(dthalbe*ryz_ji[k]);
+                sxz_ji[k]+=(fipkp_ji[k]*vxzzx_T2)+(dthalbe*rxz_ji[k]);
+                sxx_ji[k]+=DT*((g*vxxyyzz_T2)-(f*vyyzz_T2))+(dthalbe*rxx_ji[k]);
+                syy_ji[k]+=DT*((g*vxxyyzz_T2)-(f*vxxzz_T2))+(dthalbe*ryy_ji[k]);
+                szz_ji[k]+=DT*((g*vxxyyzz_T2)-(f*vxxyy_T2))+(dthalbe*rzz_ji[k]);
+
+                /* update the memory-variables */
+                d=d_ji[k];
+                e=e_ji[k];
+                rxy_ji[k]=bl*(rxy_ji[k]*cl-(dipjp_ji[k]*vxyyx_T2));
+                ryz_ji[k]=bl*(ryz_ji[k]*cl-(djpkp_ji[k]*vyzzy_T2));
+                rxz_ji[k]=bl*(rxz_ji[k]*cl-(dipkp_ji[k]*vxzzx_T2));
+                rxx_ji[k]=bl*(rxx_ji[k]*cl-(e*vxxyyzz_T2)+(d*vyyzz_T2));
+                ryy_ji[k]=bl*(ryy_ji[k]*cl-(e*vxxyyzz_T2)+(d*vxxzz_T2));
+                rzz_ji[k]=bl*(rzz_ji[k]*cl-(e*vxxyyzz_T2)+(d*vxxyy_T2));
+
+                /* and now the components of the stress tensor are
+                 completely updated */
+                sxy_ji[k]+=(dthalbe*rxy_ji[k]);
+                syz_ji[k]+=(dthalbe*ryz_ji[k]);
+                sxz_ji[k]+=(dthalbe*rxz_ji[k]);
+                sxx_ji[k]+=(dthalbe*rxx_ji[k]);
+                syy_ji[k]+=(dthalbe*ryy_ji[k]);
+                szz_ji[k]+=(dthalbe*rzz_ji[k]);
+            }
+        }
+    }
+}
+
+typedef void (*UpdateSKernel)(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, Tensor3d *r, ViscoPar *vp, float *eta, const float *b);
+
+#define UPDATE_S_FD2(ORDER) \
+static void update_s_fd2_##ORDER(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, \
+        Velocity *v, Tensor3d *s, Tensor3d *r, ViscoPar *vp, float *eta, const float *b) { \
+    update_s_fd2(ORDER / 2, nx1, nx2, ny1, ny2, nz1, nz2, v, s, r, vp, eta, b); \
+}
+FD_ORDER_LIST(UPDATE_S_FD2)
+
+/* kernel for FDORDER_TIME=2 and its FD coefficients, see update_s_kernel_ini */
+static UpdateSKernel update_s_fd2_kernel = NULL;
+static float update_s_fd2_b[3 * FD_MAX_NB];
+
+/*
+ * Select the kernel of `update_s_kernel` for FDORDER and FDORDER_TIME.
+ * Must be called once after the parameters are read.
+ */
+void update_s_kernel_ini(void) {
+
+    extern int FDORDER, FDORDER_TIME, FDCOEFF;
+
+    update_s_fd2_kernel = NULL;
+    if (FDORDER_TIME == 2) {
+        switch (FDORDER) {
+#define UPDATE_S_FD2_CASE(ORDER) case ORDER: update_s_fd2_kernel = update_s_fd2_##ORDER; break;
+            FD_ORDER_LIST(UPDATE_S_FD2_CASE)
+#undef UPDATE_S_FD2_CASE
+        }
+    }
+    if (update_s_fd2_kernel)
+        fd_coeff_fold(FDORDER, FDCOEFF, 0, update_s_fd2_b);
+}
+
+
+/*
+ * Finite-difference part of `update_s` for the grid points
+ * [nx1...nx2][ny1...ny2][nz1...nz2].  Velocities up to FDORDER/2 points
+ * outside of this range are read, so disjoint boxes of the local grid may be
+ * updated independently of each other and in any order.
+ */
+void update_s_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v,
+        Tensor3d *s,
+        Tensor3d *r,
+        ViscoPar *vp, float *eta,
+        VelocityDerivativesTensor *dv,
+        VelocityDerivativesTensor *dv_2,
+        VelocityDerivativesTensor *dv_3,
+        VelocityDerivativesTensor *dv_4,
+        Tensor3d *r_2,
+        Tensor3d *r_3,
+        Tensor3d *r_4) {
+
+    /* update boxes larger than a tile tile by tile (see tile.c) */
+    int t[6];
+    if (tile_first(nx1, nx2, ny1, ny2, nz1, nz2, t)) {
+        do
+            update_s_kernel(t[0], t[1], t[2], t[3], t[4], t[5], v, s, r, vp, eta,
+                    dv, dv_2, dv_3, dv_4, r_2, r_3, r_4);
+        while (tile_next(nx1, nx2, ny1, ny2, nz1, nz2, t));
+        return;
+    }
+
+    extern float DT, DX, DY, DZ;
+    extern int FDORDER,FDORDER_TIME, FDCOEFF;
+
     float ***vx = v->x;
     float ***vy = v->y;
     float ***vz = v->z;
@@ -129,7 +309,6 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
     float ***rxz_4 = r_4->xz;
 
     int i, j, k, l=1;
-    double time=0.0, time1=0.0, time2=0.0;
     float vxx,vxy,vxz,vyx,vyy,vyz,vzx,vzy,vzz;
     float b,c,e,g,d,f,fipjp,fjpkp,fipkp,dipjp,djpkp,dipkp;
 
@@ -143,505 +322,47 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
     float **vxyyx_j_2,**vyzzy_j_2,**vxzzx_j_2,**vxxyyzz_j_2,**vyyzz_j_2,**vxxzz_j_2,**vxxyy_j_2;
     float **vxyyx_j_3,**vyzzy_j_3,**vxzzx_j_3,**vxxyyzz_j_3,**vyyzz_j_3,**vxxzz_j_3,**vxxyy_j_3;
     float **vxyyx_j_4,**vyzzy_j_4,**vxzzx_j_4,**vxxyyzz_j_4,**vyyzz_j_4,**vxxzz_j_4,**vxxyy_j_4;
-    float *vxyyx_j_i,*vyzzy_j_i,*vxzzx_j_i,*vxxyyzz_j_i,*vyyzz_j_i,*vxxzz_j_i,*vxxyy_j_i;
-    float *vxyyx_j_i_2,*vyzzy_j_i_2,*vxzzx_j_i_2,*vxxyyzz_j_i_2,*vyyzz_j_i_2,*vxxzz_j_i_2,*vxxyy_j_i_2;
-    float *vxyyx_j_i_3,*vyzzy_j_i_3,*vxzzx_j_i_3,*vxxyyzz_j_i_3,*vyyzz_j_i_3,*vxxzz_j_i_3,*vxxyy_j_i_3;
-    float *vxyyx_j_i_4,*vyzzy_j_i_4,*vxzzx_j_i_4,*vxxyyzz_j_i_4,*vyyzz_j_i_4,*vxxzz_j_i_4,*vxxyy_j_i_4;
-    
-    float **rxx_j,**ryy_j,**rzz_j,**rxy_j,**ryz_j,**rxz_j;
-    float **rxx_j_2,**ryy_j_2,**rzz_j_2,**rxy_j_2,**ryz_j_2,**rxz_j_2;
-    float **rxx_j_3,**ryy_j_3,**rzz_j_3,**rxy_j_3,**ryz_j_3,**rxz_j_3;
-    float **rxx_j_4,**ryy_j_4,**rzz_j_4,**rxy_j_4,**ryz_j_4,**rxz_j_4;
-    
-    float *rxx_j_i,*ryy_j_i,*rzz_j_i,*rxy_j_i,*ryz_j_i,*rxz_j_i;
-    float *rxx_j_i_2,*ryy_j_i_2,*rzz_j_i_2,*rxy_j_i_2,*ryz_j_i_2,*rxz_j_i_2;
-    float *rxx_j_i_3,*ryy_j_i_3,*rzz_j_i_3,*rxy_j_i_3,*ryz_j_i_3,*rxz_j_i_3;
-    float *rxx_j_i_4,*ryy_j_i_4,*rzz_j_i_4,*rxy_j_i_4,*ryz_j_i_4,*rxz_j_i_4;
-    
-	float sumrxy,sumryz,sumrxz,sumrxx,sumryy,sumrzz;
-	float b1, b2, b3, b4, b5, b6, dthalbe;
-
-	dthalbe = DT/2.0;
-
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
-
-    
-    
-    switch (FDORDER_TIME) {
-            
-        case 2:
-            switch (FDORDER){
-                    
-                case 2 :
-                    
-                    
-                    
-                    for (j=ny1;j<=ny2;j++){
-                        for (i=nx1;i<=nx2;i++){
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                /* spatial derivatives of the components of the velocities
-                                 are computed */
-                                
-                                vxx = (vx[j][i][k]-vx[j][i-1][k])/DX;
-                                vxy = (vx[j+1][i][k]-vx[j][i][k])/DY;
-                                vxz = (vx[j][i][k+1]-vx[j][i][k])/DZ;
-                                vyx = (vy[j][i+1][k]-vy[j][i][k])/DX;
-                                vyy = (vy[j][i][k]-vy[j-1][i][k])/DY;
-                                vyz = (vy[j][i][k+1]-vy[j][i][k])/DZ;
-                                vzx = (vz[j][i+1][k]-vz[j][i][k])/DX;
-                                vzy = (vz[j+1][i][k]-vz[j][i][k])/DY;
-                                vzz = (vz[j][i][k]-vz[j][i][k-1])/DZ;
-                                
-                                
-                                /* computing sums of the old memory variables in this version only one mechanism is possi
-                                 ble */
-                                
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
-                                
-                                vxyyx_T2=vxy+vyx;
-                                vyzzy_T2=vyz+vzy;
-                                vxzzx_T2=vxz+vzx;
-                                vxxyyzz_T2=vxx+vyy+vzz;
-                                vyyzz_T2=vyy+vzz;
-                                vxxzz_T2=vxx+vzz;
-                                vxxyy_T2=vxx+vyy;
-                                
-                                sxy[j][i][k]+=(fipjp*vxyyx_T2)+(dthalbe*sumrxy);
-                                syz[j][i][k]+=(fjpkp*vyzzy_T2)+(dthalbe*sumryz);
-                                sxz[j][i][k]+=(fipkp*vxzzx_T2)+(dthalbe*sumrxz);
-                                sxx[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vyyzz_T2))+(dthalbe*sumrxx);
-                                syy[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxzz_T2))+(dthalbe*sumryy);
-                                szz[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxyy_T2))+(dthalbe*sumrzz);
-                                
-                                /* in the case of L=1 update
-                                 the memory-variables without suming*/
-                                l=1;
-                                b=1.0/(1.0+(eta[l]*0.5));
-                                c=1.0-(eta[l]*0.5);
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
-                                rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx_T2));
-                                ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy_T2));
-                                rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx_T2));
-                                rxx[j][i][k]=b*(rxx[j][i][k]*c-(e*vxxyyzz_T2)+(d*vyyzz_T2));
-                                ryy[j][i][k]=b*(ryy[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxzz_T2));
-                                rzz[j][i][k]=b*(rzz[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxyy_T2));
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                
-                                /* and now the components of the stress tensor are
-                                 completely updated */
-                                sxy[j][i][k]+=(dthalbe*sumrxy);
-                                syz[j][i][k]+=(dthalbe*sumryz);
-                                sxz[j][i][k]+=(dthalbe*sumrxz);
-                                sxx[j][i][k]+=(dthalbe*sumrxx);
-                                syy[j][i][k]+=(dthalbe*sumryy);
-                                szz[j][i][k]+=(dthalbe*sumrzz);
-                                
-                                
-                                
-                                
-                                
-                                
-                            }
-                        }
-                    }
-                    break;
-                    
-                case 4 :
-                    
-                    b1=9.0/8.0; b2=-1.0/24.0; /* Taylor coefficients */
-                    if(FDCOEFF==2){
-                        b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
-                    
-                    for (j=ny1;j<=ny2;j++){
-                        for (i=nx1;i<=nx2;i++){
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                /* spatial derivatives of the components of the velocities
-                                 are computed */
-                                
-                                vxx = (b1*(vx[j][i][k]-vx[j][i-1][k])+b2*(vx[j][i+1][k]-vx[j][i-2][k]))/DX;
-                                vxy = (b1*(vx[j+1][i][k]-vx[j][i][k])+b2*(vx[j+2][i][k]-vx[j-1][i][k]))/DY;
-                                vxz = (b1*(vx[j][i][k+1]-vx[j][i][k])+b2*(vx[j][i][k+2]-vx[j][i][k-1]))/DZ;
-                                vyx = (b1*(vy[j][i+1][k]-vy[j][i][k])+b2*(vy[j][i+2][k]-vy[j][i-1][k]))/DX;
-                                vyy = (b1*(vy[j][i][k]-vy[j-1][i][k])+b2*(vy[j+1][i][k]-vy[j-2][i][k]))/DY;
-                                vyz = (b1*(vy[j][i][k+1]-vy[j][i][k])+b2*(vy[j][i][k+2]-vy[j][i][k-1]))/DZ;
-                                vzx = (b1*(vz[j][i+1][k]-vz[j][i][k])+b2*(vz[j][i+2][k]-vz[j][i-1][k]))/DX;
-                                vzy = (b1*(vz[j+1][i][k]-vz[j][i][k])+b2*(vz[j+2][i][k]-vz[j-1][i][k]))/DY;
-                                vzz = (b1*(vz[j][i][k]-vz[j][i][k-1])+b2*(vz[j][i][k+1]-vz[j][i][k-2]))/DZ;
-                                
-                                
-                                /* computing sums of the old memory variables in this version only one mechanism is possi
-                                 ble */
-                                
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
-                                
-                                
-                                vxyyx_T2=vxy+vyx;
-                                vyzzy_T2=vyz+vzy;
-                                vxzzx_T2=vxz+vzx;
-                                vxxyyzz_T2=vxx+vyy+vzz;
-                                vyyzz_T2=vyy+vzz;
-                                vxxzz_T2=vxx+vzz;
-                                vxxyy_T2=vxx+vyy;
-                                
-                                sxy[j][i][k]+=(fipjp*vxyyx_T2)+(dthalbe*sumrxy);
-                                syz[j][i][k]+=(fjpkp*vyzzy_T2)+(dthalbe*sumryz);
-                                sxz[j][i][k]+=(fipkp*vxzzx_T2)+(dthalbe*sumrxz);
-                                sxx[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vyyzz_T2))+(dthalbe*sumrxx);
-                                syy[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxzz_T2))+(dthalbe*sumryy);
-                                szz[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxyy_T2))+(dthalbe*sumrzz);
-                                
-                                /* in the case of L=1 update
-                                 the memory-variables without suming*/
-                                l=1;
-                                b=1.0/(1.0+(eta[l]*0.5));
-                                c=1.0-(eta[l]*0.5);
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
-                                rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx_T2));
-                                ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy_T2));
-                                rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx_T2));
-                                rxx[j][i][k]=b*(rxx[j][i][k]*c-(e*vxxyyzz_T2)+(d*vyyzz_T2));
-                                ryy[j][i][k]=b*(ryy[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxzz_T2));
-                                rzz[j][i][k]=b*(rzz[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxyy_T2));
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                
-                                /* and now the components of the stress tensor are
-                                 completely updated */
-                                sxy[j][i][k]+=(dthalbe*sumrxy);
-                                syz[j][i][k]+=(dthalbe*sumryz);
-                                sxz[j][i][k]+=(dthalbe*sumrxz);
-                                sxx[j][i][k]+=(dthalbe*sumrxx);
-                                syy[j][i][k]+=(dthalbe*sumryy);
-                                szz[j][i][k]+=(dthalbe*sumrzz);
-                                
-                                
-                                
-                                
-                            }
-                        }
-                    }
-                    break;
-                    
-                case 6 :
-                    
-                    b1=75.0/64.0; b2=-25.0/384.0; b3=3.0/640.0; /* Taylor coefficients */
-                    if(FDCOEFF==2){
-                        b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
-                    
-                    for (j=ny1;j<=ny2;j++){
-                        for (i=nx1;i<=nx2;i++){
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                /* spatial derivatives of the components of the velocities
-                                 are computed */
-                                
-                                vxx = (b1*(vx[j][i][k]-vx[j][i-1][k])+
-                                       b2*(vx[j][i+1][k]-vx[j][i-2][k])+
-                                       b3*(vx[j][i+2][k]-vx[j][i-3][k]))/DX;
-                                
-                                vxy = (b1*(vx[j+1][i][k]-vx[j][i][k])+
-                                       b2*(vx[j+2][i][k]-vx[j-1][i][k])+
-                                       b3*(vx[j+3][i][k]-vx[j-2][i][k]))/DY;
-                                
-                                vxz = (b1*(vx[j][i][k+1]-vx[j][i][k])+
-                                       b2*(vx[j][i][k+2]-vx[j][i][k-1])+
-                                       b3*(vx[j][i][k+3]-vx[j][i][k-2]))/DZ;
-                                
-                                vyx = (b1*(vy[j][i+1][k]-vy[j][i][k])+
-                                       b2*(vy[j][i+2][k]-vy[j][i-1][k])+
-                                       b3*(vy[j][i+3][k]-vy[j][i-2][k]))/DX;
-                                
-                                vyy = (b1*(vy[j][i][k]-vy[j-1][i][k])+
-                                       b2*(vy[j+1][i][k]-vy[j-2][i][k])+
-                                       b3*(vy[j+2][i][k]-vy[j-3][i][k]))/DY;
-                                
-                                vyz = (b1*(vy[j][i][k+1]-vy[j][i][k])+
-                                       b2*(vy[j][i][k+2]-vy[j][i][k-1])+
-                                       b3*(vy[j][i][k+3]-vy[j][i][k-2]))/DZ;
-                                
-                                vzx = (b1*(vz[j][i+1][k]-vz[j][i][k])+
-                                       b2*(vz[j][i+2][k]-vz[j][i-1][k])+
-                                       b3*(vz[j][i+3][k]-vz[j][i-2][k]))/DX;
-                                
-                                vzy = (b1*(vz[j+1][i][k]-vz[j][i][k])+
-                                       b2*(vz[j+2][i][k]-vz[j-1][i][k])+
-                                       b3*(vz[j+3][i][k]-vz[j-2][i][k]))/DY;
-                                
-                                vzz = (b1*(vz[j][i][k]-vz[j][i][k-1])+
-                                       b2*(vz[j][i][k+1]-vz[j][i][k-2])+
-                                       b3*(vz[j][i][k+2]-vz[j][i][k-3]))/DZ;
-                                
-                                
-                                /* computing sums of the old memory variables in this version only one mechanism is possi
-                                 ble */
-                                
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
-                                
-                                
-                                vxyyx_T2=vxy+vyx;
-                                vyzzy_T2=vyz+vzy;
-                                vxzzx_T2=vxz+vzx;
-                                vxxyyzz_T2=vxx+vyy+vzz;
-                                vyyzz_T2=vyy+vzz;
-                                vxxzz_T2=vxx+vzz;
-                                vxxyy_T2=vxx+vyy;
-                                
-                                sxy[j][i][k]+=(fipjp*vxyyx_T2)+(dthalbe*sumrxy);
-                                syz[j][i][k]+=(fjpkp*vyzzy_T2)+(dthalbe*sumryz);
-                                sxz[j][i][k]+=(fipkp*vxzzx_T2)+(dthalbe*sumrxz);
-                                sxx[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vyyzz_T2))+(dthalbe*sumrxx);
-                                syy[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxzz_T2))+(dthalbe*sumryy);
-                                szz[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxyy_T2))+(dthalbe*sumrzz);
-                                
-                                /* in the case of L=1 update
-                                 the memory-variables without suming*/
-                                l=1;
-                                b=1.0/(1.0+(eta[l]*0.5));
-                                c=1.0-(eta[l]*0.5);
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
-                                rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx_T2));
-                                ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy_T2));
-                                rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx_T2));
-                                rxx[j][i][k]=b*(rxx[j][i][k]*c-(e*vxxyyzz_T2)+(d*vyyzz_T2));
-                                ryy[j][i][k]=b*(ryy[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxzz_T2));
-                                rzz[j][i][k]=b*(rzz[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxyy_T2));
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                
-                                /* and now the components of the stress tensor are
-                                 completely updated */
-                                sxy[j][i][k]+=(dthalbe*sumrxy);
-                                syz[j][i][k]+=(dthalbe*sumryz);
-                                sxz[j][i][k]+=(dthalbe*sumrxz);
-                                sxx[j][i][k]+=(dthalbe*sumrxx);
-                                syy[j][i][k]+=(dthalbe*sumryy);
-                                szz[j][i][k]+=(dthalbe*sumrzz);
-                                
-                                
-                                
-                                
-                                
-                            }
-                        }
-                    }
-                    break;
-                    
-                case 8 :
-                    
-                    b1=1225.0/1024.0; b2=-245.0/3072.0; b3=49.0/5120.0; b4=-5.0/7168.0; /* Taylor coefficients */
-                    if(FDCOEFF==2){
-                        b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
-                    
-                    for (j=ny1;j<=ny2;j++){
-                        for (i=nx1;i<=nx2;i++){
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                /* spatial derivatives of the components of the velocities
-                                 are computed */
-                                
-                                vxx = (b1*(vx[j][i][k]-vx[j][i-1][k])+
-                                       b2*(vx[j][i+1][k]-vx[j][i-2][k])+
-                                       b3*(vx[j][i+2][k]-vx[j][i-3][k])+
-                                       b4*(vx[j][i+3][k]-vx[j][i-4][k]))/DX;
-                                
-                                vxy = (b1*(vx[j+1][i][k]-vx[j][i][k])+
-                                       b2*(vx[j+2][i][k]-vx[j-1][i][k])+
-                                       b3*(vx[j+3][i][k]-vx[j-2][i][k])+
-                                       b4*(vx[j+4][i][k]-vx[j-3][i][k]))/DY;
-                                
-                                vxz = (b1*(vx[j][i][k+1]-vx[j][i][k])+
-                                       b2*(vx[j][i][k+2]-vx[j][i][k-1])+
-                                       b3*(vx[j][i][k+3]-vx[j][i][k-2])+
-                                       b4*(vx[j][i][k+4]-vx[j][i][k-3]))/DZ;
-                                
-                                vyx = (b1*(vy[j][i+1][k]-vy[j][i][k])+
-                                       b2*(vy[j][i+2][k]-vy[j][i-1][k])+
-                                       b3*(vy[j][i+3][k]-vy[j][i-2][k])+
-                                       b4*(vy[j][i+4][k]-vy[j][i-3][k]))/DX;
-                                
-                                vyy = (b1*(vy[j][i][k]-vy[j-1][i][k])+
-                                       b2*(vy[j+1][i][k]-vy[j-2][i][k])+
-                                       b3*(vy[j+2][i][k]-vy[j-3][i][k])+
-                                       b4*(vy[j+3][i][k]-vy[j-4][i][k]))/DY;
-                                
-                                vyz = (b1*(vy[j][i][k+1]-vy[j][i][k])+
-                                       b2*(vy[j][i][k+2]-vy[j][i][k-1])+
-                                       b3*(vy[j][i][k+3]-vy[j][i][k-2])+
-                                       b4*(vy[j][i][k+4]-vy[j][i][k-3]))/DZ;
-                                
-                                vzx = (b1*(vz[j][i+1][k]-vz[j][i][k])+
-                                       b2*(vz[j][i+2][k]-vz[j][i-1][k])+
-                                       b3*(vz[j][i+3][k]-vz[j][i-2][k])+
-                                       b4*(vz[j][i+4][k]-vz[j][i-3][k]))/DX;
-                                
-                                vzy = (b1*(vz[j+1][i][k]-vz[j][i][k])+
-                                       b2*(vz[j+2][i][k]-vz[j-1][i][k])+
-                                       b3*(vz[j+3][i][k]-vz[j-2][i][k])+
-                                       b4*(vz[j+4][i][k]-vz[j-3][i][k]))/DY;
-                                
-                                vzz = (b1*(vz[j][i][k]-vz[j][i][k-1])+
-                                       b2*(vz[j][i][k+1]-vz[j][i][k-2])+
-                                       b3*(vz[j][i][k+2]-vz[j][i][k-3])+
-                                       b4*(vz[j][i][k+3]-vz[j][i][k-4]))/DZ;
-                                
-                                
-                                /* computing sums of the old memory variables in this version only one mechanism is possi
-                                 ble */
-                                
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
-                                
-                                
-                                vxyyx_T2=vxy+vyx;
-                                vyzzy_T2=vyz+vzy;
-                                vxzzx_T2=vxz+vzx;
-                                vxxyyzz_T2=vxx+vyy+vzz;
-                                vyyzz_T2=vyy+vzz;
-                                vxxzz_T2=vxx+vzz;
-                                vxxyy_T2=vxx+vyy;
-                                
-                                sxy[j][i][k]+=(fipjp*vxyyx_T2)+(dthalbe*sumrxy);
-                                syz[j][i][k]+=(fjpkp*vyzzy_T2)+(dthalbe*sumryz);
-                                sxz[j][i][k]+=(fipkp*vxzzx_T2)+(dthalbe*sumrxz);
-                                sxx[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vyyzz_T2))+(dthalbe*sumrxx);
-                                syy[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxzz_T2))+(dthalbe*sumryy);
-                                szz[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxyy_T2))+(dthalbe*sumrzz);
-                                
-                                /* in the case of L=1 update
-                                 the memory-variables without suming*/
-                                l=1;
-                                b=1.0/(1.0+(eta[l]*0.5));
-                                c=1.0-(eta[l]*0.5);
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
-                                rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx_T2));
-                                ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy_T2));
-                                rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx_T2));
-                                rxx[j][i][k]=b*(rxx[j][i][k]*c-(e*vxxyyzz_T2)+(d*vyyzz_T2));
-                                ryy[j][i][k]=b*(ryy[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxzz_T2));
-                                rzz[j][i][k]=b*(rzz[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxyy_T2));
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                
-                                /* and now the components of the stress tensor are
-                                 completely updated */
-                                sxy[j][i][k]+=(dthalbe*sumrxy);
-                                syz[j][i][k]+=(dthalbe*sumryz);
-                                sxz[j][i][k]+=(dthalbe*sumrxz);
-                                sxx[j][i][k]+=(dthalbe*sumrxx);
-                                syy[j][i][k]+=(dthalbe*sumryy);
-                                szz[j][i][k]+=(dthalbe*sumrzz);
-                                
-                                
-                                
-                                
-                                
-                                
-                            }
-                        }
-                    }
-                    break;
+    float *vxyyx_j_i,*vyzzy_j_i,*vxzzx_j_i,*vxxyyzz_j_i,*vyyzz_j_i,*vxxzz_j_i,*vxxyy_j_i;
+    float *vxyyx_j_i_2,*vyzzy_j_i_2,*vxzzx_j_i_2,*vxxyyzz_j_i_2,*vyyzz_j_i_2,*vxxzz_j_i_2,*vxxyy_j_i_2;
+    float *vxyyx_j_i_3,*vyzzy_j_i_3,*vxzzx_j_i_3,*vxxyyzz_j_i_3,*vyyzz_j_i_3,*vxxzz_j_i_3,*vxxyy_j_i_3;
+    float *vxyyx_j_i_4,*vyzzy_j_i_4,*vxzzx_j_i_4,*vxxyyzz_j_i_4,*vyyzz_j_i_4,*vxxzz_j_i_4,*vxxyy_j_i_4;
+    
+    float **rxx_j,**ryy_j,**rzz_j,**rxy_j,**ryz_j,**rxz_j;
+    float **rxx_j_2,**ryy_j_2,**rzz_j_2,**rxy_j_2,**ryz_j_2,**rxz_j_2;
+    float **rxx_j_3,**ryy_j_3,**rzz_j_3,**rxy_j_3,**ryz_j_3,**rxz_j_3;
+    float **rxx_j_4,**ryy_j_4,**rzz_j_4,**rxy_j_4,**ryz_j_4,**rxz_j_4;
+    
+    float *rxx_j_i,*ryy_j_i,*rzz_j_i,*rxy_j_i,*ryz_j_i,*rxz_j_i;
+    float *rxx_j_i_2,*ryy_j_i_2,*rzz_j_i_2,*rxy_j_i_2,*ryz_j_i_2,*rxz_j_i_2;
+    float *rxx_j_i_3,*ryy_j_i_3,*rzz_j_i_3,*rxy_j_i_3,*ryz_j_i_3,*rxz_j_i_3;
+    float *rxx_j_i_4,*ryy_j_i_4,*rzz_j_i_4,*rxy_j_i_4,*ryz_j_i_4,*rxz_j_i_4;
+    
+	float sumrxy,sumryz,sumrxz,sumrxx,sumryy,sumrzz;
+	float b1, b2, b3, b4, b5, b6, dthalbe;
+
+	dthalbe = DT/2.0;
+
+    
+    
+    switch (FDORDER_TIME) {
+            
+        case 2:
+
+            /* FDORDER>2: kernel generated from stencil.h */
+            if (update_s_fd2_kernel) {
+                update_s_fd2_kernel(nx1, nx2, ny1, ny2, nz1, nz2, v, s, r, vp, eta, update_s_fd2_b);
+                break;
+            }
+
+            switch (FDORDER){
                     
-                case 10 :
+                case 2 :
                     
-                    b1=19845.0/16384.0; b2=-735.0/8192.0; b3=567.0/40960.0; b4=-405.0/229376.0; b5=35.0/294912.0; /* Taylor coefficients */
-                    if(FDCOEFF==2){
-                        b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
+                    
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, b, c, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vxx, vxxyy_T2, vxxyyzz_T2, vxxzz_T2, vxy, vxyyx_T2, vxz, vxzzx_T2, vyx, vyy, vyyzz_T2, vyz, vyzzy_T2, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         for (i=nx1;i<=nx2;i++){
                             for (k=nz1;k<=nz2;k++){
@@ -649,59 +370,15 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 /* spatial derivatives of the components of the velocities
                                  are computed */
                                 
-                                vxx = (b1*(vx[j][i][k]-vx[j][i-1][k])+
-                                       b2*(vx[j][i+1][k]-vx[j][i-2][k])+
-                                       b3*(vx[j][i+2][k]-vx[j][i-3][k])+
-                                       b4*(vx[j][i+3][k]-vx[j][i-4][k])+
-                                       b5*(vx[j][i+4][k]-vx[j][i-5][k]))/DX;
-                                
-                                vxy = (b1*(vx[j+1][i][k]-vx[j][i][k])+
-                                       b2*(vx[j+2][i][k]-vx[j-1][i][k])+
-                                       b3*(vx[j+3][i][k]-vx[j-2][i][k])+
-                                       b4*(vx[j+4][i][k]-vx[j-3][i][k])+
-                                       b5*(vx[j+5][i][k]-vx[j-4][i][k]))/DY;
-                                
-                                vxz = (b1*(vx[j][i][k+1]-vx[j][i][k])+
-                                       b2*(vx[j][i][k+2]-vx[j][i][k-1])+
-                                       b3*(vx[j][i][k+3]-vx[j][i][k-2])+
-                                       b4*(vx[j][i][k+4]-vx[j][i][k-3])+
-                                       b5*(vx[j][i][k+5]-vx[j][i][k-4]))/DZ;
-                                
-                                vyx = (b1*(vy[j][i+1][k]-vy[j][i][k])+
-                                       b2*(vy[j][i+2][k]-vy[j][i-1][k])+
-                                       b3*(vy[j][i+3][k]-vy[j][i-2][k])+
-                                       b4*(vy[j][i+4][k]-vy[j][i-3][k])+
-                                       b5*(vy[j][i+5][k]-vy[j][i-4][k]))/DX;
-                                
-                                vyy = (b1*(vy[j][i][k]-vy[j-1][i][k])+
-                                       b2*(vy[j+1][i][k]-vy[j-2][i][k])+
-                                       b3*(vy[j+2][i][k]-vy[j-3][i][k])+
-                                       b4*(vy[j+3][i][k]-vy[j-4][i][k])+
-                                       b5*(vy[j+4][i][k]-vy[j-5][i][k]))/DY;
-                                
-                                vyz = (b1*(vy[j][i][k+1]-vy[j][i][k])+
-                                       b2*(vy[j][i][k+2]-vy[j][i][k-1])+
-                                       b3*(vy[j][i][k+3]-vy[j][i][k-2])+
-                                       b4*(vy[j][i][k+4]-vy[j][i][k-3])+
-                                       b5*(vy[j][i][k+5]-vy[j][i][k-4]))/DZ;
-                                
-                                vzx = (b1*(vz[j][i+1][k]-vz[j][i][k])+
-                                       b2*(vz[j][i+2][k]-vz[j][i-1][k])+
-                                       b3*(vz[j][i+3][k]-vz[j][i-2][k])+
-                                       b4*(vz[j][i+4][k]-vz[j][i-3][k])+
-                                       b5*(vz[j][i+5][k]-vz[j][i-4][k]))/DX;
-                                
-                                vzy = (b1*(vz[j+1][i][k]-vz[j][i][k])+
-                                       b2*(vz[j+2][i][k]-vz[j-1][i][k])+
-                                       b3*(vz[j+3][i][k]-vz[j-2][i][k])+
-                                       b4*(vz[j+4][i][k]-vz[j-3][i][k])+
-                                       b5*(vz[j+5][i][k]-vz[j-4][i][k]))/DY;
-                                
-                                vzz = (b1*(vz[j][i][k]-vz[j][i][k-1])+
-                                       b2*(vz[j][i][k+1]-vz[j][i][k-2])+
-                                       b3*(vz[j][i][k+2]-vz[j][i][k-3])+
-                                       b4*(vz[j][i][k+3]-vz[j][i][k-4])+
-                                       b5*(vz[j][i][k+4]-vz[j][i][k-5]))/DZ;
+                                vxx = (vx[j][i][k]-vx[j][i-1][k])/DX;
+                                vxy = (vx[j+1][i][k]-vx[j][i][k])/DY;
+                                vxz = (vx[j][i][k+1]-vx[j][i][k])/DZ;
+                                vyx = (vy[j][i+1][k]-vy[j][i][k])/DX;
+                                vyy = (vy[j][i][k]-vy[j-1][i][k])/DY;
+                                vyz = (vy[j][i][k+1]-vy[j][i][k])/DZ;
+                                vzx = (vz[j][i+1][k]-vz[j][i][k])/DX;
+                                vzy = (vz[j+1][i][k]-vz[j][i][k])/DY;
+                                vzz = (vz[j][i][k]-vz[j][i][k-1])/DZ;
                                 
                                 
                                 /* computing sums of the old memory variables in this version only one mechanism is possi
@@ -716,12 +393,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
-                                
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 vxyyx_T2=vxy+vyx;
                                 vyzzy_T2=vyz+vzy;
@@ -743,11 +419,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 l=1;
                                 b=1.0/(1.0+(eta[l]*0.5));
                                 c=1.0-(eta[l]*0.5);
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx_T2));
                                 ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy_T2));
                                 rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx_T2));
@@ -782,164 +458,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     }
                     break;
                     
-                case 12 :
-                    
-                    /* Taylor coefficients */
-                    b1=160083.0/131072.0; b2=-12705.0/131072.0; b3=22869.0/1310720.0;
-                    b4=-5445.0/1835008.0; b5=847.0/2359296.0; b6=-63.0/2883584;
-                    
-                    /* Holberg coefficients E=0.1 %*/
-                    if(FDCOEFF==2){
-                        b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
-                    
-                    for (j=ny1;j<=ny2;j++){
-                        for (i=nx1;i<=nx2;i++){
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                /* spatial derivatives of the components of the velocities
-                                 are computed */
-                                
-                                vxx = (b1*(vx[j][i][k]-vx[j][i-1][k])+
-                                       b2*(vx[j][i+1][k]-vx[j][i-2][k])+
-                                       b3*(vx[j][i+2][k]-vx[j][i-3][k])+
-                                       b4*(vx[j][i+3][k]-vx[j][i-4][k])+
-                                       b5*(vx[j][i+4][k]-vx[j][i-5][k])+
-                                       b6*(vx[j][i+5][k]-vx[j][i-6][k]))/DX;
-                                
-                                vxy = (b1*(vx[j+1][i][k]-vx[j][i][k])+
-                                       b2*(vx[j+2][i][k]-vx[j-1][i][k])+
-                                       b3*(vx[j+3][i][k]-vx[j-2][i][k])+
-                                       b4*(vx[j+4][i][k]-vx[j-3][i][k])+
-                                       b5*(vx[j+5][i][k]-vx[j-4][i][k])+
-                                       b6*(vx[j+6][i][k]-vx[j-5][i][k]))/DY;
-                                
-                                vxz = (b1*(vx[j][i][k+1]-vx[j][i][k])+
-                                       b2*(vx[j][i][k+2]-vx[j][i][k-1])+
-                                       b3*(vx[j][i][k+3]-vx[j][i][k-2])+
-                                       b4*(vx[j][i][k+4]-vx[j][i][k-3])+
-                                       b5*(vx[j][i][k+5]-vx[j][i][k-4])+
-                                       b6*(vx[j][i][k+6]-vx[j][i][k-5]))/DZ;
-                                
-                                vyx = (b1*(vy[j][i+1][k]-vy[j][i][k])+
-                                       b2*(vy[j][i+2][k]-vy[j][i-1][k])+
-                                       b3*(vy[j][i+3][k]-vy[j][i-2][k])+
-                                       b4*(vy[j][i+4][k]-vy[j][i-3][k])+
-                                       b5*(vy[j][i+5][k]-vy[j][i-4][k])+
-                                       b6*(vy[j][i+6][k]-vy[j][i-5][k]))/DX;
-                                
-                                vyy = (b1*(vy[j][i][k]-vy[j-1][i][k])+
-                                       b2*(vy[j+1][i][k]-vy[j-2][i][k])+
-                                       b3*(vy[j+2][i][k]-vy[j-3][i][k])+
-                                       b4*(vy[j+3][i][k]-vy[j-4][i][k])+
-                                       b5*(vy[j+4][i][k]-vy[j-5][i][k])+
-                                       b6*(vy[j+5][i][k]-vy[j-6][i][k]))/DY;
-                                
-                                vyz = (b1*(vy[j][i][k+1]-vy[j][i][k])+
-                                       b2*(vy[j][i][k+2]-vy[j][i][k-1])+
-                                       b3*(vy[j][i][k+3]-vy[j][i][k-2])+
-                                       b4*(vy[j][i][k+4]-vy[j][i][k-3])+
-                                       b5*(vy[j][i][k+5]-vy[j][i][k-4])+
-                                       b6*(vy[j][i][k+6]-vy[j][i][k-5]))/DZ;
-                                
-                                vzx = (b1*(vz[j][i+1][k]-vz[j][i][k])+
-                                       b2*(vz[j][i+2][k]-vz[j][i-1][k])+
-                                       b3*(vz[j][i+3][k]-vz[j][i-2][k])+
-                                       b4*(vz[j][i+4][k]-vz[j][i-3][k])+
-                                       b5*(vz[j][i+5][k]-vz[j][i-4][k])+
-                                       b6*(vz[j][i+6][k]-vz[j][i-5][k]))/DX;
-                                
-                                vzy = (b1*(vz[j+1][i][k]-vz[j][i][k])+
-                                       b2*(vz[j+2][i][k]-vz[j-1][i][k])+
-                                       b3*(vz[j+3][i][k]-vz[j-2][i][k])+
-                                       b4*(vz[j+4][i][k]-vz[j-3][i][k])+
-                                       b5*(vz[j+5][i][k]-vz[j-4][i][k])+
-                                       b6*(vz[j+6][i][k]-vz[j-5][i][k]))/DY;
-                                
-                                vzz = (b1*(vz[j][i][k]-vz[j][i][k-1])+
-                                       b2*(vz[j][i][k+1]-vz[j][i][k-2])+
-                                       b3*(vz[j][i][k+2]-vz[j][i][k-3])+
-                                       b4*(vz[j][i][k+3]-vz[j][i][k-4])+
-                                       b5*(vz[j][i][k+4]-vz[j][i][k-5])+
-                                       b6*(vz[j][i][k+5]-vz[j][i][k-6]))/DZ;
-                                
-                                
-                                /* computing sums of the old memory variables in this version only one mechanism is possi
-                                 ble */
-                                
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
-                                
-                                
-                                vxyyx_T2=vxy+vyx;
-                                vyzzy_T2=vyz+vzy;
-                                vxzzx_T2=vxz+vzx;
-                                vxxyyzz_T2=vxx+vyy+vzz;
-                                vyyzz_T2=vyy+vzz;
-                                vxxzz_T2=vxx+vzz;
-                                vxxyy_T2=vxx+vyy;
-                                
-                                sxy[j][i][k]+=(fipjp*vxyyx_T2)+(dthalbe*sumrxy);
-                                syz[j][i][k]+=(fjpkp*vyzzy_T2)+(dthalbe*sumryz);
-                                sxz[j][i][k]+=(fipkp*vxzzx_T2)+(dthalbe*sumrxz);
-                                sxx[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vyyzz_T2))+(dthalbe*sumrxx);
-                                syy[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxzz_T2))+(dthalbe*sumryy);
-                                szz[j][i][k]+=DT*((g*vxxyyzz_T2)-(f*vxxyy_T2))+(dthalbe*sumrzz);
-                                
-                                /* in the case of L=1 update
-                                 the memory-variables without suming*/
-                                l=1;
-                                b=1.0/(1.0+(eta[l]*0.5));
-                                c=1.0-(eta[l]*0.5);
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
-                                rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx_T2));
-                                ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy_T2));
-                                rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx_T2));
-                                rxx[j][i][k]=b*(rxx[j][i][k]*c-(e*vxxyyzz_T2)+(d*vyyzz_T2));
-                                ryy[j][i][k]=b*(ryy[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxzz_T2));
-                                rzz[j][i][k]=b*(rzz[j][i][k]*c-(e*vxxyyzz_T2)+(d*vxxyy_T2));
-                                sumrxy=rxy[j][i][k];
-                                sumryz=ryz[j][i][k];
-                                sumrxz=rxz[j][i][k];
-                                sumrxx=rxx[j][i][k];
-                                sumryy=ryy[j][i][k];
-                                sumrzz=rzz[j][i][k];
-                                
-                                
-                                
-                                /* and now the components of the stress tensor are
-                                 completely updated */
-                                sxy[j][i][k]+=(dthalbe*sumrxy);
-                                syz[j][i][k]+=(dthalbe*sumryz);
-                                sxz[j][i][k]+=(dthalbe*sumrxz);
-                                sxx[j][i][k]+=(dthalbe*sumrxx);
-                                syy[j][i][k]+=(dthalbe*sumryy);
-                                szz[j][i][k]+=(dthalbe*sumrzz);
-                                
-                                
-                                
-                                
-                                
-                            }
-                        }
-                    }
+                default:
+                    err(" update_s_kernel: no kernel for this FDORDER ! ");
                     break;
-                    
             }
             break; /* Break FDORDER_TIME=2 */
             
@@ -949,6 +470,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     
                 case 2 :
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, rxx_j, rxx_j_2, rxx_j_3, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxy_j, rxy_j_2, rxy_j_3, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxz_j, rxz_j_2, rxz_j_3, rxz_j_i, rxz_j_i_2, rxz_j_i_3, ryy_j, ryy_j_2, ryy_j_3, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryz_j, ryz_j_2, ryz_j_3, ryz_j_i, ryz_j_i_2, ryz_j_i_3, rzz_j, rzz_j_2, rzz_j_3, rzz_j_i, rzz_j_i_2, rzz_j_i_3, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -991,11 +515,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -1031,11 +555,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n2=1.0-(c1*eta[l]*0.5);
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_3+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-(dipjp*vxyyx_T2));
@@ -1075,6 +599,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, rxx_j, rxx_j_2, rxx_j_3, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxy_j, rxy_j_2, rxy_j_3, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxz_j, rxz_j_2, rxz_j_3, rxz_j_i, rxz_j_i_2, rxz_j_i_3, ryy_j, ryy_j_2, ryy_j_3, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryz_j, ryz_j_2, ryz_j_3, ryz_j_i, ryz_j_i_2, ryz_j_i_3, rzz_j, rzz_j_2, rzz_j_3, rzz_j_i, rzz_j_i_2, rzz_j_i_3, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1119,11 +646,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -1159,11 +686,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n2=1.0-(c1*eta[l]*0.5);
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_3+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-(dipjp*vxyyx_T2));
@@ -1205,6 +732,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, rxx_j, rxx_j_2, rxx_j_3, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxy_j, rxy_j_2, rxy_j_3, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxz_j, rxz_j_2, rxz_j_3, rxz_j_i, rxz_j_i_2, rxz_j_i_3, ryy_j, ryy_j_2, ryy_j_3, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryz_j, ryz_j_2, ryz_j_3, ryz_j_i, ryz_j_i_2, ryz_j_i_3, rzz_j, rzz_j_2, rzz_j_3, rzz_j_i, rzz_j_i_2, rzz_j_i_3, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1275,11 +805,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -1315,11 +845,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n2=1.0-(c1*eta[l]*0.5);
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_3+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-(dipjp*vxyyx_T2));
@@ -1359,6 +889,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, rxx_j, rxx_j_2, rxx_j_3, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxy_j, rxy_j_2, rxy_j_3, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxz_j, rxz_j_2, rxz_j_3, rxz_j_i, rxz_j_i_2, rxz_j_i_3, ryy_j, ryy_j_2, ryy_j_3, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryz_j, ryz_j_2, ryz_j_3, ryz_j_i, ryz_j_i_2, ryz_j_i_3, rzz_j, rzz_j_2, rzz_j_3, rzz_j_i, rzz_j_i_2, rzz_j_i_3, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1437,11 +970,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -1477,11 +1010,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n2=1.0-(c1*eta[l]*0.5);
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_3+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-(dipjp*vxyyx_T2));
@@ -1523,6 +1056,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, rxx_j, rxx_j_2, rxx_j_3, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxy_j, rxy_j_2, rxy_j_3, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxz_j, rxz_j_2, rxz_j_3, rxz_j_i, rxz_j_i_2, rxz_j_i_3, ryy_j, ryy_j_2, ryy_j_3, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryz_j, ryz_j_2, ryz_j_3, ryz_j_i, ryz_j_i_2, ryz_j_i_3, rzz_j, rzz_j_2, rzz_j_3, rzz_j_i, rzz_j_i_2, rzz_j_i_3, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1611,11 +1147,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -1651,11 +1187,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n2=1.0-(c1*eta[l]*0.5);
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_3+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-(dipjp*vxyyx_T2));
@@ -1701,6 +1237,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, rxx_j, rxx_j_2, rxx_j_3, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxy_j, rxy_j_2, rxy_j_3, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxz_j, rxz_j_2, rxz_j_3, rxz_j_i, rxz_j_i_2, rxz_j_i_3, ryy_j, ryy_j_2, ryy_j_3, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryz_j, ryz_j_2, ryz_j_3, ryz_j_i, ryz_j_i_2, ryz_j_i_3, rzz_j, rzz_j_2, rzz_j_3, rzz_j_i, rzz_j_i_2, rzz_j_i_3, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1798,11 +1337,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -1838,11 +1377,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n2=1.0-(c1*eta[l]*0.5);
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_3+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-(dipjp*vxyyx_T2));
@@ -1886,6 +1425,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     
                 case 2 :
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, n5, rxx_j, rxx_j_2, rxx_j_3, rxx_j_4, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxx_j_i_4, rxy_j, rxy_j_2, rxy_j_3, rxy_j_4, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxy_j_i_4, rxz_j, rxz_j_2, rxz_j_3, rxz_j_4, rxz_j_i, rxz_j_i_2, rxz_j_i_3, rxz_j_i_4, ryy_j, ryy_j_2, ryy_j_3, ryy_j_4, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryy_j_i_4, ryz_j, ryz_j_2, ryz_j_3, ryz_j_4, ryz_j_i, ryz_j_i_2, ryz_j_i_3, ryz_j_i_4, rzz_j, rzz_j_2, rzz_j_3, rzz_j_4, rzz_j_i, rzz_j_i_2, rzz_j_i_3, rzz_j_i_4, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -1934,11 +1476,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k))+c4*(*(rzz_j_i_4+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -1975,11 +1517,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
                                 n5=c4*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_4+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-n5*((*(rxy_j_i_3+k))+(*(rxy_j_i_4+k)))-(dipjp*vxyyx_T2));
@@ -2019,6 +1561,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, n5, rxx_j, rxx_j_2, rxx_j_3, rxx_j_4, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxx_j_i_4, rxy_j, rxy_j_2, rxy_j_3, rxy_j_4, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxy_j_i_4, rxz_j, rxz_j_2, rxz_j_3, rxz_j_4, rxz_j_i, rxz_j_i_2, rxz_j_i_3, rxz_j_i_4, ryy_j, ryy_j_2, ryy_j_3, ryy_j_4, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryy_j_i_4, ryz_j, ryz_j_2, ryz_j_3, ryz_j_4, ryz_j_i, ryz_j_i_2, ryz_j_i_3, ryz_j_i_4, rzz_j, rzz_j_2, rzz_j_3, rzz_j_4, rzz_j_i, rzz_j_i_2, rzz_j_i_3, rzz_j_i_4, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2067,11 +1612,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k))+c4*(*(rzz_j_i_4+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -2108,11 +1653,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
                                 n5=c4*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_4+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-n5*((*(rxy_j_i_3+k))+(*(rxy_j_i_4+k)))-(dipjp*vxyyx_T2));
@@ -2155,6 +1700,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, n5, rxx_j, rxx_j_2, rxx_j_3, rxx_j_4, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxx_j_i_4, rxy_j, rxy_j_2, rxy_j_3, rxy_j_4, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxy_j_i_4, rxz_j, rxz_j_2, rxz_j_3, rxz_j_4, rxz_j_i, rxz_j_i_2, rxz_j_i_3, rxz_j_i_4, ryy_j, ryy_j_2, ryy_j_3, ryy_j_4, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryy_j_i_4, ryz_j, ryz_j_2, ryz_j_3, ryz_j_4, ryz_j_i, ryz_j_i_2, ryz_j_i_3, ryz_j_i_4, rzz_j, rzz_j_2, rzz_j_3, rzz_j_4, rzz_j_i, rzz_j_i_2, rzz_j_i_3, rzz_j_i_4, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2228,11 +1776,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k))+c4*(*(rzz_j_i_4+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -2269,11 +1817,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
                                 n5=c4*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_4+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-n5*((*(rxy_j_i_3+k))+(*(rxy_j_i_4+k)))-(dipjp*vxyyx_T2));
@@ -2314,6 +1862,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                     if(FDCOEFF==2){
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, n5, rxx_j, rxx_j_2, rxx_j_3, rxx_j_4, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxx_j_i_4, rxy_j, rxy_j_2, rxy_j_3, rxy_j_4, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxy_j_i_4, rxz_j, rxz_j_2, rxz_j_3, rxz_j_4, rxz_j_i, rxz_j_i_2, rxz_j_i_3, rxz_j_i_4, ryy_j, ryy_j_2, ryy_j_3, ryy_j_4, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryy_j_i_4, ryz_j, ryz_j_2, ryz_j_3, ryz_j_4, ryz_j_i, ryz_j_i_2, ryz_j_i_3, ryz_j_i_4, rzz_j, rzz_j_2, rzz_j_3, rzz_j_4, rzz_j_i, rzz_j_i_2, rzz_j_i_3, rzz_j_i_4, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2397,11 +1948,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k))+c4*(*(rzz_j_i_4+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -2438,11 +1989,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
                                 n5=c4*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_4+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-n5*((*(rxy_j_i_3+k))+(*(rxy_j_i_4+k)))-(dipjp*vxyyx_T2));
@@ -2485,6 +2036,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, n5, rxx_j, rxx_j_2, rxx_j_3, rxx_j_4, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxx_j_i_4, rxy_j, rxy_j_2, rxy_j_3, rxy_j_4, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxy_j_i_4, rxz_j, rxz_j_2, rxz_j_3, rxz_j_4, rxz_j_i, rxz_j_i_2, rxz_j_i_3, rxz_j_i_4, ryy_j, ryy_j_2, ryy_j_3, ryy_j_4, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryy_j_i_4, ryz_j, ryz_j_2, ryz_j_3, ryz_j_4, ryz_j_i, ryz_j_i_2, ryz_j_i_3, ryz_j_i_4, rzz_j, rzz_j_2, rzz_j_3, rzz_j_4, rzz_j_i, rzz_j_i_2, rzz_j_i_3, rzz_j_i_4, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2577,11 +2131,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k))+c4*(*(rzz_j_i_4+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -2618,11 +2172,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
                                 n5=c4*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_4+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-n5*((*(rxy_j_i_3+k))+(*(rxy_j_i_4+k)))-(dipjp*vxyyx_T2));
@@ -2668,6 +2222,9 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, n1, n2, n3, n4, n5, rxx_j, rxx_j_2, rxx_j_3, rxx_j_4, rxx_j_i, rxx_j_i_2, rxx_j_i_3, rxx_j_i_4, rxy_j, rxy_j_2, rxy_j_3, rxy_j_4, rxy_j_i, rxy_j_i_2, rxy_j_i_3, rxy_j_i_4, rxz_j, rxz_j_2, rxz_j_3, rxz_j_4, rxz_j_i, rxz_j_i_2, rxz_j_i_3, rxz_j_i_4, ryy_j, ryy_j_2, ryy_j_3, ryy_j_4, ryy_j_i, ryy_j_i_2, ryy_j_i_3, ryy_j_i_4, ryz_j, ryz_j_2, ryz_j_3, ryz_j_4, ryz_j_i, ryz_j_i_2, ryz_j_i_3, ryz_j_i_4, rzz_j, rzz_j_2, rzz_j_3, rzz_j_4, rzz_j_i, rzz_j_i_2, rzz_j_i_3, rzz_j_i_4, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vdiag, vxx, vxxyy_T2, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_T2, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_T2, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_T2, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_T2, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_T2, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         
                         rxx_j=*(rxx+j);ryy_j=*(ryy+j);rzz_j=*(rzz+j);rxy_j=*(rxy+j);ryz_j=*(ryz+j);rxz_j=*(rxz+j);
@@ -2769,11 +2326,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 sumrzz=c1*(*(rzz_j_i+k))+c2*(*(rzz_j_i_2+k))+c3*(*(rzz_j_i_3+k))+c4*(*(rzz_j_i_4+k));
                                 
                                 /* updating components of the stress tensor, partially */
-                                fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-                                fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-                                fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-                                g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-                                f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+                                fipjp=vp->fipjp[j][i][k];
+                                fjpkp=vp->fjpkp[j][i][k];
+                                fipkp=vp->fipkp[j][i][k];
+                                g=vp->g[j][i][k];
+                                f=vp->f[j][i][k];
                                 
                                 /* Save spatial derivations */
                                 *(vxyyx_j_i+k)=vxy+vyx;
@@ -2810,11 +2367,11 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
                                 n3=c2*eta[l]/2.0;
                                 n4=c3*eta[l]/2.0;
                                 n5=c4*eta[l]/2.0;
-                                dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-                                djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-                                dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-                                d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-                                e=pi[j][i][k]*eta[l]*taup[j][i][k];
+                                dipjp=vp->dipjp[j][i][k];
+                                djpkp=vp->djpkp[j][i][k];
+                                dipkp=vp->dipkp[j][i][k];
+                                d=vp->d[j][i][k];
+                                e=vp->e[j][i][k];
                                 
                                 
                                 *(rxy_j_i_4+k)=n1*((*(rxy_j_i+k))*n2-n3*((*(rxy_j_i+k))+(*(rxy_j_i_2+k)))-n4*((*(rxy_j_i_2+k))+(*(rxy_j_i_3+k)))-n5*((*(rxy_j_i_3+k))+(*(rxy_j_i_4+k)))-(dipjp*vxyyx_T2));
@@ -2852,15 +2409,4 @@ double update_s(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
             }
             break; /* Break FDORDER_TIME=4 */
     }
-    
-    
-
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0){
-			time2=MPI_Wtime();
-			time=time2-time1;
-			fprintf(FP," Real time for stress tensor update: \t\t %4.2f s.\n",time);
-		}
-	return time;
-
 }
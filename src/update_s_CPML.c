@@ -26,13 +26,9 @@
  *     Stress tensor.
  * r :
  *     Relaxation tensor.
- * pi :
- *     P-wave modulus ($\lambda + 2\mu$).
- * u :
- *     Shear modulus ($\mu$).
- * uipjp, ujpkp, uipkp :
- *     Shifted shear modulus due to the staggered grid.
- * taus, tausipjp, tausjpkp, tausipkp, taup, eta :
+ * vp :
+ *     Update coefficients of the viscoelastic medium, see `visco_coeff`.
+ * eta :
  *     Relaxation parameters.
  * K_x, a_x, b_x, K_x_half, a_x_half, b_x_half :
  *     Parameters of the Perfectly Matched Layer (PML) along x-axis.
@@ -57,9 +53,7 @@ double update_s_CPML(
         Velocity *v,
         Tensor3d *s,
         Tensor3d *r,
-        float ***pi, float ***u, float ***uipjp, float ***ujpkp, float ***uipkp,
-        float ***taus, float ***tausipjp, float ***tausjpkp,
-        float ***tausipkp, float ***taup, float *  eta,
+        ViscoPar *vp, float *  eta,
         float * K_x, float * a_x, float * b_x, float * K_x_half, float * a_x_half, float * b_x_half,
         float * K_y, float * a_y, float * b_y, float * K_y_half, float * a_y_half, float * b_y_half,
         float * K_z, float * a_z, float * b_z, float * K_z_half, float * a_z_half, float * b_z_half,
@@ -70,7 +64,7 @@ double update_s_CPML(
 
 
     extern float DT, DX, DY, DZ;
-    extern int L, MYID, LOG, FDCOEFF, FDORDER;
+    extern int MYID, LOG, FDCOEFF, FDORDER;
     extern FILE *FP;
     extern int FREE_SURF;
     extern int NPROCX, NPROCY, NPROCZ, POS[4];
@@ -145,6 +139,9 @@ double update_s_CPML(
 	}
 
 	if (POS[1]==0){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, b, c, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, h1, l, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vxx, vxxyy, vxxyyzz, vxxzz, vxy, vxyyx, vxz, vxzzx, vyx, vyy, vyyzz, vyz, vyzzy, vzx, vzy, vzz)
+#endif
 		for (j=1;j<=NY;j++){
 			for (i=1;i<=FW;i++){
 				for (k=1;k<=NZ;k++){
@@ -219,11 +216,11 @@ double update_s_CPML(
 
 
 					/* updating components of the stress tensor, partially */
-					fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-					fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-					fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-					g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-					f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+					fipjp=vp->fipjp[j][i][k];
+					fjpkp=vp->fjpkp[j][i][k];
+					fipkp=vp->fipkp[j][i][k];
+					g=vp->g[j][i][k];
+					f=vp->f[j][i][k];
 
 					vxyyx=vxy+vyx;
 					vyzzy=vyz+vzy;
@@ -245,11 +242,11 @@ double update_s_CPML(
 					l=1;
 					b=1.0/(1.0+(eta[l]*0.5));
 					c=1.0-(eta[l]*0.5);
-					dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-					djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-					dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-					d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-					e=pi[j][i][k]*eta[l]*taup[j][i][k];
+					dipjp=vp->dipjp[j][i][k];
+					djpkp=vp->djpkp[j][i][k];
+					dipkp=vp->dipkp[j][i][k];
+					d=vp->d[j][i][k];
+					e=vp->e[j][i][k];
 					rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx));
 					ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy));
 					rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx));
@@ -279,6 +276,9 @@ double update_s_CPML(
 	}
 
 	if(POS[1]==NPROCX-1){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, b, c, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, h1, l, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vxx, vxxyy, vxxyyzz, vxxzz, vxy, vxyyx, vxz, vxzzx, vyx, vyy, vyyzz, vyz, vyzzy, vzx, vzy, vzz)
+#endif
 		for (j=1;j<=NY;j++){
 			for (i=nx2+1;i<=nx2+FW;i++){
 				for (k=1;k<=NZ;k++){
@@ -358,11 +358,11 @@ double update_s_CPML(
 
 
 					/* updating components of the stress tensor, partially */
-					fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-					fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-					fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-					g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-					f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+					fipjp=vp->fipjp[j][i][k];
+					fjpkp=vp->fjpkp[j][i][k];
+					fipkp=vp->fipkp[j][i][k];
+					g=vp->g[j][i][k];
+					f=vp->f[j][i][k];
 
 					vxyyx=vxy+vyx;
 					vyzzy=vyz+vzy;
@@ -384,11 +384,11 @@ double update_s_CPML(
 					l=1;
 					b=1.0/(1.0+(eta[l]*0.5));
 					c=1.0-(eta[l]*0.5);
-					dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-					djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-					dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-					d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-					e=pi[j][i][k]*eta[l]*taup[j][i][k];
+					dipjp=vp->dipjp[j][i][k];
+					djpkp=vp->djpkp[j][i][k];
+					dipkp=vp->dipkp[j][i][k];
+					d=vp->d[j][i][k];
+					e=vp->e[j][i][k];
 					rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx));
 					ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy));
 					rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx));
@@ -418,6 +418,9 @@ double update_s_CPML(
 	}
 
 	if((POS[2]==0 && FREE_SURF==0)){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, b, c, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, h1, l, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vxx, vxxyy, vxxyyzz, vxxzz, vxy, vxyyx, vxz, vxzzx, vyx, vyy, vyyzz, vyz, vyzzy, vzx, vzy, vzz)
+#endif
 		for (j=1;j<=FW;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=1;k<=NZ;k++){
@@ -473,11 +476,11 @@ double update_s_CPML(
 
 
 					/* updating components of the stress tensor, partially */
-					fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-					fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-					fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-					g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-					f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+					fipjp=vp->fipjp[j][i][k];
+					fjpkp=vp->fjpkp[j][i][k];
+					fipkp=vp->fipkp[j][i][k];
+					g=vp->g[j][i][k];
+					f=vp->f[j][i][k];
 
 					vxyyx=vxy+vyx;
 					vyzzy=vyz+vzy;
@@ -499,11 +502,11 @@ double update_s_CPML(
 					l=1;
 					b=1.0/(1.0+(eta[l]*0.5));
 					c=1.0-(eta[l]*0.5);
-					dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-					djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-					dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-					d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-					e=pi[j][i][k]*eta[l]*taup[j][i][k];
+					dipjp=vp->dipjp[j][i][k];
+					djpkp=vp->djpkp[j][i][k];
+					dipkp=vp->dipkp[j][i][k];
+					d=vp->d[j][i][k];
+					e=vp->e[j][i][k];
 					rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx));
 					ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy));
 					rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx));
@@ -533,6 +536,9 @@ double update_s_CPML(
 	}
 
 	if(POS[2]==NPROCY-1){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, b, c, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, h1, l, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vxx, vxxyy, vxxyyzz, vxxzz, vxy, vxyyx, vxz, vxzzx, vyx, vyy, vyyzz, vyz, vyzzy, vzx, vzy, vzz)
+#endif
 		for (j=ny2+1;j<=ny2+FW;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=1;k<=NZ;k++){
@@ -589,11 +595,11 @@ double update_s_CPML(
 
 
 					/* updating components of the stress tensor, partially */
-					fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-					fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-					fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-					g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-					f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+					fipjp=vp->fipjp[j][i][k];
+					fjpkp=vp->fjpkp[j][i][k];
+					fipkp=vp->fipkp[j][i][k];
+					g=vp->g[j][i][k];
+					f=vp->f[j][i][k];
 
 					vxyyx=vxy+vyx;
 					vyzzy=vyz+vzy;
@@ -615,11 +621,11 @@ double update_s_CPML(
 					l=1;
 					b=1.0/(1.0+(eta[l]*0.5));
 					c=1.0-(eta[l]*0.5);
-					dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-					djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-					dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-					d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-					e=pi[j][i][k]*eta[l]*taup[j][i][k];
+					dipjp=vp->dipjp[j][i][k];
+					djpkp=vp->djpkp[j][i][k];
+					dipkp=vp->dipkp[j][i][k];
+					d=vp->d[j][i][k];
+					e=vp->e[j][i][k];
 					rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx));
 					ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy));
 					rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx));
@@ -651,6 +657,9 @@ double update_s_CPML(
 
 
 	if(POS[3]==0){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, b, c, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, l, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vxx, vxxyy, vxxyyzz, vxxzz, vxy, vxyyx, vxz, vxzzx, vyx, vyy, vyyzz, vyz, vyzzy, vzx, vzy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=1;k<=FW;k++){
@@ -685,11 +694,11 @@ double update_s_CPML(
 
 
 					/* updating components of the stress tensor, partially */
-					fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-					fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-					fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-					g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-					f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+					fipjp=vp->fipjp[j][i][k];
+					fjpkp=vp->fjpkp[j][i][k];
+					fipkp=vp->fipkp[j][i][k];
+					g=vp->g[j][i][k];
+					f=vp->f[j][i][k];
 
 					vxyyx=vxy+vyx;
 					vyzzy=vyz+vzy;
@@ -711,11 +720,11 @@ double update_s_CPML(
 					l=1;
 					b=1.0/(1.0+(eta[l]*0.5));
 					c=1.0-(eta[l]*0.5);
-					dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-					djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-					dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-					d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-					e=pi[j][i][k]*eta[l]*taup[j][i][k];
+					dipjp=vp->dipjp[j][i][k];
+					djpkp=vp->djpkp[j][i][k];
+					dipkp=vp->dipkp[j][i][k];
+					d=vp->d[j][i][k];
+					e=vp->e[j][i][k];
 					rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx));
 					ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy));
 					rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx));
@@ -746,6 +755,9 @@ double update_s_CPML(
 
 
 	if(POS[3]==NPROCZ-1){		
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, b, c, d, dipjp, dipkp, djpkp, e, f, fipjp, fipkp, fjpkp, g, h1, l, sumrxx, sumrxy, sumrxz, sumryy, sumryz, sumrzz, vxx, vxxyy, vxxyyzz, vxxzz, vxy, vxyyx, vxz, vxzzx, vyx, vyy, vyyzz, vyz, vyzzy, vzx, vzy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz2+1;k<=nz2+FW;k++){
@@ -783,11 +795,11 @@ double update_s_CPML(
 
 
 					/* updating components of the stress tensor, partially */
-					fipjp=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
-					fjpkp=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
-					fipkp=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
-					g=pi[j][i][k]*(1.0+L*taup[j][i][k]);
-					f=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+					fipjp=vp->fipjp[j][i][k];
+					fjpkp=vp->fjpkp[j][i][k];
+					fipkp=vp->fipkp[j][i][k];
+					g=vp->g[j][i][k];
+					f=vp->f[j][i][k];
 
 					vxyyx=vxy+vyx;
 					vyzzy=vyz+vzy;
@@ -809,11 +821,11 @@ double update_s_CPML(
 					l=1;
 					b=1.0/(1.0+(eta[l]*0.5));
 					c=1.0-(eta[l]*0.5);
-					dipjp=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
-					djpkp=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
-					dipkp=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
-					d=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
-					e=pi[j][i][k]*eta[l]*taup[j][i][k];
+					dipjp=vp->dipjp[j][i][k];
+					djpkp=vp->djpkp[j][i][k];
+					dipkp=vp->dipkp[j][i][k];
+					d=vp->d[j][i][k];
+					e=vp->e[j][i][k];
 					rxy[j][i][k]=b*(rxy[j][i][k]*c-(dipjp*vxyyx));
 					ryz[j][i][k]=b*(ryz[j][i][k]*c-(djpkp*vyzzy));
 					rxz[j][i][k]=b*(rxz[j][i][k]*c-(dipkp*vxzzx));
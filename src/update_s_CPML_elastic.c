@@ -87,6 +87,9 @@ double update_s_CPML_elastic(
 
 
 	if (POS[1]==0){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, e, h1, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent gang collapse(2)
@@ -173,6 +176,9 @@ double update_s_CPML_elastic(
 	}
 
 	if(POS[1]==NPROCX-1){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, e, h1, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel
 #pragma acc loop independent 
@@ -263,6 +269,9 @@ double update_s_CPML_elastic(
 	}
 
 	if((POS[2]==0 && FREE_SURF==0)){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, e, h1, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
@@ -327,6 +336,9 @@ double update_s_CPML_elastic(
 	}
 
 	if(POS[2]==NPROCY-1){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, e, h1, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
@@ -395,6 +407,9 @@ double update_s_CPML_elastic(
 
 
 	if(POS[3]==0){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, e, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
@@ -440,6 +455,9 @@ double update_s_CPML_elastic(
 
 
 	if(POS[3]==NPROCZ-1){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, e, h1, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
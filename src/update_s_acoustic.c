@@ -11,17 +11,26 @@
 #include "globvar.h"
 
 
-double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
+/*
+ * Finite-difference part of `update_s_acoustic` for the grid points
+ * [nx1...nx2][ny1...ny2][nz1...nz2].
+ */
+void update_s_acoustic_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		Velocity *v, float *** sxx, float ***  pi){
 
+	/* update boxes larger than a tile tile by tile (see tile.c) */
+	int t[6];
+	if (tile_first(nx1, nx2, ny1, ny2, nz1, nz2, t)) {
+		do
+			update_s_acoustic_kernel(t[0], t[1], t[2], t[3], t[4], t[5], v, sxx, pi);
+		while (tile_next(nx1, nx2, ny1, ny2, nz1, nz2, t));
+		return;
+	}
 
 	extern float DT, DX, DY, DZ;
-	extern int MYID, FDORDER, LOG, FDCOEFF;
-	extern FILE *FP;
-	extern int OUTNTIMESTEPINFO;
+	extern int FDORDER, FDCOEFF;
 
 	register int i, j, k;
-	double time=0.0, time1=0.0, time2=0.0;
 	register float vxx, vyy, vzz, dx, dy, dz;
 	register float b1, b2, b3, b4, b5, b6;
 	/*register float compx, compy, compz;*/
@@ -30,15 +39,15 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
         float ***vy = v->y;
         float ***vz = v->z;
 
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
-
 	switch (FDORDER){
 	case 2 :
 		dx=DT/DX;
 		dy=DT/DY;
 		dz=DT/DZ;
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -67,6 +76,9 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
 			b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -96,6 +108,9 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
 			b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -127,6 +142,9 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
 			b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -162,6 +180,9 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
 			b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -203,6 +224,9 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
 		if(FDCOEFF==2){
 			b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -239,6 +263,23 @@ double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, i
 		err(" error in particle velocity update: wrong FDORDER. ");
 		break;
 	} /* end of switch (FDORDER) */
+}
+
+
+double update_s_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, int nt,
+		Velocity *v, float *** sxx, float ***  pi){
+
+
+	extern int MYID, LOG;
+	extern FILE *FP;
+	extern int OUTNTIMESTEPINFO;
+
+	double time=0.0, time1=0.0, time2=0.0;
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
+
+	update_s_acoustic_kernel(nx1, nx2, ny1, ny2, nz1, nz2, v, sxx, pi);
 
 	if (LOG)
 		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0){
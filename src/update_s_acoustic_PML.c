@@ -42,6 +42,9 @@ double update_s_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 	case 2 :
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){				
@@ -84,6 +87,9 @@ double update_s_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 			b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, vxx, vyy, vzz)
+#endif
 			for (j=ny1;j<=ny2;j++){
 				for (i=nx1;i<=nx2;i++){
 					for (k=nz1;k<=nz2;k++){
@@ -127,6 +133,9 @@ double update_s_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 			b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -173,6 +182,9 @@ double update_s_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 			b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -223,6 +235,9 @@ double update_s_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 			b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -280,6 +295,9 @@ double update_s_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 		if(FDCOEFF==2){
 			b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, vxx, vyy, vzz)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
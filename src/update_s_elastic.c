@@ -9,6 +9,7 @@
 #include "data_structures.h"
 #include "fd.h"
 #include "globvar.h"
+#include "stencil.h"
 
 
 double update_s_elastic(
@@ -21,487 +22,276 @@ double update_s_elastic(
 		VelocityDerivativesTensor *dv_3,
 		VelocityDerivativesTensor *dv_4)
 {
-    extern float DT, DX, DY, DZ;
-    extern int MYID, FDORDER, FDORDER_TIME, LOG, FDCOEFF;
+    extern int MYID, LOG;
     extern FILE *FP;
     extern int OUTNTIMESTEPINFO;
 
-    float ***vx = v->x;
-    float ***vy = v->y;
-    float ***vz = v->z;
-
-    float ***sxx = s->xx;
-    float ***syy = s->yy;
-    float ***szz = s->zz;
-    float ***sxy = s->xy;
-    float ***syz = s->yz;
-    float ***sxz = s->xz;
-
-    float ***vxyyx = dv->xyyx;
-    float ***vyzzy = dv->yzzy;
-    float ***vxzzx = dv->xzzx;
-    float ***vxxyyzz = dv->xxyyzz;
-    float ***vyyzz = dv->yyzz;
-    float ***vxxzz = dv->xxzz;
-    float ***vxxyy = dv->xxyy;
-
-    float ***vxyyx_2 = dv_2->xyyx;
-    float ***vyzzy_2 = dv_2->yzzy;
-    float ***vxzzx_2 = dv_2->xzzx;
-    float ***vxxyyzz_2 = dv_2->xxyyzz;
-    float ***vyyzz_2 = dv_2->yyzz;
-    float ***vxxzz_2 = dv_2->xxzz;
-    float ***vxxyy_2 = dv_2->xxyy;
-
-    float ***vxyyx_3 = dv_3->xyyx;
-    float ***vyzzy_3 = dv_3->yzzy;
-    float ***vxzzx_3 = dv_3->xzzx;
-    float ***vxxyyzz_3 = dv_3->xxyyzz;
-    float ***vyyzz_3 = dv_3->yyzz;
-    float ***vxxzz_3 = dv_3->xxzz;
-    float ***vxxyy_3 = dv_3->xxyy;
-
-    float ***vxyyx_4 = dv_4->xyyx;
-    float ***vyzzy_4 = dv_4->yzzy;
-    float ***vxzzx_4 = dv_4->xzzx;
-    float ***vxxyyzz_4 = dv_4->xxyyzz;
-    float ***vyyzz_4 = dv_4->yyzz;
-    float ***vxxzz_4 = dv_4->xxzz;
-    float ***vxxyy_4 = dv_4->xxyy;
-
-    int i, j, k;
     double time = 0.0, time1 = 0.0, time2 = 0.0;
-    float vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
-    float g, f;
-    float c66ipjp, c44jpkp, c55ipkp;
-    float vdiag;
-    float b1, b2, b3, b4, b5, b6;
-    float c1, c2, c3, c4;               /* Coefficients for Adam Bashforth */
-
-    float **vxyyx_j, **vyzzy_j, **vxzzx_j, **vxxyyzz_j, **vyyzz_j, **vxxzz_j, **vxxyy_j;
-    float **vxyyx_j_2, **vyzzy_j_2, **vxzzx_j_2, **vxxyyzz_j_2, **vyyzz_j_2, **vxxzz_j_2, **vxxyy_j_2;
-    float **vxyyx_j_3, **vyzzy_j_3, **vxzzx_j_3, **vxxyyzz_j_3, **vyyzz_j_3, **vxxzz_j_3, **vxxyy_j_3;
-    float **vxyyx_j_4, **vyzzy_j_4, **vxzzx_j_4, **vxxyyzz_j_4, **vyyzz_j_4, **vxxzz_j_4, **vxxyy_j_4;
-    float *vxyyx_j_i, *vyzzy_j_i, *vxzzx_j_i, *vxxyyzz_j_i, *vyyzz_j_i, *vxxzz_j_i, *vxxyy_j_i;
-    float *vxyyx_j_i_2, *vyzzy_j_i_2, *vxzzx_j_i_2, *vxxyyzz_j_i_2, *vyyzz_j_i_2, *vxxzz_j_i_2, *vxxyy_j_i_2;
-    float *vxyyx_j_i_3, *vyzzy_j_i_3, *vxzzx_j_i_3, *vxxyyzz_j_i_3, *vyyzz_j_i_3, *vxxzz_j_i_3, *vxxyy_j_i_3;
-    float *vxyyx_j_i_4, *vyzzy_j_i_4, *vxzzx_j_i_4, *vxxyyzz_j_i_4, *vyyzz_j_i_4, *vxxzz_j_i_4, *vxxyy_j_i_4;
-
-    // `e` is a strain tensor at point (i, j, k).
-    Strain_ijk e;
 
     if (LOG)
         if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
             time1 = MPI_Wtime();
 
-    switch (FDORDER_TIME)
-    {
-        case 2:
+    update_s_elastic_kernel(nx1, nx2, ny1, ny2, nz1, nz2, v, s, pi, u, op,
+            dv, dv_2, dv_3, dv_4);
 
-            switch (FDORDER)
-            {
-                case 2:
+    if (LOG)
+        if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
+        {
+            time2 = MPI_Wtime();
+            time = time2 - time1;
+            fprintf(FP, " Real time for stress tensor update: \t\t %4.2f s.\n", time);
+        }
+    return time;
+}
 
-                    //#pragma acc data copyin(vx[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vy[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vz[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1])
-                    //#pragma acc data copyin (C11,C12,C13,C33,C22,C23,C66ipjp,C44jpkp,C55ipkp)
-                    //#pragma acc data copyout(sxy,syz,sxz,sxx,syy,szz)
+/*
+ * Stress update for FDORDER_TIME=2 with `nb` = FDORDER/2 coefficients `b`
+ * per direction, folded with DT and the grid spacing if `fold` is set,
+ * instantiated for each order in FD_ORDER_LIST (see stencil.h).
+ */
+FD_INLINE void update_s_elastic_fd2(int nb, int fold,
+        int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, OrthoPar *op, const float *b)
+{
+    extern float DT, DX, DY, DZ;
 
-#ifdef _OPENACC
-#pragma acc parallel
-#pragma acc loop independent
-#endif
-                    for (j = ny1; j <= ny2; j++)
-                    {
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                        for (i = nx1; i <= nx2; i++)
-                        {
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                            for (k = nz1; k <= nz2; k++)
-                            {
-                                compute_vel_deriv_2nd_order(v, i, j, k, &e);
-                                update_s_ijk_2nd_order(op, &e, i, j, k, s);
-                            }
-                        }
-                    }
-                    break;
+    const float *bx = FD_BX(b), *by = FD_BY(b), *bz = FD_BZ(b);
+    const float dt = fold ? 1.0f : DT;
 
-                case 4:
+    float ***vx = v->x, ***vy = v->y, ***vz = v->z;
+    float ***sxx = s->xx, ***syy = s->yy, ***szz = s->zz;
+    float ***sxy = s->xy, ***syz = s->yz, ***sxz = s->xz;
 
-                    b1 = 9.0 / 8.0;
-                    b2 = -1.0 / 24.0; /* Taylor coefficients */
-                    if (FDCOEFF == 2)
-                    {
-                        b1 = 1.1382;
-                        b2 = -0.046414;
-                    } /* Holberg coefficients E=0.1 %*/
+    const ptrdiff_t si = vx[1][2] - vx[1][1];
+    const ptrdiff_t sj = vx[2][1] - vx[1][1];
+    int i, j, k;
+    float vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
+    Strain_ijk e;
 
-//#pragma acc data copyin(vx[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vy[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vz[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1])
-#ifdef _OPENACC
-#pragma acc parallel
-#pragma acc loop independent collapse(3)
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, e, vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz)
 #endif
-                    for (j = ny1; j <= ny2; j++)
-                    {
-                        //#pragma acc loop independent
-                        for (i = nx1; i <= nx2; i++)
-                        {
-                            //#pragma acc loop independent
-                            for (k = nz1; k <= nz2; k++)
-                            {
-                                /* spatial derivatives of the components of the velocities
-                         are computed */
-
-                                vxx = (b1 * (vx[j][i][k] - vx[j][i - 1][k]) + b2 * (vx[j][i + 1][k] - vx[j][i - 2][k])) / DX;
-                                vxy = (b1 * (vx[j + 1][i][k] - vx[j][i][k]) + b2 * (vx[j + 2][i][k] - vx[j - 1][i][k])) / DY;
-                                vxz = (b1 * (vx[j][i][k + 1] - vx[j][i][k]) + b2 * (vx[j][i][k + 2] - vx[j][i][k - 1])) / DZ;
-                                vyx = (b1 * (vy[j][i + 1][k] - vy[j][i][k]) + b2 * (vy[j][i + 2][k] - vy[j][i - 1][k])) / DX;
-                                vyy = (b1 * (vy[j][i][k] - vy[j - 1][i][k]) + b2 * (vy[j + 1][i][k] - vy[j - 2][i][k])) / DY;
-                                vyz = (b1 * (vy[j][i][k + 1] - vy[j][i][k]) + b2 * (vy[j][i][k + 2] - vy[j][i][k - 1])) / DZ;
-                                vzx = (b1 * (vz[j][i + 1][k] - vz[j][i][k]) + b2 * (vz[j][i + 2][k] - vz[j][i - 1][k])) / DX;
-                                vzy = (b1 * (vz[j + 1][i][k] - vz[j][i][k]) + b2 * (vz[j + 2][i][k] - vz[j - 1][i][k])) / DY;
-                                vzz = (b1 * (vz[j][i][k] - vz[j][i][k - 1]) + b2 * (vz[j][i][k + 1] - vz[j][i][k - 2])) / DZ;
-
-                                e.xx = vxx;
-                                e.yy = vyy;
-                                e.zz = vzz;
-                                e.xy = vxy + vyx;
-                                e.yz = vyz + vzy;
-                                e.xz = vxz + vzx;
-
-                                update_s_ijk_2nd_order(op, &e, i, j, k, s);
-                            }
-                        }
-                    }
-                    //#pragma acc end parallel
-                    break;
-
-                case 6:
-
-                    b1 = 75.0 / 64.0;
-                    b2 = -25.0 / 384.0;
-                    b3 = 3.0 / 640.0; /* Taylor coefficients */
-                    if (FDCOEFF == 2)
-                    {
-                        b1 = 1.1965;
-                        b2 = -0.078804;
-                        b3 = 0.0081781;
-                    } /* Holberg coefficients E=0.1 %*/
-
 #ifdef _OPENACC
 #pragma acc parallel
-#pragma acc loop independent
-#endif
-                    for (j = ny1; j <= ny2; j++)
-                    {
-#ifdef _OPENACC
-#pragma acc loop independent
+#pragma acc loop independent collapse(2)
 #endif
-                        for (i = nx1; i <= nx2; i++)
-                        {
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                            for (k = nz1; k <= nz2; k++)
-                            {
-                                /* spatial derivatives of the components of the velocities
-                         are computed */
-
-                                vxx = (b1 * (vx[j][i][k] - vx[j][i - 1][k]) +
-                                       b2 * (vx[j][i + 1][k] - vx[j][i - 2][k]) +
-                                       b3 * (vx[j][i + 2][k] - vx[j][i - 3][k])) /
-                                      DX;
-
-                                vxy = (b1 * (vx[j + 1][i][k] - vx[j][i][k]) +
-                                       b2 * (vx[j + 2][i][k] - vx[j - 1][i][k]) +
-                                       b3 * (vx[j + 3][i][k] - vx[j - 2][i][k])) /
-                                      DY;
-
-                                vxz = (b1 * (vx[j][i][k + 1] - vx[j][i][k]) +
-                                       b2 * (vx[j][i][k + 2] - vx[j][i][k - 1]) +
-                                       b3 * (vx[j][i][k + 3] - vx[j][i][k - 2])) /
-                                      DZ;
-
-                                vyx = (b1 * (vy[j][i + 1][k] - vy[j][i][k]) +
-                                       b2 * (vy[j][i + 2][k] - vy[j][i - 1][k]) +
-                                       b3 * (vy[j][i + 3][k] - vy[j][i - 2][k])) /
-                                      DX;
-
-                                vyy = (b1 * (vy[j][i][k] - vy[j - 1][i][k]) +
-                                       b2 * (vy[j + 1][i][k] - vy[j - 2][i][k]) +
-                                       b3 * (vy[j + 2][i][k] - vy[j - 3][i][k])) /
-                                      DY;
-
-                                vyz = (b1 * (vy[j][i][k + 1] - vy[j][i][k]) +
-                                       b2 * (vy[j][i][k + 2] - vy[j][i][k - 1]) +
-                                       b3 * (vy[j][i][k + 3] - vy[j][i][k - 2])) /
-                                      DZ;
-
-                                vzx = (b1 * (vz[j][i + 1][k] - vz[j][i][k]) +
-                                       b2 * (vz[j][i + 2][k] - vz[j][i - 1][k]) +
-                                       b3 * (vz[j][i + 3][k] - vz[j][i - 2][k])) /
-                                      DX;
-
-                                vzy = (b1 * (vz[j + 1][i][k] - vz[j][i][k]) +
-                                       b2 * (vz[j + 2][i][k] - vz[j - 1][i][k]) +
-                                       b3 * (vz[j + 3][i][k] - vz[j - 2][i][k])) /
-                                      DY;
-
-                                vzz = (b1 * (vz[j][i][k] - vz[j][i][k - 1]) +
-                                       b2 * (vz[j][i][k + 1] - vz[j][i][k - 2]) +
-                                       b3 * (vz[j][i][k + 2] - vz[j][i][k - 3])) /
-                                      DZ;
-
-                                e.xx = vxx;
-                                e.yy = vyy;
-                                e.zz = vzz;
-                                e.xy = vxy + vyx;
-                                e.yz = vyz + vzy;
-                                e.xz = vxz + vzx;
-
-                                update_s_ijk_2nd_order(op, &e, i, j, k, s);
-                            }
-                        }
-                    }
-                    break;
-
-                case 8:
-
-                    b1 = 1225.0 / 1024.0;
-                    b2 = -245.0 / 3072.0;
-                    b3 = 49.0 / 5120.0;
-                    b4 = -5.0 / 7168.0; /* Taylor coefficients */
-                    if (FDCOEFF == 2)
-                    {
-                        b1 = 1.2257;
-                        b2 = -0.099537;
-                        b3 = 0.018063;
-                        b4 = -0.0026274;
-                    } /* Holberg coefficients E=0.1 %*/
-
-#ifdef _OPENACC
-#pragma acc parallel
-#pragma acc loop independent
-#endif
-                    for (j = ny1; j <= ny2; j++)
-                    {
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                        for (k = nz1; k <= nz2; k++)
-                        {
+    for (j = ny1; j <= ny2; j++)
+    {
+        for (i = nx1; i <= nx2; i++)
+        {
+            float *restrict sxx_ji = sxx[j][i], *restrict syy_ji = syy[j][i], *restrict szz_ji = szz[j][i];
+            float *restrict sxy_ji = sxy[j][i], *restrict syz_ji = syz[j][i], *restrict sxz_ji = sxz[j][i];
+            const float *restrict vx_ji = vx[j][i], *restrict vy_ji = vy[j][i], *restrict vz_ji = vz[j][i];
+            const float *restrict C66ipjp_ji = op->C66ipjp[j][i], *restrict C44jpkp_ji = op->C44jpkp[j][i], *restrict C55ipkp_ji = op->C55ipkp[j][i];
+            const float *restrict C11_ji = op->C11[j][i], *restrict C12_ji = op->C12[j][i], *restrict C13_ji = op->C13[j][i];
+            const float *restrict C22_ji = op->C22[j][i], *restrict C23_ji = op->C23[j][i], *restrict C33_ji = op->C33[j][i];
 #ifdef _OPENACC
 #pragma acc loop independent
 #endif
-                            for (i = nx1; i <= nx2; i++)
-                            {
-                                /* spatial derivatives of the components of the velocities
-                         are computed */
-
-                                vxx = (b1 * (vx[j][i][k] - vx[j][i - 1][k]) +
-                                       b2 * (vx[j][i + 1][k] - vx[j][i - 2][k]) +
-                                       b3 * (vx[j][i + 2][k] - vx[j][i - 3][k]) +
-                                       b4 * (vx[j][i + 3][k] - vx[j][i - 4][k])) /
-                                      DX;
-
-                                vxy = (b1 * (vx[j + 1][i][k] - vx[j][i][k]) +
-                                       b2 * (vx[j + 2][i][k] - vx[j - 1][i][k]) +
-                                       b3 * (vx[j + 3][i][k] - vx[j - 2][i][k]) +
-                                       b4 * (vx[j + 4][i][k] - vx[j - 3][i][k])) /
-                                      DY;
-
-                                vxz = (b1 * (vx[j][i][k + 1] - vx[j][i][k]) +
-                                       b2 * (vx[j][i][k + 2] - vx[j][i][k - 1]) +
-                                       b3 * (vx[j][i][k + 3] - vx[j][i][k - 2]) +
-                                       b4 * (vx[j][i][k + 4] - vx[j][i][k - 3])) /
-                                      DZ;
-
-                                vyx = (b1 * (vy[j][i + 1][k] - vy[j][i][k]) +
-                                       b2 * (vy[j][i + 2][k] - vy[j][i - 1][k]) +
-                                       b3 * (vy[j][i + 3][k] - vy[j][i - 2][k]) +
-                                       b4 * (vy[j][i + 4][k] - vy[j][i - 3][k])) /
-                                      DX;
-
-                                vyy = (b1 * (vy[j][i][k] - vy[j - 1][i][k]) +
-                                       b2 * (vy[j + 1][i][k] - vy[j - 2][i][k]) +
-                                       b3 * (vy[j + 2][i][k] - vy[j - 3][i][k]) +
-                                       b4 * (vy[j + 3][i][k] - vy[j - 4][i][k])) /
-                                      DY;
-
-                                vyz = (b1 * (vy[j][i][k + 1] - vy[j][i][k]) +
-                                       b2 * (vy[j][i][k + 2] - vy[j][i][k - 1]) +
-                                       b3 * (vy[j][i][k + 3] - vy[j][i][k - 2]) +
-                                       b4 * (vy[j][i][k + 4] - vy[j][i][k - 3])) /
-                                      DZ;
-
-                                vzx = (b1 * (vz[j][i + 1][k] - vz[j][i][k]) +
-                                       b2 * (vz[j][i + 2][k] - vz[j][i - 1][k]) +
-                                       b3 * (vz[j][i + 3][k] - vz[j][i - 2][k]) +
-                                       b4 * (vz[j][i + 4][k] - vz[j][i - 3][k])) /
-                                      DX;
-
-                                vzy = (b1 * (vz[j + 1][i][k] - vz[j][i][k]) +
-                                       b2 * (vz[j + 2][i][k] - vz[j - 1][i][k]) +
-                                       b3 * (vz[j + 3][i][k] - vz[j - 2][i][k]) +
-                                       b4 * (vz[j + 4][i][k] - vz[j - 3][i][k])) /
-                                      DY;
-
-                                vzz = (b1 * (vz[j][i][k] - vz[j][i][k - 1]) +
-                                       b2 * (vz[j][i][k + 1] - vz[j][i][k - 2]) +
-                                       b3 * (vz[j][i][k + 2] - vz[j][i][k - 3]) +
-                                       b4 * (vz[j][i][k + 3] - vz[j][i][k - 4])) /
-                                      DZ;
-
-                                /* updating components of the stress tensor, partially */
-
-                                e.xx = vxx;
-                                e.yy = vyy;
-                                e.zz = vzz;
-                                e.xy = vxy + vyx;
-                                e.yz = vyz + vzy;
-                                e.xz = vxz + vzx;
-
-                                update_s_ijk_2nd_order(op, &e, i, j, k, s);
-                            }
-                        }
-                    }
-                    break;
-
-                case 10:
+            IVDEP
+            for (k = nz1; k <= nz2; k++)
+            {
+                /* spatial derivatives of the components of the velocities
+                   are computed */
+                vxx = fd_scale(fd_bwd(vx_ji, k, si, nb, bx), DX, fold);
+                vxy = fd_scale(fd_fwd(vx_ji, k, sj, nb, by), DY, fold);
+                vxz = fd_scale(fd_fwd(vx_ji, k, 1, nb, bz), DZ, fold);
+                vyx = fd_scale(fd_fwd(vy_ji, k, si, nb, bx), DX, fold);
+                vyy = fd_scale(fd_bwd(vy_ji, k, sj, nb, by), DY, fold);
+                vyz = fd_scale(fd_fwd(vy_ji, k, 1, nb, bz), DZ, fold);
+                vzx = fd_scale(fd_fwd(vz_ji, k, si, nb, bx), DX, fold);
+                vzy = fd_scale(fd_fwd(vz_ji, k, sj, nb, by), DY, fold);
+                vzz = fd_scale(fd_bwd(vz_ji, k, 1, nb, bz), DZ, fold);
+
+                e.xx = vxx;
+                e.yy = vyy;
+                e.zz = vzz;
+                e.xy = vxy + vyx;
+                e.yz = vyz + vzy;
+                e.xz = vxz + vzx;
+
+                sxy_ji[k] += dt * (C66ipjp_ji[k] * e.xy);
+                syz_ji[k] += dt * (C44jpkp_ji[k] * e.yz);
+                sxz_ji[k] += dt * (C55ipkp_ji[k] * e.xz);
+
+                sxx_ji[k] += dt * ((C11_ji[k] * e.xx) + (C12_ji[k] * e.yy) + (C13_ji[k] * e.zz));
+                syy_ji[k] += dt * ((C12_ji[k] * e.xx) + (C22_ji[k] * e.yy) + (C23_ji[k] * e.zz));
+                szz_ji[k] += dt * ((C13_ji[k] * e.xx) + (C23_ji[k] * e.yy) + (C33_ji[k] * e.zz));
+            }
+        }
+    }
+}
 
-                    b1 = 19845.0 / 16384.0;
-                    b2 = -735.0 / 8192.0;
-                    b3 = 567.0 / 40960.0;
-                    b4 = -405.0 / 229376.0;
-                    b5 = 35.0 / 294912.0; /* Taylor coefficients */
-                    if (FDCOEFF == 2)
-                    {
-                        b1 = 1.2415;
-                        b2 = -0.11231;
-                        b3 = 0.026191;
-                        b4 = -0.0064682;
-                        b5 = 0.001191;
-                    } /* Holberg coefficients E=0.1 %*/
+typedef void (*UpdateSElasticKernel)(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, OrthoPar *op, const float *b);
+
+#define UPDATE_S_ELASTIC_FD2(ORDER) \
+static void update_s_elastic_fd2_##ORDER(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, \
+        Velocity *v, Tensor3d *s, OrthoPar *op, const float *b) \
+{ \
+    update_s_elastic_fd2(ORDER / 2, 0, nx1, nx2, ny1, ny2, nz1, nz2, v, s, op, b); \
+} \
+static void update_s_elastic_fd2_fold_##ORDER(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, \
+        Velocity *v, Tensor3d *s, OrthoPar *op, const float *b) \
+{ \
+    update_s_elastic_fd2(ORDER / 2, 1, nx1, nx2, ny1, ny2, nz1, nz2, v, s, op, b); \
+}
+FD_ORDER_LIST(UPDATE_S_ELASTIC_FD2)
+
+/* kernel for FDORDER_TIME=2 and its FD coefficients, see update_s_elastic_kernel_ini */
+static UpdateSElasticKernel update_s_elastic_fd2_kernel = NULL;
+static float update_s_elastic_fd2_b[3 * FD_MAX_NB];
+
+/*
+ * Select the kernel of `update_s_elastic_kernel` for FDORDER and
+ * FDORDER_TIME, and the vectorized variant requested by SIMD_KERNEL (see
+ * update_s_elastic_simd.c).  With FOLD_COEFF=1, the kernels use FD
+ * coefficients folded with DT and the grid spacing.  Must be called once
+ * after the parameters are read.
+ */
+void update_s_elastic_kernel_ini(void)
+{
+    extern int FDORDER, FDORDER_TIME, FDCOEFF, SIMD_KERNEL, FOLD_COEFF;
 
-#ifdef _OPENACC
-#pragma acc parallel
-#pragma acc loop independent
-#endif
-                    for (j = ny1; j <= ny2; j++)
-                    {
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                        for (i = nx1; i <= nx2; i++)
-                        {
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                            for (k = nz1; k <= nz2; k++)
-                            {
-                                /* spatial derivatives of the components of the velocities
-                         are computed */
+    update_s_elastic_fd2_kernel = NULL;
+    if (FDORDER_TIME == 2)
+    {
+        switch (FDORDER)
+        {
+#define UPDATE_S_ELASTIC_FD2_CASE(ORDER) case ORDER: update_s_elastic_fd2_kernel = \
+            FOLD_COEFF ? update_s_elastic_fd2_fold_##ORDER : update_s_elastic_fd2_##ORDER; break;
+            FD_ORDER_LIST(UPDATE_S_ELASTIC_FD2_CASE)
+#undef UPDATE_S_ELASTIC_FD2_CASE
+        }
+    }
+    if (update_s_elastic_fd2_kernel)
+        fd_coeff_fold(FDORDER, FDCOEFF, FOLD_COEFF, update_s_elastic_fd2_b);
 
-                                vxx = (b1 * (vx[j][i][k] - vx[j][i - 1][k]) +
-                                       b2 * (vx[j][i + 1][k] - vx[j][i - 2][k]) +
-                                       b3 * (vx[j][i + 2][k] - vx[j][i - 3][k]) +
-                                       b4 * (vx[j][i + 3][k] - vx[j][i - 4][k]) +
-                                       b5 * (vx[j][i + 4][k] - vx[j][i - 5][k])) /
-                                      DX;
+    update_s_elastic_simd_ini(SIMD_KERNEL, update_s_elastic_fd2_kernel ? FDORDER : 0, FOLD_COEFF);
+}
 
-                                vxy = (b1 * (vx[j + 1][i][k] - vx[j][i][k]) +
-                                       b2 * (vx[j + 2][i][k] - vx[j - 1][i][k]) +
-                                       b3 * (vx[j + 3][i][k] - vx[j - 2][i][k]) +
-                                       b4 * (vx[j + 4][i][k] - vx[j - 3][i][k]) +
-                                       b5 * (vx[j + 5][i][k] - vx[j - 4][i][k])) /
-                                      DY;
+/*
+ * Finite-difference part of `update_s_elastic` for the grid points
+ * [nx1...nx2][ny1...ny2][nz1...nz2].  Velocities up to FDORDER/2 points
+ * outside of this range are read, so disjoint boxes of the local grid may be
+ * updated independently of each other and in any order.
+ */
+void update_s_elastic_kernel(
+		int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+		Velocity *v, Tensor3d *s,
+		float ***pi, float ***u,
+		OrthoPar *op,
+		VelocityDerivativesTensor *dv,
+		VelocityDerivativesTensor *dv_2,
+		VelocityDerivativesTensor *dv_3,
+		VelocityDerivativesTensor *dv_4)
+{
+    /* update boxes larger than a tile tile by tile (see tile.c) */
+    int t[6];
+    if (tile_first(nx1, nx2, ny1, ny2, nz1, nz2, t))
+    {
+        do
+            update_s_elastic_kernel(t[0], t[1], t[2], t[3], t[4], t[5], v, s, pi, u, op,
+                    dv, dv_2, dv_3, dv_4);
+        while (tile_next(nx1, nx2, ny1, ny2, nz1, nz2, t));
+        return;
+    }
 
-                                vxz = (b1 * (vx[j][i][k + 1] - vx[j][i][k]) +
-                                       b2 * (vx[j][i][k + 2] - vx[j][i][k - 1]) +
-                                       b3 * (vx[j][i][k + 3] - vx[j][i][k - 2]) +
-                                       b4 * (vx[j][i][k + 4] - vx[j][i][k - 3]) +
-                                       b5 * (vx[j][i][k + 5] - vx[j][i][k - 4])) /
-                                      DZ;
+    extern float DT, DX, DY, DZ;
+    extern int FDORDER, FDORDER_TIME, FDCOEFF;
 
-                                vyx = (b1 * (vy[j][i + 1][k] - vy[j][i][k]) +
-                                       b2 * (vy[j][i + 2][k] - vy[j][i - 1][k]) +
-                                       b3 * (vy[j][i + 3][k] - vy[j][i - 2][k]) +
-                                       b4 * (vy[j][i + 4][k] - vy[j][i - 3][k]) +
-                                       b5 * (vy[j][i + 5][k] - vy[j][i - 4][k])) /
-                                      DX;
+    float ***vx = v->x;
+    float ***vy = v->y;
+    float ***vz = v->z;
 
-                                vyy = (b1 * (vy[j][i][k] - vy[j - 1][i][k]) +
-                                       b2 * (vy[j + 1][i][k] - vy[j - 2][i][k]) +
-                                       b3 * (vy[j + 2][i][k] - vy[j - 3][i][k]) +
-                                       b4 * (vy[j + 3][i][k] - vy[j - 4][i][k]) +
-                                       b5 * (vy[j + 4][i][k] - vy[j - 5][i][k])) /
-                                      DY;
+    float ***sxx = s->xx;
+    float ***syy = s->yy;
+    float ***szz = s->zz;
+    float ***sxy = s->xy;
+    float ***syz = s->yz;
+    float ***sxz = s->xz;
 
-                                vyz = (b1 * (vy[j][i][k + 1] - vy[j][i][k]) +
-                                       b2 * (vy[j][i][k + 2] - vy[j][i][k - 1]) +
-                                       b3 * (vy[j][i][k + 3] - vy[j][i][k - 2]) +
-                                       b4 * (vy[j][i][k + 4] - vy[j][i][k - 3]) +
-                                       b5 * (vy[j][i][k + 5] - vy[j][i][k - 4])) /
-                                      DZ;
+    float ***vxyyx = dv->xyyx;
+    float ***vyzzy = dv->yzzy;
+    float ***vxzzx = dv->xzzx;
+    float ***vxxyyzz = dv->xxyyzz;
+    float ***vyyzz = dv->yyzz;
+    float ***vxxzz = dv->xxzz;
+    float ***vxxyy = dv->xxyy;
 
-                                vzx = (b1 * (vz[j][i + 1][k] - vz[j][i][k]) +
-                                       b2 * (vz[j][i + 2][k] - vz[j][i - 1][k]) +
-                                       b3 * (vz[j][i + 3][k] - vz[j][i - 2][k]) +
-                                       b4 * (vz[j][i + 4][k] - vz[j][i - 3][k]) +
-                                       b5 * (vz[j][i + 5][k] - vz[j][i - 4][k])) /
-                                      DX;
+    float ***vxyyx_2 = dv_2->xyyx;
+    float ***vyzzy_2 = dv_2->yzzy;
+    float ***vxzzx_2 = dv_2->xzzx;
+    float ***vxxyyzz_2 = dv_2->xxyyzz;
+    float ***vyyzz_2 = dv_2->yyzz;
+    float ***vxxzz_2 = dv_2->xxzz;
+    float ***vxxyy_2 = dv_2->xxyy;
 
-                                vzy = (b1 * (vz[j + 1][i][k] - vz[j][i][k]) +
-                                       b2 * (vz[j + 2][i][k] - vz[j - 1][i][k]) +
-                                       b3 * (vz[j + 3][i][k] - vz[j - 2][i][k]) +
-                                       b4 * (vz[j + 4][i][k] - vz[j - 3][i][k]) +
-                                       b5 * (vz[j + 5][i][k] - vz[j - 4][i][k])) /
-                                      DY;
+    float ***vxyyx_3 = dv_3->xyyx;
+    float ***vyzzy_3 = dv_3->yzzy;
+    float ***vxzzx_3 = dv_3->xzzx;
+    float ***vxxyyzz_3 = dv_3->xxyyzz;
+    float ***vyyzz_3 = dv_3->yyzz;
+    float ***vxxzz_3 = dv_3->xxzz;
+    float ***vxxyy_3 = dv_3->xxyy;
 
-                                vzz = (b1 * (vz[j][i][k] - vz[j][i][k - 1]) +
-                                       b2 * (vz[j][i][k + 1] - vz[j][i][k - 2]) +
-                                       b3 * (vz[j][i][k + 2] - vz[j][i][k - 3]) +
-                                       b4 * (vz[j][i][k + 3] - vz[j][i][k - 4]) +
-                                       b5 * (vz[j][i][k + 4] - vz[j][i][k - 5])) /
-                                      DZ;
+    float ***vxyyx_4 = dv_4->xyyx;
+    float ***vyzzy_4 = dv_4->yzzy;
+    float ***vxzzx_4 = dv_4->xzzx;
+    float ***vxxyyzz_4 = dv_4->xxyyzz;
+    float ***vyyzz_4 = dv_4->yyzz;
+    float ***vxxzz_4 = dv_4->xxzz;
+    float ***vxxyy_4 = dv_4->xxyy;
 
-                                e.xx = vxx;
-                                e.yy = vyy;
-                                e.zz = vzz;
-                                e.xy = vxy + vyx;
-                                e.yz = vyz + vzy;
-                                e.xz = vxz + vzx;
+    int i, j, k;
+    float vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
+    float g, f;
+    float c66ipjp, c44jpkp, c55ipkp;
+    float vdiag;
+    float b1, b2, b3, b4, b5, b6;
+    float c1, c2, c3, c4;               /* Coefficients for Adam Bashforth */
 
-                                update_s_ijk_2nd_order(op, &e, i, j, k, s);
-                            }
-                        }
-                    }
-                    break;
+    float **vxyyx_j, **vyzzy_j, **vxzzx_j, **vxxyyzz_j, **vyyzz_j, **vxxzz_j, **vxxyy_j;
+    float **vxyyx_j_2, **vyzzy_j_2, **vxzzx_j_2, **vxxyyzz_j_2, **vyyzz_j_2, **vxxzz_j_2, **vxxyy_j_2;
+    float **vxyyx_j_3, **vyzzy_j_3, **vxzzx_j_3, **vxxyyzz_j_3, **vyyzz_j_3, **vxxzz_j_3, **vxxyy_j_3;
+    float **vxyyx_j_4, **vyzzy_j_4, **vxzzx_j_4, **vxxyyzz_j_4, **vyyzz_j_4, **vxxzz_j_4, **vxxyy_j_4;
+    float *vxyyx_j_i, *vyzzy_j_i, *vxzzx_j_i, *vxxyyzz_j_i, *vyyzz_j_i, *vxxzz_j_i, *vxxyy_j_i;
+    float *vxyyx_j_i_2, *vyzzy_j_i_2, *vxzzx_j_i_2, *vxxyyzz_j_i_2, *vyyzz_j_i_2, *vxxzz_j_i_2, *vxxyy_j_i_2;
+    float *vxyyx_j_i_3, *vyzzy_j_i_3, *vxzzx_j_i_3, *vxxyyzz_j_i_3, *vyyzz_j_i_3, *vxxzz_j_i_3, *vxxyy_j_i_3;
+    float *vxyyx_j_i_4, *vyzzy_j_i_4, *vxzzx_j_i_4, *vxxyyzz_j_i_4, *vyyzz_j_i_4, *vxxzz_j_i_4, *vxxyy_j_i_4;
 
-                case 12:
+    // `e` is a strain tensor at point (i, j, k).
+    Strain_ijk e;
 
-                    /* Taylor coefficients */
-                    b1 = 160083.0 / 131072.0;
-                    b2 = -12705.0 / 131072.0;
-                    b3 = 22869.0 / 1310720.0;
-                    b4 = -5445.0 / 1835008.0;
-                    b5 = 847.0 / 2359296.0;
-                    b6 = -63.0 / 2883584;
+    /* Distances between neighbouring grid points in i- and j-direction,
+     * equal for all components of v and s (see f3tensor_aligned). */
+    const ptrdiff_t si = vx[1][2] - vx[1][1];
+    const ptrdiff_t sj = vx[2][1] - vx[1][1];
 
-                    /* Holberg coefficients E=0.1 %*/
-                    if (FDCOEFF == 2)
-                    {
-                        b1 = 1.2508;
-                        b2 = -0.12034;
-                        b3 = 0.032131;
-                        b4 = -0.010142;
-                        b5 = 0.0029857;
-                        b6 = -0.00066667;
-                    }
+    switch (FDORDER_TIME)
+    {
+        case 2:
+
+            /* FDORDER>2: vectorized kernel or kernel generated from stencil.h */
+            if (update_s_elastic_fd2_kernel)
+            {
+                if (!update_s_elastic_simd(nx1, nx2, ny1, ny2, nz1, nz2, v, s, op, update_s_elastic_fd2_b))
+                    update_s_elastic_fd2_kernel(nx1, nx2, ny1, ny2, nz1, nz2, v, s, op, update_s_elastic_fd2_b);
+                break;
+            }
+
+            switch (FDORDER)
+            {
+                case 2:
 
+                    //#pragma acc data copyin(vx[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vy[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1],vz[ny1-1:ny2+1][nx1-1:nx2+1][nz1-1:nz2+1])
+                    //#pragma acc data copyin (C11,C12,C13,C33,C22,C23,C66ipjp,C44jpkp,C55ipkp)
+                    //#pragma acc data copyout(sxy,syz,sxz,sxx,syy,szz)
+
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, e)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel
 #pragma acc loop independent
@@ -513,98 +303,40 @@ double update_s_elastic(
 #endif
                         for (i = nx1; i <= nx2; i++)
                         {
+                            float *restrict sxx_ji = sxx[j][i], *restrict syy_ji = syy[j][i], *restrict szz_ji = szz[j][i];
+                            float *restrict sxy_ji = sxy[j][i], *restrict syz_ji = syz[j][i], *restrict sxz_ji = sxz[j][i];
+                            const float *restrict vx_ji = vx[j][i], *restrict vy_ji = vy[j][i], *restrict vz_ji = vz[j][i];
+                            const float *restrict C66ipjp_ji = op->C66ipjp[j][i], *restrict C44jpkp_ji = op->C44jpkp[j][i], *restrict C55ipkp_ji = op->C55ipkp[j][i];
+                            const float *restrict C11_ji = op->C11[j][i], *restrict C12_ji = op->C12[j][i], *restrict C13_ji = op->C13[j][i];
+                            const float *restrict C22_ji = op->C22[j][i], *restrict C23_ji = op->C23[j][i], *restrict C33_ji = op->C33[j][i];
 #ifdef _OPENACC
 #pragma acc loop independent
 #endif
+                            IVDEP
                             for (k = nz1; k <= nz2; k++)
                             {
-                                /* spatial derivatives of the components of the velocities
-                         are computed */
-
-                                vxx = (b1 * (vx[j][i][k] - vx[j][i - 1][k]) +
-                                       b2 * (vx[j][i + 1][k] - vx[j][i - 2][k]) +
-                                       b3 * (vx[j][i + 2][k] - vx[j][i - 3][k]) +
-                                       b4 * (vx[j][i + 3][k] - vx[j][i - 4][k]) +
-                                       b5 * (vx[j][i + 4][k] - vx[j][i - 5][k]) +
-                                       b6 * (vx[j][i + 5][k] - vx[j][i - 6][k])) /
-                                      DX;
-
-                                vxy = (b1 * (vx[j + 1][i][k] - vx[j][i][k]) +
-                                       b2 * (vx[j + 2][i][k] - vx[j - 1][i][k]) +
-                                       b3 * (vx[j + 3][i][k] - vx[j - 2][i][k]) +
-                                       b4 * (vx[j + 4][i][k] - vx[j - 3][i][k]) +
-                                       b5 * (vx[j + 5][i][k] - vx[j - 4][i][k]) +
-                                       b6 * (vx[j + 6][i][k] - vx[j - 5][i][k])) /
-                                      DY;
-
-                                vxz = (b1 * (vx[j][i][k + 1] - vx[j][i][k]) +
-                                       b2 * (vx[j][i][k + 2] - vx[j][i][k - 1]) +
-                                       b3 * (vx[j][i][k + 3] - vx[j][i][k - 2]) +
-                                       b4 * (vx[j][i][k + 4] - vx[j][i][k - 3]) +
-                                       b5 * (vx[j][i][k + 5] - vx[j][i][k - 4]) +
-                                       b6 * (vx[j][i][k + 6] - vx[j][i][k - 5])) /
-                                      DZ;
-
-                                vyx = (b1 * (vy[j][i + 1][k] - vy[j][i][k]) +
-                                       b2 * (vy[j][i + 2][k] - vy[j][i - 1][k]) +
-                                       b3 * (vy[j][i + 3][k] - vy[j][i - 2][k]) +
-                                       b4 * (vy[j][i + 4][k] - vy[j][i - 3][k]) +
-                                       b5 * (vy[j][i + 5][k] - vy[j][i - 4][k]) +
-                                       b6 * (vy[j][i + 6][k] - vy[j][i - 5][k])) /
-                                      DX;
-
-                                vyy = (b1 * (vy[j][i][k] - vy[j - 1][i][k]) +
-                                       b2 * (vy[j + 1][i][k] - vy[j - 2][i][k]) +
-                                       b3 * (vy[j + 2][i][k] - vy[j - 3][i][k]) +
-                                       b4 * (vy[j + 3][i][k] - vy[j - 4][i][k]) +
-                                       b5 * (vy[j + 4][i][k] - vy[j - 5][i][k]) +
-                                       b6 * (vy[j + 5][i][k] - vy[j - 6][i][k])) /
-                                      DY;
-
-                                vyz = (b1 * (vy[j][i][k + 1] - vy[j][i][k]) +
-                                       b2 * (vy[j][i][k + 2] - vy[j][i][k - 1]) +
-                                       b3 * (vy[j][i][k + 3] - vy[j][i][k - 2]) +
-                                       b4 * (vy[j][i][k + 4] - vy[j][i][k - 3]) +
-                                       b5 * (vy[j][i][k + 5] - vy[j][i][k - 4]) +
-                                       b6 * (vy[j][i][k + 6] - vy[j][i][k - 5])) /
-                                      DZ;
-
-                                vzx = (b1 * (vz[j][i + 1][k] - vz[j][i][k]) +
-                                       b2 * (vz[j][i + 2][k] - vz[j][i - 1][k]) +
-                                       b3 * (vz[j][i + 3][k] - vz[j][i - 2][k]) +
-                                       b4 * (vz[j][i + 4][k] - vz[j][i - 3][k]) +
-                                       b5 * (vz[j][i + 5][k] - vz[j][i - 4][k]) +
-                                       b6 * (vz[j][i + 6][k] - vz[j][i - 5][k])) /
-                                      DX;
-
-                                vzy = (b1 * (vz[j + 1][i][k] - vz[j][i][k]) +
-                                       b2 * (vz[j + 2][i][k] - vz[j - 1][i][k]) +
-                                       b3 * (vz[j + 3][i][k] - vz[j - 2][i][k]) +
-                                       b4 * (vz[j + 4][i][k] - vz[j - 3][i][k]) +
-                                       b5 * (vz[j + 5][i][k] - vz[j - 4][i][k]) +
-                                       b6 * (vz[j + 6][i][k] - vz[j - 5][i][k])) /
-                                      DY;
-
-                                vzz = (b1 * (vz[j][i][k] - vz[j][i][k - 1]) +
-                                       b2 * (vz[j][i][k + 1] - vz[j][i][k - 2]) +
-                                       b3 * (vz[j][i][k + 2] - vz[j][i][k - 3]) +
-                                       b4 * (vz[j][i][k + 3] - vz[j][i][k - 4]) +
-                                       b5 * (vz[j][i][k + 4] - vz[j][i][k - 5]) +
-                                       b6 * (vz[j][i][k + 5] - vz[j][i][k - 6])) /
-                                      DZ;
-
-                                e.xx = vxx;
-                                e.yy = vyy;
-                                e.zz = vzz;
-                                e.xy = vxy + vyx;
-                                e.yz = vyz + vzy;
-                                e.xz = vxz + vzx;
-
-                                update_s_ijk_2nd_order(op, &e, i, j, k, s);
+                                e.xx = (vx_ji[k] - vx_ji[k-si]) / DX;
+                                e.xy = (vx_ji[k+sj] - vx_ji[k]) / DY + (vy_ji[k+si] - vy_ji[k]) / DX;
+                                e.xz = (vx_ji[k+1] - vx_ji[k]) / DZ + (vz_ji[k+si] - vz_ji[k]) / DX;
+                                e.yy = (vy_ji[k] - vy_ji[k-sj]) / DY;
+                                e.yz = (vy_ji[k+1] - vy_ji[k]) / DZ + (vz_ji[k+sj] - vz_ji[k]) / DY;
+                                e.zz = (vz_ji[k] - vz_ji[k-1]) / DZ;
+
+                                sxy_ji[k] += DT * (C66ipjp_ji[k] * e.xy);
+                                syz_ji[k] += DT * (C44jpkp_ji[k] * e.yz);
+                                sxz_ji[k] += DT * (C55ipkp_ji[k] * e.xz);
+
+                                sxx_ji[k] += DT * ((C11_ji[k] * e.xx) + (C12_ji[k] * e.yy) + (C13_ji[k] * e.zz));
+                                syy_ji[k] += DT * ((C12_ji[k] * e.xx) + (C22_ji[k] * e.yy) + (C23_ji[k] * e.zz));
+                                szz_ji[k] += DT * ((C13_ji[k] * e.xx) + (C23_ji[k] * e.yy) + (C33_ji[k] * e.zz));
                             }
                         }
                     }
                     break;
+
+                default:
+                    err(" update_s_elastic_kernel: no kernel for this FDORDER ! ");
+                    break;
             }
             break; /* break for FDORDER_TIME=2 */
 
@@ -618,6 +350,9 @@ double update_s_elastic(
             {
                 case 2:
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -718,6 +453,9 @@ double update_s_elastic(
                         b2 = -0.046414;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -820,6 +558,9 @@ double update_s_elastic(
                         b3 = 0.0081781;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -959,6 +700,9 @@ double update_s_elastic(
                         b4 = -0.0026274;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1110,6 +854,9 @@ double update_s_elastic(
                         b5 = 0.001191;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1274,6 +1021,9 @@ double update_s_elastic(
                         b6 = -0.00066667;
                     }
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1439,6 +1189,9 @@ double update_s_elastic(
             {
                 case 2:
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1551,6 +1304,9 @@ double update_s_elastic(
                         b2 = -0.046414;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1665,6 +1421,9 @@ double update_s_elastic(
                         b3 = 0.0081781;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1816,6 +1575,9 @@ double update_s_elastic(
                         b4 = -0.0026274;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -1979,6 +1741,9 @@ double update_s_elastic(
                         b5 = 0.001191;
                     } /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -2155,6 +1920,9 @@ double update_s_elastic(
                         b6 = -0.00066667;
                     }
 
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, c44jpkp, c55ipkp, c66ipjp, f, g, vdiag, vxx, vxxyy_j, vxxyy_j_2, vxxyy_j_3, vxxyy_j_4, vxxyy_j_i, vxxyy_j_i_2, vxxyy_j_i_3, vxxyy_j_i_4, vxxyyzz_j, vxxyyzz_j_2, vxxyyzz_j_3, vxxyyzz_j_4, vxxyyzz_j_i, vxxyyzz_j_i_2, vxxyyzz_j_i_3, vxxyyzz_j_i_4, vxxzz_j, vxxzz_j_2, vxxzz_j_3, vxxzz_j_4, vxxzz_j_i, vxxzz_j_i_2, vxxzz_j_i_3, vxxzz_j_i_4, vxy, vxyyx_j, vxyyx_j_2, vxyyx_j_3, vxyyx_j_4, vxyyx_j_i, vxyyx_j_i_2, vxyyx_j_i_3, vxyyx_j_i_4, vxz, vxzzx_j, vxzzx_j_2, vxzzx_j_3, vxzzx_j_4, vxzzx_j_i, vxzzx_j_i_2, vxzzx_j_i_3, vxzzx_j_i_4, vyx, vyy, vyyzz_j, vyyzz_j_2, vyyzz_j_3, vyyzz_j_4, vyyzz_j_i, vyyzz_j_i_2, vyyzz_j_i_3, vyyzz_j_i_4, vyz, vyzzy_j, vyzzy_j_2, vyzzy_j_3, vyzzy_j_4, vyzzy_j_i, vyzzy_j_i_2, vyzzy_j_i_3, vyzzy_j_i_4, vzx, vzy, vzz)
+#endif
                     for (j = ny1; j <= ny2; j++)
                     {
                         vxyyx_j = *(vxyyx + j);
@@ -2321,15 +2089,6 @@ double update_s_elastic(
             }
             break; /* break for FDORDER_TIME=4 */
     }
-
-    if (LOG)
-        if ((MYID == 0) && ((nt + (OUTNTIMESTEPINFO - 1)) % OUTNTIMESTEPINFO) == 0)
-        {
-            time2 = MPI_Wtime();
-            time = time2 - time1;
-            fprintf(FP, " Real time for stress tensor update: \t\t %4.2f s.\n", time);
-        }
-    return time;
 }
 
 inline void compute_vel_deriv_2nd_order(Velocity *v, int i, int j, int k, Strain_ijk *e)
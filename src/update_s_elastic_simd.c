@@ -0,0 +1,388 @@
+/*------------------------------------------------------------------------
+ * Vectorized update of the stress tensor for the elastic orthorhombic
+ * medium (2nd order in time, FDORDER = 4..12).
+ *
+ * One call updates a whole row along k at fixed (j, i).  The AVX-512 and
+ * AVX2 kernels process 16 and 8 grid points per iteration with the FD
+ * coefficients held in registers; the remaining points of the row are
+ * updated by the scalar kernel.  Like the loops in update_s_elastic.c, the
+ * row kernels are instantiated for each order in FD_ORDER_LIST (see
+ * stencil.h).  The kernel is selected once at startup according to the CPU
+ * and FDORDER (see update_s_elastic_simd_ini) and the results are identical
+ * to the scalar loops in update_s_elastic_kernel: every grid point is
+ * computed with the same operations in the same order.  Like these, the
+ * kernels are instantiated once more without division by the grid spacing
+ * and multiplication by DT for FOLD_COEFF=1.
+ *
+ * The SIMD kernels are compiled with target attributes, so no special
+ * compiler flags are needed; other compilers and CPUs use the scalar loops.
+ *------------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "stencil.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define ASOFI_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/* Rows of the wavefields and the elastic constants at fixed (j, i). */
+typedef struct {
+    const float *vx, *vy, *vz;
+    float *sxx, *syy, *szz, *sxy, *syz, *sxz;
+    const float *c11, *c12, *c13, *c22, *c23, *c33;
+    const float *c66ipjp, *c44jpkp, *c55ipkp;
+} StressRow;
+
+typedef void (*StressRowKernel)(const StressRow *r, int k1, int k2,
+        ptrdiff_t si, ptrdiff_t sj, const float *b,
+        float dx, float dy, float dz, float dt);
+
+static StressRowKernel row_kernel = NULL;
+static const char *row_kernel_name = "none (scalar loops)";
+
+
+/* Update of the points k1..k2 of a row, one point at a time. */
+FD_INLINE void stress_row_scalar(const StressRow *r, int k1, int k2,
+        ptrdiff_t si, ptrdiff_t sj, int nb, int fold, const float *b,
+        float dx, float dy, float dz, float dt)
+{
+    const float *bx = FD_BX(b), *by = FD_BY(b), *bz = FD_BZ(b);
+    int k;
+    float vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
+    float exy, eyz, exz;
+
+    if (fold)
+        dt = 1.0f;
+
+    for (k = k1; k <= k2; k++) {
+        vxx = fd_scale(fd_bwd(r->vx, k, si, nb, bx), dx, fold);
+        vxy = fd_scale(fd_fwd(r->vx, k, sj, nb, by), dy, fold);
+        vxz = fd_scale(fd_fwd(r->vx, k, 1, nb, bz), dz, fold);
+        vyx = fd_scale(fd_fwd(r->vy, k, si, nb, bx), dx, fold);
+        vyy = fd_scale(fd_bwd(r->vy, k, sj, nb, by), dy, fold);
+        vyz = fd_scale(fd_fwd(r->vy, k, 1, nb, bz), dz, fold);
+        vzx = fd_scale(fd_fwd(r->vz, k, si, nb, bx), dx, fold);
+        vzy = fd_scale(fd_fwd(r->vz, k, sj, nb, by), dy, fold);
+        vzz = fd_scale(fd_bwd(r->vz, k, 1, nb, bz), dz, fold);
+
+        exy = vxy + vyx;
+        eyz = vyz + vzy;
+        exz = vxz + vzx;
+
+        r->sxy[k] += dt * (r->c66ipjp[k] * exy);
+        r->syz[k] += dt * (r->c44jpkp[k] * eyz);
+        r->sxz[k] += dt * (r->c55ipkp[k] * exz);
+
+        r->sxx[k] += dt * ((r->c11[k] * vxx) + (r->c12[k] * vyy) + (r->c13[k] * vzz));
+        r->syy[k] += dt * ((r->c12[k] * vxx) + (r->c22[k] * vyy) + (r->c23[k] * vzz));
+        r->szz[k] += dt * ((r->c13[k] * vxx) + (r->c23[k] * vyy) + (r->c33[k] * vzz));
+    }
+}
+
+
+#ifdef ASOFI_SIMD_X86
+
+/* AVX2: 8 grid points per iteration. */
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 FD_INLINE __m256 bwd_avx2(const float *f, int k, ptrdiff_t s,
+        int nb, int fold, const __m256 *vb, __m256 h)
+{
+    int n;
+    __m256 d = _mm256_mul_ps(vb[0],
+            _mm256_sub_ps(_mm256_loadu_ps(f+k), _mm256_loadu_ps(f+k-s)));
+    for (n = 1; n < nb; n++)
+        d = _mm256_add_ps(d, _mm256_mul_ps(vb[n],
+                _mm256_sub_ps(_mm256_loadu_ps(f+k+n*s), _mm256_loadu_ps(f+k-(n+1)*s))));
+    return fold ? d : _mm256_div_ps(d, h);
+}
+
+AVX2 FD_INLINE __m256 fwd_avx2(const float *f, int k, ptrdiff_t s,
+        int nb, int fold, const __m256 *vb, __m256 h)
+{
+    int n;
+    __m256 d = _mm256_mul_ps(vb[0],
+            _mm256_sub_ps(_mm256_loadu_ps(f+k+s), _mm256_loadu_ps(f+k)));
+    for (n = 1; n < nb; n++)
+        d = _mm256_add_ps(d, _mm256_mul_ps(vb[n],
+                _mm256_sub_ps(_mm256_loadu_ps(f+k+(n+1)*s), _mm256_loadu_ps(f+k-n*s))));
+    return fold ? d : _mm256_div_ps(d, h);
+}
+
+/* s[k] += dt*c[k]*e */
+AVX2 FD_INLINE void upd1_avx2(float *s, const float *c, int k, int fold,
+        __m256 e, __m256 dt)
+{
+    __m256 t = _mm256_mul_ps(_mm256_loadu_ps(c+k), e);
+    if (!fold)
+        t = _mm256_mul_ps(dt, t);
+    _mm256_storeu_ps(s+k, _mm256_add_ps(_mm256_loadu_ps(s+k), t));
+}
+
+/* s[k] += dt*(ca[k]*exx + cb[k]*eyy + cc[k]*ezz) */
+AVX2 FD_INLINE void upd3_avx2(float *s, const float *ca, const float *cb,
+        const float *cc, int k, int fold, __m256 exx, __m256 eyy, __m256 ezz, __m256 dt)
+{
+    __m256 t = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(ca+k), exx),
+                          _mm256_mul_ps(_mm256_loadu_ps(cb+k), eyy)),
+            _mm256_mul_ps(_mm256_loadu_ps(cc+k), ezz));
+    if (!fold)
+        t = _mm256_mul_ps(dt, t);
+    _mm256_storeu_ps(s+k, _mm256_add_ps(_mm256_loadu_ps(s+k), t));
+}
+
+AVX2 FD_INLINE void stress_row_avx2(const StressRow *r, int k1, int k2,
+        ptrdiff_t si, ptrdiff_t sj, int nb, int fold, const float *b,
+        float dx, float dy, float dz, float dt)
+{
+    int k, n;
+    __m256 vb[3][FD_MAX_NB], hx, hy, hz, vdt;
+    const __m256 *vbx, *vby, *vbz;
+    __m256 vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
+
+    /* the rows differ only if the coefficients are folded */
+    for (n = 0; n < nb; n++) {
+        vb[0][n] = _mm256_set1_ps(FD_BX(b)[n]);
+        vb[1][n] = _mm256_set1_ps(FD_BY(b)[n]);
+        vb[2][n] = _mm256_set1_ps(FD_BZ(b)[n]);
+    }
+    vbx = vb[0];
+    vby = fold ? vb[1] : vb[0];
+    vbz = fold ? vb[2] : vb[0];
+    hx = _mm256_set1_ps(dx);
+    hy = _mm256_set1_ps(dy);
+    hz = _mm256_set1_ps(dz);
+    vdt = _mm256_set1_ps(dt);
+
+    for (k = k1; k + 7 <= k2; k += 8) {
+        vxx = bwd_avx2(r->vx, k, si, nb, fold, vbx, hx);
+        vyy = bwd_avx2(r->vy, k, sj, nb, fold, vby, hy);
+        vzz = bwd_avx2(r->vz, k, 1, nb, fold, vbz, hz);
+        vxy = fwd_avx2(r->vx, k, sj, nb, fold, vby, hy);
+        vxz = fwd_avx2(r->vx, k, 1, nb, fold, vbz, hz);
+        vyx = fwd_avx2(r->vy, k, si, nb, fold, vbx, hx);
+        vyz = fwd_avx2(r->vy, k, 1, nb, fold, vbz, hz);
+        vzx = fwd_avx2(r->vz, k, si, nb, fold, vbx, hx);
+        vzy = fwd_avx2(r->vz, k, sj, nb, fold, vby, hy);
+
+        upd1_avx2(r->sxy, r->c66ipjp, k, fold, _mm256_add_ps(vxy, vyx), vdt);
+        upd1_avx2(r->syz, r->c44jpkp, k, fold, _mm256_add_ps(vyz, vzy), vdt);
+        upd1_avx2(r->sxz, r->c55ipkp, k, fold, _mm256_add_ps(vxz, vzx), vdt);
+
+        upd3_avx2(r->sxx, r->c11, r->c12, r->c13, k, fold, vxx, vyy, vzz, vdt);
+        upd3_avx2(r->syy, r->c12, r->c22, r->c23, k, fold, vxx, vyy, vzz, vdt);
+        upd3_avx2(r->szz, r->c13, r->c23, r->c33, k, fold, vxx, vyy, vzz, vdt);
+    }
+    stress_row_scalar(r, k, k2, si, sj, nb, fold, b, dx, dy, dz, dt);
+}
+
+
+/* AVX-512: 16 grid points per iteration. */
+
+#define AVX512 __attribute__((target("avx512f")))
+
+AVX512 FD_INLINE __m512 bwd_avx512(const float *f, int k, ptrdiff_t s,
+        int nb, int fold, const __m512 *vb, __m512 h)
+{
+    int n;
+    __m512 d = _mm512_mul_ps(vb[0],
+            _mm512_sub_ps(_mm512_loadu_ps(f+k), _mm512_loadu_ps(f+k-s)));
+    for (n = 1; n < nb; n++)
+        d = _mm512_add_ps(d, _mm512_mul_ps(vb[n],
+                _mm512_sub_ps(_mm512_loadu_ps(f+k+n*s), _mm512_loadu_ps(f+k-(n+1)*s))));
+    return fold ? d : _mm512_div_ps(d, h);
+}
+
+AVX512 FD_INLINE __m512 fwd_avx512(const float *f, int k, ptrdiff_t s,
+        int nb, int fold, const __m512 *vb, __m512 h)
+{
+    int n;
+    __m512 d = _mm512_mul_ps(vb[0],
+            _mm512_sub_ps(_mm512_loadu_ps(f+k+s), _mm512_loadu_ps(f+k)));
+    for (n = 1; n < nb; n++)
+        d = _mm512_add_ps(d, _mm512_mul_ps(vb[n],
+                _mm512_sub_ps(_mm512_loadu_ps(f+k+(n+1)*s), _mm512_loadu_ps(f+k-n*s))));
+    return fold ? d : _mm512_div_ps(d, h);
+}
+
+AVX512 FD_INLINE void upd1_avx512(float *s, const float *c, int k, int fold,
+        __m512 e, __m512 dt)
+{
+    __m512 t = _mm512_mul_ps(_mm512_loadu_ps(c+k), e);
+    if (!fold)
+        t = _mm512_mul_ps(dt, t);
+    _mm512_storeu_ps(s+k, _mm512_add_ps(_mm512_loadu_ps(s+k), t));
+}
+
+AVX512 FD_INLINE void upd3_avx512(float *s, const float *ca, const float *cb,
+        const float *cc, int k, int fold, __m512 exx, __m512 eyy, __m512 ezz, __m512 dt)
+{
+    __m512 t = _mm512_add_ps(
+            _mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(ca+k), exx),
+                          _mm512_mul_ps(_mm512_loadu_ps(cb+k), eyy)),
+            _mm512_mul_ps(_mm512_loadu_ps(cc+k), ezz));
+    if (!fold)
+        t = _mm512_mul_ps(dt, t);
+    _mm512_storeu_ps(s+k, _mm512_add_ps(_mm512_loadu_ps(s+k), t));
+}
+
+AVX512 FD_INLINE void stress_row_avx512(const StressRow *r, int k1, int k2,
+        ptrdiff_t si, ptrdiff_t sj, int nb, int fold, const float *b,
+        float dx, float dy, float dz, float dt)
+{
+    int k, n;
+    __m512 vb[3][FD_MAX_NB], hx, hy, hz, vdt;
+    const __m512 *vbx, *vby, *vbz;
+    __m512 vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
+
+    /* the rows differ only if the coefficients are folded */
+    for (n = 0; n < nb; n++) {
+        vb[0][n] = _mm512_set1_ps(FD_BX(b)[n]);
+        vb[1][n] = _mm512_set1_ps(FD_BY(b)[n]);
+        vb[2][n] = _mm512_set1_ps(FD_BZ(b)[n]);
+    }
+    vbx = vb[0];
+    vby = fold ? vb[1] : vb[0];
+    vbz = fold ? vb[2] : vb[0];
+    hx = _mm512_set1_ps(dx);
+    hy = _mm512_set1_ps(dy);
+    hz = _mm512_set1_ps(dz);
+    vdt = _mm512_set1_ps(dt);
+
+    for (k = k1; k + 15 <= k2; k += 16) {
+        vxx = bwd_avx512(r->vx, k, si, nb, fold, vbx, hx);
+        vyy = bwd_avx512(r->vy, k, sj, nb, fold, vby, hy);
+        vzz = bwd_avx512(r->vz, k, 1, nb, fold, vbz, hz);
+        vxy = fwd_avx512(r->vx, k, sj, nb, fold, vby, hy);
+        vxz = fwd_avx512(r->vx, k, 1, nb, fold, vbz, hz);
+        vyx = fwd_avx512(r->vy, k, si, nb, fold, vbx, hx);
+        vyz = fwd_avx512(r->vy, k, 1, nb, fold, vbz, hz);
+        vzx = fwd_avx512(r->vz, k, si, nb, fold, vbx, hx);
+        vzy = fwd_avx512(r->vz, k, sj, nb, fold, vby, hy);
+
+        upd1_avx512(r->sxy, r->c66ipjp, k, fold, _mm512_add_ps(vxy, vyx), vdt);
+        upd1_avx512(r->syz, r->c44jpkp, k, fold, _mm512_add_ps(vyz, vzy), vdt);
+        upd1_avx512(r->sxz, r->c55ipkp, k, fold, _mm512_add_ps(vxz, vzx), vdt);
+
+        upd3_avx512(r->sxx, r->c11, r->c12, r->c13, k, fold, vxx, vyy, vzz, vdt);
+        upd3_avx512(r->syy, r->c12, r->c22, r->c23, k, fold, vxx, vyy, vzz, vdt);
+        upd3_avx512(r->szz, r->c13, r->c23, r->c33, k, fold, vxx, vyy, vzz, vdt);
+    }
+    stress_row_scalar(r, k, k2, si, sj, nb, fold, b, dx, dy, dz, dt);
+}
+
+#endif /* ASOFI_SIMD_X86 */
+
+
+/* Row kernels with a constant number of coefficients for each order. */
+#ifdef ASOFI_SIMD_X86
+#define STRESS_ROW_FOLD(ORDER, FOLD, NAME) \
+AVX2 static void stress_row_avx2_##NAME##ORDER(const StressRow *r, int k1, int k2, \
+        ptrdiff_t si, ptrdiff_t sj, const float *b, \
+        float dx, float dy, float dz, float dt) \
+{ \
+    stress_row_avx2(r, k1, k2, si, sj, ORDER / 2, FOLD, b, dx, dy, dz, dt); \
+} \
+AVX512 static void stress_row_avx512_##NAME##ORDER(const StressRow *r, int k1, int k2, \
+        ptrdiff_t si, ptrdiff_t sj, const float *b, \
+        float dx, float dy, float dz, float dt) \
+{ \
+    stress_row_avx512(r, k1, k2, si, sj, ORDER / 2, FOLD, b, dx, dy, dz, dt); \
+}
+#define STRESS_ROW(ORDER) STRESS_ROW_FOLD(ORDER, 0, ) STRESS_ROW_FOLD(ORDER, 1, fold_)
+FD_ORDER_LIST(STRESS_ROW)
+#undef STRESS_ROW
+#undef STRESS_ROW_FOLD
+#endif
+
+
+/**
+ * Select the stress kernel.
+ *
+ * `request` is the value of SIMD_KERNEL: 0 selects the widest instruction
+ * set supported by the CPU, 1 the scalar loops, 2 AVX2 and 3 AVX-512.
+ * If the requested instruction set is not available, the next narrower
+ * one is used.  No kernel is selected for orders not in FD_ORDER_LIST,
+ * e.g. `fdorder` = 0.  If `fold` is set, the kernels for FD coefficients
+ * folded with DT and the grid spacing are selected.
+ */
+void update_s_elastic_simd_ini(int request, int fdorder, int fold)
+{
+    row_kernel = NULL;
+    row_kernel_name = "none (scalar loops)";
+
+    if (request == 1) return;
+
+#ifdef ASOFI_SIMD_X86
+    StressRowKernel avx2 = NULL, avx512 = NULL;
+
+    switch (fdorder) {
+#define STRESS_ROW_CASE(ORDER) case ORDER: \
+        avx2 = fold ? stress_row_avx2_fold_##ORDER : stress_row_avx2_##ORDER; \
+        avx512 = fold ? stress_row_avx512_fold_##ORDER : stress_row_avx512_##ORDER; break;
+        FD_ORDER_LIST(STRESS_ROW_CASE)
+#undef STRESS_ROW_CASE
+        default:
+            return;
+    }
+
+    __builtin_cpu_init();
+    if ((request == 0 || request == 3) && __builtin_cpu_supports("avx512f")) {
+        row_kernel = avx512;
+        row_kernel_name = "AVX-512";
+    }
+    else if (__builtin_cpu_supports("avx2")) {
+        row_kernel = avx2;
+        row_kernel_name = "AVX2";
+    }
+#else
+    (void) fdorder;
+    (void) fold;
+#endif
+}
+
+const char *update_s_elastic_simd_name(void)
+{
+    return row_kernel_name;
+}
+
+/**
+ * Update the stress tensor of the elastic orthorhombic medium with the
+ * selected SIMD kernel and the FD coefficients `b` (see fd_coeff_fold).
+ *
+ * Returns 0 without doing anything if no SIMD kernel is selected.
+ */
+int update_s_elastic_simd(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, OrthoPar *op, const float *b)
+{
+    extern float DT, DX, DY, DZ;
+    const ptrdiff_t si = v->x[1][2] - v->x[1][1];
+    const ptrdiff_t sj = v->x[2][1] - v->x[1][1];
+    StressRow r;
+    int i, j;
+
+    if (!row_kernel) return 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, r)
+#endif
+    for (j = ny1; j <= ny2; j++) {
+        for (i = nx1; i <= nx2; i++) {
+            r.vx = v->x[j][i]; r.vy = v->y[j][i]; r.vz = v->z[j][i];
+            r.sxx = s->xx[j][i]; r.syy = s->yy[j][i]; r.szz = s->zz[j][i];
+            r.sxy = s->xy[j][i]; r.syz = s->yz[j][i]; r.sxz = s->xz[j][i];
+            r.c11 = op->C11[j][i]; r.c12 = op->C12[j][i]; r.c13 = op->C13[j][i];
+            r.c22 = op->C22[j][i]; r.c23 = op->C23[j][i]; r.c33 = op->C33[j][i];
+            r.c66ipjp = op->C66ipjp[j][i];
+            r.c44jpkp = op->C44jpkp[j][i];
+            r.c55ipkp = op->C55ipkp[j][i];
+
+            row_kernel(&r, nz1, nz2, si, sj, b, DX, DY, DZ, DT);
+        }
+    }
+
+    return 1;
+}
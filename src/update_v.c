@@ -1,6 +1,7 @@
 #include "data_structures.h"
 #include "fd.h"
 #include "globvar.h"
+#include "stencil.h"
 
 /**
  * Update particle velocities by a staggered grid finite-difference scheme.
@@ -44,6 +45,168 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         StressDerivativesWrtVelocity *ds_dv_3,
         StressDerivativesWrtVelocity *ds_dv_4) {
 
+    double time=0.0, time1=0.0, time2=0.0;
+    extern int MYID, LOG;
+    extern FILE *FP;
+    extern int OUTNTIMESTEPINFO;
+
+    if (LOG)
+        time1=MPI_Wtime();
+
+    update_v_kernel(nx1, nx2, ny1, ny2, nz1, nz2, v, s, rjp, rkp, rip,
+            ds_dv, ds_dv_2, ds_dv_3, ds_dv_4);
+
+    update_v_body_forces(nx1, nx2, ny1, ny2, nz1, nz2, nt, v, s, rjp, rkp, rip,
+            srcpos_loc, signals, nsrc, absorb_coeff, stype);
+
+    if (LOG) {
+        time2=MPI_Wtime();
+        time=time2-time1;
+        if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) {
+            fprintf(FP," Real time for particle velocity update: \t %4.2f s.\n",time);
+        }
+    }
+
+    return time;
+}
+
+
+/*
+ * Velocity update for FDORDER_TIME=2 with `nb` = FDORDER/2 coefficients `b`
+ * per direction, folded with DT and the grid spacing if `fold` is set,
+ * instantiated for each order in FD_ORDER_LIST (see stencil.h).
+ */
+FD_INLINE void update_v_fd2(int nb, int fold, int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, float  *** rjp, float  *** rkp, float  *** rip,
+        const float *b) {
+
+    extern float DT, DX, DY, DZ;
+
+    float ***vx = v->x, ***vy = v->y, ***vz = v->z;
+    float ***sxx = s->xx, ***syy = s->yy, ***szz = s->zz;
+    float ***sxy = s->xy, ***syz = s->yz, ***sxz = s->xz;
+
+    const float *bx = FD_BX(b), *by = FD_BY(b), *bz = FD_BZ(b);
+    const float dx = fold ? 1.0f : DT/DX, dy = fold ? 1.0f : DT/DY, dz = fold ? 1.0f : DT/DZ;
+    const ptrdiff_t si = vx[1][2] - vx[1][1];
+    const ptrdiff_t sj = vx[2][1] - vx[1][1];
+    int i, j, k;
+    float sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z, szz_z, sxz_x, syz_y;
+
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
+#ifdef _OPENACC
+#pragma acc parallel
+#pragma acc loop independent collapse(2)
+#endif
+    for (j=ny1;j<=ny2;j++){
+        for (i=nx1;i<=nx2;i++){
+            float *restrict vx_ji = vx[j][i], *restrict vy_ji = vy[j][i], *restrict vz_ji = vz[j][i];
+            const float *restrict sxx_ji = sxx[j][i], *restrict syy_ji = syy[j][i], *restrict szz_ji = szz[j][i];
+            const float *restrict sxy_ji = sxy[j][i], *restrict syz_ji = syz[j][i], *restrict sxz_ji = sxz[j][i];
+            const float *restrict rip_ji = rip[j][i], *restrict rjp_ji = rjp[j][i], *restrict rkp_ji = rkp[j][i];
+#ifdef _OPENACC
+#pragma acc loop independent
+#endif
+            IVDEP
+            for (k=nz1;k<=nz2;k++){
+
+                sxx_x = dx*fd_fwd(sxx_ji, k, si, nb, bx);
+                sxy_y = dy*fd_bwd(sxy_ji, k, sj, nb, by);
+                sxz_z = dz*fd_bwd(sxz_ji, k, 1, nb, bz);
+
+                /* updating components of particle velocities */
+                vx_ji[k]+= (sxx_x + sxy_y +sxz_z)/rip_ji[k];
+
+                syy_y = dy*fd_fwd(syy_ji, k, sj, nb, by);
+                sxy_x = dx*fd_bwd(sxy_ji, k, si, nb, bx);
+                syz_z = dz*fd_bwd(syz_ji, k, 1, nb, bz);
+
+                vy_ji[k]+= (syy_y + sxy_x + syz_z)/rjp_ji[k];
+
+                szz_z = dz*fd_fwd(szz_ji, k, 1, nb, bz);
+                sxz_x = dx*fd_bwd(sxz_ji, k, si, nb, bx);
+                syz_y = dy*fd_bwd(syz_ji, k, sj, nb, by);
+
+                vz_ji[k]+= (szz_z + sxz_x + syz_y)/rkp_ji[k];
+            }
+        }
+    }
+}
+
+typedef void (*UpdateVKernel)(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, float  *** rjp, float  *** rkp, float  *** rip,
+        const float *b);
+
+#define UPDATE_V_FD2(ORDER) \
+static void update_v_fd2_##ORDER(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, \
+        Velocity *v, Tensor3d *s, float  *** rjp, float  *** rkp, float  *** rip, \
+        const float *b) { \
+    update_v_fd2(ORDER/2, 0, nx1, nx2, ny1, ny2, nz1, nz2, v, s, rjp, rkp, rip, b); \
+} \
+static void update_v_fd2_fold_##ORDER(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2, \
+        Velocity *v, Tensor3d *s, float  *** rjp, float  *** rkp, float  *** rip, \
+        const float *b) { \
+    update_v_fd2(ORDER/2, 1, nx1, nx2, ny1, ny2, nz1, nz2, v, s, rjp, rkp, rip, b); \
+}
+FD_ORDER_LIST(UPDATE_V_FD2)
+
+/* kernel for FDORDER_TIME=2 and its FD coefficients, see update_v_kernel_ini */
+static UpdateVKernel update_v_fd2_kernel = NULL;
+static float update_v_fd2_b[3 * FD_MAX_NB];
+
+/**
+ * Select the kernel of `update_v_kernel` for FDORDER and FDORDER_TIME.
+ * With FOLD_COEFF=1, the kernels use FD coefficients folded with DT and
+ * the grid spacing.  Must be called once after the parameters are read.
+ */
+void update_v_kernel_ini(void) {
+
+    extern int FDORDER, FDORDER_TIME, FDCOEFF, FOLD_COEFF;
+
+    update_v_fd2_kernel = NULL;
+    if (FDORDER_TIME != 2) return;
+
+    switch (FDORDER){
+#define UPDATE_V_FD2_CASE(ORDER) case ORDER : update_v_fd2_kernel = \
+            FOLD_COEFF ? update_v_fd2_fold_##ORDER : update_v_fd2_##ORDER; break;
+        FD_ORDER_LIST(UPDATE_V_FD2_CASE)
+#undef UPDATE_V_FD2_CASE
+        default :
+            return;
+    }
+    fd_coeff_fold(FDORDER, FDCOEFF, FOLD_COEFF, update_v_fd2_b);
+}
+
+
+/**
+ * Finite-difference part of `update_v` for the grid points
+ * [nx1...nx2][ny1...ny2][nz1...nz2].
+ *
+ * Stress values up to FDORDER/2 points outside of this range are read,
+ * all other points are updated independently of each other.  Therefore, the
+ * kernel may be applied to several disjoint boxes of the local grid in any
+ * order (see `OVERLAP_COMM` in sofi3D.c) as long as `update_v_body_forces`
+ * is called after all of them.
+ */
+void update_v_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        Velocity *v, Tensor3d *s, float  *** rjp, float  *** rkp, float  *** rip,
+        StressDerivativesWrtVelocity *ds_dv,
+        StressDerivativesWrtVelocity *ds_dv_2,
+        StressDerivativesWrtVelocity *ds_dv_3,
+        StressDerivativesWrtVelocity *ds_dv_4) {
+
+    /* update boxes larger than a tile tile by tile (see tile.c) */
+    int t[6];
+    if (tile_first(nx1, nx2, ny1, ny2, nz1, nz2, t)) {
+        do
+            update_v_kernel(t[0], t[1], t[2], t[3], t[4], t[5], v, s, rjp, rkp, rip,
+                    ds_dv, ds_dv_2, ds_dv_3, ds_dv_4);
+        while (tile_next(nx1, nx2, ny1, ny2, nz1, nz2, t));
+        return;
+    }
+
     float ***vx = v->x;
     float ***vy = v->y;
     float ***vz = v->z;
@@ -71,14 +234,10 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
     float ***svy_4 = ds_dv_4->y;
     float ***svz_4 = ds_dv_4->z;
 
-    extern float DT, DX, DY, DZ, SOURCE_ALPHA, SOURCE_BETA;
-    double time=0.0, time1=0.0, time2=0.0;
-    extern int MYID, FDORDER, FDORDER_TIME, LOG, ABS_TYPE, FDCOEFF;
-    extern FILE *FP;
-    extern int OUTNTIMESTEPINFO;
+    extern float DT, DX, DY, DZ;
+    extern int FDORDER, FDORDER_TIME, FDCOEFF;
 
-    int i, j, k, l;
-    float  amp, alpha_rad, beta_rad;
+    int i, j, k;
     float b1, b2, b3, b4, b5, b6, dx, dy, dz;
     float sxx_x, sxy_y, sxz_z, syy_y, sxy_x, syz_z;
     float szz_z, sxz_x, syz_y;
@@ -86,478 +245,80 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 
     float **svx_j,**svy_j,**svz_j;
     float **svx_j_2,**svy_j_2,**svz_j_2;
-    float **svx_j_3,**svy_j_3,**svz_j_3;
-    float **svx_j_4,**svy_j_4,**svz_j_4;
-
-    float *svx_j_i,*svy_j_i,*svz_j_i;
-    float *svx_j_i_2,*svy_j_i_2,*svz_j_i_2;
-    float *svx_j_i_3,*svy_j_i_3,*svz_j_i_3;
-    float *svx_j_i_4,*svy_j_i_4,*svz_j_i_4;
-
-    if (LOG)
-        time1=MPI_Wtime();
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
-
-    switch (FDORDER_TIME) {
-
-        case 2:
-
-            switch (FDORDER){
-                    
-                case 2 :
-                    
-                    dx=DT/DX;
-                    dy=DT/DY;
-                    dz=DT/DZ;
-                    
-                    b1=1.0; /* Taylor coefficients*/
-                    if(FDCOEFF==2){
-                        b1=1.00100; } /* Holberg coefficients E=0.1 %*/
-
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent collapse(3)
-#endif
-                    for (j=ny1;j<=ny2;j++){
-//#pragma acc loop independent
-                        for (i=nx1;i<=nx2;i++){
-//#pragma acc loop independent
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                sxx_x = dx*b1*(sxx[j][i+1][k]-sxx[j][i][k]);
-                                sxy_y = dy*b1*(sxy[j][i][k]-sxy[j-1][i][k]);
-                                sxz_z = dz*b1*(sxz[j][i][k]-sxz[j][i][k-1]); /* backward operator */
-                                
-                                /* updating components of particle velocities */
-                                vx[j][i][k]+= ((sxx_x + sxy_y +sxz_z)/rip[j][i][k]);
-                                
-                                syy_y = dy*b1*(syy[j+1][i][k]-syy[j][i][k]);
-                                sxy_x = dx*b1*(sxy[j][i][k]-sxy[j][i-1][k]);
-                                syz_z = dz*b1*(syz[j][i][k]-syz[j][i][k-1]);
-                                
-                                
-                                vy[j][i][k]+= ((syy_y + sxy_x + syz_z)/rjp[j][i][k]);
-                                
-                                szz_z = dz*b1*(szz[j][i][k+1]-szz[j][i][k]);
-                                sxz_x = dx*b1*(sxz[j][i][k]-sxz[j][i-1][k]);
-                                syz_y = dy*b1*(syz[j][i][k]-syz[j-1][i][k]);
-                                
-                                
-                                vz[j][i][k]+= ((szz_z + sxz_x + syz_y)/rkp[j][i][k]);
-                                
-                            }
-                        }
-                    }
-                    
-                    break;
-                    
-                case 4 :
-                    
-                    dx=DT/DX;
-                    dy=DT/DY;
-                    dz=DT/DZ;
-                    
-                    b1=9.0/8.0; b2=-1.0/24.0; /* Taylor coefficients*/
-                    if(FDCOEFF==2){
-                        b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
-                    
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent collapse(3)
-#endif
-                    for (j=ny1;j<=ny2;j++){
-//#pragma acc loop independent
-                        for (i=nx1;i<=nx2;i++){
-//#pragma acc loop independent
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+b2*(sxx[j][i+2][k]-sxx[j][i-1][k]));
-                                sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+b2*(sxy[j+1][i][k]-sxy[j-2][i][k]));
-                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+b2*(sxz[j][i][k+1]-sxz[j][i][k-2]));
-                                
-                                /* updating components of particle velocities */
-                                vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-                                
-                                syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+b2*(syy[j+2][i][k]-syy[j-1][i][k]));
-                                sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+b2*(sxy[j][i+1][k]-sxy[j][i-2][k]));
-                                syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+b2*(syz[j][i][k+1]-syz[j][i][k-2]));
-                                
-                                
-                                vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-                                
-                                szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+b2*(szz[j][i][k+2]-szz[j][i][k-1]));
-                                sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+b2*(sxz[j][i+1][k]-sxz[j][i-2][k]));
-                                syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+b2*(syz[j+1][i][k]-syz[j-2][i][k]));
-                                
-                                
-                                vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-                                
-                            }
-                        }
-                    }
-                    
-                    break;
-                    
-                case 6 :
-                    
-                    dx=DT/DX;
-                    dy=DT/DY;
-                    dz=DT/DZ;
-                    
-                    b1=75.0/64.0; b2=-25.0/384.0; b3=3.0/640.0; /* Taylor coefficients*/
-                    if(FDCOEFF==2){
-                        b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
-               
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent     
-#endif
-                    for (j=ny1;j<=ny2;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                        for (i=nx1;i<=nx2;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
-                                            b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
-                                            b3*(sxx[j][i+3][k]-sxx[j][i-2][k]));
-                                
-                                sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+
-                                            b2*(sxy[j+1][i][k]-sxy[j-2][i][k])+
-                                            b3*(sxy[j+2][i][k]-sxy[j-3][i][k]));
-                                
-                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+
-                                            b2*(sxz[j][i][k+1]-sxz[j][i][k-2])+
-                                            b3*(sxz[j][i][k+2]-sxz[j][i][k-3]));
-                                
-                                
-                                /* updating components of particle velocities */
-                                vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-                                
-                                syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+
-                                            b2*(syy[j+2][i][k]-syy[j-1][i][k])+
-                                            b3*(syy[j+3][i][k]-syy[j-2][i][k]));
-                                
-                                sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+
-                                            b2*(sxy[j][i+1][k]-sxy[j][i-2][k])+
-                                            b3*(sxy[j][i+2][k]-sxy[j][i-3][k]));
-                                
-                                syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+
-                                            b2*(syz[j][i][k+1]-syz[j][i][k-2])+
-                                            b3*(syz[j][i][k+2]-syz[j][i][k-3]));
-                                
-                                
-                                vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-                                
-                                szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+
-                                            b2*(szz[j][i][k+2]-szz[j][i][k-1])+
-                                            b3*(szz[j][i][k+3]-szz[j][i][k-2]));
-                                
-                                sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+
-                                            b2*(sxz[j][i+1][k]-sxz[j][i-2][k])+
-                                            b3*(sxz[j][i+2][k]-sxz[j][i-3][k]));
-                                
-                                
-                                syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+
-                                            b2*(syz[j+1][i][k]-syz[j-2][i][k])+
-                                            b3*(syz[j+2][i][k]-syz[j-3][i][k]));
-                                
-                                
-                                vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-                                
-                            }
-                        }
-                    }
-                    
-                    break;
-                    
-                case 8 :
-                    
-                    dx=DT/DX;
-                    dy=DT/DY;
-                    dz=DT/DZ;
-                    
-                    b1=1225.0/1024.0; b2=-245.0/3072.0; b3=49.0/5120.0; b4=-5.0/7168.0; /* Taylor coefficients*/
-                    if(FDCOEFF==2){
-                        b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
-                    
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent
-#endif
-                    for (j=ny1;j<=ny2;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                        for (i=nx1;i<=nx2;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
-                                            b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
-                                            b3*(sxx[j][i+3][k]-sxx[j][i-2][k])+
-                                            b4*(sxx[j][i+4][k]-sxx[j][i-3][k]));
-                                
-                                sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+
-                                            b2*(sxy[j+1][i][k]-sxy[j-2][i][k])+
-                                            b3*(sxy[j+2][i][k]-sxy[j-3][i][k])+
-                                            b4*(sxy[j+3][i][k]-sxy[j-4][i][k]));
-                                
-                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+
-                                            b2*(sxz[j][i][k+1]-sxz[j][i][k-2])+
-                                            b3*(sxz[j][i][k+2]-sxz[j][i][k-3])+
-                                            b4*(sxz[j][i][k+3]-sxz[j][i][k-4]));
-                                
-                                /* updating components of particle velocities */
-                                vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-                                
-                                syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+
-                                            b2*(syy[j+2][i][k]-syy[j-1][i][k])+
-                                            b3*(syy[j+3][i][k]-syy[j-2][i][k])+
-                                            b4*(syy[j+4][i][k]-syy[j-3][i][k]));
-                                
-                                sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+
-                                            b2*(sxy[j][i+1][k]-sxy[j][i-2][k])+
-                                            b3*(sxy[j][i+2][k]-sxy[j][i-3][k])+
-                                            b4*(sxy[j][i+3][k]-sxy[j][i-4][k]));
-                                
-                                syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+
-                                            b2*(syz[j][i][k+1]-syz[j][i][k-2])+
-                                            b3*(syz[j][i][k+2]-syz[j][i][k-3])+
-                                            b4*(syz[j][i][k+3]-syz[j][i][k-4]));
-                                
-                                
-                                vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-                                
-                                szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+
-                                            b2*(szz[j][i][k+2]-szz[j][i][k-1])+
-                                            b3*(szz[j][i][k+3]-szz[j][i][k-2])+
-                                            b4*(szz[j][i][k+4]-szz[j][i][k-3]));
-                                
-                                sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+
-                                            b2*(sxz[j][i+1][k]-sxz[j][i-2][k])+
-                                            b3*(sxz[j][i+2][k]-sxz[j][i-3][k])+
-                                            b4*(sxz[j][i+3][k]-sxz[j][i-4][k]));
-                                
-                                
-                                syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+
-                                            b2*(syz[j+1][i][k]-syz[j-2][i][k])+
-                                            b3*(syz[j+2][i][k]-syz[j-3][i][k])+
-                                            b4*(syz[j+3][i][k]-syz[j-4][i][k]));
-                                
-                                
-                                vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-                                
-                            }
-                        }
-                    }
-                    
-                    break;
+    float **svx_j_3,**svy_j_3,**svz_j_3;
+    float **svx_j_4,**svy_j_4,**svz_j_4;
+
+    float *svx_j_i,*svy_j_i,*svz_j_i;
+    float *svx_j_i_2,*svy_j_i_2,*svz_j_i_2;
+    float *svx_j_i_3,*svy_j_i_3,*svz_j_i_3;
+    float *svx_j_i_4,*svy_j_i_4,*svz_j_i_4;
+
+    /* Distances between neighbouring grid points in i- and j-direction,
+     * equal for all components of v and s (see f3tensor_aligned). */
+    const ptrdiff_t si = vx[1][2] - vx[1][1];
+    const ptrdiff_t sj = vx[2][1] - vx[1][1];
+
+
+    switch (FDORDER_TIME) {
+
+        case 2:
+
+            /* FDORDER>2: kernel generated from stencil.h */
+            if (update_v_fd2_kernel) {
+                update_v_fd2_kernel(nx1, nx2, ny1, ny2, nz1, nz2, v, s, rjp, rkp, rip, update_v_fd2_b);
+                break;
+            }
+
+            switch (FDORDER){
                     
-                case 10 :
+                case 2 :
                     
                     dx=DT/DX;
                     dy=DT/DY;
                     dz=DT/DZ;
                     
-                    
-                    b1=19845.0/16384.0; b2=-735.0/8192.0; b3=567.0/40960.0; b4=-405.0/229376.0; b5=35.0/294912.0; /* Taylor Coefficients*/
+                    b1=1.0; /* Taylor coefficients*/
                     if(FDCOEFF==2){
-                        b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
-                    
-#ifdef _OPENACC
-#pragma acc parallel 
-#pragma acc loop independent
-#endif
-                    for (j=ny1;j<=ny2;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
-                        for (i=nx1;i<=nx2;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
+                        b1=1.00100; } /* Holberg coefficients E=0.1 %*/
+
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
 #endif
-                            for (k=nz1;k<=nz2;k++){
-                                
-                                sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
-                                            b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
-                                            b3*(sxx[j][i+3][k]-sxx[j][i-2][k])+
-                                            b4*(sxx[j][i+4][k]-sxx[j][i-3][k])+
-                                            b5*(sxx[j][i+5][k]-sxx[j][i-4][k]));
-                                
-                                sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+
-                                            b2*(sxy[j+1][i][k]-sxy[j-2][i][k])+
-                                            b3*(sxy[j+2][i][k]-sxy[j-3][i][k])+
-                                            b4*(sxy[j+3][i][k]-sxy[j-4][i][k])+
-                                            b5*(sxy[j+4][i][k]-sxy[j-5][i][k]));
-                                
-                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+
-                                            b2*(sxz[j][i][k+1]-sxz[j][i][k-2])+
-                                            b3*(sxz[j][i][k+2]-sxz[j][i][k-3])+
-                                            b4*(sxz[j][i][k+3]-sxz[j][i][k-4])+
-                                            b5*(sxz[j][i][k+4]-sxz[j][i][k-5]));
-                                
-                                
-                                /* updating components of particle velocities */
-                                vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-                                
-                                syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+
-                                            b2*(syy[j+2][i][k]-syy[j-1][i][k])+
-                                            b3*(syy[j+3][i][k]-syy[j-2][i][k])+
-                                            b4*(syy[j+4][i][k]-syy[j-3][i][k])+
-                                            b5*(syy[j+5][i][k]-syy[j-4][i][k]));
-                                
-                                sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+
-                                            b2*(sxy[j][i+1][k]-sxy[j][i-2][k])+
-                                            b3*(sxy[j][i+2][k]-sxy[j][i-3][k])+
-                                            b4*(sxy[j][i+3][k]-sxy[j][i-4][k])+
-                                            b5*(sxy[j][i+4][k]-sxy[j][i-5][k]));
-                                
-                                syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+
-                                            b2*(syz[j][i][k+1]-syz[j][i][k-2])+
-                                            b3*(syz[j][i][k+2]-syz[j][i][k-3])+
-                                            b4*(syz[j][i][k+3]-syz[j][i][k-4])+
-                                            b5*(syz[j][i][k+4]-syz[j][i][k-5]));
-                                
-                                
-                                vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-                                
-                                szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+
-                                            b2*(szz[j][i][k+2]-szz[j][i][k-1])+
-                                            b3*(szz[j][i][k+3]-szz[j][i][k-2])+
-                                            b4*(szz[j][i][k+4]-szz[j][i][k-3])+
-                                            b5*(szz[j][i][k+5]-szz[j][i][k-4]));
-                                
-                                sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+
-                                            b2*(sxz[j][i+1][k]-sxz[j][i-2][k])+
-                                            b3*(sxz[j][i+2][k]-sxz[j][i-3][k])+
-                                            b4*(sxz[j][i+3][k]-sxz[j][i-4][k])+
-                                            b5*(sxz[j][i+4][k]-sxz[j][i-5][k]));
-                                
-                                
-                                syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+
-                                            b2*(syz[j+1][i][k]-syz[j-2][i][k])+
-                                            b3*(syz[j+2][i][k]-syz[j-3][i][k])+
-                                            b4*(syz[j+3][i][k]-syz[j-4][i][k])+
-                                            b5*(syz[j+4][i][k]-syz[j-5][i][k]));
-                                
-                                
-                                vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
-                                
-                            }
-                        }
-                    }
-                    
-                    break;
-                    
-                case 12 :
-                    dx=DT/DX;
-                    dy=DT/DY;
-                    dz=DT/DZ;
-                    
-                    /* Taylor coefficients */
-                    b1=160083.0/131072.0; b2=-12705.0/131072.0; b3=22869.0/1310720.0;
-                    b4=-5445.0/1835008.0; b5=847.0/2359296.0; b6=-63.0/2883584;
-                    
-                    /* Holberg coefficients E=0.1 %*/
-                    if(FDCOEFF==2){
-                        b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
-                    
-                    
 #ifdef _OPENACC
 #pragma acc parallel 
-#pragma acc loop independent
+#pragma acc loop independent collapse(2)
 #endif
                     for (j=ny1;j<=ny2;j++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
+//#pragma acc loop independent
                         for (i=nx1;i<=nx2;i++){
-#ifdef _OPENACC
-#pragma acc loop independent
-#endif
+                            float *restrict vx_ji = vx[j][i], *restrict vy_ji = vy[j][i], *restrict vz_ji = vz[j][i];
+                            const float *restrict sxx_ji = sxx[j][i], *restrict syy_ji = syy[j][i], *restrict szz_ji = szz[j][i];
+                            const float *restrict sxy_ji = sxy[j][i], *restrict syz_ji = syz[j][i], *restrict sxz_ji = sxz[j][i];
+                            const float *restrict rip_ji = rip[j][i], *restrict rjp_ji = rjp[j][i], *restrict rkp_ji = rkp[j][i];
+//#pragma acc loop independent
+                            IVDEP
                             for (k=nz1;k<=nz2;k++){
                                 
-                                sxx_x = dx*(b1*(sxx[j][i+1][k]-sxx[j][i][k])+
-                                            b2*(sxx[j][i+2][k]-sxx[j][i-1][k])+
-                                            b3*(sxx[j][i+3][k]-sxx[j][i-2][k])+
-                                            b4*(sxx[j][i+4][k]-sxx[j][i-3][k])+
-                                            b5*(sxx[j][i+5][k]-sxx[j][i-4][k])+
-                                            b6*(sxx[j][i+6][k]-sxx[j][i-5][k]));
-                                
-                                sxy_y = dy*(b1*(sxy[j][i][k]-sxy[j-1][i][k])+
-                                            b2*(sxy[j+1][i][k]-sxy[j-2][i][k])+
-                                            b3*(sxy[j+2][i][k]-sxy[j-3][i][k])+
-                                            b4*(sxy[j+3][i][k]-sxy[j-4][i][k])+
-                                            b5*(sxy[j+4][i][k]-sxy[j-5][i][k])+
-                                            b6*(sxy[j+5][i][k]-sxy[j-6][i][k]));
-                                
-                                sxz_z = dz*(b1*(sxy[j][i][k]-sxy[j][i][k-1])+
-                                            b2*(sxy[j][i][k+1]-sxy[j][i][k-2])+
-                                            b3*(sxy[j][i][k+2]-sxy[j][i][k-3])+
-                                            b4*(sxy[j][i][k+3]-sxy[j][i][k-4])+
-                                            b5*(sxy[j][i][k+4]-sxy[j][i][k-5])+
-                                            b6*(sxy[j][i][k+5]-sxy[j][i][k-6]));
-                                
+                                sxx_x = dx*b1*(sxx_ji[k+si]-sxx_ji[k]);
+                                sxy_y = dy*b1*(sxy_ji[k]-sxy_ji[k-sj]);
+                                sxz_z = dz*b1*(sxz_ji[k]-sxz_ji[k-1]); /* backward operator */
                                 
                                 /* updating components of particle velocities */
-                                vx[j][i][k]+= (sxx_x + sxy_y +sxz_z)/rip[j][i][k];
-                                
-                                syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+
-                                            b2*(syy[j+2][i][k]-syy[j-1][i][k])+
-                                            b3*(syy[j+3][i][k]-syy[j-2][i][k])+
-                                            b4*(syy[j+4][i][k]-syy[j-3][i][k])+
-                                            b5*(syy[j+5][i][k]-syy[j-4][i][k])+
-                                            b6*(syy[j+6][i][k]-syy[j-5][i][k]));
-                                
-                                sxy_x = dx*(b1*(sxy[j][i][k]-sxy[j][i-1][k])+
-                                            b2*(sxy[j][i+1][k]-sxy[j][i-2][k])+
-                                            b3*(sxy[j][i+2][k]-sxy[j][i-3][k])+
-                                            b4*(sxy[j][i+3][k]-sxy[j][i-4][k])+
-                                            b5*(sxy[j][i+4][k]-sxy[j][i-5][k])+
-                                            b6*(sxy[j][i+5][k]-sxy[j][i-6][k]));
+                                vx_ji[k]+= ((sxx_x + sxy_y +sxz_z)/rip_ji[k]);
                                 
-                                syz_z = dz*(b1*(syz[j][i][k]-syz[j][i][k-1])+
-                                            b2*(syz[j][i][k+1]-syz[j][i][k-2])+
-                                            b3*(syz[j][i][k+2]-syz[j][i][k-3])+
-                                            b4*(syz[j][i][k+3]-syz[j][i][k-4])+
-                                            b5*(syz[j][i][k+4]-syz[j][i][k-5])+
-                                            b6*(syz[j][i][k+5]-syz[j][i][k-6]));
-                                
-                                
-                                
-                                vy[j][i][k]+= (syy_y + sxy_x + syz_z)/rjp[j][i][k];
-                                
-                                szz_z = dz*(b1*(szz[j][i][k+1]-szz[j][i][k])+
-                                            b2*(szz[j][i][k+2]-szz[j][i][k-1])+
-                                            b3*(szz[j][i][k+3]-szz[j][i][k-2])+
-                                            b4*(szz[j][i][k+4]-szz[j][i][k-3])+
-                                            b5*(szz[j][i][k+5]-szz[j][i][k-4])+
-                                            b6*(szz[j][i][k+6]-szz[j][i][k-5]));
+                                syy_y = dy*b1*(syy_ji[k+sj]-syy_ji[k]);
+                                sxy_x = dx*b1*(sxy_ji[k]-sxy_ji[k-si]);
+                                syz_z = dz*b1*(syz_ji[k]-syz_ji[k-1]);
                                 
-                                sxz_x = dx*(b1*(sxz[j][i][k]-sxz[j][i-1][k])+
-                                            b2*(sxz[j][i+1][k]-sxz[j][i-2][k])+
-                                            b3*(sxz[j][i+2][k]-sxz[j][i-3][k])+
-                                            b4*(sxz[j][i+3][k]-sxz[j][i-4][k])+
-                                            b5*(sxz[j][i+4][k]-sxz[j][i-5][k])+
-                                            b6*(sxz[j][i+5][k]-sxz[j][i-6][k]));
                                 
+                                vy_ji[k]+= ((syy_y + sxy_x + syz_z)/rjp_ji[k]);
                                 
-                                syz_y = dy*(b1*(syz[j][i][k]-syz[j-1][i][k])+
-                                            b2*(syz[j+1][i][k]-syz[j-2][i][k])+
-                                            b3*(syz[j+2][i][k]-syz[j-3][i][k])+
-                                            b4*(syz[j+3][i][k]-syz[j-4][i][k])+
-                                            b5*(syz[j+4][i][k]-syz[j-5][i][k])+
-                                            b6*(syz[j+5][i][k]-syz[j-6][i][k]));
+                                szz_z = dz*b1*(szz_ji[k+1]-szz_ji[k]);
+                                sxz_x = dx*b1*(sxz_ji[k]-sxz_ji[k-si]);
+                                syz_y = dy*b1*(syz_ji[k]-syz_ji[k-sj]);
                                 
                                 
-                                vz[j][i][k]+= (szz_z + sxz_x + syz_y)/rkp[j][i][k];
+                                vz_ji[k]+= ((szz_z + sxz_x + syz_y)/rkp_ji[k]);
                                 
                             }
                         }
@@ -565,6 +326,10 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     
                     break;
                     
+                default :
+                    err(" update_v_kernel: no kernel for this FDORDER ! ");
+                    break;
+
             }
             break; /* break for FDORDER_TIME=2 */
             
@@ -584,6 +349,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.00100; } /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_i, svx_j_i_2, svx_j_i_3, svy_j, svy_j_2, svy_j_3, svy_j_i, svy_j_i_2, svy_j_i_3, svz_j, svz_j_2, svz_j_3, svz_j_i, svz_j_i_2, svz_j_i_3, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -635,6 +403,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_i, svx_j_i_2, svx_j_i_3, svy_j, svy_j_2, svy_j_3, svy_j_i, svy_j_i_2, svy_j_i_3, svz_j, svz_j_2, svz_j_3, svz_j_i, svz_j_i_2, svz_j_i_3, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -688,6 +459,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_i, svx_j_i_2, svx_j_i_3, svy_j, svy_j_2, svy_j_3, svy_j_i, svy_j_i_2, svy_j_i_3, svz_j, svz_j_2, svz_j_3, svz_j_i, svz_j_i_2, svz_j_i_3, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -765,6 +539,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_i, svx_j_i_2, svx_j_i_3, svy_j, svy_j_2, svy_j_3, svy_j_i, svy_j_i_2, svy_j_i_3, svz_j, svz_j_2, svz_j_3, svz_j_i, svz_j_i_2, svz_j_i_3, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -851,6 +628,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_i, svx_j_i_2, svx_j_i_3, svy_j, svy_j_2, svy_j_3, svy_j_i, svy_j_i_2, svy_j_i_3, svz_j, svz_j_2, svz_j_3, svz_j_i, svz_j_i_2, svz_j_i_3, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -948,6 +728,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_i, svx_j_i_2, svx_j_i_3, svy_j, svy_j_2, svy_j_3, svy_j_i, svy_j_i_2, svy_j_i_3, svz_j, svz_j_2, svz_j_3, svz_j_i, svz_j_i_2, svz_j_i_3, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -975,12 +758,12 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                                             b5*(sxy[j+4][i][k]-sxy[j-5][i][k])+
                                             b6*(sxy[j+5][i][k]-sxy[j-6][i][k]));
                                 
-                                sxz_z = dz*(b1*(sxy[j][i][k]-sxy[j][i][k-1])+
-                                            b2*(sxy[j][i][k+1]-sxy[j][i][k-2])+
-                                            b3*(sxy[j][i][k+2]-sxy[j][i][k-3])+
-                                            b4*(sxy[j][i][k+3]-sxy[j][i][k-4])+
-                                            b5*(sxy[j][i][k+4]-sxy[j][i][k-5])+
-                                            b6*(sxy[j][i][k+5]-sxy[j][i][k-6]));
+                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+
+                                            b2*(sxz[j][i][k+1]-sxz[j][i][k-2])+
+                                            b3*(sxz[j][i][k+2]-sxz[j][i][k-3])+
+                                            b4*(sxz[j][i][k+3]-sxz[j][i][k-4])+
+                                            b5*(sxz[j][i][k+4]-sxz[j][i][k-5])+
+                                            b6*(sxz[j][i][k+5]-sxz[j][i][k-6]));
                                 
                                 syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+
                                             b2*(syy[j+2][i][k]-syy[j-1][i][k])+
@@ -1061,6 +844,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.00100; } /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_4, svx_j_i, svx_j_i_2, svx_j_i_3, svx_j_i_4, svy_j, svy_j_2, svy_j_3, svy_j_4, svy_j_i, svy_j_i_2, svy_j_i_3, svy_j_i_4, svz_j, svz_j_2, svz_j_3, svz_j_4, svz_j_i, svz_j_i_2, svz_j_i_3, svz_j_i_4, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1112,6 +898,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     b1=9.0/8.0; b2=-1.0/24.0; /* Taylor coefficients*/
                     if(FDCOEFF==2){
                         b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_4, svx_j_i, svx_j_i_2, svx_j_i_3, svx_j_i_4, svy_j, svy_j_2, svy_j_3, svy_j_4, svy_j_i, svy_j_i_2, svy_j_i_3, svy_j_i_4, svz_j, svz_j_2, svz_j_3, svz_j_4, svz_j_i, svz_j_i_2, svz_j_i_3, svz_j_i_4, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1163,6 +952,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     b1=75.0/64.0; b2=-25.0/384.0; b3=3.0/640.0; /* Taylor coefficients*/
                     if(FDCOEFF==2){
                         b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_4, svx_j_i, svx_j_i_2, svx_j_i_3, svx_j_i_4, svy_j, svy_j_2, svy_j_3, svy_j_4, svy_j_i, svy_j_i_2, svy_j_i_3, svy_j_i_4, svz_j, svz_j_2, svz_j_3, svz_j_4, svz_j_i, svz_j_i_2, svz_j_i_3, svz_j_i_4, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1240,6 +1032,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_4, svx_j_i, svx_j_i_2, svx_j_i_3, svx_j_i_4, svy_j, svy_j_2, svy_j_3, svy_j_4, svy_j_i, svy_j_i_2, svy_j_i_3, svy_j_i_4, svz_j, svz_j_2, svz_j_3, svz_j_4, svz_j_i, svz_j_i_2, svz_j_i_3, svz_j_i_4, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1327,6 +1122,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_4, svx_j_i, svx_j_i_2, svx_j_i_3, svx_j_i_4, svy_j, svy_j_2, svy_j_3, svy_j_4, svy_j_i, svy_j_i_2, svy_j_i_3, svy_j_i_4, svz_j, svz_j_2, svz_j_3, svz_j_4, svz_j_i, svz_j_i_2, svz_j_i_3, svz_j_i_4, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1426,6 +1224,9 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                     if(FDCOEFF==2){
                         b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
                     
+#ifdef _OPENMP
+#pragma omp parallel for private(i, k, svx_j, svx_j_2, svx_j_3, svx_j_4, svx_j_i, svx_j_i_2, svx_j_i_3, svx_j_i_4, svy_j, svy_j_2, svy_j_3, svy_j_4, svy_j_i, svy_j_i_2, svy_j_i_3, svy_j_i_4, svz_j, svz_j_2, svz_j_3, svz_j_4, svz_j_i, svz_j_i_2, svz_j_i_3, svz_j_i_4, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
                     for (j=ny1;j<=ny2;j++){
                         svx_j=*(svx+j);svy_j=*(svy+j);svz_j=*(svz+j);
                         svx_j_2=*(svx_2+j);svy_j_2=*(svy_2+j);svz_j_2=*(svz_2+j);
@@ -1453,12 +1254,12 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                                             b5*(sxy[j+4][i][k]-sxy[j-5][i][k])+
                                             b6*(sxy[j+5][i][k]-sxy[j-6][i][k]));
                                 
-                                sxz_z = dz*(b1*(sxy[j][i][k]-sxy[j][i][k-1])+
-                                            b2*(sxy[j][i][k+1]-sxy[j][i][k-2])+
-                                            b3*(sxy[j][i][k+2]-sxy[j][i][k-3])+
-                                            b4*(sxy[j][i][k+3]-sxy[j][i][k-4])+
-                                            b5*(sxy[j][i][k+4]-sxy[j][i][k-5])+
-                                            b6*(sxy[j][i][k+5]-sxy[j][i][k-6]));
+                                sxz_z = dz*(b1*(sxz[j][i][k]-sxz[j][i][k-1])+
+                                            b2*(sxz[j][i][k+1]-sxz[j][i][k-2])+
+                                            b3*(sxz[j][i][k+2]-sxz[j][i][k-3])+
+                                            b4*(sxz[j][i][k+3]-sxz[j][i][k-4])+
+                                            b5*(sxz[j][i][k+4]-sxz[j][i][k-5])+
+                                            b6*(sxz[j][i][k+5]-sxz[j][i][k-6]));
                                 
                                 syy_y = dy*(b1*(syy[j+1][i][k]-syy[j][i][k])+
                                             b2*(syy[j+2][i][k]-syy[j-1][i][k])+
@@ -1525,12 +1326,32 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
             break; /* break for FDORDER_TIME=4 */
             
     }
-    
+}
+
+
+/**
+ * Add the body forces of the sources located at the grid points
+ * [nx1...nx2][ny1...ny2][nz1...nz2] to the particle velocities.
+ */
+void update_v_point_forces(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        int nt, Velocity *v, float  *** rjp, float  *** rkp, float  *** rip,
+        float **  srcpos_loc, float ** signals, int nsrc, int * stype) {
+
+    float ***vx = v->x;
+    float ***vy = v->y;
+    float ***vz = v->z;
+
+    extern float DT, DX, DY, DZ, SOURCE_ALPHA, SOURCE_BETA;
+
+    int i, j, k, l;
+    float  amp, alpha_rad, beta_rad;
+
     /* Adding body force components to corresponding particle velocities */
     for (l=1;l<=nsrc;l++) {
         i=(int)srcpos_loc[1][l];
         j=(int)srcpos_loc[2][l];
         k=(int)srcpos_loc[3][l];
+        if ((i<nx1) || (i>nx2) || (j<ny1) || (j>ny2) || (k<nz1) || (k>nz2)) continue;
         amp=(DT*signals[l][nt])/(DX*DY*DZ);// scaled force amplitude with F= 1N
         
         switch (stype[l]){
@@ -1554,11 +1375,46 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
                 break;
         }
     }
+}
+
+
+/**
+ * Add the body forces of all sources of the subdomain, and of those in the
+ * ghost zones if the box extends into them (HALO_DEEP), to the particle
+ * velocities and apply the exponential damping of the absorbing frame
+ * (ABS_TYPE=2) to all wavefield components at the grid points
+ * [nx1...nx2][ny1...ny2][nz1...nz2].
+ */
+void update_v_body_forces(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+        int nt, Velocity *v, Tensor3d *s, float  *** rjp, float  *** rkp, float  *** rip,
+        float **  srcpos_loc, float ** signals, int nsrc, float *** absorb_coeff, int * stype) {
+
+    float ***vx = v->x;
+    float ***vy = v->y;
+    float ***vz = v->z;
+
+    float ***sxx = s->xx;
+    float ***syy = s->yy;
+    float ***szz = s->zz;
+    float ***sxy = s->xy;
+    float ***syz = s->yz;
+    float ***sxz = s->xz;
+
+    extern int ABS_TYPE, NX, NY, NZ;
+
+    int i, j, k;
+
+    update_v_point_forces(min(nx1, 1), max(nx2, NX), min(ny1, 1), max(ny2, NY), min(nz1, 1), max(nz2, NZ),
+            nt, v, rjp, rkp, rip,
+            srcpos_loc, signals, nsrc, stype);
     
     
     /* absorbing boundary condition (exponential damping) */
     
     if (ABS_TYPE==2){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k)
+#endif
         for (j=ny1;j<=ny2;j++){
             for (i=nx1;i<=nx2;i++){
                 for (k=nz1;k<=nz2;k++){
@@ -1576,14 +1432,4 @@ double update_v(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
             }
         }
     }
-    
-    if (LOG) {
-        time2=MPI_Wtime();
-        time=time2-time1;
-        if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) {
-            fprintf(FP," Real time for particle velocity update: \t %4.2f s.\n",time);
-        }
-    }
-
-    return time;
 }
@@ -132,6 +132,9 @@ double update_v_CPML(
 	/* boundaries in x-direction */
 
 	if (POS[1]==0){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, h1, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
@@ -214,6 +217,9 @@ double update_v_CPML(
 	}
 
 	if(POS[1]==NPROCX-1){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, h1, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
@@ -297,6 +303,9 @@ double update_v_CPML(
 	}
 
 	if((POS[2]==0 && FREE_SURF==0)){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, h1, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
@@ -359,6 +368,9 @@ double update_v_CPML(
 	}
 
 	if(POS[2]==NPROCY-1){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, h1, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
@@ -422,6 +434,9 @@ double update_v_CPML(
 	/* boundaries in z-direction */
 
 	if(POS[3]==0){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
@@ -464,6 +479,9 @@ double update_v_CPML(
 	}
 
 	if(POS[3]==NPROCZ-1){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, h1, sxx_x, sxy_x, sxy_y, sxz_x, sxz_z, syy_y, syz_y, syz_z, szz_z)
+#endif
 #ifdef _OPENACC
 #pragma acc parallel 
 #pragma acc loop independent
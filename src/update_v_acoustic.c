@@ -10,20 +10,27 @@
 #include "globvar.h"
 
 
-double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
-		int nt, Velocity *v, float *** sxx, float  ***  rho, float **  srcpos_loc, float ** signals, int nsrc,
-		float *** absorb_coeff, int * stype){
-
-
-	extern float DT, DX, DY, DZ, SOURCE_ALPHA, SOURCE_BETA;
-	extern int MYID, FDORDER, ABS_TYPE, LOG, FDCOEFF;
-	extern int OUTNTIMESTEPINFO;
+/*
+ * Finite-difference part of `update_v_acoustic` for the grid points
+ * [nx1...nx2][ny1...ny2][nz1...nz2].
+ */
+void update_v_acoustic_kernel(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+		Velocity *v, float *** sxx, float  ***  rho){
+
+	/* update boxes larger than a tile tile by tile (see tile.c) */
+	int t[6];
+	if (tile_first(nx1, nx2, ny1, ny2, nz1, nz2, t)) {
+		do
+			update_v_acoustic_kernel(t[0], t[1], t[2], t[3], t[4], t[5], v, sxx, rho);
+		while (tile_next(nx1, nx2, ny1, ny2, nz1, nz2, t));
+		return;
+	}
 
-	extern FILE *FP;
+	extern float DT, DX, DY, DZ;
+	extern int FDORDER, FDCOEFF;
 
-	register int i, j, k, l;
-	float  amp, alpha_rad, beta_rad, rjp, rkp, rip;
-	double time=0.0, time1=0.0, time2=0.0;
+	register int i, j, k;
+	float rjp, rkp, rip;
 	register float b1, b2, b3, b4, b5, b6, dx, dy, dz;
 	register float sxx_x, syy_y, szz_z;
 
@@ -31,15 +38,15 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
         float ***vy = v->y;
         float ***vz = v->z;
 
-	if (LOG)
-		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
-
 	switch (FDORDER){
 	case 2 :
 		dx=DT/DX;
 		dy=DT/DY;
 		dz=DT/DZ;
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, rip, rjp, rkp)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -66,6 +73,9 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		if(FDCOEFF==2){
 			b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -99,6 +109,9 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		if(FDCOEFF==2){
 			b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -135,6 +148,9 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		if(FDCOEFF==2){
 			b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -174,6 +190,9 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		if(FDCOEFF==2){
 			b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -221,6 +240,9 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		if(FDCOEFF==2){
 			b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -262,6 +284,32 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 		err(" error in particle velocity update: wrong FDORDER. ");
 		break;
 	} /* end of switch (FDORDER) */
+}
+
+
+double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
+		int nt, Velocity *v, float *** sxx, float  ***  rho, float **  srcpos_loc, float ** signals, int nsrc,
+		float *** absorb_coeff, int * stype){
+
+
+	extern float DT, DX, DY, DZ, SOURCE_ALPHA, SOURCE_BETA;
+	extern int MYID, ABS_TYPE, LOG;
+	extern int OUTNTIMESTEPINFO;
+
+	extern FILE *FP;
+
+	register int i, j, k, l;
+	float  amp, alpha_rad, beta_rad;
+	double time=0.0, time1=0.0, time2=0.0;
+
+        float ***vx = v->x;
+        float ***vy = v->y;
+        float ***vz = v->z;
+
+	if (LOG)
+		if ((MYID==0) && ((nt+(OUTNTIMESTEPINFO-1))%OUTNTIMESTEPINFO)==0) time1=MPI_Wtime();
+
+	update_v_acoustic_kernel(nx1, nx2, ny1, ny2, nz1, nz2, v, sxx, rho);
 
 
 	/* Adding body force components to corresponding particle velocities */
@@ -304,6 +352,9 @@ double update_v_acoustic(int nx1, int nx2, int ny1, int ny2, int nz1, int nz2,
 	/* absorbing boundary condition (exponential damping) */
 
 	if (ABS_TYPE==2){
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
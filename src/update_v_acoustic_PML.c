@@ -42,6 +42,9 @@ double update_v_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 	case 2 :
 
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, rip, rjp, rkp)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -79,6 +82,9 @@ double update_v_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 		if(FDCOEFF==2){
 			b1=1.1382; b2=-0.046414;} /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 			for (j=ny1;j<=ny2;j++){
 				for (i=nx1;i<=nx2;i++){
 					for (k=nz1;k<=nz2;k++){
@@ -124,6 +130,9 @@ double update_v_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 		if(FDCOEFF==2){
 			b1=1.1965; b2=-0.078804; b3=0.0081781;}   /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -171,6 +180,9 @@ double update_v_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 		if(FDCOEFF==2){
 			b1=1.2257; b2=-0.099537; b3=0.018063; b4=-0.0026274;} /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -221,6 +233,9 @@ double update_v_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 		if(FDCOEFF==2){
 			b1=1.2415; b2=-0.11231; b3=0.026191; b4=-0.0064682; b5=0.001191;} /* Holberg coefficients E=0.1 %*/
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -279,6 +294,9 @@ double update_v_acoustic_PML(int nx1, int nx2, int ny1, int ny2, int nz1, int nz
 		if(FDCOEFF==2){
 			b1=1.2508; b2=-0.12034; b3=0.032131; b4=-0.010142; b5=0.0029857; b6=-0.00066667;}
 
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) private(i, k, PML1, PML2, rip, rjp, rkp, sxx_x, syy_y, szz_z)
+#endif
 		for (j=ny1;j<=ny2;j++){
 			for (i=nx1;i<=nx2;i++){
 				for (k=nz1;k<=nz2;k++){
@@ -364,6 +364,60 @@ float ***f3tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh){
 }
 
 
+// Alignment (in bytes) of the rows of the tensors allocated by
+// `f3tensor_aligned`; 64 bytes is one cache line and one AVX-512 register.
+#define F3_ALIGN 64
+
+static int f3tensor_lead(int ndl) {
+	/* number of padding elements in front of each row, so that element
+	   with index 1 (the first interior grid point) is aligned */
+	int nalign = F3_ALIGN / sizeof(float);
+
+	if (ndl > 1) return 0;
+	return (nalign - (1 - ndl) % nalign) % nalign;
+}
+
+float ***f3tensor_aligned(int nrl, int nrh, int ncl, int nch, int ndl, int ndh){
+	/* allocate a float 3tensor with subscript range m[nrl..nrh][ncl..nch][ndl..ndh]
+	   like f3tensor(), but
+	   - pointer tables and data are one allocation aligned to F3_ALIGN bytes,
+	   - each row along the last index is padded to a multiple of F3_ALIGN
+	     bytes and m[j][i][1] is aligned for every j and i,
+	   so that the distance between m[j][i][k] and m[j+dj][i+di][k] is the
+	   same for all tensors with the same bounds in the last two indices.
+	   Padding elements are set to zero and never used. */
+	int i, j, nrow=nrh-nrl+1, ncol=nch-ncl+1;
+	int nalign = F3_ALIGN / sizeof(float), lead = f3tensor_lead(ndl);
+	size_t ndep = ((size_t) (lead + ndh - ndl + 1) + nalign - 1) / nalign * nalign;
+	size_t ndata = (size_t) nrow * ncol * ndep, n;
+	size_t ntab = (size_t) (nrow + 1) * sizeof(float **) + (size_t) nrow * ncol * sizeof(float *);
+	float ***t, **rows, *data;
+	char *block;
+
+	/* address of the block, pointer tables, then data at the next aligned
+	   address; the address is kept for free_f3tensor_aligned() */
+	ntab = (ntab + F3_ALIGN - 1) / F3_ALIGN * F3_ALIGN;
+	block = (char *) aligned_alloc(F3_ALIGN, ntab + ndata * sizeof(float));
+	if (!block) err("allocation failure in function f3tensor_aligned() ");
+	*(void **) block = block;
+	t = (float ***) block + 1;
+	rows = (float **) (t + nrow);
+	data = (float *) (block + ntab);
+
+	t -= nrl;
+	for (j=nrl;j<=nrh;j++){
+		t[j] = rows + (size_t) (j - nrl) * ncol - ncl;
+		for (i=ncl;i<=nch;i++)
+			t[j][i] = data + ((size_t) (j - nrl) * ncol + (i - ncl)) * ndep + lead - ndl;
+	}
+
+	/* initializing 3tensor including the padding */
+	for (n=0;n<ndata;n++) data[n]=0.0;
+
+	return t;
+}
+
+
 int ***i3tensor(int nrl, int nrh, int ncl, int nch,int ndl, int ndh){
 	/* allocate a integer 3tensor with subscript range m[nrl..nrh][ncl..nch][ndl..ndh]
 		   and intializing the matrix, e.g. m[nrl..nrh][ncl..nch][ndl..ndh]=0.0 */
@@ -515,6 +569,14 @@ void free_f3tensor(float ***t,
 	free((FREE_ARG) (t+nrl-NR_END));
 }
 
+void free_f3tensor_aligned(float ***t,
+        int nrl, int nrh ATTR_UNUSED,
+        int ncl ATTR_UNUSED, int nch ATTR_UNUSED,
+        int ndl ATTR_UNUSED, int ndh ATTR_UNUSED) {
+	/* free a float tensor allocated by f3tensor_aligned() */
+	free(*((void **) (t + nrl) - 1));
+}
+
 void free_i3tensor(int ***t,
         int nrl, int nrh ATTR_UNUSED,
         int ncl, int nch ATTR_UNUSED,
@@ -0,0 +1,50 @@
+/*------------------------------------------------------------------------
+ * Update coefficients of the viscoelastic stress update
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/**
+ * Compute the coefficients of the viscoelastic stress update (L=1) once
+ * after the averaging of the material parameters, see `av_mat`.
+ * The expressions are those formerly evaluated in `update_s` at every
+ * grid point and time step, so the results do not change.
+ *
+ *  pi :
+ *      P-wave modulus ($\lambda + 2\mu$).
+ *  u :
+ *      Shear modulus ($\mu$).
+ *  uipjp, ujpkp, uipkp :
+ *      Shifts of the shear modulus due to the staggered grid.
+ *  taus, tausipjp, tausjpkp, tausipkp, taup, eta :
+ *      Parameters of the relaxation mechanism.
+ */
+void visco_coeff(ViscoPar *vp, float ***pi, float ***u,
+        float ***uipjp, float ***ujpkp, float ***uipkp,
+        float ***taus, float ***tausipjp, float ***tausjpkp, float ***tausipkp,
+        float ***taup, float *eta) {
+
+	extern int NX, NY, NZ, L;
+	extern float DT;
+	int i, j, k, l = 1;
+
+	for (j=1;j<=NY;j++){
+		for (i=1;i<=NX;i++){
+			for (k=1;k<=NZ;k++){
+				vp->fipjp[j][i][k]=uipjp[j][i][k]*DT*(1.0+L*tausipjp[j][i][k]);
+				vp->fjpkp[j][i][k]=ujpkp[j][i][k]*DT*(1.0+L*tausjpkp[j][i][k]);
+				vp->fipkp[j][i][k]=uipkp[j][i][k]*DT*(1.0+L*tausipkp[j][i][k]);
+				vp->g[j][i][k]=pi[j][i][k]*(1.0+L*taup[j][i][k]);
+				vp->f[j][i][k]=2.0*u[j][i][k]*(1.0+L*taus[j][i][k]);
+				vp->dipjp[j][i][k]=uipjp[j][i][k]*eta[l]*tausipjp[j][i][k];
+				vp->djpkp[j][i][k]=ujpkp[j][i][k]*eta[l]*tausjpkp[j][i][k];
+				vp->dipkp[j][i][k]=uipkp[j][i][k]*eta[l]*tausipkp[j][i][k];
+				vp->d[j][i][k]=2.0*u[j][i][k]*eta[l]*taus[j][i][k];
+				vp->e[j][i][k]=pi[j][i][k]*eta[l]*taup[j][i][k];
+			}
+		}
+	}
+}
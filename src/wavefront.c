@@ -0,0 +1,145 @@
+/*------------------------------------------------------------------------
+ *   Fused sweep: velocity and stress update of one time step in one sweep
+ *   (FUSED_SWEEP=1).  Only the two half steps of a single time step are
+ *   fused; the velocities are still exchanged between them, so the number
+ *   of messages per time step does not change (see HALO_DEEP for that).
+ *
+ *   Usually every wavefield is streamed through the memory twice per time
+ *   step, once by the velocity and once by the stress update.  Instead, the
+ *   velocity box vbox is swept in slabs of FDORDER/2 planes along y, and
+ *   after each slab the stress is updated in the planes of the inner box
+ *   sbox that no longer depend on velocities still to be updated, i.e. the
+ *   stress lags FDORDER/2 planes behind the velocity wavefront:
+ *
+ *       int w[4];
+ *       if (wavefront_first(vbox, sbox, w)) {
+ *           do {
+ *               velocity update of [vbox x][w[0]...w[1]][vbox z];
+ *               if (w[3] >= w[2])
+ *                   stress update of [sbox x][w[2]...w[3]][sbox z];
+ *           } while (wavefront_next(vbox, sbox, w));
+ *       }
+ *
+ *   The planes read by both updates are thus still in the cache.  sbox
+ *   keeps FDORDER/2 points distance from the halo, from velocities outside
+ *   vbox and from the absorbing frames, so the results do not differ from
+ *   those of the separate updates: the rest of the stress is updated as
+ *   usual after the exchange of the velocities.  Consecutive time steps are
+ *   not fused as the halo is only FDORDER/2 points deep.
+ *
+ *  ----------------------------------------------------------------------*/
+
+#include "fd.h"
+#include "globvar.h"
+
+
+/**
+ * Boxes of the fused update.
+ *
+ * fbox[0] is the box vbox swept by the velocity update: the inner box of
+ * `halo_split` with OVERLAP_COMM, else the box xb, yb, zb.  fbox[1]...fbox[6]
+ * cover the rest of the local grid (body forces of sources located there
+ * are added after the sweep).  sbox[0] is the box of stress values updated
+ * during the sweep, sbox[1]...sbox[6] cover the rest of xb, yb, zb.
+ */
+void wavefront_ini(int *xb, int *yb, int *zb, int sbox[7][6], int fbox[7][6])
+{
+	extern int FUSED_SWEEP, OVERLAP_COMM, ABS_TYPE, FDORDER, FW;
+	extern int BOUNDARY, FREE_SURF, NX, NY, NZ, NPROCX, NPROCY, NPROCZ, POS[4], MYID;
+	extern FILE *FP;
+
+	int hw = FDORDER / 2, gx[2] = {1, NX}, gy[2] = {1, NY}, gz[2] = {1, NZ};
+	int *b[3] = {xb, yb, zb}, lo[3], hi[3], frame_lo[3] = {0, 0, 0}, frame_hi[3] = {0, 0, 0};
+	int n;
+
+	if (!FUSED_SWEEP)
+		return;
+
+	if (OVERLAP_COMM)
+		halo_split(xb, yb, zb, hw, fbox);
+	else
+		for (n = 0; n < 3; n++) {
+			fbox[0][2 * n] = b[n][0];
+			fbox[0][2 * n + 1] = b[n][1];
+		}
+	halo_shell(gx, gy, gz, fbox);
+
+	/* absorbing frame with exponential damping, see absorb.c */
+	if (ABS_TYPE == 2) {
+		frame_lo[0] = (!BOUNDARY) && (POS[1] == 0);
+		frame_hi[0] = (!BOUNDARY) && (POS[1] == NPROCX - 1);
+		frame_lo[1] = (POS[2] == 0) && (!FREE_SURF);
+		frame_hi[1] = (POS[2] == NPROCY - 1);
+		frame_lo[2] = (!BOUNDARY) && (POS[3] == 0);
+		frame_hi[2] = (!BOUNDARY) && (POS[3] == NPROCZ - 1);
+	}
+
+	for (n = 0; n < 3; n++) {
+		lo[n] = fbox[0][2 * n] + hw;
+		hi[n] = fbox[0][2 * n + 1] - hw;
+		if (frame_lo[n])
+			lo[n] = max(lo[n], FW + 1 + hw);
+		if (frame_hi[n])
+			hi[n] = min(hi[n], (n == 0 ? NX : (n == 1 ? NY : NZ)) - FW - hw);
+
+		/* clamped so that b[0] <= lo <= hi+1 <= b[1]+1 like in halo_split */
+		sbox[0][2 * n] = min(lo[n], b[n][1] + 1);
+		sbox[0][2 * n + 1] = max(min(hi[n], b[n][1]), sbox[0][2 * n] - 1);
+	}
+
+	/* an empty box is made empty in y, the direction of the sweep */
+	if ((sbox[0][1] < sbox[0][0]) || (sbox[0][5] < sbox[0][4]))
+		sbox[0][3] = sbox[0][2] - 1;
+	halo_shell(xb, yb, zb, sbox);
+
+	if (MYID == 0)
+		fprintf(FP, " Velocity and stress of %d x %d x %d grid points are updated in one sweep.\n",
+				max(sbox[0][1] - sbox[0][0] + 1, 0), max(sbox[0][3] - sbox[0][2] + 1, 0),
+				max(sbox[0][5] - sbox[0][4] + 1, 0));
+}
+
+/* stress planes that may be updated after the velocity slab w[0]...w[1] */
+static void wavefront_set(int *vbox, int *sbox, int *w)
+{
+	extern int FDORDER;
+
+	w[2] = w[3] + 1;
+	w[3] = (w[1] < vbox[3]) ? min(w[1] - FDORDER / 2, sbox[3]) : sbox[3];
+	w[3] = max(w[3], w[2] - 1);
+}
+
+/**
+ * First slabs w = {vy1, vy2, sy1, sy2} of the sweep over vbox and sbox.
+ * The stress slab may be empty (sy2 < sy1).
+ *
+ * Returns 0 if FUSED_SWEEP is off or vbox is empty.
+ */
+int wavefront_first(int *vbox, int *sbox, int *w)
+{
+	extern int FUSED_SWEEP, FDORDER;
+
+	if (!FUSED_SWEEP || (vbox[1] < vbox[0]) || (vbox[3] < vbox[2]) || (vbox[5] < vbox[4]))
+		return 0;
+
+	w[0] = vbox[2];
+	w[1] = min(vbox[2] + max(FDORDER / 2, 1) - 1, vbox[3]);
+	w[3] = sbox[2] - 1;
+	wavefront_set(vbox, sbox, w);
+	return 1;
+}
+
+/**
+ * Advance w to the next slabs.  Returns 0 after the last ones.
+ */
+int wavefront_next(int *vbox, int *sbox, int *w)
+{
+	extern int FDORDER;
+
+	if (w[1] >= vbox[3])
+		return 0;
+
+	w[0] = w[1] + 1;
+	w[1] = min(w[0] + max(FDORDER / 2, 1) - 1, vbox[3]);
+	wavefront_set(vbox, sbox, w);
+	return 1;
+}
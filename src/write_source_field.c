@@ -28,7 +28,10 @@ void write_source_field(
     // External (global) variables.
     extern int NX, NY, NZ, POS[4], IDX, IDY, IDZ;
 
-    int i, j, k;
+    // Number of values of a grid plane written at once.
+    const int nplane = ((NX - 1) / IDX + 1) * ((NY - 1) / IDY + 1);
+    int i, j, k, n;
+    float *plane;
     FILE *fp;
     char file[STRING_SIZE];
 
@@ -38,13 +41,17 @@ void write_source_field(
         err2("Cannot open file %s for writing\n", source_field_file);
     }
 
+    plane = vector(0, nplane - 1);
     for (k = 1; k <= NZ; k += IDZ) {
+        n = 0;
         for (i = 1; i <= NX; i += IDX) {
             for (j = 1; j <= NY; j += IDY) {
-                writedsk(fp, s[j][i][k], format);
+                plane[n++] = s[j][i][k];
             }
         }
+        writedsk_block(fp, plane, nplane, format);
     }
 
+    free_vector(plane, 0, nplane - 1);
     fclose(fp);
 }
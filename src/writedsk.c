@@ -4,6 +4,9 @@
 
 #include "fd.h"
 
+/* size of the buffer for formatting ASCII output in writedsk_block */
+#define WRITEDSK_ASCII_BUFFER 65536
+
 /*
 different data formats of output:
 format=1  :  SU (IEEE)
@@ -33,3 +36,50 @@ void writedsk(FILE *fp_out, float amp, int format){
 			err(" No output was written. ");
 	}
 }
+
+
+/*
+ * Write the `n` amplitudes a[0..n-1] in one of the formats of `writedsk`.
+ * Binary data are written with a single call and ASCII data are formatted
+ * into a buffer that is written in large chunks, so callers should pass
+ * whole columns or planes instead of calling `writedsk` for each value.
+ * The output is the same as that of `writedsk`.  With format 6 (not
+ * available in `writedsk`), the values are written as one compressed
+ * record with the error bound COMPRESS_TOL, see compress.c.
+ */
+void writedsk_block(FILE *fp_out, const float *a, int n, int format){
+
+	extern float COMPRESS_TOL;
+	extern int COMPRESS_REL;
+
+	char buf[WRITEDSK_ASCII_BUFFER];
+	int i, len = 0;
+
+	switch(format){
+		case 1 : /* SU*/
+			err(" Sorry, SU-format for snapshots not implemented yet. \n");
+			break;
+		case 2 :  /*ASCII*/
+			for (i=0;i<n;i++){
+				/* "%e\n" of a float needs at most 16 characters */
+				if (len > WRITEDSK_ASCII_BUFFER - 32){
+					fwrite(buf, 1, len, fp_out);
+					len = 0;
+				}
+				len += sprintf(buf + len, "%e\n", a[i]);
+			}
+			fwrite(buf, 1, len, fp_out);
+			break;
+		case 3 :   /* BINARY */
+			if (fwrite(a, sizeof(float), n, fp_out) != (size_t) n)
+				err(" Could not write %d amplitudes to disk. ", n);
+			break;
+		case 6 :   /* compressed */
+			compress_write(fp_out, a, n, COMPRESS_TOL, COMPRESS_REL);
+			break;
+
+		default :
+			printf(" Don't know the format for the snapshot-data !\n");
+			err(" No output was written. ");
+	}
+}
@@ -1,3 +1,4 @@
+#include "enum.h"
 #include "fd.h"
 #include "globvar.h"
 
@@ -13,7 +14,8 @@
  * q :
  *     Quantity being written to file (density, stiffness elements, etc.).
  * format :
- *     File format.
+ *     File format.  With MODEL_COMPRESS=1, binary files are written
+ *     compressed (format 6) and decompressed again by `mergemod`.
  *
  * See also
  * --------
@@ -22,9 +24,12 @@
  */
 void writemod(char modfile[STRING_SIZE], float ***q, int format) {
     // External (global) variables.
-    extern int NX, NY, NZ, POS[4], IDX, IDY, IDZ;
+    extern int NX, NY, NZ, POS[4], IDX, IDY, IDZ, MODEL_COMPRESS;
 
-    int i, j, k;
+    // Number of values of a grid plane written at once.
+    const int nplane = ((NX - 1) / IDX + 1) * ((NY - 1) / IDY + 1);
+    int i, j, k, n;
+    float *plane;
     FILE *fpmod;
     char file[STRING_SIZE];
 
@@ -32,13 +37,19 @@ void writemod(char modfile[STRING_SIZE], float ***q, int format) {
     sprintf(file, "%s.%i%i%i", modfile, POS[1], POS[2], POS[3]);
     /*printf("\t%s\n\n", file);*/
     fpmod = fopen(file, "w");
+    if (MODEL_COMPRESS && (format == FILE_FORMAT_BINARY))
+        format = FILE_FORMAT_COMPRESSED;
+    plane = vector(0, nplane - 1);
     for (k = 1; k <= NZ; k += IDZ) {
+        n = 0;
         for (i = 1; i <= NX; i += IDX) {
             for (j = 1; j <= NY; j += IDY) {
-                writedsk(fpmod, q[j][i][k], format);
+                plane[n++] = q[j][i][k];
             }
         }
+        writedsk_block(fpmod, plane, nplane, format);
     }
 
+    free_vector(plane, 0, nplane - 1);
     fclose(fpmod);
 }
@@ -13,7 +13,8 @@ void writepar(FILE *fp, int ns){
 
 	/* declaration of extern variables */
 	extern int   NX, NY, NZ, NT, SOURCE_SHAPE, SOURCE_TYPE, FDORDER,FDORDER_TIME, RUN_MULTIPLE_SHOTS, NDT;
-	extern int  SNAP, SNAP_FORMAT, REC_ARRAY, L, SNAP_PLANE,FW;
+	extern int  SNAP, SNAP_FORMAT, REC_ARRAY, L, SNAP_PLANE,FW, COMPRESS_REL;
+	extern float COMPRESS_TOL;
 	extern float DX, DY, DZ, TIME, DT, TS, *FL, TAU, PLANE_WAVE_DEPTH;
 	extern float XREC1, XREC2, YREC1, YREC2, ZREC1, ZREC2;
 	extern float SOURCE_ALPHA, SOURCE_BETA, AMON, STR, DIP, RAKE;
@@ -25,6 +26,7 @@ void writepar(FILE *fp, int ns){
 	extern char SNAP_FILE[STRING_SIZE], SOURCE_FILE[STRING_SIZE], SIGNAL_FILE[STRING_SIZE], REC_FILE[STRING_SIZE], SEIS_FILE[STRING_SIZE];
 	extern char  MFILE[STRING_SIZE];
 	extern int NP, NPROCX, NPROCY, NPROCZ, MYID;
+	extern int OVERLAP_COMM, HALO_DATATYPE, PERSISTENT_COMM, HALO_SHM, HALO_DEEP;
 	
 	/* definition of local variables */
 	char th1[3], file_ext[8];
@@ -42,6 +44,16 @@ void writepar(FILE *fp, int ns){
 	fprintf(fp," Number of PEs in horizontal y-direction (NPROCY): %d\n",NPROCY);
 	fprintf(fp," Number of PEs in vertical   z-direction (NPROCZ): %d\n",NPROCZ);
 	fprintf(fp," Total number of PEs in use: %d\n",NP);
+	if (OVERLAP_COMM)
+		fprintf(fp," Halo exchange overlapped with the update of the interior (OVERLAP_COMM).\n");
+	if (HALO_DATATYPE)
+		fprintf(fp," Halo exchanged with MPI derived datatypes, no buffers (HALO_DATATYPE).\n");
+	if (PERSISTENT_COMM)
+		fprintf(fp," Halo exchanged with persistent requests (PERSISTENT_COMM).\n");
+	if (HALO_SHM)
+		fprintf(fp," Halo exchanged through the shared memory of the nodes (HALO_SHM).\n");
+	if (HALO_DEEP>1)
+		fprintf(fp," Deep halo exchanged every %d time steps (HALO_DEEP).\n",HALO_DEEP);
 	fprintf(fp,"\n");
 	fprintf(fp," ----------------------- Discretization  ---------------------\n");
 	fprintf(fp," Number of gridpoints in x-direction (NX): %i\n", NX);
@@ -267,6 +279,10 @@ void writepar(FILE *fp, int ns){
 		case 3 :
 			fprintf(fp," The data is written binary (IEEE) (4 byte per float)");
 			break;
+		case 6 :
+			fprintf(fp," The data is written compressed with an error of at most %g%s",
+				COMPRESS_TOL, COMPRESS_REL ? " times the largest amplitude of a plane" : "");
+			break;
 		default:
 			err(" Don't know the format for the Snapshot-data ! \n");
 		}
@@ -88,8 +88,8 @@ def get_datasets(filename1, filename2):
 
         data1 = np.fromfile(filename1, dtype=np.float32)
         data2 = np.fromfile(filename2, dtype=np.float32)
-        data1.reshape((NY / IDY, NX / IDX, NZ / IDZ, nsnap))
-        data2.reshape((NY / IDY, NX / IDX, NZ / IDZ, nsnap))
+        data1.reshape((NY // IDY, NX // IDX, NZ // IDZ, nsnap))
+        data2.reshape((NY // IDY, NX // IDX, NZ // IDZ, nsnap))
     else:
         raise Exception('Cannot determine dataset format!')
 
@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+# Regression test 19.
+# Same setup as test 15, but the snapshots are written compressed
+# (SNAP_FORMAT=6) with the error bound COMPRESS_TOL=1e-3 relative to the
+# largest amplitude of each grid plane and decompressed by snapmerge.
+# The result must agree within the error bound, and the compressed files
+# must take less than half of the space of the binary snapshots.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_15"
+readonly TEST_ID="TEST_19"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+# Copy test model and switch on the compressed snapshots.
+cp "${TEST_PATH}/asofi3D.json"   tmp/in_and_out
+cp "${TEST_PATH}/source.dat"     tmp/sources/
+sed -i 's/"SNAP_FORMAT" : "3",/"SNAP_FORMAT" : "6",\n\t"COMPRESS_TOL" : "1e-3",\n\t"COMPRESS_REL" : "1",/' \
+    tmp/in_and_out/asofi3D.json
+
+compile_code
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+
+# Read the files.
+# Compare with the old output, the error bound is 1e-3 times the largest
+# amplitude 1.36e-8 of the snapshot plus rounding.
+tests/compare_datasets.py \
+    tmp/snap/test.bin.div ${TEST_PATH}/snap/test.bin.div \
+    --rtol=0 --atol=1.37e-11
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Snapshots .div differ"
+fi
+
+# Compare the size of the compressed files of the PEs with the binary file.
+size_cmp=$(cat tmp/snap/test.cmp.div.* | wc -c)
+size_bin=$(wc -c < ${TEST_PATH}/snap/test.bin.div)
+if [ "$(( 2 * size_cmp ))" -ge "$size_bin" ]; then
+    error "Compressed snapshots .div take ${size_cmp} of ${size_bin} bytes"
+fi
+
+log "PASS"
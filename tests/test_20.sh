@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+# Regression test 20.
+# The vectorized conversion of the seismogram samples (byte swap and
+# IEEE/IBM floats in rwsegy.c) must give the same results as the scalar
+# loops.  The microbenchmark segybench exits with an error otherwise.
+. tests/functions.sh
+
+readonly TEST_ID="TEST_20"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+log "Compiling 'segybench'. See tmp/make.log for details"
+make --directory=src segybench > tmp/make.log
+if [ "$?" -ne 0 ]; then
+    error "Compilation of segybench failed"
+fi
+
+# An odd number of samples, so that the scalar loops convert the remainder.
+bin/segybench 100003 1 > tmp/log/segybench.log
+if [ "$?" -ne 0 ]; then
+    error "Vectorized conversion differs from the scalar loops"
+fi
+
+log "PASS"
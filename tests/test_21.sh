@@ -0,0 +1,50 @@
+#!/usr/bin/env bash
+# Regression test 21.
+# Same setup as test 01, but with periodic checkpoints written by the I/O
+# thread (CHECKPT_INTERVAL, CHECKPT_ASYNC=1).  The run is then continued
+# from the last checkpoint (CHECKPTREAD=2).  Both runs must give the
+# seismograms of test 01.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_01"
+readonly TEST_ID="TEST_21"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy test model and switch on the periodic checkpoints.
+cp "${TEST_PATH}/src/model_elastic.c"       src/
+cp "${TEST_PATH}/in_and_out/asofi3D.json"   tmp/in_and_out
+cp "${TEST_PATH}/sources/source.dat"        tmp/sources/
+sed -i 's/"CHECKPTWRITE" : "0",/"CHECKPTWRITE" : "0",\n\t\t\t"CHECKPT_INTERVAL" : "150",\n\t\t\t"CHECKPT_ASYNC" : "1",/' \
+    tmp/in_and_out/asofi3D.json
+sed -i 's#"CHECKPT_FILE" : "[^"]*"#"CHECKPT_FILE" : "snap/checkpoint_sofi3D"#' \
+    tmp/in_and_out/asofi3D.json
+
+compile_code
+
+for run in 1 2; do
+    run_solver np=16 dir=tmp log=ASOFI3D.log
+
+    # Convert seismograms in SEG-Y format to the Madagascar RSF format.
+    convert_segy_to_rsf tmp/su/test_vx.sgy
+    convert_segy_to_rsf ${TEST_PATH}/su/test_vx.sgy
+
+    # Read the files.
+    # Compare with the old output.
+    tests/compare_datasets.py tmp/su/test_vx.rsf ${TEST_PATH}/su/test_vx.rsf \
+                              --rtol=1e-12 --atol=1e-14
+    result=$?
+    if [ "$result" -ne "0" ]; then
+        error "Velocity x-component seismograms differ (run ${run})"
+    fi
+
+    # Continue from the last checkpoint.
+    rm -f tmp/su/test_vx.sgy tmp/su/test_vx.rsf
+    sed -i 's/"CHECKPTREAD" : "0",/"CHECKPTREAD" : "2",/' tmp/in_and_out/asofi3D.json
+done
+
+log "PASS"
@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+# Regression test 24.
+# Same setup as test 22 (DECOMP=1 on 5 x 3 PEs), but the source of test 01
+# is fired twice (RUN_MULTIPLE_SHOTS=1) and the sub grids may be rebalanced
+# after the first shot with the measured times (REBALANCE=1).
+# The seismograms of both shots must be those of test 01.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_01"
+readonly TEST_ID="TEST_24"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy test model, repeat the source and switch on the rebalancing.
+cp "${TEST_PATH}/src/model_elastic.c"       src/
+cp "${TEST_PATH}/in_and_out/asofi3D.json"   tmp/in_and_out
+source_line=$(grep -v '^#' "${TEST_PATH}/sources/source.dat" | grep .)
+printf '%s\n%s\n' "${source_line}" "${source_line}" > tmp/sources/source.dat
+sed -i 's/"NPROCX" : "4",/"NPROCX" : "5",/' tmp/in_and_out/asofi3D.json
+sed -i 's/"NPROCY" : "4",/"NPROCY" : "3",\n\t\t\t"DECOMP" : "1",\n\t\t\t"REBALANCE" : "1",/' tmp/in_and_out/asofi3D.json
+sed -i 's/"RUN_MULTIPLE_SHOTS" : "0",/"RUN_MULTIPLE_SHOTS" : "1",/' tmp/in_and_out/asofi3D.json
+sed -i 's/"SNAP" : "3",/"SNAP" : "0",/' tmp/in_and_out/asofi3D.json
+
+compile_code
+
+run_solver np=15 dir=tmp log=ASOFI3D.log
+
+# Convert seismograms in SEG-Y format to the Madagascar RSF format.
+convert_segy_to_rsf ${TEST_PATH}/su/test_vx.sgy
+for shot in 1 2; do
+    cp tmp/su/test_vx.sgy.shot${shot} tmp/su/test_vx_shot${shot}.sgy
+    convert_segy_to_rsf tmp/su/test_vx_shot${shot}.sgy
+
+    # Compare with the old output.
+    tests/compare_datasets.py tmp/su/test_vx_shot${shot}.rsf ${TEST_PATH}/su/test_vx.rsf \
+                              --rtol=1e-12 --atol=1e-14
+    result=$?
+    if [ "$result" -ne "0" ]; then
+        error "Velocity x-component seismograms of shot ${shot} differ"
+    fi
+done
+
+log "PASS"
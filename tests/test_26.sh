@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+# Regression test 26.
+# Same setup as test 01 with the damping boundary (ABS_TYPE=2), run once with
+# the halo exchange in every time step and once with the deep halo exchanged
+# every second time step (HALO_DEEP=2).  The seismograms must be the same.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_01"
+readonly TEST_ID="TEST_26"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy test model and switch to the damping boundary.
+cp "${TEST_PATH}/src/model_elastic.c"       src/
+cp "${TEST_PATH}/in_and_out/asofi3D.json"   tmp/in_and_out
+cp "${TEST_PATH}/sources/source.dat"        tmp/sources/
+sed -i 's/"ABS_TYPE" : "1",/"ABS_TYPE" : "2",/' tmp/in_and_out/asofi3D.json
+
+compile_code
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+mv tmp/su/test_vx.sgy tmp/su/test_vx_ref.sgy
+
+# Switch on the deep halo and run again.
+sed -i 's/"NPROCZ" : "1",/"NPROCZ" : "1",\n\t\t\t"HALO_DEEP" : "2",/' \
+    tmp/in_and_out/asofi3D.json
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+
+# Convert seismograms in SEG-Y format to the Madagascar RSF format.
+convert_segy_to_rsf tmp/su/test_vx.sgy
+convert_segy_to_rsf tmp/su/test_vx_ref.sgy
+
+# Read the files.
+# Compare with the output of the exchange in every time step.
+tests/compare_datasets.py tmp/su/test_vx.rsf tmp/su/test_vx_ref.rsf \
+                          --rtol=1e-12 --atol=1e-14
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Velocity x-component seismograms differ"
+fi
+
+log "PASS"
@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# Regression test 27.
+# Same setup as test 01, but the stress update uses the portable loops
+# (SIMD_KERNEL=1) and the AVX2 kernels (SIMD_KERNEL=2) instead of the widest
+# kernel supported by the CPU.  The result must not change.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_01"
+readonly TEST_ID="TEST_27"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy test model.
+cp "${TEST_PATH}/src/model_elastic.c"       src/
+cp "${TEST_PATH}/sources/source.dat"        tmp/sources/
+
+compile_code
+
+convert_segy_to_rsf ${TEST_PATH}/su/test_vx.sgy
+
+for kernel in 1 2; do
+    # Select the kernel of the stress update.
+    cp "${TEST_PATH}/in_and_out/asofi3D.json"   tmp/in_and_out
+    sed -i "s/\"FDCOEFF\" : \"2\",/\"FDCOEFF\" : \"2\",\n\t\t\t\"SIMD_KERNEL\" : \"${kernel}\",/" \
+        tmp/in_and_out/asofi3D.json
+
+    run_solver np=16 dir=tmp log=ASOFI3D.log
+
+    # Convert seismograms in SEG-Y format to the Madagascar RSF format.
+    convert_segy_to_rsf tmp/su/test_vx.sgy
+
+    # Read the files.
+    # Compare with the old output.
+    tests/compare_datasets.py tmp/su/test_vx.rsf ${TEST_PATH}/su/test_vx.rsf \
+                              --rtol=1e-12 --atol=1e-14
+    result=$?
+    if [ "$result" -ne "0" ]; then
+        error "Velocity x-component seismograms differ (SIMD_KERNEL=${kernel})"
+    fi
+done
+
+log "PASS"
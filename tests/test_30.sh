@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# Regression test 30.
+# Same setup as test 01, but the FD coefficients are multiplied by DT/DX,
+# DT/DY and DT/DZ at startup (FOLD_COEFF=1).  The result differs by rounding
+# errors only, but the receivers lie in the CPML frame, where such errors
+# grow to about 1e-6 (0.2 % of the largest amplitude) at the end of the
+# seismograms, as much as for a change of DT by 5e-7.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_01"
+readonly TEST_ID="TEST_30"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy test model and fold the grid spacing and time step into the FD coefficients.
+cp "${TEST_PATH}/src/model_elastic.c"       src/
+cp "${TEST_PATH}/in_and_out/asofi3D.json"   tmp/in_and_out
+cp "${TEST_PATH}/sources/source.dat"        tmp/sources/
+sed -i 's/"FDCOEFF" : "2",/"FDCOEFF" : "2",\n\t\t\t"FOLD_COEFF" : "1",/' \
+    tmp/in_and_out/asofi3D.json
+
+compile_code
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+
+# Convert seismograms in SEG-Y format to the Madagascar RSF format.
+convert_segy_to_rsf tmp/su/test_vx.sgy
+convert_segy_to_rsf ${TEST_PATH}/su/test_vx.sgy
+
+# Read the files.
+# Compare with the old output, the bound is twice the difference above.
+tests/compare_datasets.py tmp/su/test_vx.rsf ${TEST_PATH}/su/test_vx.rsf \
+                          --rtol=1e-5 --atol=2e-6
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Velocity x-component seismograms differ"
+fi
+
+log "PASS"
@@ -0,0 +1,76 @@
+#!/usr/bin/env bash
+# Regression test 31.
+# Same setup as test 01, but the velocities and the density of the model of
+# test 01 (without its anisotropy) are first written to the files
+# model/read.vp, .vs and .rho and then read from them (READMOD=1), once on
+# the 4 x 4 PEs of test 01 and once with the cost-weighted domain
+# decomposition (DECOMP=1) on 5 x 3 PEs.  Each PE reads its subdomain with
+# MPI-IO and writes it back to its own file (WRITE_MODELFILES=1), the merged
+# files must be those read.  The seismograms of both runs must be the same.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_01"
+readonly TEST_ID="TEST_31"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+backup_default_model
+
+# Copy test model and write the model files on the full grid.
+cp "${TEST_PATH}/src/model_elastic.c"       src/
+cp "${TEST_PATH}/in_and_out/asofi3D.json"   tmp/in_and_out
+cp "${TEST_PATH}/sources/source.dat"        tmp/sources/
+sed -i -e 's/"WRITE_MODELFILES" : "0",/"WRITE_MODELFILES" : "1",/' \
+       -e 's/"SNAP" : "3",/"SNAP" : "0",/' \
+       -e 's/"ID\([XYZ]\)" : "2",/"ID\1" : "1",/' \
+    tmp/in_and_out/asofi3D.json
+
+compile_code
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+
+for q in vp vs rho; do
+    mv "tmp/model/test.SOFI3D.${q}" "tmp/model/read.${q}"
+done
+
+# Read the model files.
+sed -i -e 's/"READMOD" : "0",/"READMOD" : "1",/' \
+       -e 's/"MFILE" : "model\/test",/"MFILE" : "model\/read",/' \
+    tmp/in_and_out/asofi3D.json
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+mv tmp/su/test_vx.sgy tmp/su/test_vx_ref.sgy
+
+for q in vp vs rho; do
+    cmp "tmp/model/read.SOFI3D.${q}" "tmp/model/read.${q}" \
+        || error "Model file ${q} read on 4 x 4 PEs differs"
+done
+rm -f tmp/model/read.SOFI3D.*
+
+# Read the model files on the non-uniform slabs.
+sed -i 's/"NPROCX" : "4",/"NPROCX" : "5",/' tmp/in_and_out/asofi3D.json
+sed -i 's/"NPROCY" : "4",/"NPROCY" : "3",\n\t\t\t"DECOMP" : "1",/' tmp/in_and_out/asofi3D.json
+
+run_solver np=15 dir=tmp log=ASOFI3D.log
+
+for q in vp vs rho; do
+    cmp "tmp/model/read.SOFI3D.${q}" "tmp/model/read.${q}" \
+        || error "Model file ${q} read with DECOMP=1 differs"
+done
+
+# Convert seismograms in SEG-Y format to the Madagascar RSF format.
+convert_segy_to_rsf tmp/su/test_vx.sgy
+convert_segy_to_rsf tmp/su/test_vx_ref.sgy
+
+# Read the files.
+# Compare with the output of the uniform grid.
+tests/compare_datasets.py tmp/su/test_vx.rsf tmp/su/test_vx_ref.rsf \
+                          --rtol=1e-12 --atol=1e-14
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Velocity x-component seismograms differ"
+fi
+
+log "PASS"
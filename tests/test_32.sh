@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+# Regression test 32.
+# Same setup as test 15, but the snapshots are written directly to the global
+# files with MPI-IO (SNAP_MPIIO=1) instead of being merged by snapmerge.
+# The result must not change.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_15"
+readonly TEST_ID="TEST_32"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+# Copy test model and write the snapshots with MPI-IO.
+cp "${TEST_PATH}/asofi3D.json"   tmp/in_and_out
+cp "${TEST_PATH}/source.dat"     tmp/sources/
+sed -i 's/"SNAP_FORMAT" : "3",/"SNAP_FORMAT" : "3",\n\t"SNAP_MPIIO" : "1",/' \
+    tmp/in_and_out/asofi3D.json
+
+compile_code
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+
+# Read the files.
+# Compare with the old output.
+tests/compare_datasets.py \
+    tmp/snap/test.bin.div ${TEST_PATH}/snap/test.bin.div \
+    --rtol=1e-12 --atol=1e-14
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Snapshots .div differ"
+fi
+
+log "PASS"
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+# Regression test 33.
+# Same setup as test 15, but the snapshots are written by the I/O thread
+# from staging buffers (SNAP_ASYNC=1).  The result must not change.
+. tests/functions.sh
+
+readonly MODEL="src/model_elastic.c"
+readonly TEST_PATH="tests/fixtures/test_15"
+readonly TEST_ID="TEST_33"
+
+# Setup function prepares environment for the test (creates directories).
+setup
+
+# Copy test model and write the snapshots asynchronously.
+cp "${TEST_PATH}/asofi3D.json"   tmp/in_and_out
+cp "${TEST_PATH}/source.dat"     tmp/sources/
+sed -i 's/"SNAP_FORMAT" : "3",/"SNAP_FORMAT" : "3",\n\t"SNAP_ASYNC" : "1",/' \
+    tmp/in_and_out/asofi3D.json
+
+compile_code
+
+run_solver np=16 dir=tmp log=ASOFI3D.log
+
+# Read the files.
+# Compare with the old output.
+tests/compare_datasets.py \
+    tmp/snap/test.bin.div ${TEST_PATH}/snap/test.bin.div \
+    --rtol=1e-12 --atol=1e-14
+result=$?
+if [ "$result" -ne "0" ]; then
+    error "Snapshots .div differ"
+fi
+
+log "PASS"